@@ -178,6 +178,18 @@ ScopedAStatus AidlCameraDevice::constructDefaultRequestSettings(
         static_cast<int32_t>(Status::ILLEGAL_ARGUMENT));
   }
 
+  // Default request settings don't change for a device. Apps usually ask for
+  // the same templates repeatedly while starting up.
+  auto template_index = static_cast<size_t>(hal_type);
+  bool cacheable = template_index < google_camera_hal::kTemplateCount;
+  if (cacheable) {
+    std::lock_guard<std::mutex> lock(default_request_settings_lock_);
+    if (!default_request_settings_[template_index].empty()) {
+      request_settings->metadata = default_request_settings_[template_index];
+      return ScopedAStatus::ok();
+    }
+  }
+
   std::unique_ptr<HalCameraMetadata> settings;
   res = google_camera_device_->ConstructDefaultRequestSettings(hal_type,
                                                                &settings);
@@ -198,6 +210,11 @@ ScopedAStatus AidlCameraDevice::constructDefaultRequestSettings(
   uint8_t* chars_p = (uint8_t*)settings->GetRawCameraMetadata();
   request_settings->metadata.assign(chars_p, chars_p + metadata_size);
 
+  if (cacheable) {
+    std::lock_guard<std::mutex> lock(default_request_settings_lock_);
+    default_request_settings_[template_index] = request_settings->metadata;
+  }
+
   return ScopedAStatus::ok();
 }
 
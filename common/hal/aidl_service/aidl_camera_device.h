@@ -20,6 +20,10 @@
 #include <aidl/android/hardware/camera/device/BnCameraDevice.h>
 #include <aidl/android/hardware/camera/device/ICameraDeviceCallback.h>
 
+#include <array>
+#include <mutex>
+#include <vector>
+
 #include "aidl_profiler.h"
 #include "camera_device.h"
 
@@ -107,6 +111,12 @@ class AidlCameraDevice : public BnCameraDevice {
   uint32_t camera_id_ = 0;
   std::shared_ptr<AidlProfiler> aidl_profiler_;
 
+  std::mutex default_request_settings_lock_;
+  // Converted default request settings of each template, empty until first
+  // constructed. Protected by default_request_settings_lock_.
+  std::array<std::vector<uint8_t>, google_camera_hal::kTemplateCount>
+      default_request_settings_;
+
   ScopedAStatus isStreamCombinationSupportedInternal(
       const StreamConfiguration& streamConfiguration, bool* supported,
       bool checkSettings);
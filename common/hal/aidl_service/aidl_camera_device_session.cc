@@ -24,6 +24,7 @@
 #include <android/binder_manager.h>
 #include <cutils/properties.h>
 #include <cutils/trace.h>
+#include <inttypes.h>
 #include <log/log.h>
 #include <malloc.h>
 #include <ui/GraphicBufferMapper.h>
@@ -116,6 +117,7 @@ void AidlCameraDeviceSession::ProcessCaptureResult(
           strerror(-res), res);
     return;
   }
+  UpdateResultMetadataQueueStats(aidl_results[0]);
 
   auto aidl_res = aidl_device_callback_->processCaptureResult(aidl_results);
   if (!aidl_res.isOk()) {
@@ -153,6 +155,7 @@ void AidlCameraDeviceSession::ProcessBatchCaptureResult(
             strerror(-res), res);
       return;
     }
+    UpdateResultMetadataQueueStats(aidl_result);
   }
 
   auto aidl_res = aidl_device_callback_->processCaptureResult(aidl_results);
@@ -163,6 +166,22 @@ void AidlCameraDeviceSession::ProcessBatchCaptureResult(
   }
 }
 
+void AidlCameraDeviceSession::UpdateResultMetadataQueueStats(
+    const CaptureResult& aidl_result) {
+  uint64_t num_fallbacks = result_metadata_queue_stats_.num_fallbacks;
+  aidl_utils::UpdateResultMetadataQueueStats(aidl_result,
+                                             &result_metadata_queue_stats_);
+  uint64_t new_num_fallbacks = result_metadata_queue_stats_.num_fallbacks;
+  if (new_num_fallbacks / kResultMetadataFallbackLogInterval !=
+      num_fallbacks / kResultMetadataFallbackLogInterval) {
+    ALOGW("%s: %" PRIu64 " of %" PRIu64
+          " result metadata fell back to the AIDL parcel. Consider a larger "
+          "result metadata queue.",
+          __FUNCTION__, new_num_fallbacks,
+          new_num_fallbacks + result_metadata_queue_stats_.num_fmq_writes);
+  }
+}
+
 void AidlCameraDeviceSession::NotifyHalMessage(
     const google_camera_hal::NotifyMessage& hal_message) {
   std::shared_lock lock(aidl_device_callback_lock_);
@@ -384,6 +403,17 @@ status_t AidlCameraDeviceSession::Initialize(
   device_session_ = std::move(device_session);
   aidl_profiler_ = aidl_profiler;
 
+  request_submitter_ = AidlRequestSubmitter::Create(
+      [this](const std::vector<google_camera_hal::CaptureRequest>& requests,
+             uint32_t* num_processed_requests) {
+        return device_session_->ProcessCaptureRequest(requests,
+                                                      num_processed_requests);
+      });
+  if (request_submitter_ == nullptr) {
+    ALOGW("%s: Creating request submitter failed. Submitting inline.",
+          __FUNCTION__);
+  }
+
   SetSessionCallbacks();
   return OK;
 }
@@ -549,6 +579,17 @@ ndk::ScopedAStatus AidlCameraDeviceSession::constructDefaultRequestSettings(
         static_cast<int32_t>(Status::ILLEGAL_ARGUMENT));
   }
 
+  // Default request settings don't change during a session.
+  auto template_index = static_cast<size_t>(hal_type);
+  bool cacheable = template_index < google_camera_hal::kTemplateCount;
+  if (cacheable) {
+    std::lock_guard<std::mutex> lock(default_request_settings_lock_);
+    if (!default_request_settings_[template_index].empty()) {
+      aidl_return->metadata = default_request_settings_[template_index];
+      return ndk::ScopedAStatus::ok();
+    }
+  }
+
   std::unique_ptr<google_camera_hal::HalCameraMetadata> settings = nullptr;
   res = device_session_->ConstructDefaultRequestSettings(hal_type, &settings);
   if (res != OK) {
@@ -556,8 +597,14 @@ ndk::ScopedAStatus AidlCameraDeviceSession::constructDefaultRequestSettings(
   }
 
   uint32_t metadata_size = settings->GetCameraMetadataSize();
-  uint8_t* settings_p = (uint8_t*)settings->ReleaseCameraMetadata();
+  const uint8_t* settings_p =
+      reinterpret_cast<const uint8_t*>(settings->GetRawCameraMetadata());
   aidl_return->metadata.assign(settings_p, settings_p + metadata_size);
+
+  if (cacheable) {
+    std::lock_guard<std::mutex> lock(default_request_settings_lock_);
+    default_request_settings_[template_index] = aidl_return->metadata;
+  }
   return ndk::ScopedAStatus::ok();
 }
 
@@ -693,34 +740,42 @@ ndk::ScopedAStatus AidlCameraDeviceSession::processCaptureRequest(
 
   // Converting AIDL requests to HAL requests.
   std::vector<native_handle_t*> handles_to_delete;
-  std::vector<google_camera_hal::CaptureRequest> hal_requests;
-  for (auto& request : requests) {
-    google_camera_hal::CaptureRequest hal_request = {};
-    res = aidl_utils::ConvertToHalCaptureRequest(
-        request, request_metadata_queue_.get(), &hal_request,
-        &handles_to_delete);
-    if (res != OK) {
-      ALOGE("%s: Converting to HAL capture request failed: %s(%d)",
-            __FUNCTION__, strerror(-res), res);
-      if (profile_first_request) {
-        ATRACE_END();
+  uint32_t num_processed_requests = 0;
+  if (requests.size() > 1 && request_submitter_ != nullptr) {
+    // Request N is submitted while request N+1 is being converted.
+    res = request_submitter_->SubmitBatch(requests,
+                                          request_metadata_queue_.get(),
+                                          &handles_to_delete,
+                                          &num_processed_requests);
+  } else {
+    std::vector<google_camera_hal::CaptureRequest> hal_requests;
+    for (auto& request : requests) {
+      google_camera_hal::CaptureRequest hal_request = {};
+      res = aidl_utils::ConvertToHalCaptureRequest(
+          request, request_metadata_queue_.get(), &hal_request,
+          &handles_to_delete);
+      if (res != OK) {
+        ALOGE("%s: Converting to HAL capture request failed: %s(%d)",
+              __FUNCTION__, strerror(-res), res);
+        if (profile_first_request) {
+          ATRACE_END();
+        }
+        cleanupHandles(handles_to_delete);
+        return aidl_utils::ConvertToAidlReturn(res);
       }
-      cleanupHandles(handles_to_delete);
-      return aidl_utils::ConvertToAidlReturn(res);
+
+      hal_requests.push_back(std::move(hal_request));
     }
 
-    hal_requests.push_back(std::move(hal_request));
+    res = device_session_->ProcessCaptureRequest(hal_requests,
+                                                 &num_processed_requests);
   }
-
-  uint32_t num_processed_requests = 0;
-  res = device_session_->ProcessCaptureRequest(hal_requests,
-                                               &num_processed_requests);
   if (res != OK) {
     ALOGE(
         "%s: Processing capture request failed: %s(%d). Only processed %u"
         " out of %zu.",
         __FUNCTION__, strerror(-res), res, num_processed_requests,
-        hal_requests.size());
+        requests.size());
   }
   if (num_processed_requests > INT_MAX) {
     cleanupHandles(handles_to_delete);
@@ -776,7 +831,19 @@ ndk::ScopedAStatus AidlCameraDeviceSession::close() {
                                      aidl_profiler_->GetLatencyFlag()),
         device_session_->GetProfiler(aidl_profiler_->GetCameraId(),
                                      aidl_profiler_->GetFpsFlag()));
+    // Stop the submitter thread before the device session it submits to.
+    request_submitter_ = nullptr;
     device_session_ = nullptr;
+
+    uint64_t num_fmq_writes = result_metadata_queue_stats_.num_fmq_writes;
+    uint64_t num_fallbacks = result_metadata_queue_stats_.num_fallbacks;
+    if (num_fmq_writes + num_fallbacks > 0) {
+      ALOGI("%s: Result metadata: %" PRIu64 " via FMQ (%" PRIu64
+            " bytes), %" PRIu64 " via AIDL parcel (%" PRIu64 " bytes).",
+            __FUNCTION__, num_fmq_writes,
+            result_metadata_queue_stats_.fmq_bytes.load(), num_fallbacks,
+            result_metadata_queue_stats_.fallback_bytes.load());
+    }
   }
   return ndk::ScopedAStatus::ok();
 }
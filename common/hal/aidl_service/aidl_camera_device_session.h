@@ -25,10 +25,13 @@
 #include <fmq/AidlMessageQueue.h>
 #include <utils/StrongPointer.h>
 
+#include <array>
 #include <shared_mutex>
 #include <vector>
 
 #include "aidl_profiler.h"
+#include "aidl_request_submitter.h"
+#include "aidl_utils.h"
 #include "camera_device_session.h"
 #include "hal_types.h"
 
@@ -129,6 +132,9 @@ class AidlCameraDeviceSession
   static constexpr uint32_t kRequestMetadataQueueSizeBytes = 1 << 20;  // 1MB
   static constexpr uint32_t kResultMetadataQueueSizeBytes = 1 << 20;   // 1MB
 
+  // Warn once every this many results that fall back to the AIDL parcel.
+  static constexpr uint64_t kResultMetadataFallbackLogInterval = 100;
+
   // Initialize the latest available gralloc buffer mapper.
   status_t InitializeBufferMapper();
 
@@ -195,18 +201,31 @@ class AidlCameraDeviceSession
   // Unregister thermal changed callback.
   void UnregisterThermalChangedCallback();
 
+  // Account a converted result in result_metadata_queue_stats_ and warn
+  // periodically when results fall back to copying metadata into the parcel.
+  void UpdateResultMetadataQueueStats(
+      const aidl::android::hardware::camera::device::CaptureResult& aidl_result);
+
   // Log when the first frame buffers are all received.
   void TryLogFirstFrameDone(const google_camera_hal::CaptureResult& result,
                             const char* caller_func_name);
 
   std::unique_ptr<google_camera_hal::CameraDeviceSession> device_session_;
 
+  // Submits multi-request batches to device_session_ while the rest of the
+  // batch is being converted. nullptr if batches are submitted inline.
+  std::unique_ptr<AidlRequestSubmitter> request_submitter_;
+
   // Metadata queue to read the request metadata from.
   std::unique_ptr<MetadataQueue> request_metadata_queue_;
 
   // Metadata queue to write the result metadata to.
   std::unique_ptr<MetadataQueue> result_metadata_queue_;
 
+  // How result metadata was delivered, reported when the session closes.
+  android::hardware::camera::implementation::aidl_utils::ResultMetadataQueueStats
+      result_metadata_queue_stats_;
+
   // Assuming callbacks to framework is thread-safe, the shared mutex is only
   // used to protect member variable writing and reading.
   std::shared_mutex aidl_device_callback_lock_;
@@ -234,6 +253,12 @@ class AidlCameraDeviceSession
 
   std::shared_ptr<android::hardware::camera::implementation::AidlProfiler>
       aidl_profiler_;
+
+  std::mutex default_request_settings_lock_;
+  // Converted default request settings of each template, empty until first
+  // constructed.
+  std::array<std::vector<uint8_t>, google_camera_hal::kTemplateCount>
+      default_request_settings_ GUARDED_BY(default_request_settings_lock_);
 };
 
 }  // namespace implementation
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "GCH_AidlRequestSubmitter"
+#define ATRACE_TAG ATRACE_TAG_CAMERA
+// #define LOG_NDEBUG 0
+#include "aidl_request_submitter.h"
+
+#include <log/log.h>
+#include <utils/Trace.h>
+
+namespace android {
+namespace hardware {
+namespace camera {
+namespace device {
+namespace implementation {
+
+namespace aidl_utils = ::android::hardware::camera::implementation::aidl_utils;
+
+std::unique_ptr<AidlRequestSubmitter> AidlRequestSubmitter::Create(
+    SubmitFunc submit, size_t max_queued_requests) {
+  if (submit == nullptr || max_queued_requests == 0) {
+    ALOGE("%s: submit is nullptr or max_queued_requests is 0.", __FUNCTION__);
+    return nullptr;
+  }
+
+  return std::unique_ptr<AidlRequestSubmitter>(
+      new AidlRequestSubmitter(std::move(submit), max_queued_requests));
+}
+
+AidlRequestSubmitter::AidlRequestSubmitter(SubmitFunc submit,
+                                           size_t max_queued_requests)
+    : submit_(std::move(submit)), max_queued_requests_(max_queued_requests) {
+  submit_thread_ = std::thread([this] { SubmitThreadLoop(); });
+}
+
+AidlRequestSubmitter::~AidlRequestSubmitter() {
+  {
+    std::lock_guard<std::mutex> lock(queue_lock_);
+    exiting_ = true;
+    if (!queued_requests_.empty()) {
+      ALOGW("%s: Dropping %zu queued requests.", __FUNCTION__,
+            queued_requests_.size());
+      queued_requests_.clear();
+    }
+  }
+  queue_cond_.notify_all();
+  if (submit_thread_.joinable()) {
+    submit_thread_.join();
+  }
+}
+
+status_t AidlRequestSubmitter::SubmitBatch(
+    const std::vector<aidl::android::hardware::camera::device::CaptureRequest>&
+        requests,
+    MetadataQueue* request_metadata_queue,
+    std::vector<native_handle_t*>* handles_to_delete,
+    uint32_t* num_processed_requests) {
+  ATRACE_CALL();
+  // Request N is submitted on the submission thread while request N+1 is
+  // being converted here. Request settings must be read from the FMQ in
+  // order, so conversion stays on the calling thread.
+  BeginBatch();
+  status_t res = OK;
+  size_t num_converted = 0;
+  for (; num_converted < requests.size(); num_converted++) {
+    google_camera_hal::CaptureRequest hal_request = {};
+    res = aidl_utils::ConvertToHalCaptureRequest(
+        requests[num_converted], request_metadata_queue, &hal_request,
+        handles_to_delete);
+    if (res != OK) {
+      ALOGE("%s: Converting to HAL capture request failed: %s(%d)",
+            __FUNCTION__, strerror(-res), res);
+      num_converted++;
+      break;
+    }
+
+    if (QueueRequest(std::move(hal_request)) != OK) {
+      // An earlier request failed to submit. EndBatch() reports it.
+      num_converted++;
+      break;
+    }
+  }
+
+  // The remaining requests are dropped, but their settings were queued by
+  // the client and must still be consumed.
+  for (size_t i = num_converted; i < requests.size(); i++) {
+    aidl_utils::SkipCaptureRequestSettings(requests[i],
+                                           request_metadata_queue);
+  }
+
+  // Wait for the batch to drain so the number of processed requests is
+  // accurate and the imported handles are no longer in use.
+  status_t submit_res = EndBatch(num_processed_requests);
+  return res != OK ? res : submit_res;
+}
+
+void AidlRequestSubmitter::BeginBatch() {
+  batch_lock_.lock();
+  std::lock_guard<std::mutex> lock(queue_lock_);
+  batch_status_ = OK;
+  num_processed_requests_ = 0;
+}
+
+status_t AidlRequestSubmitter::QueueRequest(
+    google_camera_hal::CaptureRequest request) {
+  ATRACE_CALL();
+  std::unique_lock<std::mutex> lock(queue_lock_);
+  queue_cond_.wait(lock, [this] {
+    base::ScopedLockAssertion assertion(queue_lock_);
+    return exiting_ || batch_status_ != OK ||
+           queued_requests_.size() < max_queued_requests_;
+  });
+
+  if (exiting_) {
+    return NO_INIT;
+  }
+  if (batch_status_ != OK) {
+    return batch_status_;
+  }
+
+  queued_requests_.push_back(std::move(request));
+  lock.unlock();
+  queue_cond_.notify_all();
+  return OK;
+}
+
+status_t AidlRequestSubmitter::EndBatch(uint32_t* num_processed_requests) {
+  ATRACE_CALL();
+  status_t res;
+  {
+    std::unique_lock<std::mutex> lock(queue_lock_);
+    queue_cond_.wait(lock, [this] {
+      base::ScopedLockAssertion assertion(queue_lock_);
+      return exiting_ || (queued_requests_.empty() && !submitting_);
+    });
+    res = exiting_ && batch_status_ == OK ? NO_INIT : batch_status_;
+    if (num_processed_requests != nullptr) {
+      *num_processed_requests = num_processed_requests_;
+    }
+  }
+  batch_lock_.unlock();
+  return res;
+}
+
+void AidlRequestSubmitter::SubmitThreadLoop() {
+  std::unique_lock<std::mutex> lock(queue_lock_);
+  while (true) {
+    queue_cond_.wait(lock, [this] {
+      base::ScopedLockAssertion assertion(queue_lock_);
+      return exiting_ || !queued_requests_.empty();
+    });
+    if (exiting_) {
+      return;
+    }
+
+    google_camera_hal::CaptureRequest request =
+        std::move(queued_requests_.front());
+    queued_requests_.pop_front();
+    if (batch_status_ != OK) {
+      // An earlier request of the batch failed. Drop the rest of the batch.
+      queue_cond_.notify_all();
+      continue;
+    }
+
+    submitting_ = true;
+    lock.unlock();
+    queue_cond_.notify_all();
+
+    std::vector<google_camera_hal::CaptureRequest> requests(1);
+    requests[0] = std::move(request);
+    uint32_t num_processed = 0;
+    status_t res = submit_(requests, &num_processed);
+
+    lock.lock();
+    submitting_ = false;
+    num_processed_requests_ += num_processed;
+    if (res != OK) {
+      ALOGE("%s: Submitting request %u failed: %s(%d)", __FUNCTION__,
+            requests[0].frame_number, strerror(-res), res);
+      batch_status_ = res;
+      queued_requests_.clear();
+    }
+    queue_cond_.notify_all();
+  }
+}
+
+}  // namespace implementation
+}  // namespace device
+}  // namespace camera
+}  // namespace hardware
+}  // namespace android
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HARDWARE_GOOGLE_CAMERA_HAL_AIDL_SERVICE_AIDL_REQUEST_SUBMITTER_H_
+#define HARDWARE_GOOGLE_CAMERA_HAL_AIDL_SERVICE_AIDL_REQUEST_SUBMITTER_H_
+
+#include <android-base/thread_annotations.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "aidl_utils.h"
+#include "hal_types.h"
+
+namespace android {
+namespace hardware {
+namespace camera {
+namespace device {
+namespace implementation {
+
+// AidlRequestSubmitter submits converted capture requests to the device
+// session on a dedicated thread, so the binder thread can convert request
+// N+1 while request N is being submitted to the HWL.
+// Requests are submitted in batches matching one processCaptureRequest call,
+// either with SubmitBatch(), or with:
+//   BeginBatch();
+//   for each request: convert, then QueueRequest();
+//   EndBatch(&num_processed);
+// Once a request of a batch fails to submit, the rest of the batch is
+// dropped, matching CameraDeviceSession::ProcessCaptureRequest.
+class AidlRequestSubmitter {
+ public:
+  // Submit requests to the device session. It has the signature of
+  // CameraDeviceSession::ProcessCaptureRequest.
+  using MetadataQueue = AidlMessageQueue<
+      int8_t, aidl::android::hardware::common::fmq::SynchronizedReadWrite>;
+
+  using SubmitFunc = std::function<status_t(
+      const std::vector<google_camera_hal::CaptureRequest>& requests,
+      uint32_t* num_processed_requests)>;
+
+  // max_queued_requests is the number of converted requests that can wait for
+  // submission before QueueRequest blocks.
+  static std::unique_ptr<AidlRequestSubmitter> Create(
+      SubmitFunc submit, size_t max_queued_requests = kDefaultMaxQueuedRequests);
+
+  // Stop the submission thread. Requests still queued are dropped.
+  ~AidlRequestSubmitter();
+
+  // Convert requests on the calling thread and submit them on the submission
+  // thread as they are converted. Request settings are read from
+  // request_metadata_queue in order. When a request fails to convert or
+  // submit, the settings of the remaining requests are consumed without being
+  // converted so the queue stays in sync with the next batch. Return the first
+  // conversion or submission error, or OK. num_processed_requests is set to
+  // the number of requests submitted successfully.
+  status_t SubmitBatch(
+      const std::vector<aidl::android::hardware::camera::device::CaptureRequest>&
+          requests,
+      MetadataQueue* request_metadata_queue,
+      std::vector<native_handle_t*>* handles_to_delete,
+      uint32_t* num_processed_requests);
+
+  // Start a batch. Only one batch can be in progress at a time.
+  void BeginBatch();
+
+  // Queue a converted request for submission. It blocks while
+  // max_queued_requests requests are waiting. Return the error of an earlier
+  // request in the batch, in which case request is not queued and the
+  // caller should stop converting the batch.
+  status_t QueueRequest(google_camera_hal::CaptureRequest request);
+
+  // Wait until all queued requests of the batch are submitted. Return the
+  // first submission error of the batch, or OK. num_processed_requests is
+  // set to the number of requests submitted successfully.
+  status_t EndBatch(uint32_t* num_processed_requests);
+
+ private:
+  static constexpr size_t kDefaultMaxQueuedRequests = 2;
+
+  AidlRequestSubmitter(SubmitFunc submit, size_t max_queued_requests);
+
+  void SubmitThreadLoop();
+
+  const SubmitFunc submit_;
+  const size_t max_queued_requests_;
+
+  // Serializes batches.
+  std::mutex batch_lock_;
+
+  std::mutex queue_lock_;
+  std::condition_variable queue_cond_;
+
+  // Requests waiting to be submitted.
+  std::deque<google_camera_hal::CaptureRequest> queued_requests_
+      GUARDED_BY(queue_lock_);
+
+  // Whether the submission thread is submitting a request.
+  bool submitting_ GUARDED_BY(queue_lock_) = false;
+
+  // First submission error of the current batch.
+  status_t batch_status_ GUARDED_BY(queue_lock_) = OK;
+
+  // Requests of the current batch submitted successfully.
+  uint32_t num_processed_requests_ GUARDED_BY(queue_lock_) = 0;
+
+  bool exiting_ GUARDED_BY(queue_lock_) = false;
+
+  std::thread submit_thread_;
+};
+
+}  // namespace implementation
+}  // namespace device
+}  // namespace camera
+}  // namespace hardware
+}  // namespace android
+
+#endif  // HARDWARE_GOOGLE_CAMERA_HAL_AIDL_SERVICE_AIDL_REQUEST_SUBMITTER_H_
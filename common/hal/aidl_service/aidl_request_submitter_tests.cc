@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "AidlRequestSubmitterTests"
+
+#include "aidl_request_submitter.h"
+
+#include <gtest/gtest.h>
+#include <system/camera_metadata.h>
+
+#include <string>
+#include <vector>
+
+#include "hal_camera_metadata.h"
+
+namespace android {
+namespace hardware {
+namespace camera {
+namespace device {
+namespace implementation {
+namespace {
+
+using ::aidl::android::hardware::camera::device::BufferStatus;
+using ::aidl::android::hardware::camera::device::CaptureRequest;
+
+constexpr size_t kQueueSizeBytes = 1 << 16;
+constexpr uint32_t kNumRequests = 5;
+constexpr uint32_t kFailedFrameNumber = 2;
+
+// Queue settings tagged with request_id and return their size.
+int32_t QueueSettings(int32_t request_id,
+                      AidlRequestSubmitter::MetadataQueue* queue) {
+  auto settings = google_camera_hal::HalCameraMetadata::Create(
+      /*entry_capacity=*/1, /*data_capacity=*/4);
+  EXPECT_EQ(settings->Set(ANDROID_REQUEST_ID, &request_id, 1), OK);
+  int32_t size = settings->GetCameraMetadataSize();
+  EXPECT_TRUE(queue->write(
+      reinterpret_cast<const int8_t*>(settings->GetRawCameraMetadata()), size));
+  return size;
+}
+
+// Queue settings tagged with the frame number, and the ones of
+// num_physical_cameras physical cameras, and return the request using them.
+CaptureRequest QueueRequestSettings(uint32_t frame_number,
+                                    AidlRequestSubmitter::MetadataQueue* queue,
+                                    uint32_t num_physical_cameras = 0) {
+  CaptureRequest request;
+  request.frameNumber = frame_number;
+  request.fmqSettingsSize = QueueSettings(frame_number, queue);
+  for (uint32_t i = 0; i < num_physical_cameras; i++) {
+    request.physicalCameraSettings.resize(i + 1);
+    auto& physical_settings = request.physicalCameraSettings[i];
+    physical_settings.physicalCameraId = std::to_string(i + 1);
+    physical_settings.fmqSettingsSize = QueueSettings(frame_number, queue);
+  }
+  return request;
+}
+
+int32_t GetRequestId(
+    const std::unique_ptr<google_camera_hal::HalCameraMetadata>& settings) {
+  camera_metadata_ro_entry entry = {};
+  if (settings == nullptr || settings->Get(ANDROID_REQUEST_ID, &entry) != OK ||
+      entry.count != 1) {
+    return -1;
+  }
+  return entry.data.i32[0];
+}
+
+int32_t GetRequestId(const google_camera_hal::CaptureRequest& request) {
+  return GetRequestId(request.settings);
+}
+
+TEST(AidlRequestSubmitterTest, FailedSubmissionKeepsQueueInSync) {
+  AidlRequestSubmitter::MetadataQueue queue(kQueueSizeBytes,
+                                            /*configureEventFlagWord=*/false);
+  std::vector<uint32_t> submitted_frames;
+  auto submitter = AidlRequestSubmitter::Create(
+      [&submitted_frames](
+          const std::vector<google_camera_hal::CaptureRequest>& requests,
+          uint32_t* num_processed_requests) {
+        EXPECT_EQ(requests.size(), 1u);
+        // Settings must match the request they were queued for.
+        EXPECT_EQ(GetRequestId(requests[0]),
+                  static_cast<int32_t>(requests[0].frame_number));
+        if (requests[0].frame_number == kFailedFrameNumber) {
+          *num_processed_requests = 0;
+          return UNKNOWN_ERROR;
+        }
+        submitted_frames.push_back(requests[0].frame_number);
+        *num_processed_requests = 1;
+        return OK;
+      });
+  ASSERT_NE(submitter, nullptr);
+
+  std::vector<CaptureRequest> requests;
+  for (uint32_t i = 0; i < kNumRequests; i++) {
+    requests.push_back(QueueRequestSettings(i, &queue));
+  }
+
+  std::vector<native_handle_t*> handles_to_delete;
+  uint32_t num_processed_requests = 0;
+  EXPECT_EQ(submitter->SubmitBatch(requests, &queue, &handles_to_delete,
+                                   &num_processed_requests),
+            UNKNOWN_ERROR);
+  EXPECT_EQ(num_processed_requests, kFailedFrameNumber);
+  EXPECT_EQ(submitted_frames, std::vector<uint32_t>({0, 1}));
+
+  // The settings of the dropped requests are consumed, so the next batch
+  // reads its own settings.
+  EXPECT_EQ(queue.availableToRead(), 0u);
+  requests = {QueueRequestSettings(kNumRequests, &queue),
+              QueueRequestSettings(kNumRequests + 1, &queue)};
+  submitted_frames.clear();
+  EXPECT_EQ(submitter->SubmitBatch(requests, &queue, &handles_to_delete,
+                                   &num_processed_requests),
+            OK);
+  EXPECT_EQ(num_processed_requests, 2u);
+  EXPECT_EQ(submitted_frames,
+            std::vector<uint32_t>({kNumRequests, kNumRequests + 1}));
+  EXPECT_EQ(queue.availableToRead(), 0u);
+}
+
+TEST(AidlRequestSubmitterTest, FailedConversionKeepsQueueInSync) {
+  AidlRequestSubmitter::MetadataQueue queue(kQueueSizeBytes,
+                                            /*configureEventFlagWord=*/false);
+  uint32_t num_submitted = 0;
+  auto submitter = AidlRequestSubmitter::Create(
+      [&num_submitted](
+          const std::vector<google_camera_hal::CaptureRequest>& requests,
+          uint32_t* num_processed_requests) {
+        num_submitted += requests.size();
+        *num_processed_requests = requests.size();
+        return OK;
+      });
+  ASSERT_NE(submitter, nullptr);
+
+  std::vector<CaptureRequest> requests;
+  for (uint32_t i = 0; i < kNumRequests; i++) {
+    requests.push_back(QueueRequestSettings(i, &queue));
+  }
+  // An output buffer with an unknown status fails to convert.
+  requests[kFailedFrameNumber].outputBuffers.resize(1);
+  requests[kFailedFrameNumber].outputBuffers[0].status =
+      static_cast<BufferStatus>(-1);
+
+  std::vector<native_handle_t*> handles_to_delete;
+  uint32_t num_processed_requests = 0;
+  EXPECT_EQ(submitter->SubmitBatch(requests, &queue, &handles_to_delete,
+                                   &num_processed_requests),
+            BAD_VALUE);
+  EXPECT_EQ(num_processed_requests, kFailedFrameNumber);
+  EXPECT_EQ(num_submitted, kFailedFrameNumber);
+  EXPECT_EQ(queue.availableToRead(), 0u);
+}
+
+TEST(AidlRequestSubmitterTest, FailedPhysicalRequestKeepsQueueInSync) {
+  const uint32_t num_physical_cameras = 2;
+  AidlRequestSubmitter::MetadataQueue queue(kQueueSizeBytes,
+                                            /*configureEventFlagWord=*/false);
+  std::vector<uint32_t> submitted_frames;
+  auto submitter = AidlRequestSubmitter::Create(
+      [&submitted_frames](
+          const std::vector<google_camera_hal::CaptureRequest>& requests,
+          uint32_t* num_processed_requests) {
+        for (const auto& request : requests) {
+          // Logical and physical settings must match the request they were
+          // queued for.
+          int32_t frame_number = request.frame_number;
+          EXPECT_EQ(GetRequestId(request), frame_number);
+          EXPECT_EQ(request.physical_camera_settings.size(),
+                    num_physical_cameras);
+          for (const auto& [camera_id, settings] :
+               request.physical_camera_settings) {
+            EXPECT_EQ(GetRequestId(settings), frame_number)
+                << "physical camera " << camera_id;
+          }
+          submitted_frames.push_back(request.frame_number);
+        }
+        *num_processed_requests = requests.size();
+        return OK;
+      });
+  ASSERT_NE(submitter, nullptr);
+
+  std::vector<CaptureRequest> requests;
+  for (uint32_t i = 0; i < kNumRequests; i++) {
+    requests.push_back(
+        QueueRequestSettings(i, &queue, num_physical_cameras));
+  }
+  // The buffer of the failing request is converted after its logical
+  // settings are read, but before its physical settings are.
+  requests[kFailedFrameNumber].outputBuffers.resize(1);
+  requests[kFailedFrameNumber].outputBuffers[0].status =
+      static_cast<BufferStatus>(-1);
+
+  std::vector<native_handle_t*> handles_to_delete;
+  uint32_t num_processed_requests = 0;
+  EXPECT_EQ(submitter->SubmitBatch(requests, &queue, &handles_to_delete,
+                                   &num_processed_requests),
+            BAD_VALUE);
+  EXPECT_EQ(num_processed_requests, kFailedFrameNumber);
+  EXPECT_EQ(submitted_frames, std::vector<uint32_t>({0, 1}));
+  EXPECT_EQ(queue.availableToRead(), 0u);
+
+  // The next batch reads its own settings.
+  requests = {
+      QueueRequestSettings(kNumRequests, &queue, num_physical_cameras),
+      QueueRequestSettings(kNumRequests + 1, &queue, num_physical_cameras)};
+  submitted_frames.clear();
+  EXPECT_EQ(submitter->SubmitBatch(requests, &queue, &handles_to_delete,
+                                   &num_processed_requests),
+            OK);
+  EXPECT_EQ(submitted_frames,
+            std::vector<uint32_t>({kNumRequests, kNumRequests + 1}));
+  EXPECT_EQ(queue.availableToRead(), 0u);
+}
+
+}  // namespace
+}  // namespace implementation
+}  // namespace device
+}  // namespace camera
+}  // namespace hardware
+}  // namespace android
@@ -22,6 +22,7 @@
 #include <log/log.h>
 #include <system/camera_metadata.h>
 
+#include <cstdlib>
 #include <regex>
 
 #include "aidl_camera_device.h"
@@ -227,77 +228,90 @@ status_t ConvertToAidlHalStreamConfig(
   return OK;
 }
 
+// Write metadata to result metadata queue in place. The queue region is
+// reserved with beginWrite() for the compact metadata size and, when the
+// region is contiguous, metadata is compacted straight into it so no unused
+// entry or data capacity is transferred. On success, fmq_result_size is set
+// to the number of bytes written.
 status_t WriteToResultMetadataQueue(
-    camera_metadata_t* metadata,
-    AidlMessageQueue<int8_t, SynchronizedReadWrite>* result_metadata_queue) {
-  if (result_metadata_queue == nullptr) {
+    const camera_metadata_t* metadata,
+    AidlMessageQueue<int8_t, SynchronizedReadWrite>* result_metadata_queue,
+    uint64_t* fmq_result_size) {
+  if (result_metadata_queue == nullptr || fmq_result_size == nullptr) {
     return BAD_VALUE;
   }
 
-  if (result_metadata_queue->availableToWrite() <= 0) {
-    ALOGW("%s: result_metadata_queue is not available to write", __FUNCTION__);
-    return BAD_VALUE;
+  size_t size = get_camera_metadata_size(metadata);
+  size_t compact_size = get_camera_metadata_compact_size(metadata);
+  if (result_metadata_queue->availableToWrite() < compact_size) {
+    ALOGV("%s: result_metadata_queue doesn't have %zu bytes available",
+          __FUNCTION__, compact_size);
+    return NO_MEMORY;
   }
 
-  uint32_t size = get_camera_metadata_size(metadata);
-  bool success = result_metadata_queue->write(
-      reinterpret_cast<const int8_t*>(metadata), size);
-  if (!success) {
-    ALOGW("%s: Writing to result metadata queue failed. (size=%u)",
-          __FUNCTION__, size);
+  AidlMessageQueue<int8_t, SynchronizedReadWrite>::MemTransaction tx;
+  if (!result_metadata_queue->beginWrite(compact_size, &tx)) {
+    ALOGW("%s: Reserving %zu bytes in result metadata queue failed.",
+          __FUNCTION__, compact_size);
     return INVALID_OPERATION;
   }
 
-  return OK;
-}
+  const auto& first_region = tx.getFirstRegion();
+  if (first_region.getLength() >= compact_size) {
+    if (copy_camera_metadata(first_region.getAddress(), compact_size,
+                             metadata) == nullptr) {
+      ALOGE("%s: Copying metadata to result metadata queue failed.",
+            __FUNCTION__);
+      return UNKNOWN_ERROR;
+    }
+  } else if (compact_size == size) {
+    // The reserved region wraps around but metadata is already compact, so
+    // it can be copied as is into both parts of the region.
+    if (!tx.copyTo(reinterpret_cast<const int8_t*>(metadata), 0, size)) {
+      ALOGE("%s: Copying metadata to result metadata queue failed.",
+            __FUNCTION__);
+      return UNKNOWN_ERROR;
+    }
+  } else {
+    // The reserved region wraps around and metadata has to be written with
+    // its unused capacity. Reserve the full size instead.
+    if (result_metadata_queue->availableToWrite() < size ||
+        !result_metadata_queue->beginWrite(size, &tx) ||
+        !tx.copyTo(reinterpret_cast<const int8_t*>(metadata), 0, size)) {
+      ALOGV("%s: Writing %zu bytes to result metadata queue failed.",
+            __FUNCTION__, size);
+      return NO_MEMORY;
+    }
+    compact_size = size;
+  }
 
-// Try writing result metadata to result metadata queue. If failed, return
-// the metadata to the caller in out_hal_metadata.
-status_t TryWritingToResultMetadataQueue(
-    std::unique_ptr<google_camera_hal::HalCameraMetadata> hal_metadata,
-    AidlMessageQueue<int8_t, SynchronizedReadWrite>* result_metadata_queue,
-    uint64_t* fmq_result_size,
-    std::unique_ptr<google_camera_hal::HalCameraMetadata>* out_hal_metadata) {
-  if (out_hal_metadata == nullptr) {
-    ALOGE("%s: out_hal_metadata is nullptr.", __FUNCTION__);
-    return BAD_VALUE;
+  if (!result_metadata_queue->commitWrite(compact_size)) {
+    ALOGW("%s: Committing result metadata queue write failed. (size=%zu)",
+          __FUNCTION__, compact_size);
+    return INVALID_OPERATION;
   }
 
-  *out_hal_metadata = std::move(hal_metadata);
+  *fmq_result_size = compact_size;
+  return OK;
+}
 
+status_t ConvertToAidlResultMetadata(
+    AidlMessageQueue<int8_t, SynchronizedReadWrite>* result_metadata_queue,
+    std::unique_ptr<google_camera_hal::HalCameraMetadata> hal_metadata,
+    std::vector<uint8_t>* aidl_metadata, uint64_t* fmq_result_size) {
   if (fmq_result_size == nullptr) {
     ALOGE("%s: fmq_result_size is nullptr", __FUNCTION__);
     return BAD_VALUE;
   }
 
   *fmq_result_size = 0;
-  if (*out_hal_metadata == nullptr) {
+  if (hal_metadata == nullptr) {
     return OK;
   }
 
-  camera_metadata_t* metadata = (*out_hal_metadata)->ReleaseCameraMetadata();
-  // Temporarily use the raw metadata to write to metadata queue.
-  status_t res = WriteToResultMetadataQueue(metadata, result_metadata_queue);
-  *out_hal_metadata = google_camera_hal::HalCameraMetadata::Create(metadata);
-
-  if (res != OK) {
-    ALOGW("%s: Writing to result metadata queue failed: %s(%d)", __FUNCTION__,
-          strerror(-res), res);
-    return res;
-  }
-
-  *fmq_result_size = (*out_hal_metadata)->GetCameraMetadataSize();
-  *out_hal_metadata = nullptr;
-  return OK;
-}
-
-status_t ConvertToAidlResultMetadata(
-    AidlMessageQueue<int8_t, SynchronizedReadWrite>* result_metadata_queue,
-    std::unique_ptr<google_camera_hal::HalCameraMetadata> hal_metadata,
-    std::vector<uint8_t>* aidl_metadata, uint64_t* fmq_result_size) {
-  if (TryWritingToResultMetadataQueue(std::move(hal_metadata),
-                                      result_metadata_queue, fmq_result_size,
-                                      &hal_metadata) == OK) {
+  const camera_metadata_t* metadata = hal_metadata->GetRawCameraMetadata();
+  if (WriteToResultMetadataQueue(metadata, result_metadata_queue,
+                                 fmq_result_size) == OK) {
     return OK;
   }
 
@@ -307,15 +321,42 @@ status_t ConvertToAidlResultMetadata(
     return BAD_VALUE;
   }
 
-  uint32_t metadata_size = hal_metadata->GetCameraMetadataSize();
-  const auto* metadata_p =
-      reinterpret_cast<const uint8_t*>(hal_metadata->GetRawCameraMetadata());
-  // TODO: Do we reallly need to copy here ?
-  aidl_metadata->assign(metadata_p, metadata_p + metadata_size);
+  // Compact while copying so the parcel only carries used entries and data.
+  size_t compact_size = get_camera_metadata_compact_size(metadata);
+  aidl_metadata->resize(compact_size);
+  if (copy_camera_metadata(aidl_metadata->data(), compact_size, metadata) ==
+      nullptr) {
+    ALOGE("%s: Copying metadata to AIDL metadata failed.", __FUNCTION__);
+    aidl_metadata->clear();
+    return UNKNOWN_ERROR;
+  }
 
   return OK;
 }
 
+void UpdateResultMetadataQueueStats(const CaptureResult& aidl_result,
+                                    ResultMetadataQueueStats* stats) {
+  if (stats == nullptr) {
+    return;
+  }
+
+  auto update = [stats](uint64_t fmq_size, size_t parcel_size) {
+    if (fmq_size > 0) {
+      stats->num_fmq_writes++;
+      stats->fmq_bytes += fmq_size;
+    } else if (parcel_size > 0) {
+      stats->num_fallbacks++;
+      stats->fallback_bytes += parcel_size;
+    }
+  };
+
+  update(aidl_result.fmqResultSize, aidl_result.result.metadata.size());
+  for (auto& physical_metadata : aidl_result.physicalCameraMetadata) {
+    update(physical_metadata.fmqMetadataSize,
+           physical_metadata.metadata.metadata.size());
+  }
+}
+
 status_t ConvertToAidlBufferStatus(google_camera_hal::BufferStatus hal_status,
                                    BufferStatus* aidl_status) {
   if (aidl_status == nullptr) {
@@ -702,6 +743,69 @@ status_t ConvertToHalStreamBuffer(
   return OK;
 }
 
+// Validate the metadata structure. This prevents memory access violation
+// that could be introduced by malformed metadata.
+// (b/236688120) In general we trust metadata sent from Framework, but this is
+// to defend an exploit chain that skips Framework's validation.
+static status_t ValidateRequestMetadata(const camera_metadata_t* metadata,
+                                        size_t expected_size) {
+  size_t metadata_size = get_camera_metadata_size(metadata);
+  if (metadata_size != expected_size) {
+    ALOGE("%s: Mismatch between camera metadata size (%zu) and setting size "
+          "(%zu)",
+          __FUNCTION__, metadata_size, expected_size);
+    return BAD_VALUE;
+  }
+
+  if (validate_camera_metadata_structure(metadata, /*expected_size=*/NULL) !=
+      OK) {
+    ALOGE("%s: Failed to validate the metadata structure", __FUNCTION__);
+    return BAD_VALUE;
+  }
+  return OK;
+}
+
+// Read size bytes of metadata from request_metadata_queue into hal_metadata.
+// The queue memory is writable by the client, so the metadata is copied once
+// into a private buffer, which is then validated and adopted by hal_metadata.
+// Validating the queue memory in place would let the client modify the
+// metadata after it is validated.
+static status_t ReadHalMetadataFromQueue(
+    uint32_t size,
+    AidlMessageQueue<int8_t, SynchronizedReadWrite>* request_metadata_queue,
+    std::unique_ptr<google_camera_hal::HalCameraMetadata>* hal_metadata) {
+  // camera_metadata_t is freed with free(), so it can be adopted by
+  // HalCameraMetadata. malloc() alignment satisfies
+  // get_camera_metadata_alignment().
+  auto metadata = reinterpret_cast<camera_metadata_t*>(malloc(size));
+  if (metadata == nullptr) {
+    ALOGE("%s: Failed to allocate %u bytes for request metadata.",
+          __FUNCTION__, size);
+    // Consume the settings so the queue stays in sync with the following
+    // requests.
+    SkipRequestSettings(size, request_metadata_queue);
+    return NO_MEMORY;
+  }
+  if (!request_metadata_queue->read(reinterpret_cast<int8_t*>(metadata),
+                                    size)) {
+    ALOGE("%s: Failed to read from request metadata queue.", __FUNCTION__);
+    free(metadata);
+    return BAD_VALUE;
+  }
+
+  status_t res = ValidateRequestMetadata(metadata, size);
+  if (res != OK) {
+    free(metadata);
+    return res;
+  }
+  *hal_metadata = google_camera_hal::HalCameraMetadata::Create(metadata);
+  if (*hal_metadata == nullptr) {
+    free(metadata);
+    return NO_MEMORY;
+  }
+  return OK;
+}
+
 status_t ConvertToHalMetadata(
     uint32_t message_queue_setting_size,
     AidlMessageQueue<int8_t, SynchronizedReadWrite>* request_metadata_queue,
@@ -712,33 +816,16 @@ status_t ConvertToHalMetadata(
     return BAD_VALUE;
   }
 
-  const camera_metadata_t* metadata = nullptr;
-  std::vector<int8_t> metadata_queue_settings;
+  // Null settings, e.g. for repeating requests, have nothing to decode.
+  *hal_metadata = nullptr;
+  if (message_queue_setting_size == 0 && request_settings.empty()) {
+    return OK;
+  }
+
   const size_t min_camera_metadata_size =
       calculate_camera_metadata_size(/*entry_count=*/0, /*data_count=*/0);
 
-  if (message_queue_setting_size == 0) {
-    // Use the settings in the request.
-    if (request_settings.size() != 0) {
-      if (request_settings.size() < min_camera_metadata_size) {
-        ALOGE("%s: The size of request_settings is %zu, which is not valid",
-              __FUNCTION__, request_settings.size());
-        return BAD_VALUE;
-      }
-
-      metadata =
-          reinterpret_cast<const camera_metadata_t*>(request_settings.data());
-
-      size_t metadata_size = get_camera_metadata_size(metadata);
-      if (metadata_size != request_settings.size()) {
-        ALOGE(
-            "%s: Mismatch between camera metadata size (%zu) and request "
-            "setting size (%zu)",
-            __FUNCTION__, metadata_size, request_settings.size());
-        return BAD_VALUE;
-      }
-    }
-  } else {
+  if (message_queue_setting_size != 0) {
     // Read the settings from request metadata queue.
     if (request_metadata_queue == nullptr) {
       ALOGE("%s: request_metadata_queue is nullptr", __FUNCTION__);
@@ -747,49 +834,75 @@ status_t ConvertToHalMetadata(
     if (message_queue_setting_size < min_camera_metadata_size) {
       ALOGE("%s: invalid message queue setting size: %u", __FUNCTION__,
             message_queue_setting_size);
+      SkipRequestSettings(message_queue_setting_size, request_metadata_queue);
       return BAD_VALUE;
     }
+    return ReadHalMetadataFromQueue(message_queue_setting_size,
+                                    request_metadata_queue, hal_metadata);
+  }
 
-    metadata_queue_settings.resize(message_queue_setting_size);
-    bool success = request_metadata_queue->read(metadata_queue_settings.data(),
-                                                message_queue_setting_size);
-    if (!success) {
-      ALOGE("%s: Failed to read from request metadata queue.", __FUNCTION__);
-      return BAD_VALUE;
-    }
-
-    metadata = reinterpret_cast<const camera_metadata_t*>(
-        metadata_queue_settings.data());
+  // Use the settings in the request, which are borrowed from the parcel
+  // until they are cloned.
+  if (request_settings.size() < min_camera_metadata_size) {
+    ALOGE("%s: The size of request_settings is %zu, which is not valid",
+          __FUNCTION__, request_settings.size());
+    return BAD_VALUE;
+  }
 
-    size_t metadata_size = get_camera_metadata_size(metadata);
-    if (metadata_size != message_queue_setting_size) {
-      ALOGE(
-          "%s: Mismatch between camera metadata size (%zu) and message "
-          "queue setting size (%u)",
-          __FUNCTION__, metadata_size, message_queue_setting_size);
-      return BAD_VALUE;
-    }
+  auto metadata =
+      reinterpret_cast<const camera_metadata_t*>(request_settings.data());
+  status_t res = ValidateRequestMetadata(metadata, request_settings.size());
+  if (res != OK) {
+    return res;
   }
 
-  if (metadata == nullptr) {
-    *hal_metadata = nullptr;
+  *hal_metadata = google_camera_hal::HalCameraMetadata::Clone(metadata);
+  return OK;
+}
+
+status_t SkipRequestSettings(
+    uint32_t message_queue_setting_size,
+    AidlMessageQueue<int8_t, SynchronizedReadWrite>* request_metadata_queue) {
+  if (message_queue_setting_size == 0) {
     return OK;
   }
-
-  // Validates the injected metadata structure. This prevents memory access
-  // violation that could be introduced by malformed metadata.
-  // (b/236688120) In general we trust metadata sent from Framework, but this is
-  // to defend an exploit chain that skips Framework's validation.
-  if (validate_camera_metadata_structure(metadata, /*expected_size=*/NULL) !=
-      OK) {
-    ALOGE("%s: Failed to validate the metadata structure", __FUNCTION__);
+  if (request_metadata_queue == nullptr) {
+    ALOGE("%s: request_metadata_queue is nullptr", __FUNCTION__);
     return BAD_VALUE;
   }
 
-  *hal_metadata = google_camera_hal::HalCameraMetadata::Clone(metadata);
+  AidlMessageQueue<int8_t, SynchronizedReadWrite>::MemTransaction tx;
+  if (!request_metadata_queue->beginRead(message_queue_setting_size, &tx) ||
+      !request_metadata_queue->commitRead(message_queue_setting_size)) {
+    ALOGE("%s: Failed to skip %u bytes of request metadata queue.",
+          __FUNCTION__, message_queue_setting_size);
+    return BAD_VALUE;
+  }
   return OK;
 }
 
+// Skip the FMQ settings of the physical cameras of aidl_request, starting at
+// first_index.
+static void SkipPhysicalCameraSettings(
+    const CaptureRequest& aidl_request, size_t first_index,
+    AidlMessageQueue<int8_t, SynchronizedReadWrite>* request_metadata_queue) {
+  const auto& physical_settings = aidl_request.physicalCameraSettings;
+  for (size_t i = first_index; i < physical_settings.size(); i++) {
+    SkipRequestSettings(physical_settings[i].fmqSettingsSize,
+                        request_metadata_queue);
+  }
+}
+
+status_t SkipCaptureRequestSettings(
+    const CaptureRequest& aidl_request,
+    AidlMessageQueue<int8_t, SynchronizedReadWrite>* request_metadata_queue) {
+  status_t res =
+      SkipRequestSettings(aidl_request.fmqSettingsSize, request_metadata_queue);
+  SkipPhysicalCameraSettings(aidl_request, /*first_index=*/0,
+                             request_metadata_queue);
+  return res;
+}
+
 status_t ConvertToHalCaptureRequest(
     const CaptureRequest& aidl_request,
     AidlMessageQueue<int8_t, SynchronizedReadWrite>* request_metadata_queue,
@@ -808,6 +921,8 @@ status_t ConvertToHalCaptureRequest(
   if (res != OK) {
     ALOGE("%s: Converting metadata failed: %s(%d)", __FUNCTION__,
           strerror(-res), res);
+    SkipPhysicalCameraSettings(aidl_request, /*first_index=*/0,
+                               request_metadata_queue);
     return res;
   }
 
@@ -819,6 +934,8 @@ status_t ConvertToHalCaptureRequest(
     if (res != OK) {
       ALOGE("%s: Converting hal stream buffer failed: %s(%d)", __FUNCTION__,
             strerror(-res), res);
+      SkipPhysicalCameraSettings(aidl_request, /*first_index=*/0,
+                                 request_metadata_queue);
       return res;
     }
 
@@ -834,13 +951,19 @@ status_t ConvertToHalCaptureRequest(
     if (res != OK) {
       ALOGE("%s: Converting hal stream buffer failed: %s(%d)", __FUNCTION__,
             strerror(-res), res);
+      SkipPhysicalCameraSettings(aidl_request, /*first_index=*/0,
+                                 request_metadata_queue);
       return res;
     }
 
     hal_request->output_buffers.push_back(hal_buffer);
   }
 
-  for (auto aidl_physical_settings : aidl_request.physicalCameraSettings) {
+  // Each ConvertToHalMetadata() call consumes its own settings, including on
+  // failure, so only the following physical settings are left to skip.
+  const auto& physical_camera_settings = aidl_request.physicalCameraSettings;
+  for (size_t i = 0; i < physical_camera_settings.size(); i++) {
+    const auto& aidl_physical_settings = physical_camera_settings[i];
     std::unique_ptr<google_camera_hal::HalCameraMetadata> hal_physical_settings;
     res = ConvertToHalMetadata(
         aidl_physical_settings.fmqSettingsSize, request_metadata_queue,
@@ -848,6 +971,7 @@ status_t ConvertToHalCaptureRequest(
     if (res != OK) {
       ALOGE("%s: Converting to HAL metadata failed: %s(%d)", __FUNCTION__,
             strerror(-res), res);
+      SkipPhysicalCameraSettings(aidl_request, i + 1, request_metadata_queue);
       return res;
     }
 
@@ -29,6 +29,7 @@
 #include <fmq/MessageQueue.h>
 #include <hal_types.h>
 
+#include <atomic>
 #include <memory>
 
 #include "aidl_camera_provider.h"
@@ -131,6 +132,20 @@ status_t ConvertToAidlCaptureResult(
     std::unique_ptr<google_camera_hal::CaptureResult> hal_result,
     CaptureResult* aidl_result);
 
+// Counters of how result metadata reached the framework: through the result
+// metadata queue, or copied into the AIDL parcel because the queue was full.
+struct ResultMetadataQueueStats {
+  std::atomic<uint64_t> num_fmq_writes = 0;
+  std::atomic<uint64_t> fmq_bytes = 0;
+  std::atomic<uint64_t> num_fallbacks = 0;
+  std::atomic<uint64_t> fallback_bytes = 0;
+};
+
+// Account the result and physical metadata of a converted AIDL result in
+// stats.
+void UpdateResultMetadataQueueStats(const CaptureResult& aidl_result,
+                                    ResultMetadataQueueStats* stats);
+
 // Convert a HAL stream buffer to a AIDL aidl stream buffer.
 status_t ConvertToAidlStreamBuffer(
     const google_camera_hal::StreamBuffer& hal_buffer,
@@ -153,6 +168,21 @@ status_t ConvertToHalMetadata(
     const std::vector<uint8_t>& request_settings,
     std::unique_ptr<google_camera_hal::HalCameraMetadata>* hal_metadata);
 
+// Consume message_queue_setting_size bytes of settings from
+// request_metadata_queue without converting them, e.g. for requests of a batch
+// that are dropped, so the queue stays in sync with the following requests.
+status_t SkipRequestSettings(
+    uint32_t message_queue_setting_size,
+    AidlMessageQueue<int8_t, SynchronizedReadWrite>* request_metadata_queue);
+
+// Consume all the FMQ settings of aidl_request, including the ones of its
+// physical cameras, without converting them.
+status_t SkipCaptureRequestSettings(
+    const CaptureRequest& aidl_request,
+    AidlMessageQueue<int8_t, SynchronizedReadWrite>* request_metadata_queue);
+
+// Convert aidl_request, reading its settings from request_metadata_queue. On
+// failure all of its remaining FMQ settings are still consumed.
 status_t ConvertToHalCaptureRequest(
     const CaptureRequest& aidl_request,
     AidlMessageQueue<int8_t, SynchronizedReadWrite>* request_metadata_queue,
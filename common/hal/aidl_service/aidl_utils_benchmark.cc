@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the per-request cost of converting an AIDL capture request, as
+// done by AidlCameraDeviceSession::processCaptureRequest.
+// Run with:
+//   adb shell /data/benchmarktest64/aidl_utils_benchmark/aidl_utils_benchmark
+
+#include <benchmark/benchmark.h>
+#include <system/camera_metadata.h>
+
+#include "aidl_utils.h"
+#include "hal_camera_metadata.h"
+
+namespace android {
+namespace hardware {
+namespace camera {
+namespace implementation {
+namespace aidl_utils {
+namespace {
+
+using MetadataQueue = AidlMessageQueue<int8_t, SynchronizedReadWrite>;
+
+constexpr size_t kQueueSizeBytes = 1 << 20;
+
+// Build request settings of roughly the size of a preview template.
+std::unique_ptr<google_camera_hal::HalCameraMetadata> CreateSettings() {
+  auto settings = google_camera_hal::HalCameraMetadata::Create(
+      /*entry_capacity=*/64, /*data_capacity=*/1024);
+  const uint8_t control_mode = ANDROID_CONTROL_MODE_AUTO;
+  const uint8_t ae_mode = ANDROID_CONTROL_AE_MODE_ON;
+  const uint8_t af_mode = ANDROID_CONTROL_AF_MODE_CONTINUOUS_PICTURE;
+  const uint8_t awb_mode = ANDROID_CONTROL_AWB_MODE_AUTO;
+  const int32_t fps_range[] = {15, 30};
+  const int32_t crop_region[] = {0, 0, 4032, 3024};
+  const int32_t regions[] = {0, 0, 0, 0, 0};
+  const float zoom_ratio = 1.0f;
+  const int64_t exposure_time = 10000000;
+  settings->Set(ANDROID_CONTROL_MODE, &control_mode, 1);
+  settings->Set(ANDROID_CONTROL_AE_MODE, &ae_mode, 1);
+  settings->Set(ANDROID_CONTROL_AF_MODE, &af_mode, 1);
+  settings->Set(ANDROID_CONTROL_AWB_MODE, &awb_mode, 1);
+  settings->Set(ANDROID_CONTROL_AE_TARGET_FPS_RANGE, fps_range, 2);
+  settings->Set(ANDROID_SCALER_CROP_REGION, crop_region, 4);
+  settings->Set(ANDROID_CONTROL_AE_REGIONS, regions, 5);
+  settings->Set(ANDROID_CONTROL_AF_REGIONS, regions, 5);
+  settings->Set(ANDROID_CONTROL_AWB_REGIONS, regions, 5);
+  settings->Set(ANDROID_CONTROL_ZOOM_RATIO, &zoom_ratio, 1);
+  settings->Set(ANDROID_SENSOR_EXPOSURE_TIME, &exposure_time, 1);
+  return settings;
+}
+
+void ConvertRequest(benchmark::State& state, const CaptureRequest& request,
+                    MetadataQueue* queue, const int8_t* queued_settings) {
+  google_camera_hal::CaptureRequest hal_request;
+  std::vector<native_handle_t*> handles_to_delete;
+  if (queued_settings != nullptr &&
+      !queue->write(queued_settings, request.fmqSettingsSize)) {
+    state.SkipWithError("Writing request metadata queue failed");
+    return;
+  }
+  if (ConvertToHalCaptureRequest(request, queue, &hal_request,
+                                 &handles_to_delete) != OK) {
+    state.SkipWithError("Converting request failed");
+  }
+  benchmark::DoNotOptimize(hal_request.settings);
+}
+
+void BM_ConvertRequestSettingsFromFmq(benchmark::State& state) {
+  MetadataQueue queue(kQueueSizeBytes, /*configureEventFlagWord=*/false);
+  auto settings = CreateSettings();
+  CaptureRequest request;
+  request.fmqSettingsSize = settings->GetCameraMetadataSize();
+  auto raw_settings =
+      reinterpret_cast<const int8_t*>(settings->GetRawCameraMetadata());
+
+  for (auto _ : state) {
+    ConvertRequest(state, request, &queue, raw_settings);
+  }
+  state.SetBytesProcessed(state.iterations() * request.fmqSettingsSize);
+}
+BENCHMARK(BM_ConvertRequestSettingsFromFmq);
+
+void BM_ConvertRequestSettingsFromParcel(benchmark::State& state) {
+  MetadataQueue queue(kQueueSizeBytes, /*configureEventFlagWord=*/false);
+  auto settings = CreateSettings();
+  auto raw_settings =
+      reinterpret_cast<const uint8_t*>(settings->GetRawCameraMetadata());
+  CaptureRequest request;
+  request.settings.metadata.assign(
+      raw_settings, raw_settings + settings->GetCameraMetadataSize());
+
+  for (auto _ : state) {
+    ConvertRequest(state, request, &queue, /*queued_settings=*/nullptr);
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          request.settings.metadata.size());
+}
+BENCHMARK(BM_ConvertRequestSettingsFromParcel);
+
+void BM_ConvertRequestNullSettings(benchmark::State& state) {
+  MetadataQueue queue(kQueueSizeBytes, /*configureEventFlagWord=*/false);
+  CaptureRequest request;
+
+  for (auto _ : state) {
+    ConvertRequest(state, request, &queue, /*queued_settings=*/nullptr);
+  }
+}
+BENCHMARK(BM_ConvertRequestNullSettings);
+
+}  // namespace
+}  // namespace aidl_utils
+}  // namespace implementation
+}  // namespace camera
+}  // namespace hardware
+}  // namespace android
+
+BENCHMARK_MAIN();
@@ -42,10 +42,37 @@ namespace google_camera_hal {
 
 constexpr char kMeasureBufferAllocationProp[] =
     "persist.vendor.camera.measure_buffer_allocation";
+constexpr char kWarmReconfigurationProp[] =
+    "persist.vendor.camera.hal.warm_reconfig";
+constexpr char kWarmReconfigurationPoolSizeProp[] =
+    "persist.vendor.camera.hal.warm_reconfig_pool_mb";
+constexpr int32_t kDefaultWarmReconfigurationPoolSizeMb = 64;
 
 static constexpr int64_t kNsPerSec = 1000000000;
 static constexpr int64_t kAllocationThreshold = 33000000;  // 33ms
 
+namespace {
+// Marks a stream reconfiguration on an internal buffer pool for the lifetime
+// of the object, so buffers of the destroyed capture session are pooled.
+class ScopedPoolReconfiguration {
+ public:
+  explicit ScopedPoolReconfiguration(InternalBufferPool* pool) : pool_(pool) {
+    if (pool_ != nullptr) {
+      pool_->BeginReconfiguration();
+    }
+  }
+
+  ~ScopedPoolReconfiguration() {
+    if (pool_ != nullptr) {
+      pool_->EndReconfiguration();
+    }
+  }
+
+ private:
+  InternalBufferPool* pool_;
+};
+}  // namespace
+
 std::vector<CaptureSessionEntryFuncs>
     CameraDeviceSession::kCaptureSessionEntries = {
         {.IsStreamConfigurationSupported =
@@ -399,6 +426,15 @@ status_t CameraDeviceSession::Initialize(
   device_session_hwl_ = std::move(device_session_hwl);
   camera_allocator_hwl_ = camera_allocator_hwl;
 
+  warm_reconfiguration_ = property_get_bool(kWarmReconfigurationProp, false);
+  if (warm_reconfiguration_) {
+    int32_t pool_size_mb =
+        property_get_int32(kWarmReconfigurationPoolSizeProp,
+                           kDefaultWarmReconfigurationPoolSizeMb);
+    internal_buffer_pool_ = InternalBufferPool::Acquire(
+        static_cast<size_t>(std::max(pool_size_mb, 0)) * 1024 * 1024);
+  }
+
   GraphicBufferMapper::preloadHal();
   InitializeCallbacks();
 
@@ -682,6 +718,8 @@ status_t CameraDeviceSession::ConfigureStreams(
   std::lock_guard<std::mutex> lock(session_lock_);
 
   std::lock_guard lock_capture_session(capture_session_lock_);
+  // Internal buffers freed by the old session can be reused by the new one.
+  ScopedPoolReconfiguration pool_reconfiguration(internal_buffer_pool_.get());
   if (capture_session_ != nullptr) {
     ATRACE_NAME("CameraDeviceSession::DestroyOldSession");
     capture_session_ = nullptr;
@@ -720,7 +758,8 @@ status_t CameraDeviceSession::ConfigureStreams(
       hwl_session_callback_, camera_allocator_hwl_, device_session_hwl_.get(),
       &hal_config, camera_device_session_callback_.process_capture_result,
       camera_device_session_callback_.notify,
-      camera_device_session_callback_.process_batch_capture_result);
+      camera_device_session_callback_.process_batch_capture_result,
+      warm_reconfiguration_ ? &capture_session_selection_cache_ : nullptr);
 
   if (capture_session_ == nullptr) {
     ALOGE("%s: Cannot find a capture session compatible with stream config",
@@ -1470,6 +1509,12 @@ void CameraDeviceSession::RemoveBufferCache(
     }
 
     device_session_hwl_->RemoveCachedBuffers(buffer_handle_it->second);
+    {
+      std::shared_lock session_lock(capture_session_lock_);
+      if (capture_session_ != nullptr) {
+        capture_session_->RemoveCachedBuffers(buffer_handle_it->second);
+      }
+    }
 
     status_t res =
         GraphicBufferMapper::get().freeBuffer(buffer_handle_it->second);
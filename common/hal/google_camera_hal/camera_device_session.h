@@ -29,6 +29,7 @@
 #include "hal_camera_metadata.h"
 #include "hal_types.h"
 #include "hwl_types.h"
+#include "internal_buffer_pool.h"
 #include "pending_requests_tracker.h"
 #include "stream_buffer_cache_manager.h"
 #include "thermal_types.h"
@@ -332,6 +333,17 @@ class CameraDeviceSession {
   std::unique_ptr<CaptureSession>
       capture_session_;  // Protected by capture_session_lock_.
 
+  // Whether persist.vendor.camera.hal.warm_reconfig is set.
+  bool warm_reconfiguration_ = false;
+
+  // Capture session entries selected for recent stream configurations. Only
+  // used if warm_reconfiguration_ is true.
+  CaptureSessionSelectionCache capture_session_selection_cache_;
+
+  // Keeps internal stream buffers across stream reconfigurations. nullptr if
+  // warm reconfiguration is disabled.
+  std::shared_ptr<InternalBufferPool> internal_buffer_pool_;
+
   // Map from a stream ID to the configured stream received from frameworks.
   // Protected by session_lock_.
   std::unordered_map<int32_t, Stream> configured_streams_map_;
@@ -14,13 +14,72 @@
  * limitations under the License.
  */
 
+//#define LOG_NDEBUG 0
+#define LOG_TAG "GCH_CaptureSessionUtils"
 #include "capture_session_utils.h"
 
+#include <log/log.h>
+
+#include "hal_utils.h"
 #include "zsl_snapshot_capture_session.h"
 
 namespace android {
 namespace google_camera_hal {
 
+using Selection = CaptureSessionSelectionCache::Selection;
+using EntryType = CaptureSessionSelectionCache::EntryType;
+
+CaptureSessionSelectionCache::CaptureSessionSelectionCache(size_t capacity)
+    : capacity_(capacity) {
+}
+
+bool CaptureSessionSelectionCache::Lookup(const std::string& key,
+                                          Selection* selection) {
+  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto entry_it = entries_.find(key);
+  if (entry_it == entries_.end()) {
+    return false;
+  }
+
+  lru_keys_.splice(lru_keys_.begin(), lru_keys_, entry_it->second.lru_it);
+  *selection = entry_it->second.selection;
+  return true;
+}
+
+void CaptureSessionSelectionCache::Insert(const std::string& key,
+                                          const Selection& selection) {
+  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto entry_it = entries_.find(key);
+  if (entry_it != entries_.end()) {
+    lru_keys_.splice(lru_keys_.begin(), lru_keys_, entry_it->second.lru_it);
+    entry_it->second.selection = selection;
+    return;
+  }
+
+  if (capacity_ == 0) {
+    return;
+  }
+
+  if (entries_.size() >= capacity_) {
+    entries_.erase(lru_keys_.back());
+    lru_keys_.pop_back();
+  }
+
+  lru_keys_.push_front(key);
+  entries_[key] = {.selection = selection, .lru_it = lru_keys_.begin()};
+}
+
+void CaptureSessionSelectionCache::Erase(const std::string& key) {
+  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto entry_it = entries_.find(key);
+  if (entry_it == entries_.end()) {
+    return;
+  }
+
+  lru_keys_.erase(entry_it->second.lru_it);
+  entries_.erase(entry_it);
+}
+
 std::unique_ptr<CaptureSession> CreateCaptureSession(
     const StreamConfiguration& stream_config,
     const std::vector<WrapperCaptureSessionEntryFuncs>&
@@ -33,41 +92,104 @@ std::unique_ptr<CaptureSession> CreateCaptureSession(
     CameraDeviceSessionHwl* camera_device_session_hwl,
     std::vector<HalStream>* hal_config,
     ProcessCaptureResultFunc process_capture_result, NotifyFunc notify,
-    ProcessBatchCaptureResultFunc process_batch_capture_result) {
+    ProcessBatchCaptureResultFunc process_batch_capture_result,
+    CaptureSessionSelectionCache* selection_cache) {
+  auto is_supported = [&](const Selection& selection) {
+    switch (selection.type) {
+      case EntryType::kWrapper:
+        return selection.index < wrapper_capture_session_entries.size() &&
+               wrapper_capture_session_entries[selection.index]
+                   .IsStreamConfigurationSupported(camera_device_session_hwl,
+                                                   stream_config);
+      case EntryType::kExternal:
+        return selection.index < external_capture_session_entries.size() &&
+               external_capture_session_entries[selection.index]
+                   ->IsStreamConfigurationSupported(camera_device_session_hwl,
+                                                    stream_config);
+      case EntryType::kPredefined:
+        return selection.index < capture_session_entries.size() &&
+               capture_session_entries[selection.index]
+                   .IsStreamConfigurationSupported(camera_device_session_hwl,
+                                                   stream_config);
+    }
+    return false;
+  };
+
+  auto create_session =
+      [&](const Selection& selection) -> std::unique_ptr<CaptureSession> {
+    switch (selection.type) {
+      case EntryType::kWrapper:
+        return wrapper_capture_session_entries[selection.index].CreateSession(
+            stream_config, external_capture_session_entries,
+            capture_session_entries, hwl_session_callback,
+            camera_buffer_allocator_hwl, camera_device_session_hwl,
+            hal_config, process_capture_result, notify);
+      case EntryType::kExternal:
+        return external_capture_session_entries[selection.index]->CreateSession(
+            camera_device_session_hwl, stream_config, process_capture_result,
+            notify, hwl_session_callback, hal_config,
+            camera_buffer_allocator_hwl);
+      case EntryType::kPredefined:
+        return capture_session_entries[selection.index].CreateSession(
+            camera_device_session_hwl, stream_config, process_capture_result,
+            process_batch_capture_result, notify, hwl_session_callback,
+            hal_config, camera_buffer_allocator_hwl);
+    }
+    return nullptr;
+  };
+
+  auto create_and_cache_session =
+      [&](const Selection& selection,
+          const std::string& key) -> std::unique_ptr<CaptureSession> {
+    std::unique_ptr<CaptureSession> session = create_session(selection);
+    if (session != nullptr && selection_cache != nullptr) {
+      selection_cache->Insert(key, selection);
+    }
+    return session;
+  };
+
+  std::string key;
+  if (selection_cache != nullptr) {
+    key = hal_utils::GetStreamConfigurationKey(stream_config);
+    Selection selection;
+    if (selection_cache->Lookup(key, &selection)) {
+      // Entries ahead of the cached one did not support this configuration,
+      // so only the cached one needs to be probed again.
+      if (is_supported(selection)) {
+        ALOGV("%s: Reusing capture session entry %zu of type %u.",
+              __FUNCTION__, selection.index,
+              static_cast<uint32_t>(selection.type));
+        return create_and_cache_session(selection, key);
+      }
+      selection_cache->Erase(key);
+    }
+  }
+
   // first pass: check predefined wrapper capture session
-  for (auto sessionEntry : wrapper_capture_session_entries) {
-    if (sessionEntry.IsStreamConfigurationSupported(camera_device_session_hwl,
-                                                    stream_config)) {
-      return sessionEntry.CreateSession(
-          stream_config, external_capture_session_entries,
-          capture_session_entries, hwl_session_callback,
-          camera_buffer_allocator_hwl, camera_device_session_hwl, hal_config,
-          process_capture_result, notify);
+  for (size_t i = 0; i < wrapper_capture_session_entries.size(); i++) {
+    Selection selection = {.type = EntryType::kWrapper, .index = i};
+    if (is_supported(selection)) {
+      return create_and_cache_session(selection, key);
     }
   }
 
   // second pass: check loaded external capture sessions
-  for (auto externalSession : external_capture_session_entries) {
-    if (externalSession->IsStreamConfigurationSupported(
-            camera_device_session_hwl, stream_config)) {
-      return externalSession->CreateSession(
-          camera_device_session_hwl, stream_config, process_capture_result,
-          notify, hwl_session_callback, hal_config, camera_buffer_allocator_hwl);
+  for (size_t i = 0; i < external_capture_session_entries.size(); i++) {
+    Selection selection = {.type = EntryType::kExternal, .index = i};
+    if (is_supported(selection)) {
+      return create_and_cache_session(selection, key);
     }
   }
 
   // third pass: check predefined capture sessions
-  for (auto sessionEntry : capture_session_entries) {
-    if (sessionEntry.IsStreamConfigurationSupported(camera_device_session_hwl,
-                                                    stream_config)) {
-      return sessionEntry.CreateSession(
-          camera_device_session_hwl, stream_config, process_capture_result,
-          process_batch_capture_result, notify, hwl_session_callback,
-          hal_config, camera_buffer_allocator_hwl);
+  for (size_t i = 0; i < capture_session_entries.size(); i++) {
+    Selection selection = {.type = EntryType::kPredefined, .index = i};
+    if (is_supported(selection)) {
+      return create_and_cache_session(selection, key);
     }
   }
   return nullptr;
 }
 
 }  // namespace google_camera_hal
-}  // namespace android
\ No newline at end of file
+}  // namespace android
@@ -19,6 +19,11 @@
 
 #include <utils/Errors.h>
 
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 #include "camera_buffer_allocator_hwl.h"
 #include "camera_device_session_hwl.h"
 #include "capture_session.h"
@@ -68,10 +73,64 @@ struct WrapperCaptureSessionEntryFuncs {
   WrapperCaptureSessionCreateFunc CreateSession;
 };
 
+// CaptureSessionSelectionCache remembers which capture session entry
+// CreateCaptureSession selected for the most recently used stream
+// configurations. Reconfiguring to one of them only probes the selected entry
+// instead of every entry ahead of it, which makes switching back and forth
+// between app modes faster.
+class CaptureSessionSelectionCache {
+ public:
+  // Which list of CreateCaptureSession entries a selection refers to.
+  enum class EntryType : uint32_t {
+    kWrapper = 0,
+    kExternal,
+    kPredefined,
+  };
+
+  struct Selection {
+    EntryType type = EntryType::kPredefined;
+    // Index into the list of entries of type.
+    size_t index = 0;
+  };
+
+  explicit CaptureSessionSelectionCache(size_t capacity = kDefaultCapacity);
+
+  // Look up the selection for a key from
+  // hal_utils::GetStreamConfigurationKey(). Return false on a miss.
+  bool Lookup(const std::string& key, Selection* selection);
+
+  // Record the selection for a key, evicting the least recently used key if
+  // the cache is full.
+  void Insert(const std::string& key, const Selection& selection);
+
+  // Remove a key.
+  void Erase(const std::string& key);
+
+ private:
+  static constexpr size_t kDefaultCapacity = 4;
+
+  const size_t capacity_;
+
+  std::mutex cache_lock_;
+
+  // Keys from the most to the least recently used. Protected by cache_lock_.
+  std::list<std::string> lru_keys_;
+
+  struct CacheEntry {
+    Selection selection;
+    std::list<std::string>::iterator lru_it;
+  };
+
+  // Map from key to its selection. Protected by cache_lock_.
+  std::unordered_map<std::string, CacheEntry> entries_;
+};
+
 // Select and create capture session.
 // When consider_zsl_capture_session is enabled, we will first consider using
 // ZslCaptureSession as a wrapper capture session when it supports the given
 // configurations.
+// If selection_cache is not nullptr, it is used to skip probing entries for
+// recently used stream configurations and updated with the selection.
 std::unique_ptr<CaptureSession> CreateCaptureSession(
     const StreamConfiguration& stream_config,
     const std::vector<WrapperCaptureSessionEntryFuncs>&
@@ -84,7 +143,8 @@ std::unique_ptr<CaptureSession> CreateCaptureSession(
     CameraDeviceSessionHwl* camera_device_session_hwl,
     std::vector<HalStream>* hal_config,
     ProcessCaptureResultFunc process_capture_result, NotifyFunc notify,
-    ProcessBatchCaptureResultFunc process_batch_capture_result = nullptr);
+    ProcessBatchCaptureResultFunc process_batch_capture_result = nullptr,
+    CaptureSessionSelectionCache* selection_cache = nullptr);
 
 }  // namespace google_camera_hal
 }  // namespace android
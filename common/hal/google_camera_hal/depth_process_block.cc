@@ -21,10 +21,14 @@
 #include <hardware/gralloc1.h>
 #include <log/log.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <ui/GraphicBufferMapper.h>
 #include <utils/Trace.h>
 
 #include <dlfcn.h>
 
+#include <algorithm>
+
 #include "depth_process_block.h"
 #include "hal_types.h"
 #include "hal_utils.h"
@@ -36,6 +40,7 @@ namespace google_camera_hal {
 #if GCH_HWL_USE_DLOPEN
 static std::string kDepthGeneratorLib = "/vendor/lib64/libdepthgenerator.so";
 using android::depth_generator::CreateDepthGenerator_t;
+using android::depth_generator::GetDepthGeneratorMaxConcurrentRequests_t;
 #endif
 const float kSmallOffset = 0.01f;
 
@@ -78,6 +83,10 @@ std::unique_ptr<DepthProcessBlock> DepthProcessBlock::Create(
 
   block->pipelined_depth_engine_enabled_ = property_get_bool(
       "persist.vendor.camera.frontdepth.enablepipeline", true);
+  block->max_depth_workers_ = std::clamp<int32_t>(
+      property_get_int32("persist.vendor.camera.frontdepth.maxworkers",
+                         kMaxDepthWorkers),
+      1, kMaxDepthWorkers);
 
   // TODO(b/129910835): Change the controlling prop into some deterministic
   // logic that controls when the front depth autocal will be triggered.
@@ -128,7 +137,10 @@ DepthProcessBlock::DepthProcessBlock(
 
 DepthProcessBlock::~DepthProcessBlock() {
   ATRACE_CALL();
+  // Release the requests still executing before destroying the generator.
+  depth_request_executor_ = nullptr;
   depth_generator_ = nullptr;
+  ClearBufferMappings();
 
   if (depth_generator_lib_handle_ != nullptr) {
     dlclose(depth_generator_lib_handle_);
@@ -157,7 +169,6 @@ status_t DepthProcessBlock::SetResultProcessor(
 status_t DepthProcessBlock::GetStreamBufferSize(const Stream& stream,
                                                 int32_t* buffer_size) {
   ATRACE_CALL();
-  // TODO(b/130764929): Use actual gralloc buffer stride instead of stream dim
   switch (stream.format) {
     case HAL_PIXEL_FORMAT_Y8:
       *buffer_size = stream.width * stream.height;
@@ -229,8 +240,15 @@ status_t DepthProcessBlock::ConfigureStreams(
     return BAD_VALUE;
   }
 
+  {
+    std::lock_guard<std::mutex> mappings_lock(buffer_mappings_lock_);
+    max_buffer_mappings_ = depth_stream_.max_buffers * depth_io_streams_.size();
+  }
+
   if (depth_generator_ == nullptr) {
-    status_t res = LoadDepthGenerator(&depth_generator_);
+    uint32_t max_concurrent_requests = 1;
+    status_t res =
+        LoadDepthGenerator(&depth_generator_, &max_concurrent_requests);
     if (res != OK) {
       ALOGE("%s: Creating DepthGenerator failed.", __FUNCTION__);
       return NO_INIT;
@@ -251,6 +269,30 @@ status_t DepthProcessBlock::ConfigureStreams(
     } else {
       ALOGI("%s: Blocking depth api is used.", __FUNCTION__);
       depth_generator_->SetResultCallback(nullptr);
+
+      uint32_t num_workers =
+          std::min(max_concurrent_requests, max_depth_workers_);
+      if (num_workers > 1) {
+        // Requests in the executor hold depth stream buffers, so the workers
+        // and the queue together must not exceed the depth stream's
+        // max_buffers.
+        uint32_t max_queued_requests =
+            std::min(num_workers, kDepthStreamMaxBuffers - num_workers);
+        depth_request_executor_ = DepthRequestExecutor::Create(
+            depth_generator_.get(), num_workers, max_queued_requests,
+            [this](DepthResultStatus result_status, uint32_t frame_number) {
+              status_t res = ProcessDepthResult(result_status, frame_number);
+              if (res != OK) {
+                ALOGE("%s: Failed to process the depth result for frame %u.",
+                      __FUNCTION__, frame_number);
+              }
+            });
+        if (depth_request_executor_ == nullptr) {
+          ALOGW("%s: Creating depth request executor failed. Executing depth "
+                "requests on the request thread.",
+                __FUNCTION__);
+        }
+      }
     }
   }
   if (session_buffer_management_supported_ &&
@@ -316,9 +358,23 @@ status_t DepthProcessBlock::SubmitAsyncDepthRequest(
   return OK;
 }
 
+status_t DepthProcessBlock::SubmitConcurrentDepthRequest(
+    DepthRequestExecutor::Request executor_request) {
+  uint32_t frame_number = executor_request.request_info.frame_number;
+  status_t res =
+      depth_request_executor_->QueueRequest(std::move(executor_request));
+  if (res != OK) {
+    ALOGE("%s: Failed to queue depth request for frame %u.", __FUNCTION__,
+          frame_number);
+    return res;
+  }
+
+  return OK;
+}
+
 status_t DepthProcessBlock::ProcessDepthResult(DepthResultStatus result_status,
                                                uint32_t frame_number) {
-  std::unique_lock<std::mutex> lock(depth_generator_api_lock_);
+  std::unique_lock<std::mutex> lock(depth_result_lock_);
   ALOGV("%s: [ud] Depth result for frame %u notified.", __FUNCTION__,
         frame_number);
 
@@ -436,7 +492,16 @@ status_t DepthProcessBlock::ProcessRequests(
     return res;
   }
 
-  if (pipelined_depth_engine_enabled_ == true) {
+  if (depth_request_executor_ != nullptr) {
+    // The executor keeps the metadata alive until the request is executed.
+    res = SubmitConcurrentDepthRequest(
+        {.request_info = std::move(request_info),
+         .settings = std::move(metadata),
+         .color_buffer_metadata = std::move(color_metadata)});
+    if (res != OK) {
+      ALOGE("%s: Failed to submit concurrent depth request.", __FUNCTION__);
+    }
+  } else if (pipelined_depth_engine_enabled_ == true) {
     res = SubmitAsyncDepthRequest(request_info);
     if (res != OK) {
       ALOGE("%s: Failed to submit asynchronized depth request.", __FUNCTION__);
@@ -458,12 +523,19 @@ status_t DepthProcessBlock::Flush() {
     return OK;
   }
 
+  // Depth requests cannot be aborted once queued. Wait for them to be
+  // released so no result arrives after Flush() returns.
+  if (depth_request_executor_ != nullptr) {
+    depth_request_executor_->WaitUntilIdle();
+  }
+
   // TODO(b/127322570): Implement this method.
   return OK;
 }
 
 status_t DepthProcessBlock::LoadDepthGenerator(
-    std::unique_ptr<DepthGenerator>* depth_generator) {
+    std::unique_ptr<DepthGenerator>* depth_generator,
+    uint32_t* max_concurrent_requests) {
   ATRACE_CALL();
 #if GCH_HWL_USE_DLOPEN
   CreateDepthGenerator_t create_depth_generator;
@@ -489,22 +561,157 @@ status_t DepthProcessBlock::LoadDepthGenerator(
   if (*depth_generator == nullptr) {
     return NO_INIT;
   }
+
+  auto get_max_concurrent_requests =
+      (GetDepthGeneratorMaxConcurrentRequests_t)dlsym(
+          depth_generator_lib_handle_,
+          "GetDepthGeneratorMaxConcurrentRequests");
+  *max_concurrent_requests = get_max_concurrent_requests != nullptr
+                                 ? get_max_concurrent_requests()
+                                 : 1;
 #else
   if (CreateDepthGenerator == nullptr) {
     return NO_INIT;
   }
   *depth_generator = std::unique_ptr<DepthGenerator>(CreateDepthGenerator());
+  *max_concurrent_requests = GetDepthGeneratorMaxConcurrentRequests != nullptr
+                                 ? GetDepthGeneratorMaxConcurrentRequests()
+                                 : 1;
 #endif
+  ALOGI("%s: Depth generator supports %u concurrent requests.", __FUNCTION__,
+        *max_concurrent_requests);
 
   return OK;
 }
 
-status_t DepthProcessBlock::MapBuffersForDepthGenerator(
-    const StreamBuffer& stream_buffer, depth_generator::Buffer* buffer) {
+status_t DepthProcessBlock::GetBufferLayout(const StreamBuffer& stream_buffer,
+                                            size_t* size, uint32_t* stride,
+                                            uint32_t* scanline) {
+  ATRACE_CALL();
+  auto& mapper = GraphicBufferMapper::get();
+  uint64_t allocation_size = 0;
+  std::vector<ui::PlaneLayout> plane_layouts;
+  if (mapper.getAllocationSize(stream_buffer.buffer, &allocation_size) == OK &&
+      mapper.getPlaneLayouts(stream_buffer.buffer, &plane_layouts) == OK &&
+      !plane_layouts.empty() && plane_layouts[0].strideInBytes > 0) {
+    *size = allocation_size;
+    *stride = plane_layouts[0].strideInBytes;
+    *scanline =
+        plane_layouts[0].totalSizeInBytes / plane_layouts[0].strideInBytes;
+    return OK;
+  }
+
+  // Gralloc cannot describe the buffer. Assume it is tightly packed.
+  const Stream& stream = depth_io_streams_[stream_buffer.stream_id];
+  ALOGW("%s: Gralloc layout unavailable for stream %d. Using stream size.",
+        __FUNCTION__, stream_buffer.stream_id);
+  *size = stream_buffer_sizes_[stream_buffer.stream_id];
+  *stride = stream.format == HAL_PIXEL_FORMAT_Y16 ? stream.width * 2
+                                                  : stream.width;
+  *scanline = stream.height;
+  return OK;
+}
+
+void DepthProcessBlock::EvictBufferMappingsLocked() {
+  while (buffer_mappings_.size() > max_buffer_mappings_) {
+    auto oldest = buffer_mappings_.end();
+    for (auto it = buffer_mappings_.begin(); it != buffer_mappings_.end();
+         it++) {
+      if (it->second.use_count == 0 &&
+          (oldest == buffer_mappings_.end() ||
+           it->second.last_used < oldest->second.last_used)) {
+        oldest = it;
+      }
+    }
+
+    if (oldest == buffer_mappings_.end()) {
+      // Every mapping is used by a pending request.
+      return;
+    }
+
+    munmap(oldest->second.addr, oldest->second.size);
+    buffer_mappings_.erase(oldest);
+  }
+}
+
+void DepthProcessBlock::ClearBufferMappings() {
+  std::lock_guard<std::mutex> lock(buffer_mappings_lock_);
+  for (auto& [buffer, mapping] : buffer_mappings_) {
+    if (mapping.use_count > 0) {
+      ALOGW("%s: Unmapping buffer %p used by %u pending requests.",
+            __FUNCTION__, buffer, mapping.use_count);
+    }
+    munmap(mapping.addr, mapping.size);
+  }
+  buffer_mappings_.clear();
+}
+
+status_t DepthProcessBlock::AcquireBufferMapping(
+    const StreamBuffer& stream_buffer, uint8_t** addr, uint32_t* stride,
+    uint32_t* scanline) {
   ATRACE_CALL();
   buffer_handle_t buffer_handle = stream_buffer.buffer;
-  ALOGV("%s: Mapping FD=%d to CPU addr.", __FUNCTION__, buffer_handle->data[0]);
+  int fd = buffer_handle->data[0];
+
+  // fstat is much cheaper than mmap/munmap and tells whether the handle still
+  // refers to the same dma-buf as the cached mapping.
+  struct stat buffer_stat = {};
+  if (fstat(fd, &buffer_stat) != 0) {
+    ALOGE("%s: fstat on FD=%d failed: %s", __FUNCTION__, fd, strerror(errno));
+    return UNKNOWN_ERROR;
+  }
+
+  std::lock_guard<std::mutex> lock(buffer_mappings_lock_);
+  auto mapping_it = buffer_mappings_.find(buffer_handle);
+  if (mapping_it != buffer_mappings_.end() &&
+      mapping_it->second.inode != buffer_stat.st_ino) {
+    // The handle was freed and its address reused for another buffer.
+    if (mapping_it->second.use_count > 0) {
+      ALOGE("%s: Buffer %p changed while used by %u pending requests.",
+            __FUNCTION__, buffer_handle, mapping_it->second.use_count);
+      return UNKNOWN_ERROR;
+    }
+    munmap(mapping_it->second.addr, mapping_it->second.size);
+    buffer_mappings_.erase(mapping_it);
+    mapping_it = buffer_mappings_.end();
+  }
+
+  if (mapping_it == buffer_mappings_.end()) {
+    BufferMapping mapping = {.inode = buffer_stat.st_ino};
+    status_t res = GetBufferLayout(stream_buffer, &mapping.size,
+                                   &mapping.stride, &mapping.scanline);
+    if (res != OK || mapping.size == 0) {
+      ALOGE("%s: Getting the layout of buffer %p failed.", __FUNCTION__,
+            buffer_handle);
+      return UNKNOWN_ERROR;
+    }
+
+    ALOGV("%s: Mapping FD=%d to CPU addr.", __FUNCTION__, fd);
+    void* virtual_addr = mmap(NULL, mapping.size, (PROT_READ | PROT_WRITE),
+                              MAP_SHARED, fd, 0);
+    if (virtual_addr == nullptr || virtual_addr == MAP_FAILED) {
+      ALOGE("%s: Failed to map the stream buffer to virtual addr.",
+            __FUNCTION__);
+      return UNKNOWN_ERROR;
+    }
+    mapping.addr = reinterpret_cast<uint8_t*>(virtual_addr);
+    mapping_it = buffer_mappings_.emplace(buffer_handle, mapping).first;
+  }
+
+  BufferMapping& mapping = mapping_it->second;
+  mapping.use_count++;
+  mapping.last_used = ++buffer_mapping_clock_;
+  *addr = mapping.addr;
+  *stride = mapping.stride;
+  *scanline = mapping.scanline;
+
+  EvictBufferMappingsLocked();
+  return OK;
+}
 
+status_t DepthProcessBlock::MapBuffersForDepthGenerator(
+    const StreamBuffer& stream_buffer, depth_generator::Buffer* buffer) {
+  ATRACE_CALL();
   int32_t stream_id = stream_buffer.stream_id;
   if (stream_buffer_sizes_.find(stream_id) == stream_buffer_sizes_.end() ||
       depth_io_streams_.find(stream_id) == depth_io_streams_.end()) {
@@ -512,48 +719,60 @@ status_t DepthProcessBlock::MapBuffersForDepthGenerator(
     return UNKNOWN_ERROR;
   }
 
-  void* virtual_addr =
-      mmap(NULL, stream_buffer_sizes_[stream_id], (PROT_READ | PROT_WRITE),
-           MAP_SHARED, buffer_handle->data[0], 0);
-
-  if (virtual_addr == nullptr || virtual_addr == reinterpret_cast<void*>(-1)) {
-    ALOGE("%s: Failed to map the stream buffer to virtual addr.", __FUNCTION__);
-    return UNKNOWN_ERROR;
+  depth_generator::BufferPlane buffer_plane = {};
+  status_t res = AcquireBufferMapping(stream_buffer, &buffer_plane.addr,
+                                      &buffer_plane.stride,
+                                      &buffer_plane.scanline);
+  if (res != OK) {
+    return res;
   }
 
   auto& stream = depth_io_streams_[stream_id];
   buffer->format = stream.format;
   buffer->width = stream.width;
   buffer->height = stream.height;
-  depth_generator::BufferPlane buffer_plane = {};
-  buffer_plane.addr = reinterpret_cast<uint8_t*>(virtual_addr);
-  // TODO(b/130764929): Use actual gralloc buffer stride instead of stream dim
-  buffer_plane.stride = stream.width;
-  buffer_plane.scanline = stream.height;
   buffer->planes.push_back(buffer_plane);
 
   return OK;
 }
 
 status_t DepthProcessBlock::UnmapBuffersForDepthGenerator(
-    const StreamBuffer& stream_buffer, uint8_t* addr) {
+    const StreamBuffer& stream_buffer) {
   ATRACE_CALL();
-  if (addr == nullptr) {
-    ALOGE("%s: Addr is null.", __FUNCTION__);
+  std::lock_guard<std::mutex> lock(buffer_mappings_lock_);
+  auto mapping_it = buffer_mappings_.find(stream_buffer.buffer);
+  if (mapping_it == buffer_mappings_.end() ||
+      mapping_it->second.use_count == 0) {
+    ALOGE("%s: Buffer %p of stream %d is not mapped.", __FUNCTION__,
+          stream_buffer.buffer, stream_buffer.stream_id);
     return BAD_VALUE;
   }
 
-  int32_t stream_id = stream_buffer.stream_id;
-  if (stream_buffer_sizes_.find(stream_id) == stream_buffer_sizes_.end() ||
-      depth_io_streams_.find(stream_id) == depth_io_streams_.end()) {
-    ALOGE("%s: Stream buffer stream id:%d not found.", __FUNCTION__, stream_id);
-    return UNKNOWN_ERROR;
+  mapping_it->second.use_count--;
+  if (mapping_it->second.removed && mapping_it->second.use_count == 0) {
+    munmap(mapping_it->second.addr, mapping_it->second.size);
+    buffer_mappings_.erase(mapping_it);
   }
-
-  munmap(addr, stream_buffer_sizes_[stream_id]);
+  EvictBufferMappingsLocked();
   return OK;
 }
 
+void DepthProcessBlock::RemoveCachedBuffers(const native_handle_t* handle) {
+  ATRACE_CALL();
+  std::lock_guard<std::mutex> lock(buffer_mappings_lock_);
+  auto mapping_it = buffer_mappings_.find(handle);
+  if (mapping_it == buffer_mappings_.end()) {
+    return;
+  }
+
+  if (mapping_it->second.use_count > 0) {
+    mapping_it->second.removed = true;
+    return;
+  }
+  munmap(mapping_it->second.addr, mapping_it->second.size);
+  buffer_mappings_.erase(mapping_it);
+}
+
 status_t DepthProcessBlock::RequestDepthStreamBuffer(
     StreamBuffer* incomplete_buffer, uint32_t frame_number) {
   if (request_stream_buffers_ == nullptr) {
@@ -746,7 +965,6 @@ status_t DepthProcessBlock::UnmapDepthRequestBuffers(uint32_t frame_number) {
   }
 
   auto& request = pending_depth_requests_[frame_number].request;
-  auto& depth_request_info = pending_depth_requests_[frame_number].depth_request;
 
   ATRACE_CALL();
   if (request.input_buffers.size() < 2 || request.input_buffers.size() > 3 ||
@@ -761,23 +979,13 @@ status_t DepthProcessBlock::UnmapDepthRequestBuffers(uint32_t frame_number) {
 
   status_t res = OK;
   for (auto& input_buffer : request.input_buffers) {
-    uint8_t* addr = nullptr;
-    int32_t stream_id = input_buffer.stream_id;
-    if (stream_id == kInvalidStreamId) {
+    if (input_buffer.stream_id == kInvalidStreamId) {
       ALOGV("%s: input buffer place holder found for frame %u", __FUNCTION__,
             frame_number);
       continue;
     }
 
-    if (stream_id == rgb_internal_yuv_stream_id_) {
-      addr = depth_request_info.color_buffer[0].planes[0].addr;
-    } else if (stream_id == ir1_internal_raw_stream_id_) {
-      addr = depth_request_info.ir_buffer[0][0].planes[0].addr;
-    } else if (stream_id == ir2_internal_raw_stream_id_) {
-      addr = depth_request_info.ir_buffer[1][0].planes[0].addr;
-    }
-
-    res = UnmapBuffersForDepthGenerator(input_buffer, addr);
+    res = UnmapBuffersForDepthGenerator(input_buffer);
     if (res != OK) {
       ALOGE("%s: Unmapping input buffer for depth generator failed.",
             __FUNCTION__);
@@ -785,8 +993,7 @@ status_t DepthProcessBlock::UnmapDepthRequestBuffers(uint32_t frame_number) {
     }
   }
 
-  res = UnmapBuffersForDepthGenerator(
-      request.output_buffers[0], depth_request_info.depth_buffer.planes[0].addr);
+  res = UnmapBuffersForDepthGenerator(request.output_buffers[0]);
   if (res != OK) {
     ALOGE("%s: Unmapping depth buffer for depth generator failed.",
           __FUNCTION__);
@@ -17,9 +17,14 @@
 #ifndef HARDWARE_GOOGLE_CAMERA_HAL_GOOGLE_CAMERA_HAL_DEPTH_PROCESS_BLOCK_H_
 #define HARDWARE_GOOGLE_CAMERA_HAL_GOOGLE_CAMERA_HAL_DEPTH_PROCESS_BLOCK_H_
 
+#include <sys/types.h>
+
 #include <map>
+#include <mutex>
+#include <unordered_map>
 
 #include "depth_generator.h"
+#include "depth_request_executor.h"
 #include "hwl_types.h"
 #include "process_block.h"
 
@@ -67,6 +72,11 @@ class DepthProcessBlock : public ProcessBlock {
   status_t Flush() override;
   // Override functions of ProcessBlock end.
 
+  // Unmap the cached mapping of a buffer removed from the buffer cache. If the
+  // buffer is used by a pending depth request, it is unmapped once the request
+  // completes.
+  void RemoveCachedBuffers(const native_handle_t* handle);
+
  protected:
   DepthProcessBlock(HwlRequestBuffersFunc request_stream_buffers_,
                     const DepthProcessBlockCreateData& create_data);
@@ -83,19 +93,45 @@ class DepthProcessBlock : public ProcessBlock {
   // Callback function to request stream buffer from camera device session
   const HwlRequestBuffersFunc request_stream_buffers_;
 
-  // Load the depth generator dynamically
-  status_t LoadDepthGenerator(std::unique_ptr<DepthGenerator>* depth_generator);
+  // Maximum number of depth requests executed concurrently by the depth
+  // request executor.
+  static constexpr uint32_t kMaxDepthWorkers = 4;
 
-  // Map the input and output buffers from buffer_handle_t to UMD virtual addr
+  // Load the depth generator dynamically. max_concurrent_requests is set to
+  // the number of requests the generator can execute concurrently.
+  status_t LoadDepthGenerator(std::unique_ptr<DepthGenerator>* depth_generator,
+                              uint32_t* max_concurrent_requests);
+
+  // Map the input and output buffers from buffer_handle_t to UMD virtual addr.
+  // The mapping is cached for the lifetime of the buffer and stays in use
+  // until UnmapBuffersForDepthGenerator() is called.
   status_t MapBuffersForDepthGenerator(const StreamBuffer& stream_buffer,
                                        depth_generator::Buffer* depth_buffer);
 
-  // Get the gralloc buffer size of a stream
+  // Get the estimated buffer size of a stream. Only used when gralloc cannot
+  // report the allocation size.
   status_t GetStreamBufferSize(const Stream& stream, int32_t* buffer_size);
 
-  // Ummap the input and output buffers
-  status_t UnmapBuffersForDepthGenerator(const StreamBuffer& stream_buffer,
-                                         uint8_t* addr);
+  // Release the input and output buffers mapped by
+  // MapBuffersForDepthGenerator(). The mapping stays cached.
+  status_t UnmapBuffersForDepthGenerator(const StreamBuffer& stream_buffer);
+
+  // Map stream_buffer or reuse its cached mapping, and mark it in use.
+  status_t AcquireBufferMapping(const StreamBuffer& stream_buffer,
+                                uint8_t** addr, uint32_t* stride,
+                                uint32_t* scanline);
+
+  // Query the gralloc allocation size, stride and scanline of a buffer.
+  // Fall back to the stream dimensions if gralloc cannot report them.
+  status_t GetBufferLayout(const StreamBuffer& stream_buffer, size_t* size,
+                           uint32_t* stride, uint32_t* scanline);
+
+  // Unmap cached buffers that are not in use until at most
+  // max_buffer_mappings_ remain. Must be protected by buffer_mappings_lock_.
+  void EvictBufferMappingsLocked();
+
+  // Unmap all cached buffers.
+  void ClearBufferMappings();
 
   // Prepare a depth request info for the depth generator
   status_t PrepareDepthRequestInfo(const CaptureRequest& request,
@@ -133,6 +169,11 @@ class DepthProcessBlock : public ProcessBlock {
   // Submit a detph request through the asynchronized depth generator API
   status_t SubmitAsyncDepthRequest(const DepthRequestInfo& request_info);
 
+  // Queue a depth request to depth_request_executor_. Blocks while the
+  // executor is full.
+  status_t SubmitConcurrentDepthRequest(
+      DepthRequestExecutor::Request executor_request);
+
   // Process the depth result of frame frame_number
   status_t ProcessDepthResult(DepthResultStatus result_status,
                               uint32_t frame_number);
@@ -163,6 +204,10 @@ class DepthProcessBlock : public ProcessBlock {
   // Depth Generator
   std::unique_ptr<DepthGenerator> depth_generator_ = nullptr;
 
+  // Executes blocking depth requests concurrently if the depth generator is
+  // reentrant. nullptr if requests are executed on the request thread.
+  std::unique_ptr<DepthRequestExecutor> depth_request_executor_;
+
   // Map from stream id to their buffer size
   std::map<int32_t, uint32_t> stream_buffer_sizes_;
 
@@ -189,6 +234,9 @@ class DepthProcessBlock : public ProcessBlock {
   // Whether the pipelined depth engine is enabled
   bool pipelined_depth_engine_enabled_ = false;
 
+  // Maximum number of blocking depth requests executed concurrently
+  uint32_t max_depth_workers_ = 1;
+
   std::mutex pending_requests_mutex_;
   // Pending depth request indexed by the frame_number
   // Must be protected by pending_requests_mutex_
@@ -205,12 +253,45 @@ class DepthProcessBlock : public ProcessBlock {
   // stream id of the internal raw stream from IR 2
   int32_t ir2_internal_raw_stream_id_ = kInvalidStreamId;
 
-  // Guarding async depth generator API calls and the result processing calls
+  // Guarding async depth generator API calls
   std::mutex depth_generator_api_lock_;
+
+  // Serializing the result processing calls
+  std::mutex depth_result_lock_;
+
+  // A buffer mapped for the depth generator.
+  struct BufferMapping {
+    uint8_t* addr = nullptr;
+    size_t size = 0;
+    // Inode of the dma-buf. Detects a freed handle whose address is reused.
+    ino_t inode = 0;
+    // Row stride in bytes and number of rows allocated.
+    uint32_t stride = 0;
+    uint32_t scanline = 0;
+    // Number of pending depth requests using the mapping.
+    uint32_t use_count = 0;
+    // Value of buffer_mapping_clock_ when the mapping was last acquired.
+    uint64_t last_used = 0;
+    // Whether the buffer was removed while in use. It is unmapped once
+    // use_count drops to 0.
+    bool removed = false;
+  };
+
+  // Maximum number of cached mappings, i.e. the depth stream's max buffers
+  // for each configured stream. Set in ConfigureStreams().
+  size_t max_buffer_mappings_ = 0;
+
+  std::mutex buffer_mappings_lock_;
+  // Map from buffer handle to its mapping. Protected by buffer_mappings_lock_.
+  std::unordered_map<buffer_handle_t, BufferMapping> buffer_mappings_;
+  // Protected by buffer_mappings_lock_.
+  uint64_t buffer_mapping_clock_ = 0;
 };
 
 #if !GCH_HWL_USE_DLOPEN
 extern "C" __attribute__((weak)) DepthGenerator* CreateDepthGenerator();
+extern "C" __attribute__((weak)) uint32_t
+GetDepthGeneratorMaxConcurrentRequests();
 #endif
 
 }  // namespace google_camera_hal
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "GCH_DepthRequestExecutor"
+#define ATRACE_TAG ATRACE_TAG_CAMERA
+#include "depth_request_executor.h"
+
+#include <log/log.h>
+#include <utils/Trace.h>
+
+namespace android {
+namespace google_camera_hal {
+
+using depth_generator::DepthResultStatus;
+
+std::unique_ptr<DepthRequestExecutor> DepthRequestExecutor::Create(
+    depth_generator::DepthGenerator* depth_generator, uint32_t num_workers,
+    uint32_t max_queued_requests, ResultFunc on_result) {
+  ATRACE_CALL();
+  if (depth_generator == nullptr || num_workers == 0 || on_result == nullptr) {
+    ALOGE("%s: depth_generator (%p) or on_result is nullptr, or num_workers "
+          "is 0.",
+          __FUNCTION__, depth_generator);
+    return nullptr;
+  }
+
+  auto executor = std::unique_ptr<DepthRequestExecutor>(
+      new DepthRequestExecutor(depth_generator,
+                               num_workers + max_queued_requests, on_result));
+  if (executor == nullptr) {
+    ALOGE("%s: Creating DepthRequestExecutor failed.", __FUNCTION__);
+    return nullptr;
+  }
+
+  for (uint32_t i = 0; i < num_workers; i++) {
+    executor->worker_threads_.emplace_back(
+        [executor = executor.get()] { executor->WorkerThreadLoop(); });
+  }
+
+  ALOGI("%s: %u workers, %u queued requests.", __FUNCTION__, num_workers,
+        max_queued_requests);
+  return executor;
+}
+
+DepthRequestExecutor::DepthRequestExecutor(
+    depth_generator::DepthGenerator* depth_generator,
+    uint32_t max_outstanding_requests, ResultFunc on_result)
+    : depth_generator_(depth_generator),
+      max_outstanding_requests_(max_outstanding_requests),
+      on_result_(on_result) {
+}
+
+DepthRequestExecutor::~DepthRequestExecutor() {
+  ATRACE_CALL();
+  {
+    std::lock_guard<std::mutex> lock(queue_lock_);
+    exiting_ = true;
+  }
+  queue_cond_.notify_all();
+
+  for (auto& worker_thread : worker_threads_) {
+    worker_thread.join();
+  }
+}
+
+status_t DepthRequestExecutor::QueueRequest(Request request) {
+  ATRACE_CALL();
+  std::unique_lock<std::mutex> lock(queue_lock_);
+  // Back-pressure the caller while the workers and the queue are full.
+  queue_cond_.wait(lock, [this]() REQUIRES(queue_lock_) {
+    return exiting_ || next_queue_sequence_ - next_release_sequence_ <
+                           max_outstanding_requests_;
+  });
+  if (exiting_) {
+    ALOGE("%s: Executor is exiting. Dropping frame %u.", __FUNCTION__,
+          request.request_info.frame_number);
+    return NO_INIT;
+  }
+
+  queued_requests_.emplace_back(next_queue_sequence_++, std::move(request));
+  lock.unlock();
+  queue_cond_.notify_all();
+  return OK;
+}
+
+void DepthRequestExecutor::WaitUntilIdle() {
+  ATRACE_CALL();
+  std::unique_lock<std::mutex> lock(queue_lock_);
+  queue_cond_.wait(lock, [this]() REQUIRES(queue_lock_) {
+    return next_release_sequence_ == next_queue_sequence_;
+  });
+}
+
+void DepthRequestExecutor::WorkerThreadLoop() {
+  while (true) {
+    uint64_t sequence;
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(queue_lock_);
+      queue_cond_.wait(lock, [this]() REQUIRES(queue_lock_) {
+        return exiting_ || !queued_requests_.empty();
+      });
+      // Drain the queue before exiting so every request is released.
+      if (queued_requests_.empty()) {
+        return;
+      }
+
+      sequence = queued_requests_.front().first;
+      request = std::move(queued_requests_.front().second);
+      queued_requests_.pop_front();
+    }
+
+    uint32_t frame_number = request.request_info.frame_number;
+    ALOGV("%s: [ud] ExecuteProcessRequest for frame %u", __FUNCTION__,
+          frame_number);
+    DepthResultStatus result_status = DepthResultStatus::kOk;
+    {
+      ATRACE_NAME("DepthRequestExecutor::ExecuteProcessRequest");
+      status_t res =
+          depth_generator_->ExecuteProcessRequest(request.request_info);
+      if (res != OK) {
+        ALOGE("%s: Depth generator fails to process frame %u.", __FUNCTION__,
+              frame_number);
+        result_status = DepthResultStatus::kError;
+      }
+    }
+    // The generator no longer references the metadata.
+    request = {};
+
+    {
+      std::lock_guard<std::mutex> lock(queue_lock_);
+      completed_requests_[sequence] = {.result_status = result_status,
+                                       .frame_number = frame_number};
+    }
+    ReleaseCompletedRequests();
+  }
+}
+
+void DepthRequestExecutor::ReleaseCompletedRequests() {
+  // Only the holder of release_lock_ advances next_release_sequence_, so a
+  // request completed while another worker is releasing is picked up by
+  // either that worker or this one.
+  std::lock_guard<std::mutex> release_lock(release_lock_);
+  while (true) {
+    CompletedRequest completed;
+    {
+      std::lock_guard<std::mutex> lock(queue_lock_);
+      auto completed_it = completed_requests_.begin();
+      if (completed_it == completed_requests_.end() ||
+          completed_it->first != next_release_sequence_) {
+        return;
+      }
+      completed = completed_it->second;
+      completed_requests_.erase(completed_it);
+    }
+
+    on_result_(completed.result_status, completed.frame_number);
+
+    {
+      std::lock_guard<std::mutex> lock(queue_lock_);
+      next_release_sequence_++;
+    }
+    queue_cond_.notify_all();
+  }
+}
+
+}  // namespace google_camera_hal
+}  // namespace android
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HARDWARE_GOOGLE_CAMERA_HAL_GOOGLE_CAMERA_HAL_DEPTH_REQUEST_EXECUTOR_H_
+#define HARDWARE_GOOGLE_CAMERA_HAL_GOOGLE_CAMERA_HAL_DEPTH_REQUEST_EXECUTOR_H_
+
+#include <android-base/thread_annotations.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "depth_generator.h"
+#include "hal_camera_metadata.h"
+
+namespace android {
+namespace google_camera_hal {
+
+// DepthRequestExecutor runs DepthGenerator::ExecuteProcessRequest for up to
+// num_workers requests at a time on its own worker threads, and releases the
+// results in the order the requests were queued.
+// It must only be used with a depth generator that can execute num_workers
+// requests concurrently.
+// Sample usage:
+//   auto executor = DepthRequestExecutor::Create(generator, 2, 2, on_result);
+//   executor->QueueRequest(std::move(request));  // for each request
+class DepthRequestExecutor {
+ public:
+  // A depth request and the metadata its request info points to. The
+  // metadata is kept alive until the request is executed.
+  struct Request {
+    depth_generator::DepthRequestInfo request_info;
+    std::unique_ptr<HalCameraMetadata> settings;
+    std::unique_ptr<HalCameraMetadata> color_buffer_metadata;
+  };
+
+  // Invoked for each request once it and all requests queued before it are
+  // executed. It is invoked from one thread at a time.
+  using ResultFunc = std::function<void(
+      depth_generator::DepthResultStatus result_status, uint32_t frame_number)>;
+
+  // depth_generator is owned by the caller and must outlive the executor.
+  // max_queued_requests is the number of requests that can wait for a worker
+  // before QueueRequest blocks.
+  static std::unique_ptr<DepthRequestExecutor> Create(
+      depth_generator::DepthGenerator* depth_generator, uint32_t num_workers,
+      uint32_t max_queued_requests, ResultFunc on_result);
+
+  // Execute and release all queued requests, then stop the worker threads.
+  ~DepthRequestExecutor();
+
+  // Queue a request for execution. It blocks while num_workers requests are
+  // executing or waiting for release and max_queued_requests requests are
+  // waiting for a worker.
+  status_t QueueRequest(Request request);
+
+  // Block until all queued requests are released.
+  void WaitUntilIdle();
+
+ private:
+  // A request that finished executing and waits for the requests queued
+  // before it.
+  struct CompletedRequest {
+    depth_generator::DepthResultStatus result_status;
+    uint32_t frame_number;
+  };
+
+  DepthRequestExecutor(depth_generator::DepthGenerator* depth_generator,
+                       uint32_t max_outstanding_requests, ResultFunc on_result);
+
+  void WorkerThreadLoop();
+
+  // Release completed requests in queue order until one is still executing.
+  void ReleaseCompletedRequests();
+
+  depth_generator::DepthGenerator* const depth_generator_;
+  // Maximum number of requests queued but not released yet.
+  const uint64_t max_outstanding_requests_;
+  const ResultFunc on_result_;
+
+  std::mutex queue_lock_;
+  // Signaled when a request is queued or released, or on exit.
+  std::condition_variable queue_cond_;
+
+  // Requests waiting for a worker, with their sequence numbers.
+  std::deque<std::pair<uint64_t, Request>> queued_requests_
+      GUARDED_BY(queue_lock_);
+
+  // Requests executed but not released yet, indexed by sequence number.
+  std::map<uint64_t, CompletedRequest> completed_requests_
+      GUARDED_BY(queue_lock_);
+
+  // Sequence number of the next request to queue.
+  uint64_t next_queue_sequence_ GUARDED_BY(queue_lock_) = 0;
+
+  // Sequence number of the next request to release.
+  uint64_t next_release_sequence_ GUARDED_BY(queue_lock_) = 0;
+
+  bool exiting_ GUARDED_BY(queue_lock_) = false;
+
+  // Serializes invoking on_result_.
+  std::mutex release_lock_;
+
+  std::vector<std::thread> worker_threads_;
+};
+
+}  // namespace google_camera_hal
+}  // namespace android
+
+#endif  // HARDWARE_GOOGLE_CAMERA_HAL_GOOGLE_CAMERA_HAL_DEPTH_REQUEST_EXECUTOR_H_
@@ -467,6 +467,8 @@ status_t DualIrCaptureSession::CreateProcessChain(
     }
   }
 
+  depth_process_block_ = depth_process_block.get();
+
   if (!AreAllStreamsConfigured(stream_config, process_block_stream_config)) {
     ALOGE("%s: Not all streams are configured!", __FUNCTION__);
     return INVALID_OPERATION;
@@ -551,5 +553,11 @@ status_t DualIrCaptureSession::Flush() {
   return request_processor_->Flush();
 }
 
+void DualIrCaptureSession::RemoveCachedBuffers(const native_handle_t* handle) {
+  if (depth_process_block_ != nullptr) {
+    depth_process_block_->RemoveCachedBuffers(handle);
+  }
+}
+
 }  // namespace google_camera_hal
 }  // namespace android
@@ -72,6 +72,8 @@ class DualIrCaptureSession : public CaptureSession {
   status_t ProcessRequest(const CaptureRequest& request) override;
 
   status_t Flush() override;
+
+  void RemoveCachedBuffers(const native_handle_t* handle) override;
   // Override functions in CaptureSession end.
 
  protected:
@@ -159,6 +161,10 @@ class DualIrCaptureSession : public CaptureSession {
 
   // Whether there is a depth stream configured in the current session
   bool has_depth_stream_ = false;
+
+  // Depth process block owned by the process chain. nullptr if there is no
+  // depth stream.
+  DepthProcessBlock* depth_process_block_ = nullptr;
 };
 
 }  // namespace google_camera_hal
@@ -454,6 +454,7 @@ status_t RgbirdCaptureSession::SetupDepthChainSegment(
         depth_block_stream_config.streams.begin(),
         depth_block_stream_config.streams.end());
 
+    depth_process_block_ = d_process_block.get();
     *depth_process_block = std::move(d_process_block);
     *depth_result_processor = std::move(d_result_processor);
   }
@@ -1079,6 +1080,12 @@ status_t RgbirdCaptureSession::Flush() {
   return rt_request_processor_->Flush();
 }
 
+void RgbirdCaptureSession::RemoveCachedBuffers(const native_handle_t* handle) {
+  if (depth_process_block_ != nullptr) {
+    depth_process_block_->RemoveCachedBuffers(handle);
+  }
+}
+
 void RgbirdCaptureSession::ProcessCaptureResult(
     std::unique_ptr<CaptureResult> result) {
   ATRACE_CALL();
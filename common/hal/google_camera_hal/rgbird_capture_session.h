@@ -75,6 +75,8 @@ class RgbirdCaptureSession : public CaptureSession {
   status_t ProcessRequest(const CaptureRequest& request) override;
 
   status_t Flush() override;
+
+  void RemoveCachedBuffers(const native_handle_t* handle) override;
   // Override functions in CaptureSession end.
 
  protected:
@@ -218,6 +220,10 @@ class RgbirdCaptureSession : public CaptureSession {
 
   std::unique_ptr<ResultDispatcher> result_dispatcher_;
 
+  // Depth process block owned by the realtime process chain. nullptr if
+  // depth processing is not needed.
+  DepthProcessBlock* depth_process_block_ = nullptr;
+
   std::mutex callback_lock_;
   // The following callbacks must be protected by callback_lock_.
   ProcessCaptureResultFunc process_capture_result_;
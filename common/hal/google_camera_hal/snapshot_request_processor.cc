@@ -142,6 +142,12 @@ status_t SnapshotRequestProcessor::SetProcessBlock(
   return OK;
 }
 
+void SnapshotRequestProcessor::SetZslSelectionPolicy(
+    std::unique_ptr<ZslSelectionPolicy> policy) {
+  std::lock_guard<std::mutex> lock(process_block_lock_);
+  zsl_selection_policy_ = std::move(policy);
+}
+
 bool SnapshotRequestProcessor::IsReadyForNextRequest() {
   ATRACE_CALL();
   if (internal_stream_manager_ == nullptr) {
@@ -184,7 +190,8 @@ status_t SnapshotRequestProcessor::ProcessRequest(const CaptureRequest& request)
   // Get multiple yuv buffer and metadata from internal stream as input
   status_t result = internal_stream_manager_->GetMostRecentStreamBuffer(
       yuv_stream_id_, &(block_request.input_buffers),
-      &(block_request.input_buffer_metadata), /*payload_frames=*/kZslBufferSize);
+      &(block_request.input_buffer_metadata), /*payload_frames=*/kZslBufferSize,
+      /*min_filled_buffers=*/kZslBufferSize, zsl_selection_policy_.get());
   if (result != OK) {
     ALOGE("%s: frame:%d GetStreamBuffer failed.", __FUNCTION__,
           request.frame_number);
@@ -51,6 +51,10 @@ class SnapshotRequestProcessor : public RequestProcessor {
   status_t Flush() override;
   // Override functions of RequestProcessor end.
 
+  // Use policy to select the ZSL buffers of snapshot requests instead of the
+  // most recent ones. policy can be nullptr to restore the default.
+  void SetZslSelectionPolicy(std::unique_ptr<ZslSelectionPolicy> policy);
+
  protected:
   explicit SnapshotRequestProcessor(HwlSessionCallback session_callback)
       : session_callback_(session_callback) {
@@ -67,6 +71,9 @@ class SnapshotRequestProcessor : public RequestProcessor {
   // Protected by process_block_lock_.
   std::unique_ptr<ProcessBlock> process_block_;
 
+  // Protected by process_block_lock_.
+  std::unique_ptr<ZslSelectionPolicy> zsl_selection_policy_;
+
   InternalStreamManager* internal_stream_manager_ = nullptr;
   int32_t yuv_stream_id_ = -1;
   uint32_t active_array_width_ = 0;
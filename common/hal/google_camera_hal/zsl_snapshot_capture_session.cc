@@ -21,6 +21,7 @@
 
 #include "zsl_snapshot_capture_session.h"
 
+#include <cutils/properties.h>
 #include <dlfcn.h>
 #include <log/log.h>
 #include <sys/stat.h>
@@ -586,6 +587,17 @@ status_t ZslSnapshotCaptureSession::SetupSnapshotProcessChain(
     return UNKNOWN_ERROR;
   }
 
+  if (property_get_bool(kZslQualitySelectionProp, false)) {
+    auto selection_policy = QualityZslSelectionPolicy::Create(
+        QualityZslSelectionPolicy::Config());
+    if (selection_policy == nullptr) {
+      ALOGE("%s: Creating QualityZslSelectionPolicy failed.", __FUNCTION__);
+      return UNKNOWN_ERROR;
+    }
+    snapshot_request_processor_->SetZslSelectionPolicy(
+        std::move(selection_policy));
+  }
+
   std::unique_ptr<SnapshotResultProcessor> snapshot_result_processor =
       SnapshotResultProcessor::Create(internal_stream_manager_.get(),
                                       additional_stream_id_);
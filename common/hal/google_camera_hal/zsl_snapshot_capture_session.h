@@ -96,6 +96,9 @@ class ZslSnapshotCaptureSession : public CaptureSession {
  private:
   static constexpr uint32_t kPartialResult = 1;
   static constexpr int kAdditionalBufferNumber = 3;
+  // Select ZSL buffers by expected sharpness instead of recency.
+  static constexpr const char* kZslQualitySelectionProp =
+      "persist.vendor.camera.hal.zsl_quality_selection";
 
   status_t Initialize(CameraDeviceSessionHwl* device_session_hwl,
                       const StreamConfiguration& stream_config,
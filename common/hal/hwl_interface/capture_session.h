@@ -58,6 +58,11 @@ class CaptureSession {
 
   // Flush all pending capture requests.
   virtual status_t Flush() = 0;
+
+  // Release any internal caching of a framework buffer that was removed from
+  // the buffer cache. handle must not be used after this returns.
+  virtual void RemoveCachedBuffers(const native_handle_t* /*handle*/) {
+  }
 };
 
 // ExternalCaptureSessionFactory defines the interface of an external capture
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "CaptureSessionUtilsTests"
+#include <log/log.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "capture_session_utils.h"
+#include "hal_utils.h"
+#include "test_utils.h"
+
+namespace android {
+namespace google_camera_hal {
+
+using Selection = CaptureSessionSelectionCache::Selection;
+using EntryType = CaptureSessionSelectionCache::EntryType;
+
+class FakeCaptureSession : public CaptureSession {
+ public:
+  status_t ProcessRequest(const CaptureRequest&) override {
+    return OK;
+  }
+
+  status_t Flush() override {
+    return OK;
+  }
+};
+
+// Return a predefined capture session entry that supports preview streams of
+// supported_width and counts how many times it is probed.
+static CaptureSessionEntryFuncs CreateEntry(uint32_t supported_width,
+                                            uint32_t* num_probes) {
+  return {
+      .IsStreamConfigurationSupported =
+          [supported_width, num_probes](CameraDeviceSessionHwl*,
+                                        const StreamConfiguration& config) {
+            (*num_probes)++;
+            return config.streams[0].width == supported_width;
+          },
+      .CreateSession =
+          [](CameraDeviceSessionHwl*, const StreamConfiguration&,
+             ProcessCaptureResultFunc, ProcessBatchCaptureResultFunc,
+             NotifyFunc, HwlSessionCallback, std::vector<HalStream>*,
+             CameraBufferAllocatorHwl*) -> std::unique_ptr<CaptureSession> {
+            return std::make_unique<FakeCaptureSession>();
+          }};
+}
+
+static std::unique_ptr<CaptureSession> CreateSession(
+    const StreamConfiguration& config,
+    const std::vector<CaptureSessionEntryFuncs>& entries,
+    CaptureSessionSelectionCache* selection_cache) {
+  std::vector<HalStream> hal_config;
+  return CreateCaptureSession(
+      config, /*wrapper_capture_session_entries=*/{},
+      /*external_capture_session_entries=*/{}, entries,
+      /*hwl_session_callback=*/{}, /*camera_buffer_allocator_hwl=*/nullptr,
+      /*camera_device_session_hwl=*/nullptr, &hal_config,
+      /*process_capture_result=*/nullptr, /*notify=*/nullptr,
+      /*process_batch_capture_result=*/nullptr, selection_cache);
+}
+
+TEST(CaptureSessionUtilsTests, StreamConfigurationKey) {
+  StreamConfiguration config;
+  test_utils::GetPreviewOnlyStreamConfiguration(&config, 1280, 720);
+  Stream stream = config.streams[0];
+  stream.id++;
+  stream.width = 640;
+  stream.height = 480;
+  config.streams.push_back(stream);
+  std::string key = hal_utils::GetStreamConfigurationKey(config);
+
+  // Stream order and the configuration counter are not part of the key.
+  std::reverse(config.streams.begin(), config.streams.end());
+  config.stream_config_counter++;
+  EXPECT_EQ(hal_utils::GetStreamConfigurationKey(config), key);
+
+  config.session_params = HalCameraMetadata::Create(/*num_entries=*/2,
+                                                    /*data_bytes=*/16);
+  ASSERT_NE(config.session_params, nullptr);
+  std::string empty_params_key = hal_utils::GetStreamConfigurationKey(config);
+  EXPECT_EQ(empty_params_key, key);
+
+  int32_t fps_range[2] = {30, 30};
+  uint8_t video_stabilization = ANDROID_CONTROL_VIDEO_STABILIZATION_MODE_ON;
+  ASSERT_EQ(config.session_params->Set(ANDROID_CONTROL_AE_TARGET_FPS_RANGE,
+                                       fps_range, 2),
+            OK);
+  ASSERT_EQ(config.session_params->Set(ANDROID_CONTROL_VIDEO_STABILIZATION_MODE,
+                                       &video_stabilization, 1),
+            OK);
+  std::string params_key = hal_utils::GetStreamConfigurationKey(config);
+  EXPECT_NE(params_key, key);
+
+  // Session parameter order is not part of the key.
+  config.session_params = HalCameraMetadata::Create(/*num_entries=*/2,
+                                                    /*data_bytes=*/16);
+  ASSERT_EQ(config.session_params->Set(ANDROID_CONTROL_VIDEO_STABILIZATION_MODE,
+                                       &video_stabilization, 1),
+            OK);
+  ASSERT_EQ(config.session_params->Set(ANDROID_CONTROL_AE_TARGET_FPS_RANGE,
+                                       fps_range, 2),
+            OK);
+  EXPECT_EQ(hal_utils::GetStreamConfigurationKey(config), params_key);
+}
+
+TEST(CaptureSessionUtilsTests, SelectionCacheEvictsLeastRecentlyUsed) {
+  CaptureSessionSelectionCache cache(/*capacity=*/2);
+  Selection selection;
+  EXPECT_FALSE(cache.Lookup("a", &selection));
+
+  cache.Insert("a", {.type = EntryType::kWrapper, .index = 0});
+  cache.Insert("b", {.type = EntryType::kExternal, .index = 1});
+  ASSERT_TRUE(cache.Lookup("a", &selection));
+  EXPECT_EQ(selection.type, EntryType::kWrapper);
+
+  // "b" is the least recently used key now.
+  cache.Insert("c", {.type = EntryType::kPredefined, .index = 2});
+  EXPECT_FALSE(cache.Lookup("b", &selection));
+  ASSERT_TRUE(cache.Lookup("c", &selection));
+  EXPECT_EQ(selection.type, EntryType::kPredefined);
+  EXPECT_EQ(selection.index, 2u);
+  EXPECT_TRUE(cache.Lookup("a", &selection));
+
+  cache.Erase("a");
+  EXPECT_FALSE(cache.Lookup("a", &selection));
+}
+
+TEST(CaptureSessionUtilsTests, CreateCaptureSessionProbesCachedEntry) {
+  uint32_t num_probes[3] = {};
+  std::vector<CaptureSessionEntryFuncs> entries = {
+      CreateEntry(/*supported_width=*/640, &num_probes[0]),
+      CreateEntry(/*supported_width=*/1280, &num_probes[1]),
+      CreateEntry(/*supported_width=*/1920, &num_probes[2])};
+  CaptureSessionSelectionCache cache;
+
+  StreamConfiguration video_config;
+  test_utils::GetPreviewOnlyStreamConfiguration(&video_config, 1920, 1080);
+  StreamConfiguration photo_config;
+  test_utils::GetPreviewOnlyStreamConfiguration(&photo_config, 1280, 720);
+
+  ASSERT_NE(CreateSession(video_config, entries, &cache), nullptr);
+  ASSERT_NE(CreateSession(photo_config, entries, &cache), nullptr);
+  EXPECT_EQ(num_probes[0], 2u);
+  EXPECT_EQ(num_probes[1], 2u);
+  EXPECT_EQ(num_probes[2], 1u);
+
+  // Switching back and forth only probes the selected entries.
+  for (uint32_t i = 0; i < 3; i++) {
+    ASSERT_NE(CreateSession(video_config, entries, &cache), nullptr);
+    ASSERT_NE(CreateSession(photo_config, entries, &cache), nullptr);
+  }
+  EXPECT_EQ(num_probes[0], 2u);
+  EXPECT_EQ(num_probes[1], 5u);
+  EXPECT_EQ(num_probes[2], 4u);
+
+  // Without a cache every entry ahead of the selected one is probed.
+  ASSERT_NE(CreateSession(video_config, entries, nullptr), nullptr);
+  EXPECT_EQ(num_probes[0], 3u);
+  EXPECT_EQ(num_probes[1], 6u);
+  EXPECT_EQ(num_probes[2], 5u);
+}
+
+}  // namespace google_camera_hal
+}  // namespace android
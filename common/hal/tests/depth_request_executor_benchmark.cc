@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures depth request throughput of DepthRequestExecutor with 1 to 4
+// workers, using a stub depth generator that burns a fixed amount of CPU per
+// request. items_per_second is the depth frame rate.
+// Run with:
+//   adb shell /data/benchmarktest64/depth_request_executor_benchmark/depth_request_executor_benchmark
+
+#include <benchmark/benchmark.h>
+
+#include "depth_request_executor.h"
+#include "stub_depth_generator.h"
+
+namespace android {
+namespace google_camera_hal {
+namespace {
+
+constexpr uint32_t kNumRequests = 60;
+
+// Args: number of workers, CPU time per request in microseconds.
+void BM_ExecuteDepthRequests(benchmark::State& state) {
+  uint32_t num_workers = state.range(0);
+  uint32_t work_us = state.range(1);
+  StubDepthGenerator generator([work_us](uint32_t) { return work_us; });
+  auto executor = DepthRequestExecutor::Create(
+      &generator, num_workers, /*max_queued_requests=*/num_workers,
+      [](depth_generator::DepthResultStatus, uint32_t) {});
+
+  uint32_t frame_number = 0;
+  for (auto _ : state) {
+    for (uint32_t i = 0; i < kNumRequests; i++) {
+      DepthRequestExecutor::Request request;
+      request.request_info.frame_number = frame_number++;
+      executor->QueueRequest(std::move(request));
+    }
+    executor->WaitUntilIdle();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumRequests);
+}
+BENCHMARK(BM_ExecuteDepthRequests)
+    ->ArgsProduct({{1, 2, 3, 4}, {2000, 8000}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace google_camera_hal
+}  // namespace android
+
+BENCHMARK_MAIN();
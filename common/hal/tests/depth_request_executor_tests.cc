@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "DepthRequestExecutorTests"
+#include <log/log.h>
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <vector>
+
+#include "depth_request_executor.h"
+#include "stub_depth_generator.h"
+
+namespace android {
+namespace google_camera_hal {
+
+using depth_generator::DepthResultStatus;
+
+static DepthRequestExecutor::Request CreateRequest(uint32_t frame_number) {
+  DepthRequestExecutor::Request request;
+  request.request_info.frame_number = frame_number;
+  return request;
+}
+
+TEST(DepthRequestExecutorTests, Create) {
+  StubDepthGenerator generator([](uint32_t) { return 0; });
+  auto on_result = [](DepthResultStatus, uint32_t) {};
+
+  EXPECT_EQ(DepthRequestExecutor::Create(nullptr, 2, 2, on_result), nullptr);
+  EXPECT_EQ(DepthRequestExecutor::Create(&generator, 0, 2, on_result), nullptr);
+  EXPECT_EQ(DepthRequestExecutor::Create(&generator, 2, 2, nullptr), nullptr);
+  EXPECT_NE(DepthRequestExecutor::Create(&generator, 2, 2, on_result), nullptr);
+}
+
+TEST(DepthRequestExecutorTests, ReleaseInOrder) {
+  constexpr uint32_t kNumWorkers = 4;
+  constexpr uint32_t kNumRequests = 40;
+  // Earlier frames take longer so they finish out of order.
+  StubDepthGenerator generator(
+      [](uint32_t frame_number) { return 1000 * (4 - frame_number % 4); });
+  generator.SetFailingFrame(7);
+
+  std::mutex lock;
+  std::vector<uint32_t> released_frames;
+  std::vector<DepthResultStatus> released_status;
+  auto executor = DepthRequestExecutor::Create(
+      &generator, kNumWorkers, /*max_queued_requests=*/kNumWorkers,
+      [&](DepthResultStatus result_status, uint32_t frame_number) {
+        std::lock_guard<std::mutex> l(lock);
+        released_frames.push_back(frame_number);
+        released_status.push_back(result_status);
+      });
+  ASSERT_NE(executor, nullptr);
+
+  for (uint32_t i = 0; i < kNumRequests; i++) {
+    ASSERT_EQ(executor->QueueRequest(CreateRequest(i)), OK);
+  }
+  executor->WaitUntilIdle();
+
+  std::lock_guard<std::mutex> l(lock);
+  ASSERT_EQ(released_frames.size(), kNumRequests);
+  for (uint32_t i = 0; i < kNumRequests; i++) {
+    EXPECT_EQ(released_frames[i], i);
+    EXPECT_EQ(released_status[i],
+              i == 7 ? DepthResultStatus::kError : DepthResultStatus::kOk);
+  }
+  EXPECT_GT(generator.GetMaxExecutingRequests(), 1u);
+  EXPECT_LE(generator.GetMaxExecutingRequests(), kNumWorkers);
+}
+
+TEST(DepthRequestExecutorTests, BackPressure) {
+  constexpr uint32_t kNumWorkers = 2;
+  constexpr uint32_t kMaxQueuedRequests = 1;
+  StubDepthGenerator generator([](uint32_t) { return 500; });
+
+  std::mutex lock;
+  uint32_t num_released = 0;
+  auto executor = DepthRequestExecutor::Create(
+      &generator, kNumWorkers, kMaxQueuedRequests,
+      [&](DepthResultStatus, uint32_t) {
+        std::lock_guard<std::mutex> l(lock);
+        num_released++;
+      });
+  ASSERT_NE(executor, nullptr);
+
+  // Each queued request beyond the limit must wait for an earlier release.
+  for (uint32_t i = 0; i < 20; i++) {
+    ASSERT_EQ(executor->QueueRequest(CreateRequest(i)), OK);
+    std::lock_guard<std::mutex> l(lock);
+    EXPECT_LE(i + 1 - num_released, kNumWorkers + kMaxQueuedRequests);
+  }
+
+  // Destroying the executor releases the remaining requests.
+  executor = nullptr;
+  EXPECT_EQ(num_released, 20u);
+}
+
+}  // namespace google_camera_hal
+}  // namespace android
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "InternalBufferPoolTests"
+#include <log/log.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <set>
+#include <thread>
+
+#include "internal_buffer_pool.h"
+
+namespace android {
+namespace google_camera_hal {
+
+// Hands out fake buffer handles and tracks the live ones.
+class FakeBufferAllocator : public IHalBufferAllocator {
+ public:
+  explicit FakeBufferAllocator(std::set<buffer_handle_t>* live_buffers)
+      : live_buffers_(live_buffers) {
+  }
+
+  status_t AllocateBuffers(const HalBufferDescriptor& buffer_descriptor,
+                           std::vector<buffer_handle_t>* buffers) override {
+    for (uint32_t i = 0; i < buffer_descriptor.immediate_num_buffers; i++) {
+      auto buffer = reinterpret_cast<buffer_handle_t>(++next_handle_);
+      live_buffers_->insert(buffer);
+      buffers->push_back(buffer);
+    }
+    return OK;
+  }
+
+  void FreeBuffers(std::vector<buffer_handle_t>* buffers) override {
+    for (auto buffer : *buffers) {
+      live_buffers_->erase(buffer);
+    }
+    buffers->clear();
+  }
+
+ private:
+  std::set<buffer_handle_t>* live_buffers_;
+  uintptr_t next_handle_ = 0;
+};
+
+static HalBufferDescriptor CreateDescriptor(uint32_t width, uint32_t height,
+                                            uint32_t num_buffers) {
+  return {.width = width,
+          .height = height,
+          .format = HAL_PIXEL_FORMAT_YCBCR_420_888,
+          .immediate_num_buffers = num_buffers,
+          .max_num_buffers = num_buffers};
+}
+
+static std::unique_ptr<InternalBufferPool> CreatePool(
+    std::set<buffer_handle_t>* live_buffers, size_t max_pooled_bytes,
+    std::chrono::milliseconds idle_timeout =
+        InternalBufferPool::kDefaultIdleTimeout) {
+  return InternalBufferPool::Create(
+      std::make_unique<FakeBufferAllocator>(live_buffers), max_pooled_bytes,
+      idle_timeout);
+}
+
+// Pool a buffer of 640x480 in a reconfiguration.
+static void PoolBuffer(InternalBufferPool* pool) {
+  std::vector<buffer_handle_t> buffers;
+  ASSERT_EQ(pool->AllocateBuffers(CreateDescriptor(640, 480, 1), &buffers), OK);
+  pool->BeginReconfiguration();
+  pool->FreeBuffers(&buffers);
+  pool->EndReconfiguration();
+}
+
+TEST(InternalBufferPoolTests, FreeOutsideReconfiguration) {
+  std::set<buffer_handle_t> live_buffers;
+  auto pool = CreatePool(&live_buffers, /*max_pooled_bytes=*/SIZE_MAX);
+  ASSERT_NE(pool, nullptr);
+
+  std::vector<buffer_handle_t> buffers;
+  ASSERT_EQ(pool->AllocateBuffers(CreateDescriptor(640, 480, 4), &buffers), OK);
+  EXPECT_EQ(buffers.size(), 4u);
+  EXPECT_EQ(live_buffers.size(), 4u);
+
+  pool->FreeBuffers(&buffers);
+  EXPECT_TRUE(buffers.empty());
+  EXPECT_EQ(pool->GetNumPooledBuffers(), 0u);
+  EXPECT_TRUE(live_buffers.empty());
+}
+
+TEST(InternalBufferPoolTests, ReuseAcrossReconfigurations) {
+  std::set<buffer_handle_t> live_buffers;
+  auto pool = CreatePool(&live_buffers, /*max_pooled_bytes=*/SIZE_MAX);
+  ASSERT_NE(pool, nullptr);
+
+  auto photo_descriptor = CreateDescriptor(4032, 3024, 4);
+  auto video_descriptor = CreateDescriptor(1920, 1080, 6);
+  std::vector<buffer_handle_t> photo_buffers;
+  ASSERT_EQ(pool->AllocateBuffers(photo_descriptor, &photo_buffers), OK);
+  std::set<buffer_handle_t> first_photo_buffers(photo_buffers.begin(),
+                                                photo_buffers.end());
+
+  // Photo to video. Photo buffers are kept while video is configured.
+  std::vector<buffer_handle_t> video_buffers;
+  pool->BeginReconfiguration();
+  pool->FreeBuffers(&photo_buffers);
+  ASSERT_EQ(pool->AllocateBuffers(video_descriptor, &video_buffers), OK);
+  pool->EndReconfiguration();
+  EXPECT_EQ(pool->GetNumPooledBuffers(), 4u);
+  EXPECT_EQ(live_buffers.size(), 10u);
+
+  // Video back to photo reuses the photo buffers and keeps the video ones.
+  pool->BeginReconfiguration();
+  pool->FreeBuffers(&video_buffers);
+  ASSERT_EQ(pool->AllocateBuffers(photo_descriptor, &photo_buffers), OK);
+  pool->EndReconfiguration();
+  EXPECT_EQ(std::set<buffer_handle_t>(photo_buffers.begin(),
+                                      photo_buffers.end()),
+            first_photo_buffers);
+  EXPECT_EQ(pool->GetNumPooledBuffers(), 6u);
+  EXPECT_EQ(live_buffers.size(), 10u);
+
+  // A third configuration frees the video buffers pooled before it.
+  std::vector<buffer_handle_t> other_buffers;
+  pool->BeginReconfiguration();
+  pool->FreeBuffers(&photo_buffers);
+  ASSERT_EQ(pool->AllocateBuffers(CreateDescriptor(640, 480, 2),
+                                  &other_buffers),
+            OK);
+  pool->EndReconfiguration();
+  EXPECT_EQ(pool->GetNumPooledBuffers(), 4u);
+  EXPECT_EQ(live_buffers.size(), 6u);
+
+  pool->FreeBuffers(&other_buffers);
+  pool = nullptr;
+  EXPECT_TRUE(live_buffers.empty());
+}
+
+TEST(InternalBufferPoolTests, PooledBytesBudget) {
+  std::set<buffer_handle_t> live_buffers;
+  // Room for two 640x480 YUV buffers.
+  auto pool = CreatePool(&live_buffers, /*max_pooled_bytes=*/640 * 480 * 3);
+  ASSERT_NE(pool, nullptr);
+
+  std::vector<buffer_handle_t> buffers;
+  ASSERT_EQ(pool->AllocateBuffers(CreateDescriptor(640, 480, 3), &buffers), OK);
+
+  pool->BeginReconfiguration();
+  pool->FreeBuffers(&buffers);
+  EXPECT_EQ(pool->GetNumPooledBuffers(), 2u);
+  EXPECT_EQ(live_buffers.size(), 2u);
+  pool->EndReconfiguration();
+}
+
+TEST(InternalBufferPoolTests, TrimPooledBuffers) {
+  std::set<buffer_handle_t> live_buffers;
+  auto pool = CreatePool(&live_buffers, /*max_pooled_bytes=*/SIZE_MAX);
+  ASSERT_NE(pool, nullptr);
+
+  PoolBuffer(pool.get());
+  EXPECT_EQ(pool->GetNumPooledBuffers(), 1u);
+  pool->TrimPooledBuffers();
+  EXPECT_EQ(pool->GetNumPooledBuffers(), 0u);
+  EXPECT_TRUE(live_buffers.empty());
+}
+
+TEST(InternalBufferPoolTests, FreeIdlePooledBuffers) {
+  std::set<buffer_handle_t> live_buffers;
+  auto pool = CreatePool(&live_buffers, /*max_pooled_bytes=*/SIZE_MAX,
+                         /*idle_timeout=*/std::chrono::milliseconds(10));
+  ASSERT_NE(pool, nullptr);
+
+  PoolBuffer(pool.get());
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (pool->GetNumPooledBuffers() > 0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(pool->GetNumPooledBuffers(), 0u);
+  EXPECT_TRUE(live_buffers.empty());
+}
+
+TEST(InternalBufferPoolTests, KeepPooledBuffersWhileReconfiguring) {
+  std::set<buffer_handle_t> live_buffers;
+  auto pool = CreatePool(&live_buffers, /*max_pooled_bytes=*/SIZE_MAX,
+                         /*idle_timeout=*/std::chrono::milliseconds(10));
+  ASSERT_NE(pool, nullptr);
+
+  PoolBuffer(pool.get());
+  // A reconfiguration in progress may reuse the pooled buffer.
+  pool->BeginReconfiguration();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(pool->GetNumPooledBuffers(), 1u);
+  pool->EndReconfiguration();
+  EXPECT_EQ(pool->GetNumPooledBuffers(), 0u);
+}
+
+}  // namespace google_camera_hal
+}  // namespace android
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures CameraDeviceSession::ConfigureStreams latency when cycling through
+// a number of stream configurations, e.g. 2 for an app switching between
+// photo and video mode. Cycling through more configurations than the capture
+// session selection cache holds measures the cold path.
+// BM_ReconfigureZslStreams measures reallocating the internal ZSL streams of
+// a capture session on each reconfiguration, with and without the warm
+// reconfiguration buffer pool.
+// Run with:
+//   adb shell /data/benchmarktest64/reconfigure_benchmark/reconfigure_benchmark
+
+#include <benchmark/benchmark.h>
+#include <gmock/gmock.h>
+#include <hardware/gralloc.h>
+#include <hardware/gralloc1.h>
+
+#include "camera_device_session.h"
+#include "internal_buffer_pool.h"
+#include "internal_stream_manager.h"
+#include "mock_device_session_hwl.h"
+#include "test_utils.h"
+
+namespace android {
+namespace google_camera_hal {
+namespace {
+
+// Arg: number of distinct stream configurations to cycle through.
+void BM_ConfigureStreams(benchmark::State& state) {
+  auto session_hwl =
+      std::make_unique<::testing::NiceMock<MockDeviceSessionHwl>>();
+  session_hwl->DelegateCallsToFakeSession();
+  auto session = CameraDeviceSession::Create(
+      std::move(session_hwl), /*external_session_factory_entries=*/{});
+  if (session == nullptr) {
+    state.SkipWithError("Creating CameraDeviceSession failed.");
+    return;
+  }
+
+  uint32_t num_configs = state.range(0);
+  std::vector<StreamConfiguration> configs(num_configs);
+  for (uint32_t i = 0; i < num_configs; i++) {
+    test_utils::GetPreviewOnlyStreamConfiguration(&configs[i], 640 + 64 * i,
+                                                  480 + 48 * i);
+  }
+
+  size_t i = 0;
+  for (auto _ : state) {
+    ConfigureStreamsReturn hal_config;
+    status_t res = session->ConfigureStreams(configs[i++ % num_configs],
+                                             /*v2=*/false, &hal_config);
+    if (res != OK) {
+      state.SkipWithError("ConfigureStreams failed.");
+      return;
+    }
+  }
+}
+BENCHMARK(BM_ConfigureStreams)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(8)
+    ->Unit(benchmark::kMicrosecond);
+
+// Budget of the warm reconfiguration pool. It holds the internal streams of
+// one configuration.
+constexpr size_t kWarmPoolBytes = 64 * 1024 * 1024;
+constexpr uint32_t kZslRawBuffers = 8;
+constexpr uint32_t kZslYuvBuffers = 4;
+
+// Register a ZSL RAW stream and an internal YUV stream sized for config_index
+// and allocate their buffers, as ZSL capture sessions do when configured.
+status_t ConfigureZslStreams(uint32_t config_index,
+                             InternalStreamManager* stream_manager) {
+  uint32_t width = 2016 + 64 * config_index;
+  uint32_t height = 1512 + 48 * config_index;
+  const struct {
+    android_pixel_format_t format;
+    uint64_t usage;
+    uint32_t max_buffers;
+  } internal_streams[] = {
+      {HAL_PIXEL_FORMAT_RAW10, GRALLOC_USAGE_HW_CAMERA_ZSL, kZslRawBuffers},
+      {HAL_PIXEL_FORMAT_YCBCR_420_888, GRALLOC_USAGE_HW_CAMERA_WRITE,
+       kZslYuvBuffers},
+  };
+
+  for (auto& internal_stream : internal_streams) {
+    Stream stream = {.stream_type = StreamType::kOutput,
+                     .width = width,
+                     .height = height,
+                     .format = internal_stream.format,
+                     .usage = internal_stream.usage};
+    int32_t stream_id = -1;
+    status_t res =
+        stream_manager->RegisterNewInternalStream(stream, &stream_id);
+    if (res != OK) {
+      return res;
+    }
+
+    HalStream hal_stream = {.id = stream_id,
+                            .override_format = internal_stream.format,
+                            .producer_usage = GRALLOC1_PRODUCER_USAGE_CAMERA,
+                            .consumer_usage = GRALLOC1_CONSUMER_USAGE_CAMERA,
+                            .max_buffers = internal_stream.max_buffers};
+    res = stream_manager->AllocateBuffers(hal_stream);
+    if (res != OK) {
+      return res;
+    }
+  }
+  return OK;
+}
+
+// Arg 0: whether warm reconfiguration is enabled.
+// Arg 1: number of distinct stream configurations to cycle through.
+void BM_ReconfigureZslStreams(benchmark::State& state) {
+  std::shared_ptr<InternalBufferPool> pool;
+  if (state.range(0) != 0) {
+    pool = InternalBufferPool::Acquire(kWarmPoolBytes);
+    if (pool == nullptr) {
+      state.SkipWithError("Acquiring the internal buffer pool failed.");
+      return;
+    }
+  }
+
+  uint32_t num_configs = state.range(1);
+  std::unique_ptr<InternalStreamManager> stream_manager;
+  size_t i = 0;
+  for (auto _ : state) {
+    // The capture session of the previous configuration is destroyed while
+    // the next one is created, as in CameraDeviceSession::ConfigureStreams.
+    if (pool != nullptr) {
+      pool->BeginReconfiguration();
+    }
+    stream_manager = nullptr;
+    stream_manager = InternalStreamManager::Create();
+    status_t res = stream_manager == nullptr
+                       ? NO_MEMORY
+                       : ConfigureZslStreams(i++ % num_configs,
+                                             stream_manager.get());
+    if (pool != nullptr) {
+      pool->EndReconfiguration();
+    }
+    if (res != OK) {
+      state.SkipWithError("Configuring ZSL streams failed.");
+      return;
+    }
+  }
+}
+BENCHMARK(BM_ReconfigureZslStreams)
+    ->ArgNames({"warm", "configs"})
+    ->ArgsProduct({{0, 1}, {1, 2}})
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace google_camera_hal
+}  // namespace android
+
+BENCHMARK_MAIN();
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HARDWARE_GOOGLE_CAMERA_HAL_TESTS_STUB_DEPTH_GENERATOR_H_
+#define HARDWARE_GOOGLE_CAMERA_HAL_TESTS_STUB_DEPTH_GENERATOR_H_
+
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <set>
+
+#include "depth_generator.h"
+
+namespace android {
+namespace google_camera_hal {
+
+// StubDepthGenerator is a reentrant DepthGenerator whose
+// ExecuteProcessRequest burns a configurable amount of CPU time, so the
+// scaling of concurrent depth execution can be measured without a depth
+// engine.
+class StubDepthGenerator : public depth_generator::DepthGenerator {
+ public:
+  // Return the CPU time in microseconds to spend on frame_number.
+  using WorkFunc = std::function<uint32_t(uint32_t frame_number)>;
+
+  explicit StubDepthGenerator(WorkFunc work) : work_(work) {
+  }
+
+  status_t EnqueueProcessRequest(
+      const depth_generator::DepthRequestInfo&) override {
+    return INVALID_OPERATION;
+  }
+
+  status_t ExecuteProcessRequest(
+      const depth_generator::DepthRequestInfo& request_info) override {
+    uint32_t num_executing = ++num_executing_;
+    uint32_t max_executing = max_executing_.load();
+    while (num_executing > max_executing &&
+           !max_executing_.compare_exchange_weak(max_executing,
+                                                 num_executing)) {
+    }
+
+    BurnCpu(work_(request_info.frame_number));
+    num_executing_--;
+
+    std::lock_guard<std::mutex> lock(lock_);
+    return failing_frames_.count(request_info.frame_number) > 0 ? UNKNOWN_ERROR
+                                                                : OK;
+  }
+
+  void SetResultCallback(
+      depth_generator::DepthResultCallbackFunction) override {
+  }
+
+  // Make ExecuteProcessRequest fail for frame_number.
+  void SetFailingFrame(uint32_t frame_number) {
+    std::lock_guard<std::mutex> lock(lock_);
+    failing_frames_.insert(frame_number);
+  }
+
+  // Maximum number of ExecuteProcessRequest calls that ran concurrently.
+  uint32_t GetMaxExecutingRequests() const {
+    return max_executing_.load();
+  }
+
+ private:
+  static int64_t GetThreadCpuTimeNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+  }
+
+  // Spin until this thread has consumed work_us of CPU time.
+  static void BurnCpu(uint32_t work_us) {
+    int64_t end_ns = GetThreadCpuTimeNs() + work_us * 1000LL;
+    volatile uint32_t sink = 0;
+    while (GetThreadCpuTimeNs() < end_ns) {
+      for (uint32_t i = 0; i < 1000; i++) {
+        sink = sink + i;
+      }
+    }
+  }
+
+  const WorkFunc work_;
+  std::atomic<uint32_t> num_executing_ = 0;
+  std::atomic<uint32_t> max_executing_ = 0;
+
+  std::mutex lock_;
+  std::set<uint32_t> failing_frames_;
+};
+
+}  // namespace google_camera_hal
+}  // namespace android
+
+#endif  // HARDWARE_GOOGLE_CAMERA_HAL_TESTS_STUB_DEPTH_GENERATOR_H_
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "TagNameResolverTests"
+#include <gtest/gtest.h>
+#include <log/log.h>
+#include <system/camera_metadata.h>
+
+#include <string>
+#include <vector>
+
+#include "tag_name_resolver.h"
+#include "vendor_tag_utils.h"
+
+namespace android {
+namespace google_camera_hal {
+
+static const std::vector<VendorTagSection> kVendorTagSections = {
+    {.section_name = "com.google.test",
+     .tags = {{.tag_id = 0x80000000,
+               .tag_name = "first",
+               .tag_type = CameraMetadataType::kInt32},
+              {.tag_id = 0x80000001,
+               .tag_name = "second",
+               .tag_type = CameraMetadataType::kByte}}},
+    {.section_name = "com.google.test.nested",
+     .tags = {{.tag_id = 0x80010000,
+               .tag_name = "first",
+               .tag_type = CameraMetadataType::kFloat}}},
+};
+
+TEST(TagNameResolverTest, AllAndroidTags) {
+  auto& resolver = TagNameResolver::GetInstance();
+  for (uint32_t section = 0; section < ANDROID_SECTION_COUNT; section++) {
+    const char* section_name = camera_metadata_section_names[section];
+    for (uint32_t tag = camera_metadata_section_bounds[section][0];
+         tag < camera_metadata_section_bounds[section][1]; tag++) {
+      const char* tag_name = get_camera_metadata_tag_name(tag);
+      if (tag_name == nullptr) {
+        continue;
+      }
+
+      std::string name = std::string(section_name) + "." + tag_name;
+      uint32_t tag_id = 0;
+      ASSERT_EQ(resolver.GetTag(name, &tag_id), OK) << name;
+      EXPECT_EQ(tag_id, tag) << name;
+
+      tag_id = 0;
+      ASSERT_EQ(resolver.GetTag(section_name, tag_name, &tag_id), OK) << name;
+      EXPECT_EQ(tag_id, tag) << name;
+    }
+  }
+}
+
+TEST(TagNameResolverTest, UnknownNames) {
+  auto& resolver = TagNameResolver::GetInstance();
+  uint32_t tag_id = 0;
+  EXPECT_EQ(resolver.GetTag("", &tag_id), NAME_NOT_FOUND);
+  EXPECT_EQ(resolver.GetTag("android", &tag_id), NAME_NOT_FOUND);
+  EXPECT_EQ(resolver.GetTag("android.control", &tag_id), NAME_NOT_FOUND);
+  EXPECT_EQ(resolver.GetTag("android.control.aeMode.", &tag_id),
+            NAME_NOT_FOUND);
+  EXPECT_EQ(resolver.GetTag("android.control.aemode", &tag_id),
+            NAME_NOT_FOUND);
+  EXPECT_EQ(resolver.GetTag("android.control", "", &tag_id), NAME_NOT_FOUND);
+  EXPECT_EQ(resolver.GetTag("android", "control.aeMode", &tag_id),
+            NAME_NOT_FOUND);
+  EXPECT_EQ(resolver.GetTag("android.control.aeMode", nullptr), BAD_VALUE);
+}
+
+TEST(TagNameResolverTest, VendorTags) {
+  auto& resolver = TagNameResolver::GetInstance();
+  uint32_t tag_id = 0;
+  EXPECT_EQ(resolver.GetTag("com.google.test.first", &tag_id), NAME_NOT_FOUND);
+
+  ASSERT_EQ(resolver.SetVendorTags(kVendorTagSections), OK);
+  for (auto& section : kVendorTagSections) {
+    for (auto& tag : section.tags) {
+      ASSERT_EQ(resolver.GetTag(section.section_name + "." + tag.tag_name,
+                                &tag_id),
+                OK);
+      EXPECT_EQ(tag_id, tag.tag_id);
+      ASSERT_EQ(resolver.GetVendorTag(section.section_name, tag.tag_name,
+                                      &tag_id),
+                OK);
+      EXPECT_EQ(tag_id, tag.tag_id);
+    }
+  }
+
+  // Android tags are not vendor tags.
+  EXPECT_EQ(resolver.GetVendorTag("android.control", "aeMode", &tag_id),
+            NAME_NOT_FOUND);
+  EXPECT_EQ(resolver.GetTag("android.control", "aeMode", &tag_id), OK);
+  EXPECT_EQ(tag_id, static_cast<uint32_t>(ANDROID_CONTROL_AE_MODE));
+
+  ASSERT_EQ(resolver.SetVendorTags({}), OK);
+  EXPECT_EQ(resolver.GetTag("com.google.test.first", &tag_id), NAME_NOT_FOUND);
+
+  // Restore the tags added to VendorTagManager by other tests.
+  ASSERT_EQ(resolver.SetVendorTags(VendorTagManager::GetInstance().GetTags()),
+            OK);
+}
+
+TEST(TagNameResolverTest, DuplicateVendorTags) {
+  std::vector<TagNameTable::Entry> entries = {
+      {.section_name = "com.google.test", .tag_name = "first", .tag_id = 1},
+      {.section_name = "com.google.test", .tag_name = "first", .tag_id = 2},
+  };
+  EXPECT_EQ(TagNameTable::Create(entries), nullptr);
+}
+
+TEST(TagNameResolverTest, LargeTable) {
+  std::vector<TagNameTable::Entry> entries;
+  for (uint32_t i = 0; i < 5000; i++) {
+    entries.push_back(
+        {.section_name = "com.google.section" + std::to_string(i % 7),
+         .tag_name = "tag" + std::to_string(i),
+         .tag_id = i});
+  }
+
+  auto table = TagNameTable::Create(entries);
+  ASSERT_NE(table, nullptr);
+  EXPECT_EQ(table->GetNumTags(), entries.size());
+  for (auto& entry : entries) {
+    uint32_t tag_id = 0;
+    ASSERT_EQ(table->GetTag(entry.section_name, entry.tag_name, &tag_id), OK);
+    EXPECT_EQ(tag_id, entry.tag_id);
+  }
+}
+
+}  // namespace google_camera_hal
+}  // namespace android
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the shutter-to-snapshot cost of selecting ZSL buffers, and the
+// realtime cost of returning a filled buffer, with 30 to 60 ZSL buffers.
+// Run with:
+//   adb shell /data/benchmarktest64/zsl_buffer_manager_benchmark/zsl_buffer_manager_benchmark
+
+#include <benchmark/benchmark.h>
+#include <time.h>
+
+#include "zsl_buffer_manager.h"
+
+namespace android {
+namespace google_camera_hal {
+namespace {
+
+constexpr uint32_t kNumSnapshotBuffers = 3;
+constexpr int64_t kFrameDurationNs = 33333333;
+
+// Hands out fake buffer handles so the benchmark measures bookkeeping only.
+class FakeBufferAllocator : public IHalBufferAllocator {
+ public:
+  status_t AllocateBuffers(const HalBufferDescriptor& buffer_descriptor,
+                           std::vector<buffer_handle_t>* buffers) override {
+    for (uint32_t i = 0; i < buffer_descriptor.immediate_num_buffers; i++) {
+      buffers->push_back(reinterpret_cast<buffer_handle_t>(++next_handle_));
+    }
+    return OK;
+  }
+
+  void FreeBuffers(std::vector<buffer_handle_t>* buffers) override {
+    buffers->clear();
+  }
+
+ private:
+  uintptr_t next_handle_ = 0;
+};
+
+int64_t GetBootTimeNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_BOOTTIME, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Result metadata of a realtime frame, with the tags snapshot selection
+// looks at placed after a typical number of other entries.
+std::unique_ptr<HalCameraMetadata> CreateResultMetadata(int64_t timestamp) {
+  auto metadata = HalCameraMetadata::Create(/*num_entries=*/64,
+                                            /*data_bytes=*/4096);
+  int32_t crop_region[4] = {0, 0, 4032, 3024};
+  metadata->Set(ANDROID_SCALER_CROP_REGION, crop_region, 4);
+  int32_t sensitivity = 100;
+  metadata->Set(ANDROID_SENSOR_SENSITIVITY, &sensitivity, 1);
+  int64_t exposure_time = 10000000;
+  metadata->Set(ANDROID_SENSOR_EXPOSURE_TIME, &exposure_time, 1);
+  uint8_t ae_mode = ANDROID_CONTROL_AE_MODE_ON;
+  metadata->Set(ANDROID_CONTROL_AE_MODE, &ae_mode, 1);
+  uint8_t ae_state = ANDROID_CONTROL_AE_STATE_CONVERGED;
+  metadata->Set(ANDROID_CONTROL_AE_STATE, &ae_state, 1);
+  uint8_t af_state = ANDROID_CONTROL_AF_STATE_PASSIVE_FOCUSED;
+  metadata->Set(ANDROID_CONTROL_AF_STATE, &af_state, 1);
+  uint8_t flash_state = ANDROID_FLASH_STATE_READY;
+  metadata->Set(ANDROID_FLASH_STATE, &flash_state, 1);
+  uint8_t lens_state = ANDROID_LENS_STATE_STATIONARY;
+  metadata->Set(ANDROID_LENS_STATE, &lens_state, 1);
+  metadata->Set(ANDROID_SENSOR_TIMESTAMP, &timestamp, 1);
+  return metadata;
+}
+
+// Fill a manager holding num_buffers buffers with one frame per buffer.
+// Timestamps are in the future so the frames stay recent for the whole run.
+std::unique_ptr<ZslBufferManager> CreateFilledManager(
+    FakeBufferAllocator* allocator, uint32_t num_buffers,
+    uint32_t* frame_number, int64_t* timestamp) {
+  auto manager = std::make_unique<ZslBufferManager>(allocator);
+  HalBufferDescriptor buffer_descriptor = {
+      .width = 4032,
+      .height = 3024,
+      .format = HAL_PIXEL_FORMAT_RAW10,
+      .immediate_num_buffers = num_buffers,
+      .max_num_buffers = num_buffers,
+  };
+  if (manager->AllocateBuffers(buffer_descriptor) != OK) {
+    return nullptr;
+  }
+
+  *timestamp = GetBootTimeNs() + 3600 * 1000000000LL;
+  for (uint32_t i = 0; i < num_buffers; i++) {
+    StreamBuffer buffer = {};
+    buffer.buffer = manager->GetEmptyBuffer();
+    manager->ReturnFilledBuffer(*frame_number, buffer);
+    auto metadata = CreateResultMetadata(*timestamp);
+    manager->ReturnMetadata(*frame_number, metadata.get(),
+                            /*partial_result=*/1);
+    (*frame_number)++;
+    *timestamp += kFrameDurationNs;
+  }
+  return manager;
+}
+
+void BM_GetMostRecentZslBuffers(benchmark::State& state) {
+  FakeBufferAllocator allocator;
+  uint32_t frame_number = 0;
+  int64_t timestamp = 0;
+  auto manager = CreateFilledManager(&allocator, state.range(0),
+                                     &frame_number, &timestamp);
+  if (manager == nullptr) {
+    state.SkipWithError("Creating ZslBufferManager failed.");
+    return;
+  }
+
+  std::vector<ZslBufferManager::ZslBuffer> zsl_buffers;
+  zsl_buffers.reserve(kNumSnapshotBuffers);
+  for (auto _ : state) {
+    manager->GetMostRecentZslBuffers(&zsl_buffers, kNumSnapshotBuffers,
+                                     kNumSnapshotBuffers);
+    if (zsl_buffers.size() != kNumSnapshotBuffers) {
+      state.SkipWithError("Not enough ZSL buffers selected.");
+      return;
+    }
+    manager->ReturnZslBuffers(std::move(zsl_buffers));
+    zsl_buffers.clear();
+  }
+}
+BENCHMARK(BM_GetMostRecentZslBuffers)->Arg(30)->Arg(45)->Arg(60);
+
+void BM_ReturnFilledZslBuffer(benchmark::State& state) {
+  FakeBufferAllocator allocator;
+  uint32_t frame_number = 0;
+  int64_t timestamp = 0;
+  auto manager = CreateFilledManager(&allocator, state.range(0),
+                                     &frame_number, &timestamp);
+  if (manager == nullptr) {
+    state.SkipWithError("Creating ZslBufferManager failed.");
+    return;
+  }
+
+  auto metadata = CreateResultMetadata(timestamp);
+  for (auto _ : state) {
+    // Recycles the oldest filled buffer, as the realtime pipeline does.
+    StreamBuffer buffer = {};
+    buffer.buffer = manager->GetEmptyBuffer();
+    manager->ReturnFilledBuffer(frame_number, buffer);
+    manager->ReturnMetadata(frame_number, metadata.get(),
+                            /*partial_result=*/1);
+    frame_number++;
+  }
+}
+BENCHMARK(BM_ReturnFilledZslBuffer)->Arg(30)->Arg(45)->Arg(60);
+
+}  // namespace
+}  // namespace google_camera_hal
+}  // namespace android
+
+BENCHMARK_MAIN();
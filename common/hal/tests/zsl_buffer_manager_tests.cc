@@ -17,6 +17,8 @@
 #define LOG_TAG "ZslBufferManagerTests"
 #include <log/log.h>
 
+#include <algorithm>
+
 #include <gtest/gtest.h>
 #include <zsl_buffer_manager.h>
 
@@ -158,6 +160,128 @@ TEST(ZslBufferManagerTests, GetRecentBuffers) {
   }
 }
 
+// Test that GetMostRecentZslBuffers skips stale buffers, keeps frame number
+// order for buffers returned out of order, and falls back when flash fired.
+TEST(ZslBufferManagerTests, SelectRecentBuffers) {
+  static const uint32_t kNumStaleBuffers = 10;
+  static const int64_t kStaleTimestampOffsetNs = 2000000000;  // 2 seconds
+  auto manager = std::make_unique<ZslBufferManager>();
+  ASSERT_NE(manager, nullptr) << "Creating ZslBufferManager failed.";
+
+  status_t res = manager->AllocateBuffers(kRawBufferDescriptor);
+  ASSERT_EQ(res, OK) << "AllocateBuffers failed: " << strerror(res);
+
+  auto fill_buffer = [&manager](uint32_t frame_number, int64_t timestamp_offset,
+                                uint8_t flash_state) {
+    StreamBuffer stream_buffer = {};
+    stream_buffer.buffer = manager->GetEmptyBuffer();
+    ASSERT_NE(stream_buffer.buffer, kInvalidBufferHandle);
+    ASSERT_EQ(manager->ReturnFilledBuffer(frame_number, stream_buffer), OK);
+
+    auto metadata = HalCameraMetadata::Create(kNumEntries, kDataBytes);
+    SetMetadata(metadata);
+    camera_metadata_ro_entry entry = {};
+    ASSERT_EQ(metadata->Get(ANDROID_SENSOR_TIMESTAMP, &entry), OK);
+    int64_t timestamp = entry.data.i64[0] - timestamp_offset;
+    uint8_t ae_mode = ANDROID_CONTROL_AE_MODE_ON_AUTO_FLASH;
+    ASSERT_EQ(metadata->Set(ANDROID_SENSOR_TIMESTAMP, &timestamp, 1), OK);
+    ASSERT_EQ(metadata->Set(ANDROID_CONTROL_AE_MODE, &ae_mode, 1), OK);
+    ASSERT_EQ(metadata->Set(ANDROID_FLASH_STATE, &flash_state, 1), OK);
+    ASSERT_EQ(manager->ReturnMetadata(frame_number, metadata.get(),
+                                      /*partial_result=*/1),
+              OK);
+  };
+
+  uint32_t frame_number = 0;
+  for (; frame_number < kNumStaleBuffers; frame_number++) {
+    fill_buffer(frame_number, kStaleTimestampOffsetNs,
+                ANDROID_FLASH_STATE_READY);
+  }
+  for (; frame_number < kMaxBufferDepth; frame_number++) {
+    fill_buffer(frame_number, /*timestamp_offset=*/0, ANDROID_FLASH_STATE_READY);
+  }
+
+  // Only the recent buffers are returned.
+  std::vector<ZslBufferManager::ZslBuffer> zsl_buffers;
+  manager->GetMostRecentZslBuffers(&zsl_buffers, kMaxBufferDepth,
+                                   /*min_buffers=*/1);
+  ASSERT_EQ(zsl_buffers.size(), kMaxBufferDepth - kNumStaleBuffers);
+  for (uint32_t i = 0; i < zsl_buffers.size(); i++) {
+    EXPECT_EQ(zsl_buffers[i].frame_number, kNumStaleBuffers + i);
+    EXPECT_EQ(zsl_buffers[i].selection_keys.flash_state,
+              ANDROID_FLASH_STATE_READY);
+  }
+
+  // Buffers returned out of order are selected in frame number order.
+  std::reverse(zsl_buffers.begin(), zsl_buffers.end());
+  manager->ReturnZslBuffers(std::move(zsl_buffers));
+  zsl_buffers.clear();
+  manager->GetMostRecentZslBuffers(&zsl_buffers, /*num_buffers=*/2,
+                                   /*min_buffers=*/1);
+  ASSERT_EQ(zsl_buffers.size(), 2u);
+  EXPECT_EQ(zsl_buffers[0].frame_number, kMaxBufferDepth - 2);
+  EXPECT_EQ(zsl_buffers[1].frame_number, kMaxBufferDepth - 1);
+  manager->ReturnZslBuffers(std::move(zsl_buffers));
+  zsl_buffers.clear();
+
+  // A flash-fired buffer makes ZSL fall back to the realtime pipeline.
+  fill_buffer(frame_number, /*timestamp_offset=*/0, ANDROID_FLASH_STATE_FIRED);
+  manager->GetMostRecentZslBuffers(&zsl_buffers, /*num_buffers=*/2,
+                                   /*min_buffers=*/1);
+  EXPECT_TRUE(zsl_buffers.empty());
+}
+
+// Test that GetMostRecentZslBuffers still finds all the recent buffers when a
+// buffer in the middle of the ring has no timestamp.
+TEST(ZslBufferManagerTests, SelectRecentBuffersWithMissingTimestamp) {
+  static const uint32_t kNumStaleBuffers = 4;
+  static const uint32_t kMissingTimestampFrame = kMaxBufferDepth / 2;
+  static const int64_t kStaleTimestampOffsetNs = 2000000000;  // 2 seconds
+  auto manager = std::make_unique<ZslBufferManager>();
+  ASSERT_NE(manager, nullptr) << "Creating ZslBufferManager failed.";
+
+  status_t res = manager->AllocateBuffers(kRawBufferDescriptor);
+  ASSERT_EQ(res, OK) << "AllocateBuffers failed: " << strerror(res);
+
+  for (uint32_t frame_number = 0; frame_number < kMaxBufferDepth;
+       frame_number++) {
+    StreamBuffer stream_buffer = {};
+    stream_buffer.buffer = manager->GetEmptyBuffer();
+    ASSERT_NE(stream_buffer.buffer, kInvalidBufferHandle);
+    ASSERT_EQ(manager->ReturnFilledBuffer(frame_number, stream_buffer), OK);
+
+    auto metadata = HalCameraMetadata::Create(kNumEntries, kDataBytes);
+    if (frame_number != kMissingTimestampFrame) {
+      SetMetadata(metadata);
+    }
+    if (frame_number < kNumStaleBuffers) {
+      camera_metadata_ro_entry entry = {};
+      ASSERT_EQ(metadata->Get(ANDROID_SENSOR_TIMESTAMP, &entry), OK);
+      int64_t timestamp = entry.data.i64[0] - kStaleTimestampOffsetNs;
+      ASSERT_EQ(metadata->Set(ANDROID_SENSOR_TIMESTAMP, &timestamp, 1), OK);
+    }
+    ASSERT_EQ(manager->ReturnMetadata(frame_number, metadata.get(),
+                                      /*partial_result=*/1),
+              OK);
+  }
+
+  // All the recent buffers are returned, except the one without timestamp.
+  std::vector<ZslBufferManager::ZslBuffer> zsl_buffers;
+  manager->GetMostRecentZslBuffers(&zsl_buffers, kMaxBufferDepth,
+                                   /*min_buffers=*/1);
+  std::vector<uint32_t> frame_numbers;
+  for (const auto& zsl_buffer : zsl_buffers) {
+    frame_numbers.push_back(zsl_buffer.frame_number);
+  }
+  std::vector<uint32_t> expected_frame_numbers;
+  for (uint32_t i = kNumStaleBuffers; i < kMaxBufferDepth; i++) {
+    if (i != kMissingTimestampFrame) {
+      expected_frame_numbers.push_back(i);
+    }
+  }
+  EXPECT_EQ(frame_numbers, expected_frame_numbers);
+}
+
 // Test ZslBufferManager ReturnMetadata.
 // If allocated_metadata_ size is greater than kMaxAllcatedMetadataSize(100),
 // ReturnMetadata() will return error and not allocate new metadata.
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Replays recorded ZSL metadata through the ZSL selection policies and
+// compares the frames they pick.
+//
+// Usage:
+//   zsl_selection_policy_eval <recording.csv> [ring_size] [num_buffers]
+//
+// Each line of the recording is either a realtime frame or a shutter press:
+//   frame,<frame_number>,<timestamp_ns>,<exposure_time_ns>,<ae_mode>,
+//       <ae_state>,<af_state>,<flash_state>,<lens_state>,<angular_speed>
+//   shutter,<timestamp_ns>
+// Enum values are the camera_metadata values, or -1 if not reported.
+// angular_speed is the mean gyro angular speed in rad/s during the exposure,
+// or -1 if unknown. Lines starting with '#' are ignored.
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "zsl_selection_policy.h"
+
+namespace android {
+namespace google_camera_hal {
+namespace {
+
+struct PolicyStats {
+  const char* name = nullptr;
+  ZslSelectionPolicy* policy = nullptr;
+  uint32_t num_shutters = 0;
+  uint32_t num_fallbacks = 0;
+  uint64_t num_selected = 0;
+  // Sum of the expected blur of selected frames, in radians.
+  double blur_sum = 0;
+  // Sum of the time from the newest selected frame to the shutter, in ns.
+  double lag_sum_ns = 0;
+};
+
+class Replayer {
+ public:
+  Replayer(size_t ring_size, uint32_t num_buffers)
+      : ring_size_(ring_size), num_buffers_(num_buffers) {
+    scorer_ = QualityZslSelectionPolicy::Create(
+        QualityZslSelectionPolicy::Config(),
+        [this](int64_t start_time, int64_t /*end_time*/) {
+          return GetAngularSpeed(start_time);
+        });
+  }
+
+  void AddPolicy(const char* name, ZslSelectionPolicy* policy) {
+    PolicyStats stats;
+    stats.name = name;
+    stats.policy = policy;
+    stats_.push_back(stats);
+  }
+
+  // Recorded angular speed of the frame exposed at start_time.
+  float GetAngularSpeed(int64_t start_time) const {
+    auto it = angular_speeds_.find(start_time);
+    return it == angular_speeds_.end() ? -1.0f : it->second;
+  }
+
+  void AddFrame(const ZslCandidate& candidate, float angular_speed) {
+    if (candidates_.size() == ring_size_) {
+      angular_speeds_.erase(candidates_.front().keys.timestamp);
+      candidates_.pop_front();
+    }
+    candidates_.push_back(candidate);
+    angular_speeds_[candidate.keys.timestamp] = angular_speed;
+  }
+
+  void Shutter(int64_t timestamp) {
+    std::vector<ZslCandidate> candidates(candidates_.begin(),
+                                         candidates_.end());
+    for (auto& stats : stats_) {
+      std::vector<size_t> selected;
+      stats.policy->SelectBuffers(candidates, timestamp, num_buffers_,
+                                  &selected);
+      stats.num_shutters++;
+      if (selected.empty()) {
+        stats.num_fallbacks++;
+        continue;
+      }
+      for (size_t index : selected) {
+        stats.blur_sum += scorer_->GetBlurScore(candidates[index]);
+      }
+      stats.num_selected += selected.size();
+      stats.lag_sum_ns += timestamp - candidates[selected.back()].keys.timestamp;
+    }
+  }
+
+  void PrintStats() const {
+    printf("%-12s %8s %9s %14s %12s\n", "policy", "shutters", "fallbacks",
+           "mean_blur_mrad", "mean_lag_ms");
+    for (auto& stats : stats_) {
+      uint32_t num_zsl = stats.num_shutters - stats.num_fallbacks;
+      double mean_blur = stats.num_selected > 0
+                             ? stats.blur_sum / stats.num_selected * 1000
+                             : 0;
+      double mean_lag = num_zsl > 0 ? stats.lag_sum_ns / num_zsl / 1000000 : 0;
+      printf("%-12s %8u %9u %14.3f %12.2f\n", stats.name, stats.num_shutters,
+             stats.num_fallbacks, mean_blur, mean_lag);
+    }
+  }
+
+ private:
+  const size_t ring_size_;
+  const uint32_t num_buffers_;
+  std::deque<ZslCandidate> candidates_;
+  std::unordered_map<int64_t, float> angular_speeds_;
+  std::unique_ptr<QualityZslSelectionPolicy> scorer_;
+  std::vector<PolicyStats> stats_;
+};
+
+bool ParseFrame(const char* line, ZslCandidate* candidate,
+                float* angular_speed) {
+  ZslSelectionKeys& keys = candidate->keys;
+  return sscanf(line,
+                "frame,%" SCNu32 ",%" SCNd64 ",%" SCNd64
+                ",%d,%d,%d,%d,%d,%f",
+                &candidate->frame_number, &keys.timestamp, &keys.exposure_time,
+                &keys.ae_mode, &keys.ae_state, &keys.af_state,
+                &keys.flash_state, &keys.lens_state, angular_speed) == 9;
+}
+
+int Run(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s <recording.csv> [ring_size] [num_buffers]\n",
+            argv[0]);
+    return 1;
+  }
+  size_t ring_size = argc > 2 ? strtoul(argv[2], nullptr, 10) : 30;
+  uint32_t num_buffers = argc > 3 ? strtoul(argv[3], nullptr, 10) : 3;
+  if (ring_size == 0 || num_buffers == 0) {
+    fprintf(stderr, "ring_size and num_buffers must be positive.\n");
+    return 1;
+  }
+
+  FILE* file = fopen(argv[1], "r");
+  if (file == nullptr) {
+    fprintf(stderr, "Opening %s failed: %s\n", argv[1], strerror(errno));
+    return 1;
+  }
+
+  Replayer replayer(ring_size, num_buffers);
+  MostRecentZslSelectionPolicy most_recent;
+  auto quality = QualityZslSelectionPolicy::Create(
+      QualityZslSelectionPolicy::Config(),
+      [&replayer](int64_t start_time, int64_t /*end_time*/) {
+        return replayer.GetAngularSpeed(start_time);
+      });
+  replayer.AddPolicy("most_recent", &most_recent);
+  replayer.AddPolicy("quality", quality.get());
+
+  char line[512];
+  uint32_t line_number = 0;
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    line_number++;
+    if (line[0] == '#' || line[0] == '\n') {
+      continue;
+    }
+
+    ZslCandidate candidate;
+    float angular_speed = -1.0f;
+    int64_t shutter_timestamp = 0;
+    if (ParseFrame(line, &candidate, &angular_speed)) {
+      replayer.AddFrame(candidate, angular_speed);
+    } else if (sscanf(line, "shutter,%" SCNd64, &shutter_timestamp) == 1) {
+      replayer.Shutter(shutter_timestamp);
+    } else {
+      fprintf(stderr, "Skipping malformed line %u: %s", line_number, line);
+    }
+  }
+  fclose(file);
+
+  replayer.PrintStats();
+  return 0;
+}
+
+}  // namespace
+}  // namespace google_camera_hal
+}  // namespace android
+
+int main(int argc, char** argv) {
+  return android::google_camera_hal::Run(argc, argv);
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "ZslSelectionPolicyTests"
+#include <log/log.h>
+
+#include <gtest/gtest.h>
+#include <zsl_selection_policy.h>
+
+namespace android {
+namespace google_camera_hal {
+
+static constexpr int64_t kRequestTimestamp = 10000000000;  // 10 seconds
+static constexpr int64_t kFrameDurationNs = 33333333;
+static constexpr int64_t kExposureTimeNs = 20000000;
+
+// Candidates captured back to back up to kRequestTimestamp, all converged.
+static std::vector<ZslCandidate> CreateCandidates(uint32_t num_candidates) {
+  std::vector<ZslCandidate> candidates(num_candidates);
+  for (uint32_t i = 0; i < num_candidates; i++) {
+    candidates[i].frame_number = i;
+    candidates[i].keys.timestamp =
+        kRequestTimestamp - (num_candidates - i) * kFrameDurationNs;
+    candidates[i].keys.exposure_time = kExposureTimeNs;
+    candidates[i].keys.ae_mode = ANDROID_CONTROL_AE_MODE_ON;
+    candidates[i].keys.ae_state = ANDROID_CONTROL_AE_STATE_CONVERGED;
+    candidates[i].keys.af_state = ANDROID_CONTROL_AF_STATE_PASSIVE_FOCUSED;
+    candidates[i].keys.flash_state = ANDROID_FLASH_STATE_READY;
+    candidates[i].keys.lens_state = ANDROID_LENS_STATE_STATIONARY;
+  }
+  return candidates;
+}
+
+TEST(ZslSelectionPolicyTests, MostRecent) {
+  MostRecentZslSelectionPolicy policy;
+  auto candidates = CreateCandidates(/*num_candidates=*/10);
+
+  std::vector<size_t> selected;
+  policy.SelectBuffers(candidates, kRequestTimestamp, /*num_buffers=*/3,
+                       &selected);
+  EXPECT_EQ(selected, std::vector<size_t>({7, 8, 9}));
+
+  // Flash fired under auto flash falls back to realtime capture.
+  for (auto& candidate : candidates) {
+    candidate.keys.ae_mode = ANDROID_CONTROL_AE_MODE_ON_AUTO_FLASH;
+  }
+  candidates[2].keys.flash_state = ANDROID_FLASH_STATE_FIRED;
+  selected.clear();
+  policy.SelectBuffers(candidates, kRequestTimestamp, /*num_buffers=*/3,
+                       &selected);
+  EXPECT_TRUE(selected.empty());
+}
+
+TEST(ZslSelectionPolicyTests, QualityPrefersLowMotion) {
+  // Frames 4 and 6 were captured while the device was still.
+  auto motion_func = [](int64_t start_time, int64_t /*end_time*/) {
+    int64_t frame = (start_time - (kRequestTimestamp - 10 * kFrameDurationNs)) /
+                    kFrameDurationNs;
+    return frame == 4 || frame == 6 ? 0.01f : 0.5f;
+  };
+  auto policy = QualityZslSelectionPolicy::Create(
+      QualityZslSelectionPolicy::Config(), motion_func);
+  ASSERT_NE(policy, nullptr);
+
+  auto candidates = CreateCandidates(/*num_candidates=*/10);
+  std::vector<size_t> selected;
+  policy->SelectBuffers(candidates, kRequestTimestamp, /*num_buffers=*/2,
+                        &selected);
+  EXPECT_EQ(selected, std::vector<size_t>({4, 6}));
+}
+
+TEST(ZslSelectionPolicyTests, QualityRejectsUnconvergedAndOld) {
+  QualityZslSelectionPolicy::Config config;
+  config.max_buffer_age_ns = 5 * kFrameDurationNs;
+  auto policy = QualityZslSelectionPolicy::Create(config);
+  ASSERT_NE(policy, nullptr);
+
+  auto candidates = CreateCandidates(/*num_candidates=*/10);
+  candidates[9].keys.ae_state = ANDROID_CONTROL_AE_STATE_SEARCHING;
+  candidates[8].keys.af_state = ANDROID_CONTROL_AF_STATE_PASSIVE_SCAN;
+  candidates[7].keys.lens_state = ANDROID_LENS_STATE_MOVING;
+  // Shorter exposure is sharper without motion data.
+  candidates[5].keys.exposure_time = kExposureTimeNs / 2;
+
+  std::vector<size_t> selected;
+  policy->SelectBuffers(candidates, kRequestTimestamp, /*num_buffers=*/1,
+                        &selected);
+  EXPECT_EQ(selected, std::vector<size_t>({5}));
+
+  // Only frames 5 and 6 qualify within the latency budget.
+  selected.clear();
+  policy->SelectBuffers(candidates, kRequestTimestamp, /*num_buffers=*/3,
+                        &selected);
+  EXPECT_EQ(selected, std::vector<size_t>({5, 6}));
+}
+
+}  // namespace google_camera_hal
+}  // namespace android
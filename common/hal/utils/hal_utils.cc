@@ -22,6 +22,7 @@
 #include <inttypes.h>
 #include <log/log.h>
 
+#include <algorithm>
 #include <string>
 
 #include "vendor_tag_defs.h"
@@ -656,6 +657,75 @@ status_t RemoveFdInfoFromResult(HalCameraMetadata* metadata) {
   return OK;
 }
 
+namespace {
+template <typename T>
+void AppendKeyValue(const T& value, std::string* key) {
+  key->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+}  // namespace
+
+std::string GetStreamConfigurationKey(
+    const StreamConfiguration& stream_config) {
+  std::string key;
+  AppendKeyValue(stream_config.operation_mode, &key);
+  AppendKeyValue(stream_config.multi_resolution_input_image, &key);
+
+  std::vector<const Stream*> streams;
+  streams.reserve(stream_config.streams.size());
+  for (auto& stream : stream_config.streams) {
+    streams.push_back(&stream);
+  }
+  std::sort(streams.begin(), streams.end(),
+            [](const Stream* a, const Stream* b) { return a->id < b->id; });
+
+  AppendKeyValue(streams.size(), &key);
+  for (auto stream : streams) {
+    AppendKeyValue(stream->id, &key);
+    AppendKeyValue(stream->stream_type, &key);
+    AppendKeyValue(stream->width, &key);
+    AppendKeyValue(stream->height, &key);
+    AppendKeyValue(stream->format, &key);
+    AppendKeyValue(stream->usage, &key);
+    AppendKeyValue(stream->data_space, &key);
+    AppendKeyValue(stream->rotation, &key);
+    AppendKeyValue(stream->is_physical_camera_stream, &key);
+    AppendKeyValue(stream->physical_camera_id, &key);
+    AppendKeyValue(stream->buffer_size, &key);
+    AppendKeyValue(stream->group_id, &key);
+    AppendKeyValue(stream->intended_for_max_resolution_mode, &key);
+    AppendKeyValue(stream->intended_for_default_resolution_mode, &key);
+    AppendKeyValue(stream->dynamic_profile, &key);
+    AppendKeyValue(stream->use_case, &key);
+    AppendKeyValue(stream->color_space, &key);
+  }
+
+  const camera_metadata_t* session_params =
+      stream_config.session_params != nullptr
+          ? stream_config.session_params->GetRawCameraMetadata()
+          : nullptr;
+  size_t num_entries = session_params != nullptr
+                           ? get_camera_metadata_entry_count(session_params)
+                           : 0;
+  std::vector<camera_metadata_ro_entry_t> entries(num_entries);
+  for (size_t i = 0; i < num_entries; i++) {
+    get_camera_metadata_ro_entry(session_params, i, &entries[i]);
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const camera_metadata_ro_entry_t& a,
+               const camera_metadata_ro_entry_t& b) { return a.tag < b.tag; });
+
+  AppendKeyValue(num_entries, &key);
+  for (auto& entry : entries) {
+    AppendKeyValue(entry.tag, &key);
+    AppendKeyValue(entry.type, &key);
+    AppendKeyValue(entry.count, &key);
+    key.append(reinterpret_cast<const char*>(entry.data.u8),
+               entry.count * camera_metadata_type_size[entry.type]);
+  }
+
+  return key;
+}
+
 void DumpStreamConfiguration(const StreamConfiguration& stream_configuration,
                              const std::string& title) {
   std::string str = "======== " + title + " ========";
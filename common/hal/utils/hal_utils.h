@@ -100,6 +100,12 @@ status_t GetLensShadingMapMode(const CaptureRequest& request,
 // Remove lens shading information
 status_t RemoveLsInfoFromResult(HalCameraMetadata* metadata);
 
+// Get a canonical key of a stream configuration. Two configurations have the
+// same key if they have the same streams, in any order, operation mode and
+// session parameters, in any order. stream_config_counter and log_id are not
+// part of the key.
+std::string GetStreamConfigurationKey(const StreamConfiguration& stream_config);
+
 // Dump the information in the stream configuration
 void DumpStreamConfiguration(const StreamConfiguration& stream_configuration,
                              const std::string& title);
@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "GCH_InternalBufferPool"
+#define ATRACE_TAG ATRACE_TAG_CAMERA
+#include "internal_buffer_pool.h"
+
+#include <log/log.h>
+#include <string.h>
+#include <utils/Trace.h>
+
+#include "gralloc_buffer_allocator.h"
+
+namespace android {
+namespace google_camera_hal {
+
+std::mutex InternalBufferPool::shared_pool_lock_;
+std::weak_ptr<InternalBufferPool> InternalBufferPool::shared_pool_;
+
+std::shared_ptr<InternalBufferPool> InternalBufferPool::Acquire(
+    size_t max_pooled_bytes, std::chrono::milliseconds idle_timeout) {
+  ATRACE_CALL();
+  std::lock_guard<std::mutex> lock(shared_pool_lock_);
+  std::shared_ptr<InternalBufferPool> pool = shared_pool_.lock();
+  if (pool != nullptr) {
+    return pool;
+  }
+
+  pool = Create(GrallocBufferAllocator::Create(), max_pooled_bytes,
+                idle_timeout);
+  if (pool == nullptr) {
+    ALOGE("%s: Creating the shared pool failed.", __FUNCTION__);
+    return nullptr;
+  }
+
+  shared_pool_ = pool;
+  return pool;
+}
+
+std::shared_ptr<InternalBufferPool> InternalBufferPool::GetShared() {
+  std::lock_guard<std::mutex> lock(shared_pool_lock_);
+  return shared_pool_.lock();
+}
+
+std::unique_ptr<InternalBufferPool> InternalBufferPool::Create(
+    std::unique_ptr<IHalBufferAllocator> allocator, size_t max_pooled_bytes,
+    std::chrono::milliseconds idle_timeout) {
+  if (allocator == nullptr) {
+    ALOGE("%s: allocator is nullptr.", __FUNCTION__);
+    return nullptr;
+  }
+
+  return std::unique_ptr<InternalBufferPool>(new InternalBufferPool(
+      std::move(allocator), max_pooled_bytes, idle_timeout));
+}
+
+InternalBufferPool::InternalBufferPool(
+    std::unique_ptr<IHalBufferAllocator> allocator, size_t max_pooled_bytes,
+    std::chrono::milliseconds idle_timeout)
+    : allocator_(std::move(allocator)),
+      max_pooled_bytes_(max_pooled_bytes),
+      idle_timeout_(idle_timeout) {
+}
+
+InternalBufferPool::~InternalBufferPool() {
+  ATRACE_CALL();
+  {
+    std::lock_guard<std::mutex> lock(pool_lock_);
+    exiting_ = true;
+  }
+  trim_cond_.notify_one();
+  if (trim_thread_.joinable()) {
+    trim_thread_.join();
+  }
+
+  std::lock_guard<std::mutex> lock(pool_lock_);
+  FreePooledBuffersLocked([](const PooledBuffer&) { return true; });
+  if (!allocated_buffers_.empty()) {
+    ALOGW("%s: %zu buffers are not freed.", __FUNCTION__,
+          allocated_buffers_.size());
+  }
+}
+
+size_t InternalBufferPool::EstimateBufferSize(
+    const HalBufferDescriptor& descriptor) {
+  size_t num_pixels = static_cast<size_t>(descriptor.width) * descriptor.height;
+  switch (descriptor.format) {
+    case HAL_PIXEL_FORMAT_BLOB:
+    case HAL_PIXEL_FORMAT_Y8:
+      return num_pixels;
+    case HAL_PIXEL_FORMAT_RAW10:
+      return num_pixels * 5 / 4;
+    case HAL_PIXEL_FORMAT_YCBCR_420_888:
+    case HAL_PIXEL_FORMAT_YCrCb_420_SP:
+    case HAL_PIXEL_FORMAT_YV12:
+    case HAL_PIXEL_FORMAT_IMPLEMENTATION_DEFINED:
+      return num_pixels * 3 / 2;
+    case HAL_PIXEL_FORMAT_RAW16:
+    case HAL_PIXEL_FORMAT_Y16:
+      return num_pixels * 2;
+    default:
+      return num_pixels * 4;
+  }
+}
+
+status_t InternalBufferPool::AllocateBuffers(
+    const HalBufferDescriptor& buffer_descriptor,
+    std::vector<buffer_handle_t>* buffers) {
+  ATRACE_CALL();
+  if (buffers == nullptr) {
+    ALOGE("%s: buffers is nullptr.", __FUNCTION__);
+    return BAD_VALUE;
+  }
+
+  BufferKey key = {buffer_descriptor.width, buffer_descriptor.height,
+                   buffer_descriptor.format, buffer_descriptor.producer_flags,
+                   buffer_descriptor.consumer_flags};
+  size_t size = EstimateBufferSize(buffer_descriptor);
+  uint32_t num_buffers = buffer_descriptor.immediate_num_buffers;
+
+  std::vector<buffer_handle_t> reused_buffers;
+  {
+    std::lock_guard<std::mutex> lock(pool_lock_);
+    auto pooled_it = pooled_buffers_.find(key);
+    if (pooled_it != pooled_buffers_.end()) {
+      auto& pooled = pooled_it->second;
+      while (!pooled.empty() && reused_buffers.size() < num_buffers) {
+        reused_buffers.push_back(pooled.back().buffer);
+        pooled.pop_back();
+        num_pooled_buffers_--;
+        pooled_bytes_ -= size;
+      }
+      if (pooled.empty()) {
+        pooled_buffers_.erase(pooled_it);
+      }
+    }
+  }
+
+  std::vector<buffer_handle_t> new_buffers;
+  if (reused_buffers.size() < num_buffers) {
+    HalBufferDescriptor descriptor = buffer_descriptor;
+    descriptor.immediate_num_buffers = num_buffers - reused_buffers.size();
+    status_t res = allocator_->AllocateBuffers(descriptor, &new_buffers);
+    if (res != OK) {
+      ALOGE("%s: Allocating %u buffers failed: %s(%d)", __FUNCTION__,
+            descriptor.immediate_num_buffers, strerror(-res), res);
+      allocator_->FreeBuffers(&reused_buffers);
+      return res;
+    }
+  }
+
+  ALOGV("%s: Reused %zu and allocated %zu buffers of %ux%u format %d.",
+        __FUNCTION__, reused_buffers.size(), new_buffers.size(),
+        buffer_descriptor.width, buffer_descriptor.height,
+        buffer_descriptor.format);
+
+  reused_buffers.insert(reused_buffers.end(), new_buffers.begin(),
+                        new_buffers.end());
+  std::lock_guard<std::mutex> lock(pool_lock_);
+  for (auto buffer : reused_buffers) {
+    allocated_buffers_[buffer] = {.key = key, .size = size};
+    buffers->push_back(buffer);
+  }
+
+  return OK;
+}
+
+void InternalBufferPool::FreeBuffers(std::vector<buffer_handle_t>* buffers) {
+  ATRACE_CALL();
+  if (buffers == nullptr) {
+    return;
+  }
+
+  std::vector<buffer_handle_t> buffers_to_free;
+  {
+    std::lock_guard<std::mutex> lock(pool_lock_);
+    for (auto buffer : *buffers) {
+      auto allocated_it = allocated_buffers_.find(buffer);
+      if (allocated_it == allocated_buffers_.end()) {
+        ALOGW("%s: Buffer %p was not allocated by the pool.", __FUNCTION__,
+              buffer);
+        buffers_to_free.push_back(buffer);
+        continue;
+      }
+
+      AllocatedBuffer allocated = allocated_it->second;
+      allocated_buffers_.erase(allocated_it);
+      if (num_reconfiguring_ == 0 ||
+          pooled_bytes_ + allocated.size > max_pooled_bytes_) {
+        buffers_to_free.push_back(buffer);
+        continue;
+      }
+
+      pooled_buffers_[allocated.key].push_back(
+          {.buffer = buffer, .reconfiguration = reconfiguration_count_});
+      num_pooled_buffers_++;
+      pooled_bytes_ += allocated.size;
+    }
+  }
+
+  allocator_->FreeBuffers(&buffers_to_free);
+  buffers->clear();
+}
+
+void InternalBufferPool::BeginReconfiguration() {
+  std::lock_guard<std::mutex> lock(pool_lock_);
+  num_reconfiguring_++;
+  reconfiguration_count_++;
+  // Pooled buffers may be reused by the new configuration.
+  trim_scheduled_ = false;
+}
+
+void InternalBufferPool::EndReconfiguration() {
+  ATRACE_CALL();
+  std::lock_guard<std::mutex> lock(pool_lock_);
+  if (num_reconfiguring_ == 0) {
+    ALOGE("%s: No reconfiguration in progress.", __FUNCTION__);
+    return;
+  }
+  num_reconfiguring_--;
+
+  uint64_t current = reconfiguration_count_;
+  FreePooledBuffersLocked([current](const PooledBuffer& pooled) {
+    return pooled.reconfiguration < current;
+  });
+  ALOGV("%s: %zu buffers (%zu bytes) pooled.", __FUNCTION__,
+        num_pooled_buffers_, pooled_bytes_);
+
+  if (num_reconfiguring_ > 0 || num_pooled_buffers_ == 0) {
+    return;
+  }
+  trim_scheduled_ = true;
+  trim_deadline_ = std::chrono::steady_clock::now() + idle_timeout_;
+  if (!trim_thread_.joinable()) {
+    trim_thread_ = std::thread([this] { TrimThreadLoop(); });
+  }
+  trim_cond_.notify_one();
+}
+
+void InternalBufferPool::TrimPooledBuffers() {
+  ATRACE_CALL();
+  std::lock_guard<std::mutex> lock(pool_lock_);
+  trim_scheduled_ = false;
+  FreePooledBuffersLocked([](const PooledBuffer&) { return true; });
+}
+
+void InternalBufferPool::TrimThreadLoop() {
+  std::unique_lock<std::mutex> lock(pool_lock_);
+  while (!exiting_) {
+    if (!trim_scheduled_) {
+      trim_cond_.wait(lock);
+      continue;
+    }
+    if (std::chrono::steady_clock::now() < trim_deadline_) {
+      trim_cond_.wait_until(lock, trim_deadline_);
+      continue;
+    }
+
+    ALOGV("%s: Freeing %zu idle pooled buffers (%zu bytes).", __FUNCTION__,
+          num_pooled_buffers_, pooled_bytes_);
+    trim_scheduled_ = false;
+    FreePooledBuffersLocked([](const PooledBuffer&) { return true; });
+  }
+}
+
+size_t InternalBufferPool::GetNumPooledBuffers() {
+  std::lock_guard<std::mutex> lock(pool_lock_);
+  return num_pooled_buffers_;
+}
+
+void InternalBufferPool::FreePooledBuffersLocked(
+    const std::function<bool(const PooledBuffer&)>& drop) {
+  std::vector<buffer_handle_t> buffers_to_free;
+  for (auto pooled_it = pooled_buffers_.begin();
+       pooled_it != pooled_buffers_.end();) {
+    auto& [key, pooled] = *pooled_it;
+    HalBufferDescriptor descriptor = {.width = std::get<0>(key),
+                                      .height = std::get<1>(key),
+                                      .format = std::get<2>(key)};
+    size_t size = EstimateBufferSize(descriptor);
+    size_t num_kept = 0;
+    for (auto& pooled_buffer : pooled) {
+      if (drop(pooled_buffer)) {
+        buffers_to_free.push_back(pooled_buffer.buffer);
+        num_pooled_buffers_--;
+        pooled_bytes_ -= size;
+      } else {
+        pooled[num_kept++] = pooled_buffer;
+      }
+    }
+    pooled.resize(num_kept);
+    pooled_it = pooled.empty() ? pooled_buffers_.erase(pooled_it)
+                               : std::next(pooled_it);
+  }
+
+  allocator_->FreeBuffers(&buffers_to_free);
+}
+
+}  // namespace google_camera_hal
+}  // namespace android
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HARDWARE_GOOGLE_CAMERA_HAL_UTILS_INTERNAL_BUFFER_POOL_H_
+#define HARDWARE_GOOGLE_CAMERA_HAL_UTILS_INTERNAL_BUFFER_POOL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "hal_buffer_allocator.h"
+
+namespace android {
+namespace google_camera_hal {
+
+// InternalBufferPool is an IHalBufferAllocator that keeps the internal stream
+// buffers freed while streams are being reconfigured, so the next capture
+// session can reuse buffers with matching descriptors instead of allocating
+// them again. Buffers freed outside of a reconfiguration are freed right away.
+// Pooled buffers are kept until the end of the following reconfiguration and
+// within a byte budget, so switching back and forth between two stream
+// configurations reuses the internal buffers of both. Buffers still pooled
+// idle_timeout after a reconfiguration are freed, so a session that stays in
+// one configuration doesn't keep the buffers of the previous one.
+//
+// One pool is shared by all camera device sessions that acquired it. Internal
+// stream managers created without an allocator use it while it is alive.
+class InternalBufferPool : public IHalBufferAllocator {
+ public:
+  // Time pooled buffers are kept after a reconfiguration ends.
+  static constexpr std::chrono::milliseconds kDefaultIdleTimeout =
+      std::chrono::seconds(5);
+
+  // Return the shared pool, creating it with a budget of max_pooled_bytes if
+  // it does not exist. The pool and its pooled buffers are freed when the
+  // last reference is released.
+  static std::shared_ptr<InternalBufferPool> Acquire(
+      size_t max_pooled_bytes,
+      std::chrono::milliseconds idle_timeout = kDefaultIdleTimeout);
+
+  // Return the shared pool if it exists, or nullptr.
+  static std::shared_ptr<InternalBufferPool> GetShared();
+
+  // Create a pool that allocates buffers with allocator. Used by tests.
+  static std::unique_ptr<InternalBufferPool> Create(
+      std::unique_ptr<IHalBufferAllocator> allocator, size_t max_pooled_bytes,
+      std::chrono::milliseconds idle_timeout = kDefaultIdleTimeout);
+
+  virtual ~InternalBufferPool();
+
+  // Override functions of IHalBufferAllocator start.
+  status_t AllocateBuffers(const HalBufferDescriptor& buffer_descriptor,
+                           std::vector<buffer_handle_t>* buffers) override;
+
+  void FreeBuffers(std::vector<buffer_handle_t>* buffers) override;
+  // Override functions of IHalBufferAllocator end.
+
+  // Start pooling freed buffers for a stream reconfiguration.
+  void BeginReconfiguration();
+
+  // Stop pooling freed buffers and free the buffers pooled before the
+  // previous reconfiguration. The remaining pooled buffers are freed after
+  // idle_timeout unless another reconfiguration starts.
+  void EndReconfiguration();
+
+  // Free all pooled buffers.
+  void TrimPooledBuffers();
+
+  // Return the number of pooled buffers.
+  size_t GetNumPooledBuffers();
+
+ private:
+  // Buffers are interchangeable if these descriptor fields match.
+  using BufferKey = std::tuple<uint32_t /*width*/, uint32_t /*height*/,
+                               android_pixel_format_t /*format*/,
+                               uint64_t /*producer_flags*/,
+                               uint64_t /*consumer_flags*/>;
+
+  struct PooledBuffer {
+    buffer_handle_t buffer = nullptr;
+    // Reconfiguration in which the buffer was pooled.
+    uint64_t reconfiguration = 0;
+  };
+
+  struct AllocatedBuffer {
+    BufferKey key;
+    size_t size = 0;
+  };
+
+  InternalBufferPool(std::unique_ptr<IHalBufferAllocator> allocator,
+                     size_t max_pooled_bytes,
+                     std::chrono::milliseconds idle_timeout);
+
+  // Estimate the size of a buffer for the byte budget.
+  static size_t EstimateBufferSize(const HalBufferDescriptor& descriptor);
+
+  // Free pooled buffers for which drop returns true. Must be called with
+  // pool_lock_ locked.
+  void FreePooledBuffersLocked(
+      const std::function<bool(const PooledBuffer&)>& drop);
+
+  // Free the pooled buffers once trim_deadline_ passes.
+  void TrimThreadLoop();
+
+  static std::mutex shared_pool_lock_;
+  static std::weak_ptr<InternalBufferPool> shared_pool_;
+
+  const std::unique_ptr<IHalBufferAllocator> allocator_;
+  const size_t max_pooled_bytes_;
+  const std::chrono::milliseconds idle_timeout_;
+
+  std::mutex pool_lock_;
+  std::condition_variable trim_cond_;
+
+  // Buffers handed out by this pool. Protected by pool_lock_.
+  std::unordered_map<buffer_handle_t, AllocatedBuffer> allocated_buffers_;
+
+  // Pooled buffers, from the oldest to the newest for each key. Protected by
+  // pool_lock_.
+  std::map<BufferKey, std::vector<PooledBuffer>> pooled_buffers_;
+
+  // Protected by pool_lock_.
+  size_t num_pooled_buffers_ = 0;
+  size_t pooled_bytes_ = 0;
+
+  // Number of reconfigurations in progress and started so far. Protected by
+  // pool_lock_.
+  uint32_t num_reconfiguring_ = 0;
+  uint64_t reconfiguration_count_ = 0;
+
+  // Whether the pooled buffers are freed at trim_deadline_. Protected by
+  // pool_lock_.
+  bool trim_scheduled_ = false;
+  std::chrono::steady_clock::time_point trim_deadline_;
+
+  // Protected by pool_lock_.
+  bool exiting_ = false;
+
+  // Started by the first EndReconfiguration() that leaves buffers pooled.
+  std::thread trim_thread_;
+};
+
+}  // namespace google_camera_hal
+}  // namespace android
+
+#endif  // HARDWARE_GOOGLE_CAMERA_HAL_UTILS_INTERNAL_BUFFER_POOL_H_
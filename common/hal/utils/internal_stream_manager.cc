@@ -432,7 +432,8 @@ bool InternalStreamManager::IsPendingBufferEmpty(int32_t stream_id) {
 status_t InternalStreamManager::GetMostRecentStreamBuffer(
     int32_t stream_id, std::vector<StreamBuffer>* input_buffers,
     std::vector<std::unique_ptr<HalCameraMetadata>>* input_buffer_metadata,
-    uint32_t payload_frames, int32_t min_filled_buffers) {
+    uint32_t payload_frames, int32_t min_filled_buffers,
+    ZslSelectionPolicy* selection_policy) {
   ATRACE_CALL();
   std::lock_guard<std::mutex> lock(stream_mutex_);
 
@@ -461,7 +462,7 @@ status_t InternalStreamManager::GetMostRecentStreamBuffer(
 
   std::vector<ZslBufferManager::ZslBuffer> filled_buffers;
   buffer_managers_[owner_stream_id]->GetMostRecentZslBuffers(
-      &filled_buffers, payload_frames, min_filled_buffers);
+      &filled_buffers, payload_frames, min_filled_buffers, selection_policy);
 
   if (filled_buffers.size() == 0) {
     ALOGE("%s: There is no input buffers.", __FUNCTION__);
@@ -84,11 +84,13 @@ class InternalStreamManager {
                           const HalCameraMetadata* metadata,
                           int partial_result = 1);
 
-  // Get the most recent buffer and metadata.
+  // Get the most recent buffer and metadata. If selection_policy is not
+  // nullptr, it selects the buffers instead.
   status_t GetMostRecentStreamBuffer(
       int32_t stream_id, std::vector<StreamBuffer>* input_buffers,
       std::vector<std::unique_ptr<HalCameraMetadata>>* input_buffer_metadata,
-      uint32_t payload_frames, int32_t min_filled_buffers = kMinFilledBuffers);
+      uint32_t payload_frames, int32_t min_filled_buffers = kMinFilledBuffers,
+      ZslSelectionPolicy* selection_policy = nullptr);
 
   // Return the buffer from GetMostRecentStreamBuffer
   status_t ReturnZslStreamBuffers(uint32_t frame_number, int32_t stream_id);
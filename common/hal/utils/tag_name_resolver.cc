@@ -0,0 +1,321 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "GCH_TagNameResolver"
+#include "tag_name_resolver.h"
+
+#include <log/log.h>
+#include <system/camera_metadata.h>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+namespace android {
+namespace google_camera_hal {
+
+// Average number of names per bucket. Larger buckets make the table smaller
+// but take longer to place.
+static constexpr size_t kNamesPerBucket = 2;
+static constexpr uint32_t kMaxSeed = 1 << 20;
+
+// Seeded 32-bit FNV-1a. The hash of a full name can be computed in parts,
+// so section and tag names don't have to be concatenated for a lookup.
+static uint32_t HashStart(uint32_t seed) {
+  return 0x811c9dc5u ^ (seed * 0x9e3779b9u);
+}
+
+static uint32_t HashAppend(uint32_t hash, std::string_view bytes) {
+  for (unsigned char c : bytes) {
+    hash ^= c;
+    hash *= 0x01000193u;
+  }
+  return hash;
+}
+
+// FNV-1a alone mixes the last characters poorly, which are often all that
+// differ between tag names.
+static uint32_t HashFinish(uint32_t hash) {
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bu;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35u;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+static uint32_t Hash(uint32_t seed, std::string_view name) {
+  return HashFinish(HashAppend(HashStart(seed), name));
+}
+
+static uint32_t Hash(uint32_t seed, std::string_view section_name,
+                     std::string_view tag_name) {
+  uint32_t hash = HashAppend(HashStart(seed), section_name);
+  hash = HashAppend(hash, ".");
+  return HashFinish(HashAppend(hash, tag_name));
+}
+
+std::unique_ptr<TagNameTable> TagNameTable::Create(
+    const std::vector<Entry>& entries) {
+  auto table = std::unique_ptr<TagNameTable>(new TagNameTable());
+  if (table == nullptr) {
+    ALOGE("%s: Creating TagNameTable failed.", __FUNCTION__);
+    return nullptr;
+  }
+
+  status_t res = table->Build(entries);
+  if (res != OK) {
+    ALOGE("%s: Building TagNameTable failed: %s(%d)", __FUNCTION__,
+          strerror(-res), res);
+    return nullptr;
+  }
+
+  return table;
+}
+
+status_t TagNameTable::Build(const std::vector<Entry>& entries) {
+  if (entries.empty()) {
+    return OK;
+  }
+
+  std::vector<std::string> names;
+  names.reserve(entries.size());
+  std::unordered_set<std::string> unique_names;
+  for (auto& entry : entries) {
+    names.push_back(entry.section_name + "." + entry.tag_name);
+    if (!unique_names.insert(names.back()).second) {
+      // Identical names would never be placed into separate slots.
+      ALOGE("%s: Tag name %s is used more than once", __FUNCTION__,
+            names.back().c_str());
+      return BAD_VALUE;
+    }
+  }
+
+  // Distribute the names into buckets with the unseeded hash.
+  size_t num_buckets = (entries.size() + kNamesPerBucket - 1) / kNamesPerBucket;
+  std::vector<std::vector<size_t>> buckets(num_buckets);
+  for (size_t i = 0; i < names.size(); i++) {
+    buckets[Hash(0, names[i]) % num_buckets].push_back(i);
+  }
+
+  // Place the largest buckets first while most slots are still free.
+  std::vector<size_t> bucket_order(num_buckets);
+  for (size_t i = 0; i < num_buckets; i++) {
+    bucket_order[i] = i;
+  }
+  std::stable_sort(bucket_order.begin(), bucket_order.end(),
+                   [&buckets](size_t a, size_t b) {
+                     return buckets[a].size() > buckets[b].size();
+                   });
+
+  size_t num_slots = entries.size();
+  std::vector<bool> occupied(num_slots, false);
+  std::vector<size_t> slot_entries(num_slots);
+  bucket_seeds_.assign(num_buckets, 0);
+
+  std::vector<size_t> bucket_slots;
+  for (size_t bucket_index : bucket_order) {
+    const std::vector<size_t>& bucket = buckets[bucket_index];
+    if (bucket.empty()) {
+      break;
+    }
+
+    // Find a seed that puts every name of the bucket into a free slot.
+    uint32_t seed = 1;
+    for (; seed < kMaxSeed; seed++) {
+      bucket_slots.clear();
+      for (size_t entry_index : bucket) {
+        size_t slot = Hash(seed, names[entry_index]) % num_slots;
+        bool taken = occupied[slot] ||
+                     std::find(bucket_slots.begin(), bucket_slots.end(),
+                               slot) != bucket_slots.end();
+        if (taken) {
+          break;
+        }
+        bucket_slots.push_back(slot);
+      }
+
+      if (bucket_slots.size() == bucket.size()) {
+        break;
+      }
+    }
+
+    if (seed == kMaxSeed) {
+      ALOGE("%s: Failed to place %s", __FUNCTION__, names[bucket[0]].c_str());
+      slots_.clear();
+      bucket_seeds_.clear();
+      return BAD_VALUE;
+    }
+
+    bucket_seeds_[bucket_index] = seed;
+    for (size_t i = 0; i < bucket.size(); i++) {
+      occupied[bucket_slots[i]] = true;
+      slot_entries[bucket_slots[i]] = bucket[i];
+    }
+  }
+
+  slots_.resize(num_slots);
+  for (size_t slot = 0; slot < num_slots; slot++) {
+    const Entry& entry = entries[slot_entries[slot]];
+    slots_[slot].name = std::move(names[slot_entries[slot]]);
+    slots_[slot].section_length = entry.section_name.size();
+    slots_[slot].tag_id = entry.tag_id;
+  }
+
+  ALOGV("%s: Placed %zu names into %zu buckets", __FUNCTION__, num_slots,
+        num_buckets);
+  return OK;
+}
+
+status_t TagNameTable::GetTag(std::string_view name, uint32_t* tag_id) const {
+  if (tag_id == nullptr) {
+    ALOGE("%s: tag_id is nullptr", __FUNCTION__);
+    return BAD_VALUE;
+  }
+
+  if (slots_.empty()) {
+    return NAME_NOT_FOUND;
+  }
+
+  uint32_t seed = bucket_seeds_[Hash(0, name) % bucket_seeds_.size()];
+  const Slot& slot = slots_[Hash(seed, name) % slots_.size()];
+  if (slot.name != name) {
+    return NAME_NOT_FOUND;
+  }
+
+  *tag_id = slot.tag_id;
+  return OK;
+}
+
+status_t TagNameTable::GetTag(std::string_view section_name,
+                              std::string_view tag_name,
+                              uint32_t* tag_id) const {
+  if (tag_id == nullptr) {
+    ALOGE("%s: tag_id is nullptr", __FUNCTION__);
+    return BAD_VALUE;
+  }
+
+  if (slots_.empty()) {
+    return NAME_NOT_FOUND;
+  }
+
+  uint32_t seed =
+      bucket_seeds_[Hash(0, section_name, tag_name) % bucket_seeds_.size()];
+  const Slot& slot = slots_[Hash(seed, section_name, tag_name) % slots_.size()];
+  std::string_view name = slot.name;
+  if (slot.section_length != section_name.size() ||
+      name.size() != section_name.size() + 1 + tag_name.size() ||
+      name.substr(0, section_name.size()) != section_name ||
+      name.substr(section_name.size() + 1) != tag_name) {
+    return NAME_NOT_FOUND;
+  }
+
+  *tag_id = slot.tag_id;
+  return OK;
+}
+
+TagNameResolver& TagNameResolver::GetInstance() {
+  static TagNameResolver instance;
+  return instance;
+}
+
+TagNameResolver::TagNameResolver() {
+  std::vector<TagNameTable::Entry> entries;
+  for (uint32_t section = 0; section < ANDROID_SECTION_COUNT; section++) {
+    uint32_t tag_begin = camera_metadata_section_bounds[section][0];
+    uint32_t tag_end = camera_metadata_section_bounds[section][1];
+    for (uint32_t tag = tag_begin; tag < tag_end; tag++) {
+      const char* tag_name = get_camera_metadata_tag_name(tag);
+      if (tag_name == nullptr) {
+        continue;
+      }
+      entries.push_back({.section_name = camera_metadata_section_names[section],
+                         .tag_name = tag_name,
+                         .tag_id = tag});
+    }
+  }
+
+  android_tags_ = TagNameTable::Create(entries);
+  if (android_tags_ == nullptr) {
+    LOG_ALWAYS_FATAL("%s: Indexing %zu tag names failed", __FUNCTION__,
+                     entries.size());
+  }
+}
+
+status_t TagNameResolver::GetTag(std::string_view name,
+                                 uint32_t* tag_id) const {
+  status_t res = android_tags_->GetTag(name, tag_id);
+  if (res != NAME_NOT_FOUND) {
+    return res;
+  }
+
+  std::lock_guard<std::mutex> lock(vendor_tags_lock_);
+  if (vendor_tags_ == nullptr) {
+    return NAME_NOT_FOUND;
+  }
+  return vendor_tags_->GetTag(name, tag_id);
+}
+
+status_t TagNameResolver::GetTag(std::string_view section_name,
+                                 std::string_view tag_name,
+                                 uint32_t* tag_id) const {
+  status_t res = android_tags_->GetTag(section_name, tag_name, tag_id);
+  if (res != NAME_NOT_FOUND) {
+    return res;
+  }
+
+  return GetVendorTag(section_name, tag_name, tag_id);
+}
+
+status_t TagNameResolver::GetVendorTag(std::string_view section_name,
+                                       std::string_view tag_name,
+                                       uint32_t* tag_id) const {
+  std::lock_guard<std::mutex> lock(vendor_tags_lock_);
+  if (vendor_tags_ == nullptr) {
+    return NAME_NOT_FOUND;
+  }
+  return vendor_tags_->GetTag(section_name, tag_name, tag_id);
+}
+
+status_t TagNameResolver::SetVendorTags(
+    const std::vector<VendorTagSection>& tag_sections) {
+  std::vector<TagNameTable::Entry> entries;
+  for (auto& section : tag_sections) {
+    for (auto& tag : section.tags) {
+      entries.push_back({.section_name = section.section_name,
+                         .tag_name = tag.tag_name,
+                         .tag_id = tag.tag_id});
+    }
+  }
+
+  std::unique_ptr<TagNameTable> vendor_tags;
+  if (!entries.empty()) {
+    vendor_tags = TagNameTable::Create(entries);
+    if (vendor_tags == nullptr) {
+      ALOGE("%s: Indexing %zu vendor tag names failed", __FUNCTION__,
+            entries.size());
+      return BAD_VALUE;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(vendor_tags_lock_);
+  vendor_tags_ = std::move(vendor_tags);
+  return OK;
+}
+
+}  // namespace google_camera_hal
+}  // namespace android
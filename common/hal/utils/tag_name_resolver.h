@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HARDWARE_GOOGLE_CAMERA_HAL_UTILS_TAG_NAME_RESOLVER_H_
+#define HARDWARE_GOOGLE_CAMERA_HAL_UTILS_TAG_NAME_RESOLVER_H_
+
+#include <utils/Errors.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "hal_types.h"
+
+namespace android {
+namespace google_camera_hal {
+
+// Minimal perfect hash table from tag names to tag ids, built with the hash
+// and displace method. Every name owns one slot, so a lookup hashes the name
+// twice and compares it with a single stored name.
+class TagNameTable {
+ public:
+  struct Entry {
+    std::string section_name;
+    std::string tag_name;
+    uint32_t tag_id = 0;
+  };
+
+  // Return nullptr if entries contain duplicate names.
+  static std::unique_ptr<TagNameTable> Create(
+      const std::vector<Entry>& entries);
+
+  // Return the tag id of a full tag name, e.g. "android.control.aeMode".
+  status_t GetTag(std::string_view name, uint32_t* tag_id) const;
+
+  // Return the tag id of section_name.tag_name.
+  status_t GetTag(std::string_view section_name, std::string_view tag_name,
+                  uint32_t* tag_id) const;
+
+  size_t GetNumTags() const {
+    return slots_.size();
+  }
+
+ private:
+  struct Slot {
+    // Full tag name.
+    std::string name;
+    size_t section_length = 0;
+    uint32_t tag_id = 0;
+  };
+
+  TagNameTable() = default;
+
+  status_t Build(const std::vector<Entry>& entries);
+
+  // Entries ordered by slot.
+  std::vector<Slot> slots_;
+  // Hash seed of each bucket.
+  std::vector<uint32_t> bucket_seeds_;
+};
+
+// Resolves metadata tag names to tag ids in constant time. Names of the tags
+// defined by libcamera_metadata are indexed on first use. Vendor tag sections
+// are kept in a separate table that VendorTagManager rebuilds whenever its
+// tags change.
+class TagNameResolver {
+ public:
+  static TagNameResolver& GetInstance();
+
+  // Return the tag id of a full tag name, e.g. "android.control.aeMode".
+  // Vendor tags are resolved as well. Return NAME_NOT_FOUND if the name is
+  // unknown.
+  status_t GetTag(std::string_view name, uint32_t* tag_id) const;
+
+  // Return the tag id of a tag in a section, e.g. "android.control" and
+  // "aeMode".
+  status_t GetTag(std::string_view section_name, std::string_view tag_name,
+                  uint32_t* tag_id) const;
+
+  // Return the tag id of a tag in an added vendor tag section.
+  status_t GetVendorTag(std::string_view section_name,
+                        std::string_view tag_name, uint32_t* tag_id) const;
+
+  // Replace the vendor tag sections.
+  status_t SetVendorTags(const std::vector<VendorTagSection>& tag_sections);
+
+ private:
+  TagNameResolver();
+
+  // Names of the tags defined by libcamera_metadata.
+  std::unique_ptr<TagNameTable> android_tags_;
+
+  mutable std::mutex vendor_tags_lock_;
+  // Protected by vendor_tags_lock_.
+  std::unique_ptr<TagNameTable> vendor_tags_;
+};
+
+}  // namespace google_camera_hal
+}  // namespace android
+
+#endif  // HARDWARE_GOOGLE_CAMERA_HAL_UTILS_TAG_NAME_RESOLVER_H_
@@ -24,6 +24,7 @@
 #include <string>
 #include <unordered_set>
 
+#include "tag_name_resolver.h"
 #include "vendor_tag_utils.h"
 
 namespace android {
@@ -130,6 +131,15 @@ status_t VendorTagManager::AddTags(
           strerror(-res), res);
     return res;
   }
+
+  // Section/tag name lookups go through the resolver's perfect hash table,
+  // which is rebuilt from the combined tags.
+  res = TagNameResolver::GetInstance().SetVendorTags(combined_tags);
+  if (res != OK) {
+    ALOGE("%s: Indexing vendor tag names failed: %s(%d)", __FUNCTION__,
+          strerror(-res), res);
+    return res;
+  }
   tag_sections_ = combined_tags;
 
   // Add new tags to internal maps to help speed up the metadata framework
@@ -141,9 +151,6 @@ status_t VendorTagManager::AddTags(
                         .tag_type = static_cast<int>(tag.tag_type),
                         .section_name = section.section_name,
                         .tag_name = tag.tag_name};
-
-      vendor_tag_inverse_map_[TagString(section.section_name, tag.tag_name)] =
-          tag.tag_id;
     }
   }
 
@@ -173,6 +180,7 @@ void VendorTagManager::Reset() {
   std::lock_guard<std::mutex> lock(api_mutex_);
   vendor_tag_map_.clear();
   tag_sections_.clear();
+  TagNameResolver::GetInstance().SetVendorTags({});
   set_camera_metadata_vendor_ops(nullptr);
 }
 
@@ -250,16 +258,12 @@ status_t VendorTagManager::GetTag(const std::string section_name,
     return BAD_VALUE;
   }
   std::lock_guard<std::mutex> lock(api_mutex_);
-
-  const TagString section_tag{section_name, tag_name};
-
-  auto itr = vendor_tag_inverse_map_.find(section_tag);
-  if (itr == vendor_tag_inverse_map_.end()) {
+  if (TagNameResolver::GetInstance().GetVendorTag(section_name, tag_name,
+                                                  tag_id) != OK) {
     ALOGE("%s Given section/tag names not found", __FUNCTION__);
     return BAD_VALUE;
   }
 
-  *tag_id = itr->second;
   return OK;
 }
 
@@ -89,19 +89,6 @@ class VendorTagManager : public VendorTagInterface {
   // vendor tag callbacks, protected by api_mutex_.
   std::unordered_map<uint32_t, VendorTagInfo> vendor_tag_map_;
 
-  using TagString = std::pair<std::string, std::string>;
-
-  struct TagStringHash {
-    size_t operator()(const TagString& pair) const {
-      std::hash<TagString::first_type> h1;
-      std::hash<TagString::second_type> h2;
-      return h1(pair.first) ^ h2(pair.second);
-    }
-  };
-
-  std::unordered_map<const TagString, uint32_t, TagStringHash>
-      vendor_tag_inverse_map_;
-
   // Protects the public entry points into this class.
   mutable std::mutex api_mutex_;
 
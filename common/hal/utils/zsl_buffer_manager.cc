@@ -23,6 +23,8 @@
 
 #include <time.h>
 
+#include <algorithm>
+
 #include "zsl_buffer_manager.h"
 
 namespace android {
@@ -44,6 +46,126 @@ ZslBufferManager::~ZslBufferManager() {
   }
 }
 
+void ZslBufferManager::FilledBufferRing::Reserve(size_t capacity) {
+  if (capacity <= slots_.size()) {
+    return;
+  }
+
+  // Linearize into the new storage so head_ restarts at 0.
+  std::vector<ZslBuffer> slots(capacity);
+  for (size_t i = 0; i < size_; i++) {
+    slots[i] = std::move(slots_[Slot(i)]);
+  }
+  slots_ = std::move(slots);
+  head_ = 0;
+}
+
+void ZslBufferManager::FilledBufferRing::UpdateCounters(
+    const ZslBuffer& zsl_buffer, int32_t delta) {
+  if (zsl_buffer.selection_keys.flash_state == ANDROID_FLASH_STATE_FIRED) {
+    num_flash_fired_ += delta;
+  }
+  if (zsl_buffer.selection_keys.timestamp ==
+      ZslSelectionKeys::kInvalidTimestamp) {
+    num_invalid_timestamps_ += delta;
+  }
+}
+
+void ZslBufferManager::FilledBufferRing::Insert(ZslBuffer zsl_buffer) {
+  // Find the insertion point from the newest end; out-of-order inserts are
+  // rare and close to the end.
+  size_t index = size_;
+  while (index > 0 && At(index - 1).frame_number > zsl_buffer.frame_number) {
+    index--;
+  }
+
+  if (index > 0 && At(index - 1).frame_number == zsl_buffer.frame_number) {
+    ZslBuffer& existing = slots_[Slot(index - 1)];
+    UpdateCounters(existing, -1);
+    UpdateCounters(zsl_buffer, 1);
+    existing = std::move(zsl_buffer);
+    return;
+  }
+
+  if (size_ == slots_.size()) {
+    Reserve(std::max<size_t>(1, slots_.size() * 2));
+  }
+
+  // Shift newer buffers by one slot to make room at index.
+  for (size_t i = size_; i > index; i--) {
+    slots_[Slot(i)] = std::move(slots_[Slot(i - 1)]);
+  }
+  UpdateCounters(zsl_buffer, 1);
+  slots_[Slot(index)] = std::move(zsl_buffer);
+  size_++;
+}
+
+ZslBufferManager::ZslBuffer ZslBufferManager::FilledBufferRing::Take(
+    size_t index) {
+  ZslBuffer zsl_buffer = std::move(slots_[Slot(index)]);
+  UpdateCounters(zsl_buffer, -1);
+
+  if (index == 0) {
+    head_ = Slot(1);
+  } else {
+    // Shift newer buffers by one slot to close the gap.
+    for (size_t i = index; i + 1 < size_; i++) {
+      slots_[Slot(i)] = std::move(slots_[Slot(i + 1)]);
+    }
+  }
+  size_--;
+  return zsl_buffer;
+}
+
+size_t ZslBufferManager::FilledBufferRing::FindFrameNumber(
+    uint32_t frame_number) const {
+  size_t low = 0;
+  size_t high = size_;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (At(mid).frame_number < frame_number) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low < size_ && At(low).frame_number == frame_number ? low : size_;
+}
+
+size_t ZslBufferManager::FilledBufferRing::LowerBoundTimestamp(
+    int64_t timestamp) const {
+  // Buffers without a timestamp break the timestamp order, so scan linearly
+  // past them.
+  if (num_invalid_timestamps_ > 0) {
+    for (size_t i = 0; i < size_; i++) {
+      int64_t buffer_timestamp = At(i).selection_keys.timestamp;
+      if (buffer_timestamp != ZslSelectionKeys::kInvalidTimestamp &&
+          buffer_timestamp >= timestamp) {
+        return i;
+      }
+    }
+    return size_;
+  }
+
+  size_t low = 0;
+  size_t high = size_;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (At(mid).selection_keys.timestamp < timestamp) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+void ZslBufferManager::AddFilledBufferLocked(ZslBuffer zsl_buffer) {
+  zsl_buffer.selection_keys =
+      ZslSelectionKeys::Parse(zsl_buffer.metadata.get());
+  filled_zsl_buffers_.Insert(std::move(zsl_buffer));
+}
+
 status_t ZslBufferManager::AllocateBuffers(
     const HalBufferDescriptor& buffer_descriptor) {
   ATRACE_CALL();
@@ -54,6 +176,13 @@ status_t ZslBufferManager::AllocateBuffers(
     return ALREADY_EXISTS;
   }
 
+  // Use the shared internal buffer pool, if a camera device session keeps
+  // one, so buffers survive stream reconfiguration.
+  if (buffer_allocator_ == nullptr) {
+    shared_buffer_pool_ = InternalBufferPool::GetShared();
+    buffer_allocator_ = shared_buffer_pool_.get();
+  }
+
   // Create a buffer allocator if the client doesn't specify one.
   if (buffer_allocator_ == nullptr) {
     // Create a buffer manager.
@@ -68,6 +197,7 @@ status_t ZslBufferManager::AllocateBuffers(
 
   uint32_t num_buffers = buffer_descriptor.immediate_num_buffers;
   buffer_descriptor_ = buffer_descriptor;
+  filled_zsl_buffers_.Reserve(buffer_descriptor.max_num_buffers);
   status_t res = AllocateBuffersLocked(num_buffers);
   if (res != OK) {
     ALOGE("%s: Allocating %d buffers failed.", __FUNCTION__, num_buffers);
@@ -154,10 +284,8 @@ buffer_handle_t ZslBufferManager::GetEmptyBufferLocked() {
   if (empty_zsl_buffers_.size() > 0) {
     buffer = empty_zsl_buffers_[0];
     empty_zsl_buffers_.pop_front();
-  } else if (filled_zsl_buffers_.size() > 0) {
-    auto buffer_iter = filled_zsl_buffers_.begin();
-    buffer = buffer_iter->second.buffer.buffer;
-    filled_zsl_buffers_.erase(buffer_iter);
+  } else if (filled_zsl_buffers_.Size() > 0) {
+    buffer = filled_zsl_buffers_.Take(0).buffer.buffer;
   } else if (partially_filled_zsl_buffers_.size() > 0) {
     auto buffer_iter = partially_filled_zsl_buffers_.begin();
     while (buffer_iter != partially_filled_zsl_buffers_.end()) {
@@ -298,8 +426,8 @@ status_t ZslBufferManager::ReturnFilledBuffer(uint32_t frame_number,
           "%s: both buffer and metadata for frame[%u] are ready. Move to "
           "filled_zsl_buffers_.",
           __FUNCTION__, frame_number);
-      filled_zsl_buffers_[frame_number] =
-          std::move(partially_filled_zsl_buffers_[frame_number]);
+      AddFilledBufferLocked(
+          std::move(partially_filled_zsl_buffers_[frame_number]));
       partially_filled_zsl_buffers_.erase(frame_number);
     }
   } else {
@@ -374,8 +502,7 @@ status_t ZslBufferManager::ReturnMetadata(uint32_t frame_number,
           "%s: both buffer and metadata for frame[%u] are ready. Move to "
           "filled_zsl_buffers_.",
           __FUNCTION__, frame_number);
-      filled_zsl_buffers_[frame_number] =
-          std::move(partially_filled_buffer_it->second);
+      AddFilledBufferLocked(std::move(partially_filled_buffer_it->second));
       partially_filled_zsl_buffers_.erase(frame_number);
     }
   }
@@ -408,7 +535,7 @@ status_t ZslBufferManager::GetCurrentTimestampNs(int64_t* current_timestamp) {
 
 void ZslBufferManager::GetMostRecentZslBuffers(
     std::vector<ZslBuffer>* zsl_buffers, uint32_t num_buffers,
-    uint32_t min_buffers) {
+    uint32_t min_buffers, ZslSelectionPolicy* policy) {
   ATRACE_CALL();
   if (zsl_buffers == nullptr) {
     return;
@@ -422,68 +549,130 @@ void ZslBufferManager::GetMostRecentZslBuffers(
     return;
   }
 
+  if (policy != nullptr) {
+    SelectZslBuffersWithPolicy(zsl_buffers, num_buffers, min_buffers,
+                               current_timestamp, policy);
+    return;
+  }
+
   std::unique_lock<std::mutex> lock(zsl_buffers_lock_);
-  if (filled_zsl_buffers_.size() < min_buffers) {
+  size_t num_filled = filled_zsl_buffers_.Size();
+  if (num_filled < min_buffers) {
     ALOGD("%s: Requested min_buffers = %u, ZslBufferManager only has %zu",
-          __FUNCTION__, min_buffers, filled_zsl_buffers_.size());
+          __FUNCTION__, min_buffers, num_filled);
     ALOGD("%s: Not enough ZSL buffers to get, returns empty zsl_buffers.",
           __FUNCTION__);
     return;
   }
 
-  num_buffers =
-      std::min(static_cast<uint32_t>(filled_zsl_buffers_.size()), num_buffers);
-  auto zsl_buffer_iter = filled_zsl_buffers_.begin();
-
-  // Skip the older ones.
-  for (uint32_t i = 0; i < filled_zsl_buffers_.size() - num_buffers; i++) {
-    zsl_buffer_iter++;
+  if (num_filled == 0) {
+    return;
   }
 
+  num_buffers = std::min(static_cast<uint32_t>(num_filled), num_buffers);
+  size_t first = num_filled - num_buffers;
+
   // Fallback to realtime pipeline capture if there are any flash-fired frame
   // in zsl buffers with AE_MODE_ON_AUTO_FLASH.
-  camera_metadata_ro_entry entry = {};
-  res = zsl_buffer_iter->second.metadata->Get(ANDROID_CONTROL_AE_MODE, &entry);
-  if (res == OK && entry.data.u8[0] == ANDROID_CONTROL_AE_MODE_ON_AUTO_FLASH) {
-    for (auto search_iter = filled_zsl_buffers_.begin();
-         search_iter != filled_zsl_buffers_.end(); search_iter++) {
-      res = search_iter->second.metadata->Get(ANDROID_FLASH_STATE, &entry);
-      if (res == OK && entry.count == 1) {
-        if (entry.data.u8[0] == ANDROID_FLASH_STATE_FIRED) {
-          ALOGD("%s: Returns empty zsl_buffers due to flash fired",
-                __FUNCTION__);
-          return;
-        }
-      }
+  if (filled_zsl_buffers_.At(first).selection_keys.ae_mode ==
+          ANDROID_CONTROL_AE_MODE_ON_AUTO_FLASH &&
+      filled_zsl_buffers_.NumFlashFired() > 0) {
+    ALOGD("%s: Returns empty zsl_buffers due to flash fired", __FUNCTION__);
+    return;
+  }
+
+  // Only include recent buffers. Skip the older ones with a binary search;
+  // the remaining scan only visits the candidates.
+  first = std::max(first, filled_zsl_buffers_.LowerBoundTimestamp(
+                              current_timestamp - kMaxBufferTimestampDiff + 1));
+  size_t index = first;
+  uint32_t num_selected = 0;
+  while (index < filled_zsl_buffers_.Size() && num_selected < num_buffers) {
+    int64_t buffer_timestamp =
+        filled_zsl_buffers_.At(index).selection_keys.timestamp;
+    if (buffer_timestamp == ZslSelectionKeys::kInvalidTimestamp) {
+      ALOGW("%s: Frame %u has no sensor timestamp.", __FUNCTION__,
+            filled_zsl_buffers_.At(index).frame_number);
+      index++;
+    } else if (current_timestamp - buffer_timestamp < kMaxBufferTimestampDiff) {
+      zsl_buffers->push_back(filled_zsl_buffers_.Take(index));
+      num_selected++;
+    } else {
+      index++;
     }
   }
+}
 
-  for (uint32_t i = 0; i < num_buffers; i++) {
-    camera_metadata_ro_entry entry = {};
-    int64_t buffer_timestamp;
-    res =
-        zsl_buffer_iter->second.metadata->Get(ANDROID_SENSOR_TIMESTAMP, &entry);
-    if (res != OK || entry.count != 1) {
-      ALOGW("%s: Getting sensor timestamp failed: %s(%d)", __FUNCTION__,
-            strerror(-res), res);
-      return;
+void ZslBufferManager::SelectZslBuffersWithPolicy(
+    std::vector<ZslBuffer>* zsl_buffers, uint32_t num_buffers,
+    uint32_t min_buffers, int64_t current_timestamp,
+    ZslSelectionPolicy* policy) {
+  ATRACE_CALL();
+  std::lock_guard<std::mutex> selection_lock(selection_lock_);
+  selection_candidates_.clear();
+  selected_candidates_.clear();
+  {
+    std::lock_guard<std::mutex> lock(zsl_buffers_lock_);
+    for (size_t i = 0; i < filled_zsl_buffers_.Size(); i++) {
+      const ZslBuffer& zsl_buffer = filled_zsl_buffers_.At(i);
+      selection_candidates_.push_back({.frame_number = zsl_buffer.frame_number,
+                                       .keys = zsl_buffer.selection_keys});
     }
+  }
 
-    buffer_timestamp = entry.data.i64[0];
-    // Only include recent buffers.
-    if (current_timestamp - buffer_timestamp < kMaxBufferTimestampDiff) {
-      zsl_buffers->push_back(std::move(zsl_buffer_iter->second));
-      zsl_buffer_iter = filled_zsl_buffers_.erase(zsl_buffer_iter);
-    } else {
-      zsl_buffer_iter++;
+  if (selection_candidates_.size() < min_buffers) {
+    ALOGD("%s: Requested min_buffers = %u, ZslBufferManager only has %zu",
+          __FUNCTION__, min_buffers, selection_candidates_.size());
+    return;
+  }
+
+  // The realtime pipeline keeps filling buffers while the policy runs.
+  policy->SelectBuffers(selection_candidates_, current_timestamp, num_buffers,
+                        &selected_candidates_);
+  if (selected_candidates_.size() > num_buffers) {
+    ALOGW("%s: Policy selected %zu buffers, more than %u requested.",
+          __FUNCTION__, selected_candidates_.size(), num_buffers);
+    selected_candidates_.resize(num_buffers);
+  }
+
+  std::lock_guard<std::mutex> lock(zsl_buffers_lock_);
+  // Selected buffers may have been recycled meanwhile. Make sure enough are
+  // still there before taking any.
+  uint32_t num_available = 0;
+  for (size_t index : selected_candidates_) {
+    if (index < selection_candidates_.size() &&
+        filled_zsl_buffers_.FindFrameNumber(
+            selection_candidates_[index].frame_number) <
+            filled_zsl_buffers_.Size()) {
+      num_available++;
+    }
+  }
+  if (num_available == 0 || num_available < min_buffers) {
+    ALOGD("%s: %u of %zu selected buffers available, min_buffers %u.",
+          __FUNCTION__, num_available, selected_candidates_.size(),
+          min_buffers);
+    return;
+  }
+
+  for (size_t index : selected_candidates_) {
+    if (index >= selection_candidates_.size()) {
+      continue;
+    }
+    size_t ring_index = filled_zsl_buffers_.FindFrameNumber(
+        selection_candidates_[index].frame_number);
+    if (ring_index < filled_zsl_buffers_.Size()) {
+      zsl_buffers->push_back(filled_zsl_buffers_.Take(ring_index));
     }
   }
 }
 
 void ZslBufferManager::ReturnZslBuffer(ZslBuffer zsl_buffer) {
   ATRACE_CALL();
+  // Parse outside of the lock; the caller owns the metadata until now.
+  zsl_buffer.selection_keys =
+      ZslSelectionKeys::Parse(zsl_buffer.metadata.get());
   std::unique_lock<std::mutex> lock(zsl_buffers_lock_);
-  filled_zsl_buffers_[zsl_buffer.frame_number] = std::move(zsl_buffer);
+  filled_zsl_buffers_.Insert(std::move(zsl_buffer));
 }
 
 void ZslBufferManager::ReturnZslBuffers(std::vector<ZslBuffer> zsl_buffers) {
@@ -513,6 +702,7 @@ void ZslBufferManager::AddPendingBuffers(const std::vector<ZslBuffer>& buffers)
         .frame_number = buffer.frame_number,
         .buffer = buffer.buffer,
         .metadata = HalCameraMetadata::Clone(buffer.metadata.get()),
+        .selection_keys = buffer.selection_keys,
     };
 
     pending_zsl_buffers_.emplace(buffer.buffer.buffer, std::move(zsl_buffer));
@@ -28,8 +28,10 @@
 
 #include "gralloc_buffer_allocator.h"
 #include "hal_buffer_allocator.h"
+#include "internal_buffer_pool.h"
 
 #include "hal_types.h"
+#include "zsl_selection_policy.h"
 
 namespace android {
 namespace google_camera_hal {
@@ -53,6 +55,8 @@ class ZslBufferManager {
     std::unique_ptr<HalCameraMetadata> metadata;
     // Last partial result received
     int partial_result = 0;
+    // Selection keys parsed from metadata once it is complete.
+    ZslSelectionKeys selection_keys;
   };
 
   // Allocate buffers. This can only be called once.
@@ -79,6 +83,9 @@ class ZslBufferManager {
                           const HalCameraMetadata* metadata, int partial_result);
 
   // Get a number of the most recent ZSL buffers.
+  // Selection uses the cached selection keys: the first recent buffer is
+  // binary searched by timestamp, so the cost does not depend on how many
+  // older buffers are held. Buffers without a sensor timestamp are skipped.
   // If numBuffers is larger than available ZSL buffers,
   // zslBuffers will contain all available ZSL buffers,
   // i.e. zslBuffers.size() may be smaller than numBuffers.
@@ -88,8 +95,11 @@ class ZslBufferManager {
   // zsl buffer manager should return. If this can not be satisfied
   // (i.e. not enough ZSL buffers exist),
   // this GetMostRecentZslBuffers returns an empty vector.
+  // If policy is not nullptr, it selects the buffers among all filled buffers
+  // instead. The policy runs without holding the ZSL buffer lock.
   void GetMostRecentZslBuffers(std::vector<ZslBuffer>* zsl_buffers,
-                               uint32_t num_buffers, uint32_t min_buffers);
+                               uint32_t num_buffers, uint32_t min_buffers,
+                               ZslSelectionPolicy* policy = nullptr);
 
   // Return a ZSL buffer that was previously obtained by
   // GetMostRecentZslBuffers().
@@ -146,22 +156,88 @@ class ZslBufferManager {
   // Try to free unused buffers. Must be protected by zsl_buffers_lock_.
   void FreeUnusedBuffersLocked();
 
+  // Select ZSL buffers with policy. Used by GetMostRecentZslBuffers().
+  void SelectZslBuffersWithPolicy(std::vector<ZslBuffer>* zsl_buffers,
+                                  uint32_t num_buffers, uint32_t min_buffers,
+                                  int64_t current_timestamp,
+                                  ZslSelectionPolicy* policy);
+
+  // Parse the selection keys of a complete ZSL buffer and move it to
+  // filled_zsl_buffers_. Must be protected by zsl_buffers_lock_.
+  void AddFilledBufferLocked(ZslBuffer zsl_buffer);
+
+  // Ring of filled ZSL buffers ordered by frame number, which is also sensor
+  // timestamp order. Storage is reserved for all buffers the manager can
+  // allocate, so the realtime path does not allocate once it is warm.
+  class FilledBufferRing {
+   public:
+    // Make room for capacity buffers.
+    void Reserve(size_t capacity);
+
+    size_t Size() const {
+      return size_;
+    }
+
+    // Index 0 is the oldest buffer.
+    const ZslBuffer& At(size_t index) const {
+      return slots_[Slot(index)];
+    }
+
+    // Insert a buffer in frame number order. Buffers normally arrive in order,
+    // so this is an append; returned ZSL buffers may need to be shifted in.
+    // A buffer with the same frame number as an existing one replaces it.
+    void Insert(ZslBuffer zsl_buffer);
+
+    // Remove and return the buffer at index.
+    ZslBuffer Take(size_t index);
+
+    // Return the index of the buffer of frame_number, or Size() if there is
+    // none.
+    size_t FindFrameNumber(uint32_t frame_number) const;
+
+    // Return the index of the first buffer whose timestamp is valid and not
+    // less than timestamp, or Size() if there is none. Binary search unless
+    // some buffers have no timestamp.
+    size_t LowerBoundTimestamp(int64_t timestamp) const;
+
+    // Number of buffers whose flash state is FIRED.
+    size_t NumFlashFired() const {
+      return num_flash_fired_;
+    }
+
+   private:
+    size_t Slot(size_t index) const {
+      return (head_ + index) % slots_.size();
+    }
+
+    void UpdateCounters(const ZslBuffer& zsl_buffer, int32_t delta);
+
+    std::vector<ZslBuffer> slots_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+    size_t num_flash_fired_ = 0;
+    size_t num_invalid_timestamps_ = 0;
+  };
+
   bool allocated_ = false;
   std::mutex zsl_buffers_lock_;
 
   // Buffer manager for allocating the buffers. Protected by mZslBuffersLock.
   std::unique_ptr<IHalBufferAllocator> internal_buffer_allocator_;
 
+  // Shared internal buffer pool used if the client doesn't specify an
+  // allocator. Protected by mZslBuffersLock.
+  std::shared_ptr<InternalBufferPool> shared_buffer_pool_;
+
   // external buffer allocator
   IHalBufferAllocator* buffer_allocator_ = nullptr;
 
   // Empty ZSL buffer queue. Protected by mZslBuffersLock.
   std::deque<buffer_handle_t> empty_zsl_buffers_;
 
-  // Filled ZSL buffers. Map from frameNumber to ZslBuffer.
-  // Ordered from the oldest to the newest buffers.
+  // Filled ZSL buffers ordered from the oldest to the newest buffers.
   // Protected by mZslBuffersLock.
-  std::map<uint32_t, ZslBuffer> filled_zsl_buffers_;
+  FilledBufferRing filled_zsl_buffers_;
 
   // Partially filled ZSL buffers. Either the metadata or
   // the buffer is returned. Once the metadata and the buffer are both ready,
@@ -187,6 +263,12 @@ class ZslBufferManager {
 
   // Partial result count reported by camera HAL
   int partial_result_count_ = 1;
+
+  // Candidates offered to a selection policy. Reused across snapshots.
+  // Protected by selection_lock_.
+  std::mutex selection_lock_;
+  std::vector<ZslCandidate> selection_candidates_;
+  std::vector<size_t> selected_candidates_;
 };
 
 }  // namespace google_camera_hal
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "GCH_ZslSelectionPolicy"
+#define ATRACE_TAG ATRACE_TAG_CAMERA
+#include <inttypes.h>
+#include <log/log.h>
+#include <utils/Trace.h>
+
+#include <algorithm>
+
+#include "zsl_selection_policy.h"
+
+namespace android {
+namespace google_camera_hal {
+
+namespace {
+
+constexpr float kNsPerSec = 1e9f;
+
+// Whether any candidate fired flash while the candidate at ae_mode_index was
+// in auto flash mode. The realtime pipeline captures flash snapshots instead
+// of ZSL.
+bool HasAutoFlashFired(const std::vector<ZslCandidate>& candidates,
+                       size_t ae_mode_index) {
+  if (ae_mode_index >= candidates.size() ||
+      candidates[ae_mode_index].keys.ae_mode !=
+          ANDROID_CONTROL_AE_MODE_ON_AUTO_FLASH) {
+    return false;
+  }
+  return std::any_of(candidates.begin(), candidates.end(),
+                     [](const ZslCandidate& candidate) {
+                       return candidate.keys.flash_state ==
+                              ANDROID_FLASH_STATE_FIRED;
+                     });
+}
+
+}  // namespace
+
+ZslSelectionKeys ZslSelectionKeys::Parse(const HalCameraMetadata* metadata) {
+  ZslSelectionKeys keys;
+  if (metadata == nullptr) {
+    return keys;
+  }
+
+  camera_metadata_ro_entry entry = {};
+  if (metadata->Get(ANDROID_SENSOR_TIMESTAMP, &entry) == OK &&
+      entry.count == 1) {
+    keys.timestamp = entry.data.i64[0];
+  }
+  if (metadata->Get(ANDROID_SENSOR_EXPOSURE_TIME, &entry) == OK &&
+      entry.count == 1) {
+    keys.exposure_time = entry.data.i64[0];
+  }
+
+  auto get_enum = [metadata](uint32_t tag) {
+    camera_metadata_ro_entry entry = {};
+    if (metadata->Get(tag, &entry) == OK && entry.count == 1) {
+      return static_cast<int32_t>(entry.data.u8[0]);
+    }
+    return kInvalidEnum;
+  };
+  keys.ae_mode = get_enum(ANDROID_CONTROL_AE_MODE);
+  keys.ae_state = get_enum(ANDROID_CONTROL_AE_STATE);
+  keys.af_state = get_enum(ANDROID_CONTROL_AF_STATE);
+  keys.flash_state = get_enum(ANDROID_FLASH_STATE);
+  keys.lens_state = get_enum(ANDROID_LENS_STATE);
+  return keys;
+}
+
+void MostRecentZslSelectionPolicy::SelectBuffers(
+    const std::vector<ZslCandidate>& candidates, int64_t request_timestamp,
+    uint32_t num_buffers, std::vector<size_t>* selected) {
+  size_t first = candidates.size() - std::min<size_t>(candidates.size(),
+                                                       num_buffers);
+  if (selected == nullptr || HasAutoFlashFired(candidates, first)) {
+    return;
+  }
+
+  for (size_t i = first; i < candidates.size(); i++) {
+    int64_t timestamp = candidates[i].keys.timestamp;
+    if (timestamp != ZslSelectionKeys::kInvalidTimestamp &&
+        request_timestamp - timestamp < kMaxBufferAgeNs) {
+      selected->push_back(i);
+    }
+  }
+}
+
+std::unique_ptr<QualityZslSelectionPolicy> QualityZslSelectionPolicy::Create(
+    const Config& config, MotionFunc motion_func) {
+  if (config.max_buffer_age_ns <= 0 || config.default_angular_speed < 0) {
+    ALOGE("%s: Invalid config: max_buffer_age_ns %" PRId64
+          ", default_angular_speed %f",
+          __FUNCTION__, config.max_buffer_age_ns,
+          config.default_angular_speed);
+    return nullptr;
+  }
+
+  return std::unique_ptr<QualityZslSelectionPolicy>(
+      new QualityZslSelectionPolicy(config, std::move(motion_func)));
+}
+
+QualityZslSelectionPolicy::QualityZslSelectionPolicy(const Config& config,
+                                                     MotionFunc motion_func)
+    : config_(config), motion_func_(std::move(motion_func)) {
+}
+
+bool QualityZslSelectionPolicy::IsQualified(const ZslCandidate& candidate,
+                                            int64_t request_timestamp) const {
+  const ZslSelectionKeys& keys = candidate.keys;
+  if (keys.timestamp == ZslSelectionKeys::kInvalidTimestamp ||
+      request_timestamp - keys.timestamp > config_.max_buffer_age_ns) {
+    return false;
+  }
+
+  // Unknown states are accepted; not every HWL reports them.
+  if (config_.require_ae_converged &&
+      (keys.ae_state == ANDROID_CONTROL_AE_STATE_SEARCHING ||
+       keys.ae_state == ANDROID_CONTROL_AE_STATE_PRECAPTURE)) {
+    return false;
+  }
+
+  if (config_.require_af_converged &&
+      (keys.af_state == ANDROID_CONTROL_AF_STATE_PASSIVE_SCAN ||
+       keys.af_state == ANDROID_CONTROL_AF_STATE_ACTIVE_SCAN ||
+       keys.af_state == ANDROID_CONTROL_AF_STATE_PASSIVE_UNFOCUSED ||
+       keys.af_state == ANDROID_CONTROL_AF_STATE_NOT_FOCUSED_LOCKED)) {
+    return false;
+  }
+
+  if (config_.reject_lens_moving &&
+      keys.lens_state == ANDROID_LENS_STATE_MOVING) {
+    return false;
+  }
+
+  return true;
+}
+
+float QualityZslSelectionPolicy::GetBlurScore(
+    const ZslCandidate& candidate) const {
+  const ZslSelectionKeys& keys = candidate.keys;
+  float angular_speed = -1.0f;
+  if (motion_func_ != nullptr && keys.exposure_time > 0) {
+    angular_speed =
+        motion_func_(keys.timestamp, keys.timestamp + keys.exposure_time);
+  }
+  if (angular_speed < 0) {
+    angular_speed = config_.default_angular_speed;
+  }
+
+  return angular_speed * (keys.exposure_time / kNsPerSec);
+}
+
+void QualityZslSelectionPolicy::SelectBuffers(
+    const std::vector<ZslCandidate>& candidates, int64_t request_timestamp,
+    uint32_t num_buffers, std::vector<size_t>* selected) {
+  ATRACE_CALL();
+  if (selected == nullptr || num_buffers == 0 ||
+      HasAutoFlashFired(candidates, candidates.size() - 1)) {
+    return;
+  }
+
+  scored_candidates_.clear();
+  for (size_t i = 0; i < candidates.size(); i++) {
+    if (IsQualified(candidates[i], request_timestamp)) {
+      scored_candidates_.emplace_back(GetBlurScore(candidates[i]), i);
+    }
+  }
+
+  // Sharpest first; newer frames win ties to reduce shutter lag.
+  size_t num_selected =
+      std::min<size_t>(num_buffers, scored_candidates_.size());
+  std::partial_sort(scored_candidates_.begin(),
+                    scored_candidates_.begin() + num_selected,
+                    scored_candidates_.end(),
+                    [](const std::pair<float, size_t>& a,
+                       const std::pair<float, size_t>& b) {
+                      return a.first != b.first ? a.first < b.first
+                                                : a.second > b.second;
+                    });
+
+  size_t first = selected->size();
+  for (size_t i = 0; i < num_selected; i++) {
+    selected->push_back(scored_candidates_[i].second);
+  }
+  std::sort(selected->begin() + first, selected->end());
+
+  ALOGV("%s: Selected %zu of %zu candidates.", __FUNCTION__, num_selected,
+        candidates.size());
+}
+
+}  // namespace google_camera_hal
+}  // namespace android
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HARDWARE_GOOGLE_CAMERA_HAL_UTILS_ZSL_SELECTION_POLICY_H
+#define HARDWARE_GOOGLE_CAMERA_HAL_UTILS_ZSL_SELECTION_POLICY_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "hal_types.h"
+
+namespace android {
+namespace google_camera_hal {
+
+// Result metadata of a ZSL buffer that snapshot selection looks at. Parsed
+// once when the buffer is filled so selection does not scan metadata tags.
+struct ZslSelectionKeys {
+  // ANDROID_SENSOR_TIMESTAMP, or kInvalidTimestamp if absent.
+  int64_t timestamp = kInvalidTimestamp;
+  // ANDROID_SENSOR_EXPOSURE_TIME, or 0 if absent.
+  int64_t exposure_time = 0;
+  // Enum values of the following tags, or kInvalidEnum if absent.
+  int32_t ae_mode = kInvalidEnum;      // ANDROID_CONTROL_AE_MODE
+  int32_t ae_state = kInvalidEnum;     // ANDROID_CONTROL_AE_STATE
+  int32_t af_state = kInvalidEnum;     // ANDROID_CONTROL_AF_STATE
+  int32_t flash_state = kInvalidEnum;  // ANDROID_FLASH_STATE
+  int32_t lens_state = kInvalidEnum;   // ANDROID_LENS_STATE
+
+  static constexpr int64_t kInvalidTimestamp = -1;
+  static constexpr int32_t kInvalidEnum = -1;
+
+  // Parse the keys from metadata. metadata can be nullptr.
+  static ZslSelectionKeys Parse(const HalCameraMetadata* metadata);
+};
+
+// A filled ZSL buffer offered to a ZslSelectionPolicy.
+struct ZslCandidate {
+  uint32_t frame_number = 0;
+  ZslSelectionKeys keys;
+};
+
+// ZslSelectionPolicy decides which ZSL buffers a snapshot request uses.
+// Policies only look at candidates and must not block; they are called on the
+// snapshot request path.
+class ZslSelectionPolicy {
+ public:
+  virtual ~ZslSelectionPolicy() = default;
+
+  // Select up to num_buffers candidates for a snapshot requested at
+  // request_timestamp (CLOCK_BOOTTIME). candidates are ordered from the
+  // oldest to the newest frame. Indices of the selected candidates are
+  // appended to selected in ascending order. Selecting nothing makes the
+  // caller fall back to a realtime capture.
+  virtual void SelectBuffers(const std::vector<ZslCandidate>& candidates,
+                             int64_t request_timestamp, uint32_t num_buffers,
+                             std::vector<size_t>* selected) = 0;
+};
+
+// Selects the most recent buffers captured within a second of the request,
+// and nothing if a frame fired flash under AE_MODE_ON_AUTO_FLASH. This is
+// what ZslBufferManager does when no policy is given.
+class MostRecentZslSelectionPolicy : public ZslSelectionPolicy {
+ public:
+  void SelectBuffers(const std::vector<ZslCandidate>& candidates,
+                     int64_t request_timestamp, uint32_t num_buffers,
+                     std::vector<size_t>* selected) override;
+
+ private:
+  static constexpr int64_t kMaxBufferAgeNs = 1000000000;  // 1 second
+};
+
+// Scores candidates by expected motion blur and selects the sharpest ones
+// that are converged and captured within a latency budget.
+class QualityZslSelectionPolicy : public ZslSelectionPolicy {
+ public:
+  struct Config {
+    // Candidates older than this relative to the request are not considered.
+    int64_t max_buffer_age_ns = 500000000;  // 500 ms
+    // Reject candidates whose AE is still searching.
+    bool require_ae_converged = true;
+    // Reject candidates whose AF is scanning or failed to focus.
+    bool require_af_converged = true;
+    // Reject candidates captured while the lens was moving.
+    bool reject_lens_moving = true;
+    // Angular speed in rad/s assumed when there is no motion data.
+    float default_angular_speed = 0.05f;
+  };
+
+  // Return the mean gyro angular speed in rad/s between start_time and
+  // end_time (CLOCK_BOOTTIME), or a negative value if unknown. It can be
+  // backed by GoogSensorMotion gyro samples.
+  using MotionFunc =
+      std::function<float(int64_t start_time, int64_t end_time)>;
+
+  // motion_func is optional.
+  static std::unique_ptr<QualityZslSelectionPolicy> Create(
+      const Config& config, MotionFunc motion_func = nullptr);
+
+  void SelectBuffers(const std::vector<ZslCandidate>& candidates,
+                     int64_t request_timestamp, uint32_t num_buffers,
+                     std::vector<size_t>* selected) override;
+
+  // Whether a candidate may be selected for a request at request_timestamp.
+  bool IsQualified(const ZslCandidate& candidate,
+                   int64_t request_timestamp) const;
+
+  // Expected blur of a candidate, in radians of camera rotation during the
+  // exposure. Lower is sharper.
+  float GetBlurScore(const ZslCandidate& candidate) const;
+
+ protected:
+  QualityZslSelectionPolicy(const Config& config, MotionFunc motion_func);
+
+ private:
+  const Config config_;
+  MotionFunc motion_func_;
+
+  // Scratch storage reused across requests.
+  std::vector<std::pair<float, size_t>> scored_candidates_;
+};
+
+}  // namespace google_camera_hal
+}  // namespace android
+
+#endif  // HARDWARE_GOOGLE_CAMERA_HAL_UTILS_ZSL_SELECTION_POLICY_H
@@ -40,6 +40,12 @@ class DepthGenerator {
   virtual void SetResultCallback(DepthResultCallbackFunction) = 0;
 };
 typedef DepthGenerator* (*CreateDepthGenerator_t)();
+
+// Optionally exported by a depth generator library as
+// "GetDepthGeneratorMaxConcurrentRequests". It returns the number of
+// ExecuteProcessRequest calls that can run concurrently on one DepthGenerator.
+// A library that does not export it is treated as non-reentrant.
+typedef uint32_t (*GetDepthGeneratorMaxConcurrentRequests_t)();
 }  // namespace depth_generator
 }  // namespace android
 #endif  // HARDWARE_GOOGLE_CAMERA_LIB_DEPTH_GENERATOR_H_
\ No newline at end of file
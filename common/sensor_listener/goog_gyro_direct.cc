@@ -23,6 +23,8 @@
 #include <utils/Log.h>
 #include <utils/SystemClock.h>
 
+#include <cstring>
+
 #include "goog_gralloc_wrapper.h"
 
 #include "goog_gyro_direct.h"
@@ -46,7 +48,11 @@ GoogGyroDirect::GoogGyroDirect(RateLevel rate_level,
       gyro_direct_buf_length_(gyro_direct_buf_length),
       goog_gralloc_wrapper_ptr_(nullptr),
       gyro_direct_channel_native_buf_handle_(nullptr),
-      gyro_direct_channel_addr_(nullptr) {
+      gyro_direct_channel_addr_(nullptr),
+      gyro_event_snapshot_(
+          static_cast<size_t>(SensorsEventFormatOffset::TOTAL_LENGTH) *
+          gyro_direct_buf_length),
+      gyro_samples_(gyro_direct_buf_length) {
   goog_gralloc_wrapper_ptr_ = std::make_unique<GoogGrallocWrapper>();
 }
 
@@ -99,6 +105,7 @@ status_t GoogGyroDirect::DisableDirectChannel() {
                                     [](const auto&, auto) {});
     gyro_direct_enabled_ = false;
   }
+  ResetGyroSamples();
   return OK;
 }
 
@@ -194,65 +201,150 @@ status_t GoogGyroDirect::EnableDirectChannel() {
       });
 
   gyro_direct_enabled_ = true;
+  ResetGyroSamples();
 
   ALOGV("%s %d Direct sensor mdoe: %d %d", __func__, __LINE__,
         gyro_direct_initialized_, gyro_direct_enabled_);
   return OK;
 }
 
-void GoogGyroDirect::QueryGyroEventsBetweenTimestamps(
-    int64_t start_time, int64_t end_time,
-    std::vector<int64_t>* event_timestamps, std::vector<float>* motion_vector_x,
-    std::vector<float>* motion_vector_y, std::vector<float>* motion_vector_z,
-    std::vector<int64_t>* event_arrival_timestamps) const {
-  event_timestamps->clear();
-  motion_vector_x->clear();
-  motion_vector_y->clear();
-  motion_vector_z->clear();
-  event_arrival_timestamps->clear();
-
+bool GoogGyroDirect::UpdateGyroSamplesLocked() const {
   if (gyro_direct_channel_addr_ == nullptr) {
-    return;
+    gyro_samples_.Clear();
+    next_read_pos_ = -1;
+    return false;
+  }
+
+  const sensors_event_t* channel_events =
+      reinterpret_cast<const sensors_event_t*>(gyro_direct_channel_addr_);
+  int num_events = gyro_direct_buf_length_;
+  if (next_read_pos_ >= 0) {
+    // If the last event read is gone, the sensor hub wrapped around the
+    // buffer since the last update and the events left can't be ordered
+    // from the read position.
+    int last_read_pos = (next_read_pos_ + num_events - 1) % num_events;
+    sensors_event_t last_read_event;
+    memcpy(&last_read_event, &channel_events[last_read_pos],
+           sizeof(last_read_event));
+    if (last_read_event.timestamp != gyro_samples_.LatestTimestamp()) {
+      next_read_pos_ = -1;
+    }
+  }
+  if (next_read_pos_ < 0) {
+    RebuildGyroSamplesLocked();
+    return true;
+  }
+
+  // Copy events one by one to a local copy as lock is lacking.
+  int64_t event_arrival_time = elapsedRealtimeNano();
+  int64_t last_timestamp = gyro_samples_.LatestTimestamp();
+  for (int i = 0; i < num_events; ++i) {
+    sensors_event_t event;
+    memcpy(&event, &channel_events[next_read_pos_], sizeof(event));
+    // Stop at the write position of the sensor hub.
+    if (event.timestamp <= last_timestamp) {
+      break;
+    }
+    gyro_samples_.Push(event.timestamp, event.data[0], event.data[1],
+                       event.data[2], event_arrival_time);
+    last_timestamp = event.timestamp;
+    next_read_pos_ = (next_read_pos_ + 1) % num_events;
   }
-  sensors_event_t* buffer_head_ptr =
-      reinterpret_cast<sensors_event_t*>(gyro_direct_channel_addr_);
+  return true;
+}
+
+void GoogGyroDirect::RebuildGyroSamplesLocked() const {
+  gyro_samples_.Clear();
+  next_read_pos_ = -1;
 
   // Copy shared buffer content to local buffer as lock is lacking.
-  std::vector<sensors_event_t> event_vector;
-  event_vector.insert(event_vector.begin(), buffer_head_ptr,
-                      buffer_head_ptr + gyro_direct_buf_length_);
+  memcpy(gyro_event_snapshot_.data(), gyro_direct_channel_addr_,
+         gyro_event_snapshot_.size());
+  const sensors_event_t* events =
+      reinterpret_cast<const sensors_event_t*>(gyro_event_snapshot_.data());
 
   int64_t event_arrival_time = elapsedRealtimeNano();
   int64_t earliest_timestamp = LLONG_MAX;
   int head_pos = -1;
-  int num_events = event_vector.size();
+  int num_events = gyro_direct_buf_length_;
   for (int i = 0; i < num_events; ++i) {
-    if (event_vector[i].timestamp != 0 &&
-        event_vector[i].timestamp < earliest_timestamp) {
-      earliest_timestamp = event_vector[i].timestamp;
+    if (events[i].timestamp != 0 && events[i].timestamp < earliest_timestamp) {
+      earliest_timestamp = events[i].timestamp;
       head_pos = i;
     }
   }
-
-  // Fill events within timestamps range to output vectors.
   if (head_pos == -1) {
     return;
   }
-  for (int i = 0; i < num_events; ++i) {
-    int index = (head_pos + i) % num_events;
-    if (event_vector[index].timestamp <= start_time) {
-      continue;
-    }
-    if (event_vector[index].timestamp > end_time) {
+
+  int64_t last_timestamp = 0;
+  int i = 0;
+  for (; i < num_events; ++i) {
+    const sensors_event_t& event = events[(head_pos + i) % num_events];
+    // Stop at unwritten slots or at the write position of the sensor hub.
+    if (event.timestamp <= last_timestamp) {
       break;
     }
+    gyro_samples_.Push(event.timestamp, event.data[0], event.data[1],
+                       event.data[2], event_arrival_time);
+    last_timestamp = event.timestamp;
+  }
+  next_read_pos_ = (head_pos + i) % num_events;
+}
+
+void GoogGyroDirect::ResetGyroSamples() {
+  std::lock_guard<std::mutex> l(gyro_samples_lock_);
+  gyro_samples_.Clear();
+  next_read_pos_ = -1;
+}
+
+void GoogGyroDirect::QueryGyroEventsBetweenTimestamps(
+    int64_t start_time, int64_t end_time,
+    std::vector<int64_t>* event_timestamps, std::vector<float>* motion_vector_x,
+    std::vector<float>* motion_vector_y, std::vector<float>* motion_vector_z,
+    std::vector<int64_t>* event_arrival_timestamps) const {
+  std::lock_guard<std::mutex> l(gyro_samples_lock_);
+  UpdateGyroSamplesLocked();
+
+  // Size outputs for the samples in the queried range only.
+  size_t capacity = gyro_samples_.CountBetweenTimestamps(start_time, end_time);
+  event_timestamps->resize(capacity);
+  motion_vector_x->resize(capacity);
+  motion_vector_y->resize(capacity);
+  motion_vector_z->resize(capacity);
+  event_arrival_timestamps->resize(capacity);
+  MotionSampleBuffer buffer = {
+      .timestamps = event_timestamps->data(),
+      .x = motion_vector_x->data(),
+      .y = motion_vector_y->data(),
+      .z = motion_vector_z->data(),
+      .arrival_timestamps = event_arrival_timestamps->data(),
+      .capacity = capacity,
+  };
+  gyro_samples_.CopyBetweenTimestamps(start_time, end_time, &buffer);
+}
+
+size_t GoogGyroDirect::QueryGyroEventsBetweenTimestamps(
+    int64_t start_time, int64_t end_time, MotionSampleBuffer* out) const {
+  std::lock_guard<std::mutex> l(gyro_samples_lock_);
+  if (!UpdateGyroSamplesLocked()) {
+    return 0;
+  }
+  return gyro_samples_.CopyBetweenTimestamps(start_time, end_time, out);
+}
 
-    event_timestamps->push_back(event_vector[index].timestamp);
-    motion_vector_x->push_back(event_vector[index].data[0]);
-    motion_vector_y->push_back(event_vector[index].data[1]);
-    motion_vector_z->push_back(event_vector[index].data[2]);
-    event_arrival_timestamps->push_back(event_arrival_time);
+size_t GoogGyroDirect::InterpolateGyroEvents(const int64_t* query_timestamps,
+                                             size_t num_query,
+                                             float* motion_vector_x,
+                                             float* motion_vector_y,
+                                             float* motion_vector_z) const {
+  std::lock_guard<std::mutex> l(gyro_samples_lock_);
+  if (!UpdateGyroSamplesLocked()) {
+    return 0;
   }
+  return gyro_samples_.Interpolate(query_timestamps, num_query,
+                                   motion_vector_x, motion_vector_y,
+                                   motion_vector_z);
 }
 
 }  // namespace camera_sensor_listener
@@ -20,7 +20,10 @@
 #include <android/frameworks/sensorservice/1.0/ISensorManager.h>
 #include <android/hardware/sensors/1.0/types.h>
 
+#include <mutex>
+
 #include "goog_gralloc_wrapper.h"
+#include "goog_motion_sample_ring.h"
 
 namespace android {
 namespace camera_sensor_listener {
@@ -102,6 +105,25 @@ class GoogGyroDirect {
       std::vector<float>* motion_vector_z,
       std::vector<int64_t>* event_arrival_timestamps) const;
 
+  // Allocation-free variant of QueryGyroEventsBetweenTimestamps.
+  // Copy gyro events in range (start_time, end_time] into the caller provided
+  // buffer, in chronological order. If out is too small, the earliest
+  // out->capacity events in the range are copied.
+  // Return the number of events copied.
+  size_t QueryGyroEventsBetweenTimestamps(int64_t start_time, int64_t end_time,
+                                          MotionSampleBuffer* out) const;
+
+  // Linearly interpolate gyro data at timestamps sorted ascending, e.g. the
+  // readout time of each sensor row for rolling shutter correction.
+  // motion_vector_x, motion_vector_y, motion_vector_z must hold at least
+  // num_query entries. Timestamps outside of available events are clamped to
+  // the earliest or latest event.
+  // Return the number of interpolated samples, 0 if no event is available.
+  size_t InterpolateGyroEvents(const int64_t* query_timestamps,
+                               size_t num_query, float* motion_vector_x,
+                               float* motion_vector_y,
+                               float* motion_vector_z) const;
+
   // Enable GoogGyroDirect to query events from direct channel.
   // Return 0 on success.
   status_t EnableDirectChannel();
@@ -120,6 +142,21 @@ class GoogGyroDirect {
   GoogGyroDirect(::android::hardware::sensors::V1_0::RateLevel rate_level,
                  size_t gyro_direct_buf_length);
 
+  // Append the gyro events written to the shared direct channel buffer since
+  // the last update to gyro_samples_, reading only the new events. The whole
+  // buffer is only scanned on the first update, or when the sensor hub wrote
+  // over events that weren't read yet.
+  // Return false if direct channel buffer is not available.
+  bool UpdateGyroSamplesLocked() const;
+
+  // Snapshot the shared direct channel buffer into gyro_event_snapshot_ and
+  // rebuild gyro_samples_ from it in chronological order.
+  void RebuildGyroSamplesLocked() const;
+
+  // Forget the read position in the direct channel buffer, e.g. when the
+  // channel is reconfigured and the sensor hub restarts writing.
+  void ResetGyroSamples();
+
   // Whether gyro direct channel buffer is initialized.
   bool gyro_direct_initialized_;
 
@@ -149,6 +186,20 @@ class GoogGyroDirect {
   // Gyro sensor info.
   ::android::hardware::sensors::V1_0::SensorInfo sensor_info_;
 
+  // Lock protecting gyro_event_snapshot_ and gyro_samples_.
+  mutable std::mutex gyro_samples_lock_;
+
+  // Preallocated local copy of the shared buffer, as the shared buffer is
+  // written by the sensor hub without a lock.
+  mutable std::vector<uint8_t> gyro_event_snapshot_;
+
+  // Timestamp-indexed gyro events read from the shared buffer.
+  mutable MotionSampleRing gyro_samples_;
+
+  // Slot of the shared buffer the next event is read from, -1 if the buffer
+  // hasn't been read yet.
+  mutable int next_read_pos_ = -1;
+
   // Default sensor event queue size is set to 20.
   static constexpr size_t kDefaultEventQueueSize = 20;
 
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "goog_motion_sample_ring.h"
+
+#include <algorithm>
+
+namespace android {
+namespace camera_sensor_listener {
+
+MotionSampleRing::MotionSampleRing(size_t capacity)
+    : capacity_(capacity),
+      timestamps_(capacity),
+      x_(capacity),
+      y_(capacity),
+      z_(capacity),
+      arrival_timestamps_(capacity) {
+}
+
+void MotionSampleRing::Push(int64_t timestamp, float x, float y, float z,
+                            int64_t arrival_timestamp) {
+  if (capacity_ == 0) {
+    return;
+  }
+  size_t slot;
+  if (size_ < capacity_) {
+    slot = Slot(size_);
+    size_++;
+  } else {
+    slot = head_;
+    head_ = Slot(1);
+  }
+  timestamps_[slot] = timestamp;
+  x_[slot] = x;
+  y_[slot] = y;
+  z_[slot] = z;
+  arrival_timestamps_[slot] = arrival_timestamp;
+}
+
+void MotionSampleRing::Clear() {
+  head_ = 0;
+  size_ = 0;
+}
+
+size_t MotionSampleRing::UpperBound(int64_t timestamp) const {
+  size_t low = 0;
+  size_t high = size_;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (TimestampAt(mid) <= timestamp) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+void MotionSampleRing::CopyRange(size_t first, size_t num_sample,
+                                 MotionSampleBuffer* out) const {
+  // A logical range maps to at most two contiguous physical segments.
+  size_t copied = 0;
+  while (copied < num_sample) {
+    size_t slot = Slot(first + copied);
+    size_t count = std::min(num_sample - copied, capacity_ - slot);
+    std::copy_n(&timestamps_[slot], count, out->timestamps + copied);
+    std::copy_n(&x_[slot], count, out->x + copied);
+    std::copy_n(&y_[slot], count, out->y + copied);
+    std::copy_n(&z_[slot], count, out->z + copied);
+    if (out->arrival_timestamps != nullptr) {
+      std::copy_n(&arrival_timestamps_[slot], count,
+                  out->arrival_timestamps + copied);
+    }
+    copied += count;
+  }
+}
+
+size_t MotionSampleRing::CopyLatest(size_t num_sample,
+                                    MotionSampleBuffer* out) const {
+  if (out == nullptr) {
+    return 0;
+  }
+  size_t count = std::min({num_sample, size_, out->capacity});
+  CopyRange(size_ - count, count, out);
+  return count;
+}
+
+size_t MotionSampleRing::CountBetweenTimestamps(int64_t start_time,
+                                                int64_t end_time) const {
+  if (size_ == 0 || start_time >= end_time) {
+    return 0;
+  }
+  return UpperBound(end_time) - UpperBound(start_time);
+}
+
+size_t MotionSampleRing::CopyBetweenTimestamps(int64_t start_time,
+                                               int64_t end_time,
+                                               MotionSampleBuffer* out) const {
+  if (out == nullptr || size_ == 0 || start_time >= end_time) {
+    return 0;
+  }
+  size_t first = UpperBound(start_time);
+  size_t last = UpperBound(end_time);
+  size_t count = std::min(last - first, out->capacity);
+  CopyRange(first, count, out);
+  return count;
+}
+
+size_t MotionSampleRing::Interpolate(const int64_t* query_timestamps,
+                                     size_t num_query, float* x, float* y,
+                                     float* z) const {
+  if (size_ == 0 || query_timestamps == nullptr || x == nullptr ||
+      y == nullptr || z == nullptr) {
+    return 0;
+  }
+
+  // Queries are sorted, so only the first one needs a binary search; the
+  // rest advance the bracketing index monotonically.
+  size_t next = num_query > 0 ? UpperBound(query_timestamps[0]) : 0;
+  for (size_t i = 0; i < num_query; i++) {
+    int64_t t = query_timestamps[i];
+    while (next < size_ && TimestampAt(next) <= t) {
+      next++;
+    }
+
+    if (next == 0 || next == size_) {
+      size_t slot = Slot(next == 0 ? 0 : size_ - 1);
+      x[i] = x_[slot];
+      y[i] = y_[slot];
+      z[i] = z_[slot];
+      continue;
+    }
+
+    size_t slot0 = Slot(next - 1);
+    size_t slot1 = Slot(next);
+    int64_t t0 = timestamps_[slot0];
+    int64_t t1 = timestamps_[slot1];
+    float w = t1 > t0 ? static_cast<float>(t - t0) / static_cast<float>(t1 - t0)
+                      : 0.f;
+    x[i] = x_[slot0] + w * (x_[slot1] - x_[slot0]);
+    y[i] = y_[slot0] + w * (y_[slot1] - y_[slot0]);
+    z[i] = z_[slot0] + w * (z_[slot1] - z_[slot0]);
+  }
+  return num_query;
+}
+
+}  // namespace camera_sensor_listener
+}  // namespace android
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VENDOR_GOOGLE_CAMERA_SENSOR_LISTENER_GOOG_MOTION_SAMPLE_RING_H_
+#define VENDOR_GOOGLE_CAMERA_SENSOR_LISTENER_GOOG_MOTION_SAMPLE_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace android {
+namespace camera_sensor_listener {
+
+// Caller-owned, fixed-capacity structure-of-arrays buffer that motion sample
+// queries copy into. All arrays must hold at least capacity elements.
+// arrival_timestamps may be nullptr if the caller does not need them.
+struct MotionSampleBuffer {
+  int64_t* timestamps = nullptr;
+  float* x = nullptr;
+  float* y = nullptr;
+  float* z = nullptr;
+  int64_t* arrival_timestamps = nullptr;
+  size_t capacity = 0;
+};
+
+// Fixed-capacity ring of motion samples stored as structure of arrays and
+// indexed by event timestamp.
+// Samples must be pushed in chronological order, which is how sensor service
+// and direct channels deliver them. Once the ring is full the oldest sample
+// is overwritten. All storage is allocated at construction; pushing and
+// querying never allocate.
+// MotionSampleRing is not thread-safe. Callers must serialize access.
+class MotionSampleRing {
+ public:
+  explicit MotionSampleRing(size_t capacity);
+
+  // Append a sample, overwriting the oldest one if the ring is full.
+  void Push(int64_t timestamp, float x, float y, float z,
+            int64_t arrival_timestamp);
+
+  // Remove all samples.
+  void Clear();
+
+  size_t Size() const {
+    return size_;
+  }
+
+  size_t Capacity() const {
+    return capacity_;
+  }
+
+  // Copy the latest min(num_sample, Size(), out->capacity) samples into out,
+  // in chronological order. Returns the number of samples copied.
+  size_t CopyLatest(size_t num_sample, MotionSampleBuffer* out) const;
+
+  // Return the number of samples with timestamps in range
+  // (start_time, end_time], in O(log n).
+  size_t CountBetweenTimestamps(int64_t start_time, int64_t end_time) const;
+
+  // Return the timestamp of the latest sample, or 0 if the ring is empty.
+  int64_t LatestTimestamp() const {
+    return size_ > 0 ? TimestampAt(size_ - 1) : 0;
+  }
+
+  // Copy samples with timestamps in range (start_time, end_time] into out, in
+  // chronological order. Range bounds are binary searched so the cost is
+  // O(log n + k) for k returned samples. If out is too small, the earliest
+  // out->capacity samples in the range are copied. Returns the number of
+  // samples copied.
+  size_t CopyBetweenTimestamps(int64_t start_time, int64_t end_time,
+                               MotionSampleBuffer* out) const;
+
+  // Linearly interpolate x, y, z at each of num_query timestamps in
+  // query_timestamps, e.g. the exposure start time of each sensor row for
+  // rolling shutter correction. query_timestamps must be sorted ascending.
+  // Queries outside of the ring's time span are clamped to the first or last
+  // sample. Returns the number of queries written, which is 0 if the ring is
+  // empty and num_query otherwise.
+  size_t Interpolate(const int64_t* query_timestamps, size_t num_query,
+                     float* x, float* y, float* z) const;
+
+ private:
+  // Map a logical index (0 is the oldest sample) to a physical slot.
+  size_t Slot(size_t logical_index) const {
+    size_t slot = head_ + logical_index;
+    return slot >= capacity_ ? slot - capacity_ : slot;
+  }
+
+  int64_t TimestampAt(size_t logical_index) const {
+    return timestamps_[Slot(logical_index)];
+  }
+
+  // Return the logical index of the first sample whose timestamp is greater
+  // than timestamp, or Size() if there is none.
+  size_t UpperBound(int64_t timestamp) const;
+
+  // Copy num_sample samples starting at logical index first into out.
+  void CopyRange(size_t first, size_t num_sample,
+                 MotionSampleBuffer* out) const;
+
+  const size_t capacity_;
+  // Physical slot of the oldest sample.
+  size_t head_ = 0;
+  size_t size_ = 0;
+
+  std::vector<int64_t> timestamps_;
+  std::vector<float> x_;
+  std::vector<float> y_;
+  std::vector<float> z_;
+  std::vector<int64_t> arrival_timestamps_;
+};
+
+}  // namespace camera_sensor_listener
+}  // namespace android
+
+#endif  // VENDOR_GOOGLE_CAMERA_SENSOR_LISTENER_GOOG_MOTION_SAMPLE_RING_H_
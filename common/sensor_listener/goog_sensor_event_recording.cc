@@ -0,0 +1,350 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "goog_sensor_event_recording"
+
+#include "goog_sensor_event_recording.h"
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utils/Log.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace android {
+namespace camera_sensor_listener {
+
+using ::android::hardware::sensors::V1_0::SensorType;
+
+static_assert(sizeof(::android::hardware::sensors::V1_0::EventPayload) ==
+                  sizeof(GoogSensorEventRecord::payload),
+              "EventPayload size mismatch");
+
+namespace {
+
+size_t GetFileSize(uint64_t num_records) {
+  return sizeof(GoogSensorEventFileHeader) +
+         num_records * sizeof(GoogSensorEventRecord);
+}
+
+}  // namespace
+
+std::shared_ptr<GoogSensorEventRecorder> GoogSensorEventRecorder::Create(
+    const std::string& file_path) {
+  int fd = open(file_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  if (fd < 0) {
+    ALOGE("%s %d opening %s failed: %s", __func__, __LINE__, file_path.c_str(),
+          strerror(errno));
+    return nullptr;
+  }
+
+  auto recorder =
+      std::shared_ptr<GoogSensorEventRecorder>(new GoogSensorEventRecorder(fd));
+  // The lock must be released before a failed recorder is destroyed.
+  bool initialized = false;
+  {
+    std::lock_guard<std::mutex> l(recorder->lock_);
+    if (recorder->EnsureCapacityLocked(kGrowRecords) == OK) {
+      auto header =
+          reinterpret_cast<GoogSensorEventFileHeader*>(recorder->mapped_addr_);
+      header->magic = kGoogSensorEventFileMagic;
+      header->version = kGoogSensorEventFileVersion;
+      header->record_size = sizeof(GoogSensorEventRecord);
+      header->reserved = 0;
+      header->num_records = 0;
+      initialized = true;
+    }
+  }
+  return initialized ? recorder : nullptr;
+}
+
+GoogSensorEventRecorder::GoogSensorEventRecorder(int fd) : fd_(fd) {
+}
+
+GoogSensorEventRecorder::~GoogSensorEventRecorder() {
+  std::lock_guard<std::mutex> l(lock_);
+  if (mapped_addr_ != nullptr) {
+    uint64_t num_records =
+        reinterpret_cast<GoogSensorEventFileHeader*>(mapped_addr_)->num_records;
+    munmap(mapped_addr_, mapped_size_);
+    mapped_addr_ = nullptr;
+    if (ftruncate(fd_, GetFileSize(num_records)) != 0) {
+      ALOGW("%s %d trimming recording failed: %s", __func__, __LINE__,
+            strerror(errno));
+    }
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+status_t GoogSensorEventRecorder::EnsureCapacityLocked(uint64_t num_records) {
+  size_t required_size = GetFileSize(num_records);
+  if (required_size <= mapped_size_) {
+    return OK;
+  }
+
+  uint64_t grown_records =
+      (num_records + kGrowRecords - 1) / kGrowRecords * kGrowRecords;
+  size_t new_size = GetFileSize(grown_records);
+  if (ftruncate(fd_, new_size) != 0) {
+    ALOGE("%s %d growing recording to %zu bytes failed: %s", __func__,
+          __LINE__, new_size, strerror(errno));
+    return NO_MEMORY;
+  }
+
+  void* new_addr;
+  if (mapped_addr_ == nullptr) {
+    new_addr =
+        mmap(nullptr, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  } else {
+    new_addr = mremap(mapped_addr_, mapped_size_, new_size, MREMAP_MAYMOVE);
+  }
+  if (new_addr == MAP_FAILED) {
+    ALOGE("%s %d mapping %zu bytes failed: %s", __func__, __LINE__, new_size,
+          strerror(errno));
+    return NO_MEMORY;
+  }
+  mapped_addr_ = reinterpret_cast<uint8_t*>(new_addr);
+  mapped_size_ = new_size;
+  return OK;
+}
+
+status_t GoogSensorEventRecorder::Append(const ExtendedSensorEvent& event) {
+  std::lock_guard<std::mutex> l(lock_);
+  if (mapped_addr_ == nullptr) {
+    return NO_INIT;
+  }
+  uint64_t num_records =
+      reinterpret_cast<GoogSensorEventFileHeader*>(mapped_addr_)->num_records;
+  status_t res = EnsureCapacityLocked(num_records + 1);
+  if (res != OK) {
+    return res;
+  }
+
+  auto header = reinterpret_cast<GoogSensorEventFileHeader*>(mapped_addr_);
+  auto record = reinterpret_cast<GoogSensorEventRecord*>(
+      mapped_addr_ + sizeof(GoogSensorEventFileHeader));
+  GoogSensorEventRecord& new_record = record[num_records];
+  new_record.timestamp = event.sensor_event.timestamp;
+  new_record.event_arrival_time_ns = event.event_arrival_time_ns;
+  new_record.sensor_handle = event.sensor_event.sensorHandle;
+  new_record.sensor_type = static_cast<int32_t>(event.sensor_event.sensorType);
+  memcpy(new_record.payload, &event.sensor_event.u, sizeof(new_record.payload));
+  // Publish the record only after it is complete.
+  header->num_records = num_records + 1;
+  return OK;
+}
+
+uint64_t GoogSensorEventRecorder::GetNumRecords() const {
+  std::lock_guard<std::mutex> l(lock_);
+  if (mapped_addr_ == nullptr) {
+    return 0;
+  }
+  return reinterpret_cast<GoogSensorEventFileHeader*>(mapped_addr_)
+      ->num_records;
+}
+
+std::unique_ptr<GoogSensorEventRecording> GoogSensorEventRecording::Open(
+    const std::string& file_path) {
+  int fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    ALOGE("%s %d opening %s failed: %s", __func__, __LINE__, file_path.c_str(),
+          strerror(errno));
+    return nullptr;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 ||
+      static_cast<size_t>(file_stat.st_size) <
+          sizeof(GoogSensorEventFileHeader)) {
+    ALOGE("%s %d %s is not a sensor event recording", __func__, __LINE__,
+          file_path.c_str());
+    close(fd);
+    return nullptr;
+  }
+
+  size_t file_size = file_stat.st_size;
+  void* addr = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    ALOGE("%s %d mapping %s failed: %s", __func__, __LINE__, file_path.c_str(),
+          strerror(errno));
+    return nullptr;
+  }
+
+  auto header = reinterpret_cast<const GoogSensorEventFileHeader*>(addr);
+  if (header->magic != kGoogSensorEventFileMagic ||
+      header->version != kGoogSensorEventFileVersion ||
+      header->record_size != sizeof(GoogSensorEventRecord)) {
+    ALOGE("%s %d %s has unsupported format (magic 0x%x version %u)", __func__,
+          __LINE__, file_path.c_str(), header->magic, header->version);
+    munmap(addr, file_size);
+    return nullptr;
+  }
+
+  // Tolerate recordings whose header was not trimmed, e.g. after a crash.
+  size_t num_records = std::min<uint64_t>(
+      header->num_records,
+      (file_size - sizeof(GoogSensorEventFileHeader)) /
+          sizeof(GoogSensorEventRecord));
+  auto records = reinterpret_cast<const GoogSensorEventRecord*>(
+      reinterpret_cast<const uint8_t*>(addr) +
+      sizeof(GoogSensorEventFileHeader));
+  return std::unique_ptr<GoogSensorEventRecording>(
+      new GoogSensorEventRecording(addr, file_size, records, num_records));
+}
+
+GoogSensorEventRecording::GoogSensorEventRecording(
+    void* mapped_addr, size_t mapped_size, const GoogSensorEventRecord* records,
+    size_t num_records)
+    : mapped_addr_(mapped_addr),
+      mapped_size_(mapped_size),
+      records_(records),
+      num_records_(num_records) {
+}
+
+GoogSensorEventRecording::~GoogSensorEventRecording() {
+  munmap(mapped_addr_, mapped_size_);
+}
+
+ExtendedSensorEvent GoogSensorEventRecording::ToExtendedSensorEvent(
+    const GoogSensorEventRecord& record) {
+  ExtendedSensorEvent event;
+  memset(&event, 0, sizeof(event));
+  event.sensor_event.timestamp = record.timestamp;
+  event.sensor_event.sensorHandle = record.sensor_handle;
+  event.sensor_event.sensorType = static_cast<SensorType>(record.sensor_type);
+  memcpy(&event.sensor_event.u, record.payload, sizeof(record.payload));
+  event.event_arrival_time_ns = record.event_arrival_time_ns;
+  return event;
+}
+
+std::unique_ptr<GoogSensorEventPlayer> GoogSensorEventPlayer::Create(
+    std::shared_ptr<GoogSensorEventRecording> recording, int32_t sensor_handle,
+    float playback_speed) {
+  if (recording == nullptr || playback_speed < 0) {
+    ALOGE("%s %d invalid recording or playback speed %f", __func__, __LINE__,
+          playback_speed);
+    return nullptr;
+  }
+  return std::unique_ptr<GoogSensorEventPlayer>(new GoogSensorEventPlayer(
+      std::move(recording), sensor_handle, playback_speed));
+}
+
+int32_t GoogSensorEventPlayer::FindSensorHandle(
+    const GoogSensorEventRecording& recording, SensorType sensor_type) {
+  int32_t type = static_cast<int32_t>(sensor_type);
+  for (size_t i = 0; i < recording.GetNumRecords(); i++) {
+    if (recording.GetRecord(i).sensor_type == type) {
+      return recording.GetRecord(i).sensor_handle;
+    }
+  }
+  return -1;
+}
+
+GoogSensorEventPlayer::GoogSensorEventPlayer(
+    std::shared_ptr<GoogSensorEventRecording> recording, int32_t sensor_handle,
+    float playback_speed)
+    : recording_(std::move(recording)),
+      sensor_handle_(sensor_handle),
+      playback_speed_(playback_speed) {
+}
+
+GoogSensorEventPlayer::~GoogSensorEventPlayer() {
+  Stop();
+}
+
+status_t GoogSensorEventPlayer::Start(
+    std::function<void(const ExtendedSensorEvent& event)> deliver_event) {
+  if (deliver_event == nullptr) {
+    return BAD_VALUE;
+  }
+  Stop();
+
+  deliver_event_ = std::move(deliver_event);
+  {
+    std::lock_guard<std::mutex> l(playback_lock_);
+    stop_requested_ = false;
+    done_ = false;
+  }
+  playback_thread_ = std::thread([this] { PlaybackThreadLoop(); });
+  return OK;
+}
+
+void GoogSensorEventPlayer::Stop() {
+  {
+    std::lock_guard<std::mutex> l(playback_lock_);
+    stop_requested_ = true;
+  }
+  playback_cond_.notify_all();
+  if (playback_thread_.joinable()) {
+    playback_thread_.join();
+  }
+}
+
+void GoogSensorEventPlayer::WaitUntilDone() {
+  std::unique_lock<std::mutex> l(playback_lock_);
+  playback_cond_.wait(l, [this] {
+    base::ScopedLockAssertion assertion(playback_lock_);
+    return done_;
+  });
+}
+
+void GoogSensorEventPlayer::PlaybackThreadLoop() {
+  auto playback_start = std::chrono::steady_clock::now();
+  int64_t first_timestamp = -1;
+
+  for (size_t i = 0; i < recording_->GetNumRecords(); i++) {
+    const GoogSensorEventRecord& record = recording_->GetRecord(i);
+    if (record.sensor_handle != sensor_handle_) {
+      continue;
+    }
+    if (first_timestamp < 0) {
+      first_timestamp = record.timestamp;
+    }
+
+    std::unique_lock<std::mutex> l(playback_lock_);
+    if (playback_speed_ > 0) {
+      auto offset = std::chrono::nanoseconds(static_cast<int64_t>(
+          (record.timestamp - first_timestamp) / playback_speed_));
+      playback_cond_.wait_until(l, playback_start + offset, [this] {
+        base::ScopedLockAssertion assertion(playback_lock_);
+        return stop_requested_;
+      });
+    }
+    if (stop_requested_) {
+      break;
+    }
+    l.unlock();
+
+    deliver_event_(GoogSensorEventRecording::ToExtendedSensorEvent(record));
+  }
+
+  {
+    std::lock_guard<std::mutex> l(playback_lock_);
+    done_ = true;
+  }
+  playback_cond_.notify_all();
+}
+
+}  // namespace camera_sensor_listener
+}  // namespace android
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VENDOR_GOOGLE_CAMERA_SENSOR_LISTENER_GOOG_SENSOR_EVENT_RECORDING_H_
+#define VENDOR_GOOGLE_CAMERA_SENSOR_LISTENER_GOOG_SENSOR_EVENT_RECORDING_H_
+
+#include <android-base/thread_annotations.h>
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "goog_sensor_wrapper.h"
+
+namespace android {
+namespace camera_sensor_listener {
+
+// On-disk layout of a sensor event recording:
+//   GoogSensorEventFileHeader
+//   GoogSensorEventRecord[num_records]
+// All fields are little-endian, native layout. Records are appended in
+// arrival order and never rewritten, so a recording interrupted by a crash
+// is still readable up to the last complete record.
+struct GoogSensorEventFileHeader {
+  // Must be kGoogSensorEventFileMagic.
+  uint32_t magic;
+  // Must be kGoogSensorEventFileVersion.
+  uint32_t version;
+  // sizeof(GoogSensorEventRecord) at the time of recording.
+  uint32_t record_size;
+  uint32_t reserved;
+  // Number of complete records following the header.
+  uint64_t num_records;
+};
+
+struct GoogSensorEventRecord {
+  int64_t timestamp;
+  int64_t event_arrival_time_ns;
+  int32_t sensor_handle;
+  int32_t sensor_type;
+  // Raw copy of ::android::hardware::sensors::V1_0::EventPayload.
+  uint8_t payload[64];
+};
+
+// "GSER" for Google Sensor Event Recording.
+constexpr uint32_t kGoogSensorEventFileMagic = 0x52455347;
+constexpr uint32_t kGoogSensorEventFileVersion = 1;
+
+// GoogSensorEventRecorder appends ExtendedSensorEvent streams to a
+// memory-mapped file. The file is grown in chunks so appending an event is
+// a memcpy in the common case.
+// Sample usage:
+//   auto recorder = GoogSensorEventRecorder::Create("/data/gyro.gser");
+//   sensor_ptr->SetEventRecorder(recorder);
+class GoogSensorEventRecorder {
+ public:
+  // Create a recorder writing to file_path. An existing file is truncated.
+  // Return nullptr if the file cannot be created or mapped.
+  static std::shared_ptr<GoogSensorEventRecorder> Create(
+      const std::string& file_path);
+
+  // Destructor.
+  // Trim the file to the recorded events and unmap it.
+  ~GoogSensorEventRecorder();
+
+  // Append one event. Thread-safe.
+  // Return 0 on success.
+  status_t Append(const ExtendedSensorEvent& event);
+
+  // Number of events recorded so far.
+  uint64_t GetNumRecords() const;
+
+ private:
+  GoogSensorEventRecorder(int fd);
+
+  // Make sure the mapping can hold num_records records.
+  status_t EnsureCapacityLocked(uint64_t num_records)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  mutable std::mutex lock_;
+  int fd_ = -1;
+  uint8_t* mapped_addr_ GUARDED_BY(lock_) = nullptr;
+  size_t mapped_size_ GUARDED_BY(lock_) = 0;
+
+  // Number of records the file is grown by at a time.
+  static constexpr uint64_t kGrowRecords = 4096;
+};
+
+// GoogSensorEventRecording gives read-only, memory-mapped access to a file
+// written by GoogSensorEventRecorder.
+class GoogSensorEventRecording {
+ public:
+  // Map the recording at file_path. Return nullptr if the file does not exist
+  // or is not a valid recording.
+  static std::unique_ptr<GoogSensorEventRecording> Open(
+      const std::string& file_path);
+
+  ~GoogSensorEventRecording();
+
+  size_t GetNumRecords() const {
+    return num_records_;
+  }
+
+  // Return the record at index, which must be < GetNumRecords().
+  const GoogSensorEventRecord& GetRecord(size_t index) const {
+    return records_[index];
+  }
+
+  // Convert a record back into the event that was recorded.
+  static ExtendedSensorEvent ToExtendedSensorEvent(
+      const GoogSensorEventRecord& record);
+
+ private:
+  GoogSensorEventRecording(void* mapped_addr, size_t mapped_size,
+                           const GoogSensorEventRecord* records,
+                           size_t num_records);
+
+  void* mapped_addr_;
+  size_t mapped_size_;
+  const GoogSensorEventRecord* records_;
+  size_t num_records_;
+};
+
+// GoogSensorEventPlayer replays a recording on its own thread, in place of a
+// live sensor service connection. Events are delivered with their original
+// spacing divided by playback_speed, or back to back if playback_speed is 0.
+// Only events of the requested sensor handle are delivered, so one recording
+// can hold several sensors.
+class GoogSensorEventPlayer {
+ public:
+  // Input:
+  //   recording: recording to replay.
+  //   sensor_handle: handle of the recorded sensor to replay.
+  //   playback_speed: 1.0 replays in original timing, 0 replays as fast as
+  //     possible.
+  static std::unique_ptr<GoogSensorEventPlayer> Create(
+      std::shared_ptr<GoogSensorEventRecording> recording,
+      int32_t sensor_handle, float playback_speed = 1.0f);
+
+  // Return the handle of the first recorded sensor of sensor_type, or -1 if
+  // the recording holds no such event.
+  static int32_t FindSensorHandle(
+      const GoogSensorEventRecording& recording,
+      ::android::hardware::sensors::V1_0::SensorType sensor_type);
+
+  ~GoogSensorEventPlayer();
+
+  // Sensor handle of the replayed sensor.
+  int32_t GetSensorHandle() const {
+    return sensor_handle_;
+  }
+
+  // Start replaying events into deliver_event from the beginning of the
+  // recording. Return 0 on success.
+  status_t Start(std::function<void(const ExtendedSensorEvent& event)>
+                     deliver_event);
+
+  // Stop replaying and join the playback thread. Must not be called from
+  // deliver_event.
+  void Stop();
+
+  // Block until all events have been delivered or playback is stopped.
+  void WaitUntilDone();
+
+ private:
+  GoogSensorEventPlayer(std::shared_ptr<GoogSensorEventRecording> recording,
+                        int32_t sensor_handle, float playback_speed);
+
+  void PlaybackThreadLoop();
+
+  std::shared_ptr<GoogSensorEventRecording> recording_;
+  const int32_t sensor_handle_;
+  const float playback_speed_;
+
+  std::function<void(const ExtendedSensorEvent& event)> deliver_event_;
+  std::thread playback_thread_;
+
+  std::mutex playback_lock_;
+  std::condition_variable playback_cond_;
+  bool stop_requested_ GUARDED_BY(playback_lock_) = false;
+  bool done_ GUARDED_BY(playback_lock_) = true;
+};
+
+}  // namespace camera_sensor_listener
+}  // namespace android
+
+#endif  // VENDOR_GOOGLE_CAMERA_SENSOR_LISTENER_GOOG_SENSOR_EVENT_RECORDING_H_
@@ -18,6 +18,7 @@
 
 #include "goog_sensor_motion.h"
 
+#include <algorithm>
 #include <cinttypes>
 
 #include "utils/Errors.h"
@@ -59,7 +60,8 @@ GoogSensorMotion::GoogSensorMotion(MotionSensorType motion_sensor_type,
                                    int64_t sampling_period_us,
                                    size_t event_queue_size)
     : GoogSensorWrapper(event_queue_size, sampling_period_us),
-      motion_sensor_type_(motion_sensor_type) {
+      motion_sensor_type_(motion_sensor_type),
+      motion_samples_(event_queue_size) {
   ALOGD("%s %d create sensor %s", __func__, __LINE__,
         GetSensorName(motion_sensor_type));
 }
@@ -107,6 +109,47 @@ sp<GoogSensorMotion> GoogSensorMotion::Create(MotionSensorType motion_sensor_typ
   return sensor_ptr;
 }
 
+sp<GoogSensorMotion> GoogSensorMotion::CreateFromRecording(
+    MotionSensorType motion_sensor_type,
+    std::shared_ptr<GoogSensorEventRecording> recording, float playback_speed,
+    size_t event_queue_size) {
+  int motion_sensor_type_index = static_cast<int>(motion_sensor_type);
+  if (motion_sensor_type_index >= static_cast<int>(MotionSensorType::TOTAL_NUM)) {
+    ALOGE("%s %d unsupported motion sensor type %d", __func__, __LINE__,
+          motion_sensor_type_index);
+    return nullptr;
+  }
+  if (recording == nullptr) {
+    ALOGE("%s %d recording is nullptr", __func__, __LINE__);
+    return nullptr;
+  }
+  int32_t sensor_handle = GoogSensorEventPlayer::FindSensorHandle(
+      *recording, GetHalSensorType(motion_sensor_type));
+  if (sensor_handle < 0) {
+    ALOGE("%s %d recording holds no %s event", __func__, __LINE__,
+          GetSensorName(motion_sensor_type));
+    return nullptr;
+  }
+  std::unique_ptr<GoogSensorEventPlayer> player = GoogSensorEventPlayer::Create(
+      std::move(recording), sensor_handle, playback_speed);
+  if (player == nullptr) {
+    ALOGE("%s %d failed to create event player for %s", __func__, __LINE__,
+          GetSensorName(motion_sensor_type));
+    return nullptr;
+  }
+
+  // Sampling period is given by the recording.
+  sp<GoogSensorMotion> sensor_ptr = new GoogSensorMotion(
+      motion_sensor_type, kDefaultSamplingPeriodUs, event_queue_size);
+  sensor_ptr->SetEventPlayer(std::move(player));
+  status_t result = sensor_ptr->Enable();
+  if (result != 0) {
+    ALOGE("%s %d failed to start playback for %s", __func__, __LINE__,
+          sensor_ptr->GetSensorName());
+  }
+  return sensor_ptr;
+}
+
 void GoogSensorMotion::GetLatestNSensorEvents(
     int num_sample, std::vector<int64_t>* event_timestamps,
     std::vector<float>* motion_vector_x, std::vector<float>* motion_vector_y,
@@ -122,17 +165,22 @@ void GoogSensorMotion::GetLatestNSensorEvents(
     return;
   }
   std::lock_guard<std::mutex> l(event_buffer_lock_);
-  int start_index =
-      std::max(0, static_cast<int>(event_buffer_.size()) - num_sample);
-  auto event = event_buffer_.begin();
-  std::advance(event, start_index);
-  for (; event != event_buffer_.end(); ++event) {
-    event_timestamps->push_back(event->sensor_event.timestamp);
-    motion_vector_x->push_back(event->sensor_event.u.vec3.x);
-    motion_vector_y->push_back(event->sensor_event.u.vec3.y);
-    motion_vector_z->push_back(event->sensor_event.u.vec3.z);
-    event_arrival_timestamps->push_back(event->event_arrival_time_ns);
-  }
+  size_t count =
+      std::min(static_cast<size_t>(num_sample), motion_samples_.Size());
+  event_timestamps->resize(count);
+  motion_vector_x->resize(count);
+  motion_vector_y->resize(count);
+  motion_vector_z->resize(count);
+  event_arrival_timestamps->resize(count);
+  MotionSampleBuffer buffer = {
+      .timestamps = event_timestamps->data(),
+      .x = motion_vector_x->data(),
+      .y = motion_vector_y->data(),
+      .z = motion_vector_z->data(),
+      .arrival_timestamps = event_arrival_timestamps->data(),
+      .capacity = count,
+  };
+  motion_samples_.CopyLatest(count, &buffer);
 }
 
 void GoogSensorMotion::QuerySensorEventsBetweenTimestamps(
@@ -140,31 +188,53 @@ void GoogSensorMotion::QuerySensorEventsBetweenTimestamps(
     std::vector<int64_t>* event_timestamps, std::vector<float>* motion_vector_x,
     std::vector<float>* motion_vector_y, std::vector<float>* motion_vector_z,
     std::vector<int64_t>* event_arrival_timestamps) const {
-  event_timestamps->clear();
-  motion_vector_x->clear();
-  motion_vector_y->clear();
-  motion_vector_z->clear();
-  event_arrival_timestamps->clear();
+  std::lock_guard<std::mutex> l(event_buffer_lock_);
+
+  // Size outputs for the samples in the queried range only.
+  size_t capacity =
+      motion_samples_.CountBetweenTimestamps(start_time, end_time);
+  event_timestamps->resize(capacity);
+  motion_vector_x->resize(capacity);
+  motion_vector_y->resize(capacity);
+  motion_vector_z->resize(capacity);
+  event_arrival_timestamps->resize(capacity);
+  MotionSampleBuffer buffer = {
+      .timestamps = event_timestamps->data(),
+      .x = motion_vector_x->data(),
+      .y = motion_vector_y->data(),
+      .z = motion_vector_z->data(),
+      .arrival_timestamps = event_arrival_timestamps->data(),
+      .capacity = capacity,
+  };
+  motion_samples_.CopyBetweenTimestamps(start_time, end_time, &buffer);
+}
 
+size_t GoogSensorMotion::GetLatestNSensorEvents(size_t num_sample,
+                                                MotionSampleBuffer* out) const {
   std::lock_guard<std::mutex> l(event_buffer_lock_);
+  return motion_samples_.CopyLatest(num_sample, out);
+}
 
-  event_timestamps->reserve(event_buffer_.size());
-  motion_vector_x->reserve(event_buffer_.size());
-  motion_vector_y->reserve(event_buffer_.size());
-  motion_vector_z->reserve(event_buffer_.size());
-  event_arrival_timestamps->reserve(event_buffer_.size());
+size_t GoogSensorMotion::QuerySensorEventsBetweenTimestamps(
+    int64_t start_time, int64_t end_time, MotionSampleBuffer* out) const {
+  std::lock_guard<std::mutex> l(event_buffer_lock_);
+  return motion_samples_.CopyBetweenTimestamps(start_time, end_time, out);
+}
 
-  for (const auto& event : event_buffer_) {
-    int64_t event_time = event.sensor_event.timestamp;
-    if (event_time <= start_time || event_time > end_time) {
-      continue;
-    }
-    event_timestamps->push_back(event_time);
-    motion_vector_x->push_back(event.sensor_event.u.vec3.x);
-    motion_vector_y->push_back(event.sensor_event.u.vec3.y);
-    motion_vector_z->push_back(event.sensor_event.u.vec3.z);
-    event_arrival_timestamps->push_back(event.event_arrival_time_ns);
-  }
+size_t GoogSensorMotion::InterpolateSensorEvents(
+    const int64_t* query_timestamps, size_t num_query, float* motion_vector_x,
+    float* motion_vector_y, float* motion_vector_z) const {
+  std::lock_guard<std::mutex> l(event_buffer_lock_);
+  return motion_samples_.Interpolate(query_timestamps, num_query,
+                                     motion_vector_x, motion_vector_y,
+                                     motion_vector_z);
+}
+
+void GoogSensorMotion::OnEventBufferedLocked(const ExtendedSensorEvent& event) {
+  motion_samples_.Push(event.sensor_event.timestamp,
+                       event.sensor_event.u.vec3.x, event.sensor_event.u.vec3.y,
+                       event.sensor_event.u.vec3.z,
+                       event.event_arrival_time_ns);
 }
 
 int32_t GoogSensorMotion::GetSensorHandle() {
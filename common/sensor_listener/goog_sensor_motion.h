@@ -17,6 +17,8 @@
 #ifndef VENDOR_GOOGLE_CAMERA_SENSOR_LISTENER_GOOG_SENSOR_MOTION_H_
 #define VENDOR_GOOGLE_CAMERA_SENSOR_LISTENER_GOOG_SENSOR_MOTION_H_
 
+#include "goog_motion_sample_ring.h"
+#include "goog_sensor_event_recording.h"
 #include "goog_sensor_wrapper.h"
 
 namespace android {
@@ -84,6 +86,14 @@ enum class MotionSensorType : int {
 //         /*num_sample=*/5, &event_timestamps, &motion_vector_x,
 //         &motion_vector_y, &motion_vector_z, &arrival_timestamps);
 //   }
+// Per-frame consumers such as video stabilization should prefer the
+// allocation-free MotionSampleBuffer overloads:
+//   int64_t timestamps[kMaxSamples];
+//   float x[kMaxSamples], y[kMaxSamples], z[kMaxSamples];
+//   MotionSampleBuffer buffer = {.timestamps = timestamps, .x = x, .y = y,
+//                                .z = z, .capacity = kMaxSamples};
+//   size_t num_samples = sensor_ptr->QuerySensorEventsBetweenTimestamps(
+//       exposure_start, exposure_end, &buffer);
 class GoogSensorMotion : public GoogSensorWrapper {
  public:
   // Return a StrongPointer pointing to newly created GoogSensorMotion
@@ -99,6 +109,21 @@ class GoogSensorMotion : public GoogSensorWrapper {
       int64_t sampling_period_us = kDefaultSamplingPeriodUs,
       size_t event_queue_size = kDefaultEventQueueSize);
 
+  // Return a StrongPointer pointing to newly created GoogSensorMotion
+  // instance that replays recorded events instead of connecting to sensor
+  // service, so it can run offline.
+  // Inputs:
+  //   motion_sensor_type: sensor type defined in enum class MotionSensorType.
+  //   recording: recording holding events of motion_sensor_type.
+  //   playback_speed: 1.0 replays in original timing, 0 replays as fast as
+  //     possible.
+  //   event_queue_size: size of event queue to hold incoming sensor events.
+  static sp<GoogSensorMotion> CreateFromRecording(
+      MotionSensorType motion_sensor_type,
+      std::shared_ptr<GoogSensorEventRecording> recording,
+      float playback_speed = 1.0f,
+      size_t event_queue_size = kDefaultEventQueueSize);
+
   // Destructor.
   // Destroy and free the resources of a GoogSensorMotion.
   ~GoogSensorMotion();
@@ -152,6 +177,39 @@ class GoogSensorMotion : public GoogSensorWrapper {
       std::vector<float>* motion_vector_z,
       std::vector<int64_t>* event_arrival_timestamps) const;
 
+  // Allocation-free variant of GetLatestNSensorEvents.
+  // Copy the latest min(num_sample, out->capacity) events into the caller
+  // provided buffer, in chronological order.
+  // Return the number of events copied.
+  size_t GetLatestNSensorEvents(size_t num_sample,
+                                MotionSampleBuffer* out) const;
+
+  // Allocation-free variant of QuerySensorEventsBetweenTimestamps.
+  // Copy events in range (start_time, end_time] into the caller provided
+  // buffer, in chronological order. Range bounds are binary searched, so the
+  // cost is proportional to the number of returned events. If out is too
+  // small, the earliest out->capacity events in the range are copied.
+  // Return the number of events copied.
+  size_t QuerySensorEventsBetweenTimestamps(int64_t start_time,
+                                            int64_t end_time,
+                                            MotionSampleBuffer* out) const;
+
+  // Linearly interpolate event data at arbitrary timestamps, e.g. the
+  // readout time of each sensor row for rolling shutter correction.
+  // Inputs:
+  //   query_timestamps: timestamps to interpolate at, sorted ascending.
+  //   num_query: number of entries in query_timestamps.
+  // Outputs:
+  //   motion_vector_x, motion_vector_y, motion_vector_z: caller provided
+  //     arrays of at least num_query entries to hold interpolated data.
+  // Timestamps outside of buffered events are clamped to the earliest or
+  // latest event. Return the number of interpolated samples, which is 0 when
+  // no event has been received yet.
+  size_t InterpolateSensorEvents(const int64_t* query_timestamps,
+                                 size_t num_query, float* motion_vector_x,
+                                 float* motion_vector_y,
+                                 float* motion_vector_z) const;
+
   const char* GetSensorName() const {
     return GetSensorName(motion_sensor_type_);
   }
@@ -160,6 +218,10 @@ class GoogSensorMotion : public GoogSensorWrapper {
   // Get motion sensor handle.
   virtual int32_t GetSensorHandle() final;
 
+  // Index each buffered event into motion_samples_.
+  void OnEventBufferedLocked(const ExtendedSensorEvent& event) override
+      EXCLUSIVE_LOCKS_REQUIRED(event_buffer_lock_);
+
  private:
   // Constructor.
   // Create and initialize a GoogSensorMotion.
@@ -175,6 +237,10 @@ class GoogSensorMotion : public GoogSensorWrapper {
 
   MotionSensorType motion_sensor_type_;
 
+  // Timestamp-indexed structure-of-arrays copy of event_buffer_ serving all
+  // queries. It holds as many events as event_buffer_.
+  MotionSampleRing motion_samples_ GUARDED_BY(event_buffer_lock_);
+
   static constexpr size_t kDefaultEventQueueSize = 20;
   static constexpr int64_t kDefaultSamplingPeriodUs = 20000;  // = 50 Hz
   static constexpr int64_t kMinSamplingPeriodUs = 2500;       // = 400 Hz
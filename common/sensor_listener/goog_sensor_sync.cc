@@ -37,6 +37,7 @@ namespace camera_sensor_listener {
 using ::android::frameworks::sensorservice::V1_0::ISensorManager;
 using ::android::frameworks::sensorservice::V1_0::Result;
 using ::android::hardware::sensors::V1_0::SensorInfo;
+using ::android::hardware::sensors::V1_0::SensorType;
 
 GoogSensorSync::GoogSensorSync(uint8_t cam_id, size_t event_queue_size)
     : GoogSensorWrapper(event_queue_size), cam_id_(cam_id) {
@@ -73,6 +74,38 @@ sp<GoogSensorSync> GoogSensorSync::Create(uint8_t cam_id,
   return sensor_sync_ptr;
 }
 
+sp<GoogSensorSync> GoogSensorSync::CreateFromRecording(
+    uint8_t cam_id, std::shared_ptr<GoogSensorEventRecording> recording,
+    SensorType sensor_type, float playback_speed, size_t event_queue_size) {
+  if (recording == nullptr) {
+    ALOGE("%s %d recording is nullptr.", __func__, __LINE__);
+    return nullptr;
+  }
+  int32_t sensor_handle =
+      GoogSensorEventPlayer::FindSensorHandle(*recording, sensor_type);
+  if (sensor_handle < 0) {
+    ALOGE("%s %d recording holds no Vsync event of sensor type %d.", __func__,
+          __LINE__, static_cast<int32_t>(sensor_type));
+    return nullptr;
+  }
+  std::unique_ptr<GoogSensorEventPlayer> player = GoogSensorEventPlayer::Create(
+      std::move(recording), sensor_handle, playback_speed);
+  if (player == nullptr) {
+    ALOGE("%s %d failed to create event player.", __func__, __LINE__);
+    return nullptr;
+  }
+
+  sp<GoogSensorSync> sensor_sync_ptr =
+      new GoogSensorSync(cam_id, event_queue_size);
+  sensor_sync_ptr->SetEventPlayer(std::move(player));
+  status_t result = sensor_sync_ptr->Enable();
+  if (result != 0) {
+    ALOGE("%s %d failed to start GoogSensorSync playback.", __func__,
+          __LINE__);
+  }
+  return sensor_sync_ptr;
+}
+
 void GoogSensorSync::ExtractFrameIdAndBoottimeTimestamp(
     const ExtendedSensorEvent& event, int64_t* frame_id,
     int64_t* timestamp_boottime) const {
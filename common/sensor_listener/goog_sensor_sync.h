@@ -17,6 +17,7 @@
 #ifndef VENDOR_GOOGLE_CAMERA_SENSOR_LISTENER_GOOG_SENSOR_SYNC_H_
 #define VENDOR_GOOGLE_CAMERA_SENSOR_LISTENER_GOOG_SENSOR_SYNC_H_
 
+#include "goog_sensor_event_recording.h"
 #include "goog_sensor_wrapper.h"
 
 namespace android {
@@ -39,6 +40,24 @@ class GoogSensorSync : public GoogSensorWrapper {
   static sp<GoogSensorSync> Create(
       uint8_t cam_id, size_t event_queue_size = kDefaultEventQueueSize);
 
+  // Return a StrongPointer pointing to newly created GoogSensorSync instance
+  // that replays recorded Vsync events instead of connecting to sensor
+  // service, so sync accuracy can be evaluated offline.
+  // Inputs:
+  //   cam_id: physical camera id associated with Vsync sensor.
+  //   recording: recording holding Vsync events of cam_id.
+  //   sensor_type: vendor defined sensor type of the recorded Vsync sensor.
+  //     Events of the first recorded sensor of this type are replayed.
+  //   playback_speed: 1.0 replays in original timing, 0 replays as fast as
+  //     possible.
+  //   event_queue_size: size of event queue to hold incoming Vsync events.
+  // Return nullptr if the recording holds no event of sensor_type.
+  static sp<GoogSensorSync> CreateFromRecording(
+      uint8_t cam_id, std::shared_ptr<GoogSensorEventRecording> recording,
+      ::android::hardware::sensors::V1_0::SensorType sensor_type,
+      float playback_speed = 1.0f,
+      size_t event_queue_size = kDefaultEventQueueSize);
+
   // Destructor.
   // Destroy and free the resources of a GoogSensorSync.
   ~GoogSensorSync();
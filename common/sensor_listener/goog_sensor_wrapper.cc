@@ -28,6 +28,7 @@
 #include <algorithm>
 #include <cmath>
 
+#include "goog_sensor_event_recording.h"
 #include "goog_sensor_wrapper.h"
 
 namespace android {
@@ -81,10 +82,47 @@ status_t GoogSensorWrapper::SetEventProcessor(
   return OK;
 }
 
+status_t GoogSensorWrapper::SetEventRecorder(
+    std::shared_ptr<GoogSensorEventRecorder> recorder) {
+  std::lock_guard<std::mutex> l(event_recorder_lock_);
+  event_recorder_ = std::move(recorder);
+  return OK;
+}
+
+status_t GoogSensorWrapper::SetEventPlayer(
+    std::unique_ptr<GoogSensorEventPlayer> player) {
+  std::lock_guard<std::mutex> l(event_queue_lock_);
+  if (enabled_) {
+    ALOGE("%s %d event player must be set before enabling the sensor",
+          __func__, __LINE__);
+    return INVALID_OPERATION;
+  }
+  event_player_ = std::move(player);
+  return OK;
+}
+
 status_t GoogSensorWrapper::Enable() {
   status_t res = OK;
   std::lock_guard<std::mutex> l(event_queue_lock_);
 
+  if (event_player_ != nullptr) {
+    if (enabled_) {
+      return OK;
+    }
+    handle_ = event_player_->GetSensorHandle();
+    res = event_player_->Start([this](const ExtendedSensorEvent& event) {
+      ExtendedSensorEvent replayed_event = event;
+      HandleEvent(&replayed_event, /*is_replayed=*/true);
+    });
+    if (res != OK) {
+      ALOGE("%s %d starting event player failed: %d(%s)", __func__, __LINE__,
+            res, strerror(-res));
+      return res;
+    }
+    enabled_ = true;
+    return OK;
+  }
+
   if (event_queue_ == nullptr) {
     res = InitializeEventQueueLocked();
     if (res != OK) {
@@ -111,6 +149,15 @@ status_t GoogSensorWrapper::Enable() {
 }
 
 status_t GoogSensorWrapper::Disable() {
+  if (event_player_ != nullptr) {
+    // Stop playback before taking event_queue_lock_, since the playback
+    // thread needs it to deliver events.
+    event_player_->Stop();
+    std::lock_guard<std::mutex> l(event_queue_lock_);
+    enabled_ = false;
+    return OK;
+  }
+
   std::lock_guard<std::mutex> l(event_queue_lock_);
 
   if (enabled_) {
@@ -169,27 +216,44 @@ status_t GoogSensorWrapper::InitializeEventQueueLocked() {
 int GoogSensorWrapper::EventCallback(const Event& e) {
   ExtendedSensorEvent event;
   memset(&event, 0, sizeof(event));
-  std::lock_guard<std::mutex> l(event_queue_lock_);
   event.sensor_event = e;
-  if (event.sensor_event.sensorHandle == handle_ &&
-      event.sensor_event.sensorType != SensorType::ADDITIONAL_INFO) {
-    {
-      std::lock_guard<std::mutex> l(event_buffer_lock_);
-      if (event_buffer_.size() >= event_buffer_size_limit_) {
-        event_buffer_.pop_front();
-      }
-      event.event_arrival_time_ns = elapsedRealtimeNano();
-      event_buffer_.push_back(event);
+  HandleEvent(&event, /*is_replayed=*/false);
+
+  // Return 1 to continue receiving callbacks.
+  return 1;
+}
+
+void GoogSensorWrapper::HandleEvent(ExtendedSensorEvent* event,
+                                    bool is_replayed) {
+  std::lock_guard<std::mutex> l(event_queue_lock_);
+  if (event->sensor_event.sensorHandle != handle_ ||
+      event->sensor_event.sensorType == SensorType::ADDITIONAL_INFO) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> l(event_buffer_lock_);
+    if (event_buffer_.size() >= event_buffer_size_limit_) {
+      event_buffer_.pop_front();
+    }
+    if (!is_replayed) {
+      event->event_arrival_time_ns = elapsedRealtimeNano();
     }
+    event_buffer_.push_back(*event);
+    OnEventBufferedLocked(*event);
+  }
 
-    std::lock_guard<std::mutex> el(event_processor_lock_);
-    if (event_processor_ != nullptr) {
-      event_processor_(event);
+  {
+    std::lock_guard<std::mutex> rl(event_recorder_lock_);
+    if (event_recorder_ != nullptr) {
+      event_recorder_->Append(*event);
     }
   }
 
-  // Return 1 to continue receiving callbacks.
-  return 1;
+  std::lock_guard<std::mutex> el(event_processor_lock_);
+  if (event_processor_ != nullptr) {
+    event_processor_(*event);
+  }
 }
 
 }  // namespace camera_sensor_listener
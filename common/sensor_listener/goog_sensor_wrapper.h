@@ -23,6 +23,7 @@
 
 #include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 
 #include "utils/Errors.h"
@@ -38,6 +39,9 @@ struct ExtendedSensorEvent {
   int64_t event_arrival_time_ns;
 };
 
+class GoogSensorEventPlayer;
+class GoogSensorEventRecorder;
+
 class GoogSensorWrapper : public virtual RefBase {
  public:
   virtual ~GoogSensorWrapper();
@@ -50,6 +54,15 @@ class GoogSensorWrapper : public virtual RefBase {
   status_t SetEventProcessor(
       std::function<void(const ExtendedSensorEvent& event)> event_processor);
 
+  // Record every received event to recorder. Pass nullptr to stop
+  // recording. Recording can be started or stopped at any time.
+  status_t SetEventRecorder(std::shared_ptr<GoogSensorEventRecorder> recorder);
+
+  // Replace the live sensor service connection with events replayed by
+  // player. It must be called before GoogSensorWrapper::Enable, and the
+  // wrapper keeps replaying until GoogSensorWrapper::Disable.
+  status_t SetEventPlayer(std::unique_ptr<GoogSensorEventPlayer> player);
+
   // Enables the sensor. When object is created, sensor is disabled by default.
   // Returns 0 on success.
   status_t Enable();
@@ -72,6 +85,13 @@ class GoogSensorWrapper : public virtual RefBase {
   // Virtual function to get different sensor handler, e.g., gyro handler.
   virtual int32_t GetSensorHandle() = 0;
 
+  // Invoked with event_buffer_lock_ held after event has been appended to
+  // event_buffer_. Derived classes can override it to maintain additional
+  // indexes over the buffered events.
+  virtual void OnEventBufferedLocked(const ExtendedSensorEvent& /*event*/)
+      EXCLUSIVE_LOCKS_REQUIRED(event_buffer_lock_) {
+  }
+
   // Buffer of the most recent events. Oldest in the front.
   std::deque<ExtendedSensorEvent> event_buffer_ GUARDED_BY(event_buffer_lock_);
 
@@ -84,6 +104,11 @@ class GoogSensorWrapper : public virtual RefBase {
   // user-defined callback function event_processor_.
   int EventCallback(const ::android::hardware::sensors::V1_0::Event& e);
 
+  // Enqueue event to event_buffer_, record it and invoke event_processor_.
+  // Live events are stamped with the current time as arrival time, while
+  // replayed events keep their recorded arrival time.
+  void HandleEvent(ExtendedSensorEvent* event, bool is_replayed);
+
   // Initialize sensor handler and set event_queue_.
   status_t InitializeEventQueueLocked()
       EXCLUSIVE_LOCKS_REQUIRED(event_queue_lock_);
@@ -102,6 +127,18 @@ class GoogSensorWrapper : public virtual RefBase {
   // Lock protecting event_processor_.
   mutable std::mutex event_processor_lock_;
 
+  // Optional recorder of received events.
+  std::shared_ptr<GoogSensorEventRecorder> event_recorder_
+      GUARDED_BY(event_recorder_lock_);
+
+  // Lock protecting event_recorder_.
+  mutable std::mutex event_recorder_lock_;
+
+  // Optional player replacing event_queue_. Only set before Enable, and
+  // not guarded by event_queue_lock_ since its playback thread acquires
+  // event_queue_lock_ when delivering events.
+  std::unique_ptr<GoogSensorEventPlayer> event_player_;
+
   // Size limit for the event buffer.
   size_t event_buffer_size_limit_;
 
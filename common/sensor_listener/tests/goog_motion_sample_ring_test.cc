@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "goog_motion_sample_ring.h"
+
+namespace android {
+namespace camera_sensor_listener {
+namespace {
+
+constexpr size_t kRingCapacity = 8;
+constexpr size_t kBufferCapacity = 16;
+
+struct TestBuffer {
+  int64_t timestamps[kBufferCapacity];
+  float x[kBufferCapacity];
+  float y[kBufferCapacity];
+  float z[kBufferCapacity];
+  int64_t arrival_timestamps[kBufferCapacity];
+
+  MotionSampleBuffer View(size_t capacity = kBufferCapacity) {
+    return {.timestamps = timestamps,
+            .x = x,
+            .y = y,
+            .z = z,
+            .arrival_timestamps = arrival_timestamps,
+            .capacity = capacity};
+  }
+};
+
+// Push samples with timestamps 10, 20, ..., num_sample * 10 and data equal to
+// the sample index.
+void FillRing(MotionSampleRing* ring, size_t num_sample) {
+  for (size_t i = 1; i <= num_sample; i++) {
+    ring->Push(i * 10, i, -static_cast<float>(i), 2 * i, i * 10 + 1);
+  }
+}
+
+}  // namespace
+
+TEST(MotionSampleRingTest, CopyLatestBeforeAndAfterWrap) {
+  MotionSampleRing ring(kRingCapacity);
+  TestBuffer buffer;
+  MotionSampleBuffer view = buffer.View();
+
+  EXPECT_EQ(ring.CopyLatest(4, &view), 0u);
+
+  FillRing(&ring, 3);
+  ASSERT_EQ(ring.CopyLatest(4, &view), 3u);
+  EXPECT_EQ(buffer.timestamps[0], 10);
+  EXPECT_EQ(buffer.timestamps[2], 30);
+
+  FillRing(&ring, 13);
+  EXPECT_EQ(ring.Size(), kRingCapacity);
+  ASSERT_EQ(ring.CopyLatest(kBufferCapacity, &view), kRingCapacity);
+  for (size_t i = 0; i < kRingCapacity; i++) {
+    int64_t expected = (13 - kRingCapacity + 1 + i) * 10;
+    EXPECT_EQ(buffer.timestamps[i], expected);
+    EXPECT_EQ(buffer.x[i], expected / 10);
+    EXPECT_EQ(buffer.y[i], -expected / 10);
+    EXPECT_EQ(buffer.z[i], expected / 5);
+    EXPECT_EQ(buffer.arrival_timestamps[i], expected + 1);
+  }
+}
+
+TEST(MotionSampleRingTest, CopyBetweenTimestamps) {
+  MotionSampleRing ring(kRingCapacity);
+  FillRing(&ring, 12);  // Holds timestamps 50..120.
+  TestBuffer buffer;
+  MotionSampleBuffer view = buffer.View();
+
+  // Range is (start_time, end_time].
+  ASSERT_EQ(ring.CopyBetweenTimestamps(60, 90, &view), 3u);
+  EXPECT_EQ(buffer.timestamps[0], 70);
+  EXPECT_EQ(buffer.timestamps[2], 90);
+
+  ASSERT_EQ(ring.CopyBetweenTimestamps(0, 1000, &view), kRingCapacity);
+  EXPECT_EQ(buffer.timestamps[0], 50);
+  EXPECT_EQ(buffer.timestamps[kRingCapacity - 1], 120);
+
+  EXPECT_EQ(ring.CopyBetweenTimestamps(120, 1000, &view), 0u);
+  EXPECT_EQ(ring.CopyBetweenTimestamps(0, 40, &view), 0u);
+  EXPECT_EQ(ring.CopyBetweenTimestamps(75, 79, &view), 0u);
+
+  // Output capacity limits the copy to the earliest samples.
+  MotionSampleBuffer small_view = buffer.View(2);
+  ASSERT_EQ(ring.CopyBetweenTimestamps(0, 1000, &small_view), 2u);
+  EXPECT_EQ(buffer.timestamps[0], 50);
+  EXPECT_EQ(buffer.timestamps[1], 60);
+
+  // Arrival timestamps are optional.
+  view.arrival_timestamps = nullptr;
+  EXPECT_EQ(ring.CopyBetweenTimestamps(60, 90, &view), 3u);
+}
+
+TEST(MotionSampleRingTest, CountBetweenTimestamps) {
+  MotionSampleRing ring(kRingCapacity);
+  EXPECT_EQ(ring.CountBetweenTimestamps(0, 1000), 0u);
+  EXPECT_EQ(ring.LatestTimestamp(), 0);
+
+  FillRing(&ring, 12);  // Holds timestamps 50..120.
+  EXPECT_EQ(ring.CountBetweenTimestamps(60, 90), 3u);
+  EXPECT_EQ(ring.CountBetweenTimestamps(0, 1000), kRingCapacity);
+  EXPECT_EQ(ring.CountBetweenTimestamps(120, 1000), 0u);
+  EXPECT_EQ(ring.CountBetweenTimestamps(90, 60), 0u);
+  EXPECT_EQ(ring.LatestTimestamp(), 120);
+}
+
+TEST(MotionSampleRingTest, Interpolate) {
+  MotionSampleRing ring(kRingCapacity);
+  float x[4], y[4], z[4];
+  const int64_t kQueries[] = {0, 15, 20, 100};
+  EXPECT_EQ(ring.Interpolate(kQueries, 4, x, y, z), 0u);
+
+  FillRing(&ring, 3);  // Holds timestamps 10, 20, 30.
+  ASSERT_EQ(ring.Interpolate(kQueries, 4, x, y, z), 4u);
+  // Clamped to the earliest sample.
+  EXPECT_FLOAT_EQ(x[0], 1.f);
+  EXPECT_FLOAT_EQ(x[1], 1.5f);
+  EXPECT_FLOAT_EQ(y[1], -1.5f);
+  EXPECT_FLOAT_EQ(z[1], 3.f);
+  EXPECT_FLOAT_EQ(x[2], 2.f);
+  // Clamped to the latest sample.
+  EXPECT_FLOAT_EQ(x[3], 3.f);
+}
+
+}  // namespace camera_sensor_listener
+}  // namespace android
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "goog_sensor_event_recording.h"
+#include "goog_sensor_motion.h"
+#include "goog_sensor_sync.h"
+#include "utils/RefBase.h"
+
+namespace android {
+namespace camera_sensor_listener {
+namespace {
+
+using ::android::hardware::sensors::V1_0::SensorType;
+
+constexpr int32_t kGyroHandle = 7;
+constexpr int32_t kAccelHandle = 9;
+constexpr int32_t kVsyncHandle = 11;
+// Vsync sensors are vendor defined, so use the first private sensor type.
+constexpr SensorType kVsyncSensorType = SensorType::DEVICE_PRIVATE_BASE;
+constexpr int kNumGyroEvents = 100;
+constexpr int64_t kGyroPeriodNs = 5000000;  // 200Hz.
+
+ExtendedSensorEvent MakeEvent(int32_t handle, SensorType type,
+                              int64_t timestamp, float value) {
+  ExtendedSensorEvent event;
+  memset(&event, 0, sizeof(event));
+  event.sensor_event.sensorHandle = handle;
+  event.sensor_event.sensorType = type;
+  event.sensor_event.timestamp = timestamp;
+  event.sensor_event.u.vec3.x = value;
+  event.sensor_event.u.vec3.y = -value;
+  event.sensor_event.u.vec3.z = 2 * value;
+  event.event_arrival_time_ns = timestamp + 1000;
+  return event;
+}
+
+// Record interleaved gyro and accelerometer events to file_path.
+void WriteRecording(const std::string& file_path) {
+  auto recorder = GoogSensorEventRecorder::Create(file_path);
+  ASSERT_NE(recorder, nullptr);
+  for (int i = 1; i <= kNumGyroEvents; i++) {
+    ASSERT_EQ(recorder->Append(MakeEvent(kGyroHandle, SensorType::GYROSCOPE,
+                                         i * kGyroPeriodNs, i)),
+              OK);
+    if (i % 4 == 0) {
+      ASSERT_EQ(recorder->Append(MakeEvent(kAccelHandle,
+                                           SensorType::ACCELEROMETER,
+                                           i * kGyroPeriodNs, -i)),
+                OK);
+    }
+  }
+  EXPECT_EQ(recorder->GetNumRecords(), kNumGyroEvents + kNumGyroEvents / 4);
+}
+
+std::string GetRecordingPath(const char* name) {
+  return ::testing::TempDir() + name;
+}
+
+}  // namespace
+
+TEST(GoogSensorEventRecordingTest, RecordAndRead) {
+  std::string file_path = GetRecordingPath("record_and_read.gser");
+  WriteRecording(file_path);
+
+  auto recording = GoogSensorEventRecording::Open(file_path);
+  ASSERT_NE(recording, nullptr);
+  ASSERT_EQ(recording->GetNumRecords(), kNumGyroEvents + kNumGyroEvents / 4);
+
+  ExtendedSensorEvent event =
+      GoogSensorEventRecording::ToExtendedSensorEvent(recording->GetRecord(0));
+  EXPECT_EQ(event.sensor_event.sensorHandle, kGyroHandle);
+  EXPECT_EQ(event.sensor_event.sensorType, SensorType::GYROSCOPE);
+  EXPECT_EQ(event.sensor_event.timestamp, kGyroPeriodNs);
+  EXPECT_EQ(event.sensor_event.u.vec3.x, 1.f);
+  EXPECT_EQ(event.sensor_event.u.vec3.y, -1.f);
+  EXPECT_EQ(event.sensor_event.u.vec3.z, 2.f);
+  EXPECT_EQ(event.event_arrival_time_ns, kGyroPeriodNs + 1000);
+
+  EXPECT_EQ(GoogSensorEventPlayer::FindSensorHandle(*recording,
+                                                    SensorType::ACCELEROMETER),
+            kAccelHandle);
+  EXPECT_EQ(GoogSensorEventPlayer::FindSensorHandle(*recording,
+                                                    SensorType::GRAVITY),
+            -1);
+  unlink(file_path.c_str());
+}
+
+TEST(GoogSensorEventRecordingTest, RejectInvalidFile) {
+  std::string file_path = GetRecordingPath("invalid.gser");
+  FILE* file = fopen(file_path.c_str(), "w");
+  ASSERT_NE(file, nullptr);
+  fputs("not a sensor event recording", file);
+  fclose(file);
+  EXPECT_EQ(GoogSensorEventRecording::Open(file_path), nullptr);
+  unlink(file_path.c_str());
+}
+
+TEST(GoogSensorEventRecordingTest, ReplayMotionSensorOffline) {
+  std::string file_path = GetRecordingPath("replay_motion.gser");
+  WriteRecording(file_path);
+  std::shared_ptr<GoogSensorEventRecording> recording =
+      GoogSensorEventRecording::Open(file_path);
+  ASSERT_NE(recording, nullptr);
+
+  sp<GoogSensorMotion> sensor_ptr = GoogSensorMotion::CreateFromRecording(
+      MotionSensorType::GYROSCOPE, recording, /*playback_speed=*/0,
+      /*event_queue_size=*/kNumGyroEvents);
+  ASSERT_NE(sensor_ptr, nullptr);
+  ASSERT_TRUE(sensor_ptr->GetSensorEnablingStatus());
+
+  // Wait until the whole recording has been replayed.
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  std::vector<int64_t> timestamps, arrival_timestamps;
+  std::vector<float> x, y, z;
+  do {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    sensor_ptr->GetLatestNSensorEvents(kNumGyroEvents, &timestamps, &x, &y, &z,
+                                       &arrival_timestamps);
+  } while (timestamps.size() < kNumGyroEvents &&
+           std::chrono::steady_clock::now() < deadline);
+
+  // Only gyro events are replayed, with their recorded arrival times.
+  ASSERT_EQ(timestamps.size(), kNumGyroEvents);
+  for (int i = 0; i < kNumGyroEvents; i++) {
+    EXPECT_EQ(timestamps[i], (i + 1) * kGyroPeriodNs);
+    EXPECT_EQ(x[i], i + 1);
+    EXPECT_EQ(arrival_timestamps[i], timestamps[i] + 1000);
+  }
+
+  sensor_ptr->QuerySensorEventsBetweenTimestamps(
+      10 * kGyroPeriodNs, 20 * kGyroPeriodNs, &timestamps, &x, &y, &z,
+      &arrival_timestamps);
+  EXPECT_EQ(timestamps.size(), 10u);
+  sensor_ptr.clear();
+  unlink(file_path.c_str());
+}
+
+TEST(GoogSensorEventRecordingTest, ReplaySyncSensorOfMixedRecording) {
+  std::string file_path = GetRecordingPath("replay_sync.gser");
+  WriteRecording(file_path);
+  std::shared_ptr<GoogSensorEventRecording> recording =
+      GoogSensorEventRecording::Open(file_path);
+  ASSERT_NE(recording, nullptr);
+
+  // Gyro and accelerometer events must not be replayed as Vsync events.
+  EXPECT_EQ(GoogSensorSync::CreateFromRecording(/*cam_id=*/0, recording,
+                                                kVsyncSensorType,
+                                                /*playback_speed=*/0),
+            nullptr);
+
+  unlink(file_path.c_str());
+
+  // Vsync events recorded after other sensor events are replayed.
+  file_path = GetRecordingPath("replay_sync_mixed.gser");
+  auto recorder = GoogSensorEventRecorder::Create(file_path);
+  ASSERT_NE(recorder, nullptr);
+  ASSERT_EQ(recorder->Append(MakeEvent(kGyroHandle, SensorType::GYROSCOPE,
+                                       kGyroPeriodNs, 1)),
+            OK);
+  ASSERT_EQ(recorder->Append(MakeEvent(kVsyncHandle, kVsyncSensorType,
+                                       2 * kGyroPeriodNs, 0)),
+            OK);
+  recorder.reset();
+  recording = GoogSensorEventRecording::Open(file_path);
+  ASSERT_NE(recording, nullptr);
+  EXPECT_EQ(GoogSensorEventPlayer::FindSensorHandle(*recording,
+                                                    kVsyncSensorType),
+            kVsyncHandle);
+
+  sp<GoogSensorSync> sync_ptr = GoogSensorSync::CreateFromRecording(
+      /*cam_id=*/0, recording, kVsyncSensorType, /*playback_speed=*/0);
+  ASSERT_NE(sync_ptr, nullptr);
+  EXPECT_TRUE(sync_ptr->GetSensorEnablingStatus());
+  sync_ptr.clear();
+  unlink(file_path.c_str());
+}
+
+}  // namespace camera_sensor_listener
+}  // namespace android
@@ -19,7 +19,9 @@
 #include "EmulatedCameraDeviceHWLImpl.h"
 
 #include <hardware/camera_common.h>
+#include <inttypes.h>
 #include <log/log.h>
+#include <utils/Timers.h>
 
 #include "EmulatedCameraDeviceSessionHWLImpl.h"
 #include "utils/HWLUtils.h"
@@ -29,11 +31,12 @@ namespace android {
 std::unique_ptr<CameraDeviceHwl> EmulatedCameraDeviceHwlImpl::Create(
     uint32_t camera_id, std::unique_ptr<HalCameraMetadata> static_meta,
     PhysicalDeviceMapPtr physical_devices,
-    std::shared_ptr<EmulatedTorchState> torch_state) {
+    std::shared_ptr<EmulatedTorchState> torch_state,
+    std::unique_ptr<EmulatedCameraDeviceInfo> device_info) {
   auto device = std::unique_ptr<EmulatedCameraDeviceHwlImpl>(
       new EmulatedCameraDeviceHwlImpl(camera_id, std::move(static_meta),
-                                      std::move(physical_devices),
-                                      torch_state));
+                                      std::move(physical_devices), torch_state,
+                                      std::move(device_info)));
 
   if (device == nullptr) {
     ALOGE("%s: Creating EmulatedCameraDeviceHwlImpl failed.", __FUNCTION__);
@@ -56,9 +59,11 @@ std::unique_ptr<CameraDeviceHwl> EmulatedCameraDeviceHwlImpl::Create(
 EmulatedCameraDeviceHwlImpl::EmulatedCameraDeviceHwlImpl(
     uint32_t camera_id, std::unique_ptr<HalCameraMetadata> static_meta,
     PhysicalDeviceMapPtr physical_devices,
-    std::shared_ptr<EmulatedTorchState> torch_state)
+    std::shared_ptr<EmulatedTorchState> torch_state,
+    std::unique_ptr<EmulatedCameraDeviceInfo> device_info)
     : camera_id_(camera_id),
       static_metadata_(std::move(static_meta)),
+      device_info_(std::move(device_info)),
       physical_device_map_(std::move(physical_devices)),
       torch_state_(torch_state) {}
 
@@ -103,8 +108,10 @@ status_t EmulatedCameraDeviceHwlImpl::Initialize() {
   default_torch_strength_level_ = GetDefaultTorchStrengthLevel();
   maximum_torch_strength_level_ = GetMaximumTorchStrengthLevel();
 
-  device_info_ = EmulatedCameraDeviceInfo::Create(
-      HalCameraMetadata::Clone(static_metadata_.get()));
+  if (device_info_ == nullptr) {
+    device_info_ = EmulatedCameraDeviceInfo::Create(
+        HalCameraMetadata::Clone(static_metadata_.get()));
+  }
   if (device_info_ == nullptr) {
     ALOGE("%s: Unable to create device info for camera %d", __FUNCTION__,
           camera_id_);
@@ -238,6 +245,7 @@ status_t EmulatedCameraDeviceHwlImpl::CreateCameraDeviceSessionHwl(
     return BAD_VALUE;
   }
 
+  nsecs_t start_time = systemTime(SYSTEM_TIME_MONOTONIC);
   std::unique_ptr<EmulatedCameraDeviceInfo> deviceInfo =
       EmulatedCameraDeviceInfo::Clone(*device_info_);
   *session = EmulatedCameraDeviceSessionHwlImpl::Create(
@@ -252,6 +260,13 @@ status_t EmulatedCameraDeviceHwlImpl::CreateCameraDeviceSessionHwl(
     torch_state_->AcquireFlashHw();
   }
 
+  if (!session_created_) {
+    session_created_ = true;
+    ALOGI("%s: First session of camera %u created in %" PRId64 " ms",
+          __FUNCTION__, camera_id_,
+          ns2ms(systemTime(SYSTEM_TIME_MONOTONIC) - start_time));
+  }
+
   return OK;
 }
 
@@ -261,7 +276,8 @@ bool EmulatedCameraDeviceHwlImpl::IsStreamCombinationSupported(
       camera_id_, stream_config, *stream_configuration_map_,
       *stream_configuration_map_max_resolution_,
       physical_stream_configuration_map_,
-      physical_stream_configuration_map_max_resolution_, sensor_chars_);
+      physical_stream_configuration_map_max_resolution_, sensor_chars_,
+      &stream_combination_cache_);
 }
 
 int32_t EmulatedCameraDeviceHwlImpl::GetDefaultTorchStrengthLevel() const {
@@ -40,10 +40,13 @@ using google_camera_hal::TorchMode;
 
 class EmulatedCameraDeviceHwlImpl : public CameraDeviceHwl {
  public:
+  // device_info may be built ahead of time from static_meta, it is created
+  // during initialization if it is nullptr.
   static std::unique_ptr<CameraDeviceHwl> Create(
       uint32_t camera_id, std::unique_ptr<HalCameraMetadata> static_meta,
       PhysicalDeviceMapPtr physical_devices,
-      std::shared_ptr<EmulatedTorchState> torch_state);
+      std::shared_ptr<EmulatedTorchState> torch_state,
+      std::unique_ptr<EmulatedCameraDeviceInfo> device_info = nullptr);
 
   virtual ~EmulatedCameraDeviceHwlImpl() = default;
 
@@ -81,10 +84,11 @@ class EmulatedCameraDeviceHwlImpl : public CameraDeviceHwl {
   // End of override functions in CameraDeviceHwl.
 
  private:
-  EmulatedCameraDeviceHwlImpl(uint32_t camera_id,
-                              std::unique_ptr<HalCameraMetadata> static_meta,
-                              PhysicalDeviceMapPtr physical_devices,
-                              std::shared_ptr<EmulatedTorchState> torch_state);
+  EmulatedCameraDeviceHwlImpl(
+      uint32_t camera_id, std::unique_ptr<HalCameraMetadata> static_meta,
+      PhysicalDeviceMapPtr physical_devices,
+      std::shared_ptr<EmulatedTorchState> torch_state,
+      std::unique_ptr<EmulatedCameraDeviceInfo> device_info);
 
   status_t Initialize();
 
@@ -102,9 +106,11 @@ class EmulatedCameraDeviceHwlImpl : public CameraDeviceHwl {
   PhysicalDeviceMapPtr physical_device_map_;
   std::shared_ptr<EmulatedTorchState> torch_state_;
   LogicalCharacteristics sensor_chars_;
+  StreamCombinationCache stream_combination_cache_;
   int32_t default_torch_strength_level_ = 0;
   int32_t maximum_torch_strength_level_ = 0;
-
+  // Whether a session has been created, used to report first open latency.
+  bool session_created_ = false;
 };
 
 }  // namespace android
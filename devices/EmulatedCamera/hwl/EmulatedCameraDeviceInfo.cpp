@@ -75,10 +75,9 @@ std::unique_ptr<EmulatedCameraDeviceInfo> EmulatedCameraDeviceInfo::Create(
 
 std::unique_ptr<EmulatedCameraDeviceInfo> EmulatedCameraDeviceInfo::Clone(
     const EmulatedCameraDeviceInfo& other) {
-  std::unique_ptr<HalCameraMetadata> static_metadata =
-      HalCameraMetadata::Clone(other.static_metadata_.get());
-
-  return EmulatedCameraDeviceInfo::Create(std::move(static_metadata));
+  // Everything derived from the static metadata is copied rather than
+  // initialized again, the metadata and request templates are shared.
+  return std::make_unique<EmulatedCameraDeviceInfo>(other);
 }
 
 status_t EmulatedCameraDeviceInfo::InitializeSensorDefaults() {
@@ -1997,6 +1996,38 @@ status_t EmulatedCameraDeviceInfo::InitializeRequestDefaults() {
   return InitializeInfoDefaults();
 }
 
+status_t EmulatedCameraDeviceInfo::FinalizeRequestTemplates() {
+  for (auto& default_request : default_requests_) {
+    if (default_request == nullptr) {
+      continue;
+    }
+
+    // Templates are built one Set() at a time and end up with spare
+    // capacity. Cloning allocates exactly what is used, which keeps copies
+    // handed out by ConstructDefaultRequestSettings() small. Sorting lets
+    // lookups binary search.
+    camera_metadata_t* metadata =
+        clone_camera_metadata(default_request->GetRawCameraMetadata());
+    if (metadata == nullptr) {
+      ALOGE("%s: Cloning request template failed", __FUNCTION__);
+      return NO_MEMORY;
+    }
+
+    if (sort_camera_metadata(metadata) != OK) {
+      ALOGW("%s: Sorting request template failed", __FUNCTION__);
+    }
+
+    auto compact_request = HalCameraMetadata::Create(metadata);
+    if (compact_request == nullptr) {
+      free_camera_metadata(metadata);
+      return NO_MEMORY;
+    }
+    default_request = std::move(compact_request);
+  }
+
+  return OK;
+}
+
 bool EmulatedCameraDeviceInfo::SupportsCapability(uint8_t cap) {
   return available_capabilities_.find(cap) != available_capabilities_.end();
 }
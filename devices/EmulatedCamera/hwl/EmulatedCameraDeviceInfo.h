@@ -53,8 +53,10 @@ struct EmulatedCameraDeviceInfo {
   static std::unique_ptr<EmulatedCameraDeviceInfo> Clone(
       const EmulatedCameraDeviceInfo& other);
 
-  std::unique_ptr<HalCameraMetadata> static_metadata_;
-  std::unique_ptr<HalCameraMetadata> default_requests_[kTemplateCount];
+  // Static metadata and request templates are shared with clones. Request
+  // templates must not be modified once the device info is initialized.
+  std::shared_ptr<const HalCameraMetadata> static_metadata_;
+  std::shared_ptr<HalCameraMetadata> default_requests_[kTemplateCount];
 
   static const std::set<uint8_t> kSupportedCapabilites;
   static const std::set<uint8_t> kSupportedHWLevels;
@@ -265,9 +267,16 @@ struct EmulatedCameraDeviceInfo {
  private:
   status_t Initialize(unique_ptr<HalCameraMetadata> staticMetadata) {
     static_metadata_ = std::move(staticMetadata);
-    return InitializeRequestDefaults();
+    status_t res = InitializeRequestDefaults();
+    if (res != OK) {
+      return res;
+    }
+    return FinalizeRequestTemplates();
   }
 
+  // Replace the request templates with compact, sorted copies.
+  status_t FinalizeRequestTemplates();
+
   status_t InitializeRequestDefaults();
   status_t InitializeSensorDefaults();
   status_t InitializeFlashDefaults();
@@ -22,14 +22,19 @@
 #include <android-base/strings.h>
 #include <cutils/properties.h>
 #include <hardware/camera_common.h>
+#include <inttypes.h>
 #include <log/log.h>
+#include <utils/Timers.h>
 
 #include "EmulatedCameraDeviceHWLImpl.h"
 #include "EmulatedCameraDeviceSessionHWLImpl.h"
 #include "EmulatedLogicalRequestState.h"
 #include "EmulatedSensor.h"
 #include "EmulatedTorchState.h"
+#include "EmulatedVendorTags.h"
+#include "utils/CharacteristicsCache.h"
 #include "utils/HWLUtils.h"
+#include "tag_name_resolver.h"
 #include "vendor_tag_defs.h"
 
 namespace android {
@@ -47,6 +52,13 @@ constexpr std::string_view kConfigurationFileDirVendor = "/vendor/etc/config/";
 constexpr std::string_view kConfigurationFileDirApex =
     "/apex/com.google.emulated.camera.provider.hal/etc/config/";
 
+// Compiled characteristics of the configuration files, see
+// CharacteristicsCache.
+constexpr char kCharacteristicsCacheProp[] =
+    "persist.vendor.camera.emulated.characteristics_cache";
+constexpr std::string_view kCharacteristicsCacheDir = "/data/vendor/camera/";
+constexpr std::string_view kCharacteristicsCacheSuffix = ".characteristics";
+
 constexpr StreamSize s240pStreamSize = std::pair(240, 180);
 constexpr StreamSize s720pStreamSize = std::pair(1280, 720);
 constexpr StreamSize s1440pStreamSize = std::pair(1920, 1440);
@@ -61,6 +73,7 @@ EmulatedCameraProviderHwlImpl::Create() {
     return nullptr;
   }
 
+  nsecs_t start_time = systemTime(SYSTEM_TIME_MONOTONIC);
   status_t res = provider->Initialize();
   if (res != OK) {
     ALOGE("%s: Initializing EmulatedCameraProviderHwlImpl failed: %s (%d).",
@@ -68,7 +81,8 @@ EmulatedCameraProviderHwlImpl::Create() {
     return nullptr;
   }
 
-  ALOGI("%s: Created EmulatedCameraProviderHwlImpl", __FUNCTION__);
+  ALOGI("%s: Created EmulatedCameraProviderHwlImpl in %" PRId64 " ms",
+        __FUNCTION__, ns2ms(systemTime(SYSTEM_TIME_MONOTONIC) - start_time));
 
   return provider;
 }
@@ -79,68 +93,9 @@ status_t EmulatedCameraProviderHwlImpl::GetTagFromName(const char* name,
     return BAD_VALUE;
   }
 
-  size_t name_length = strlen(name);
-  // First, find the section by the longest string match
-  const char* section = NULL;
-  size_t section_index = 0;
-  size_t section_length = 0;
-  for (size_t i = 0; i < ANDROID_SECTION_COUNT; ++i) {
-    const char* str = camera_metadata_section_names[i];
-
-    ALOGV("%s: Trying to match against section '%s'", __FUNCTION__, str);
-
-    if (strstr(name, str) == name) {  // name begins with the section name
-      size_t str_length = strlen(str);
-
-      ALOGV("%s: Name begins with section name", __FUNCTION__);
-
-      // section name is the longest we've found so far
-      if (section == NULL || section_length < str_length) {
-        section = str;
-        section_index = i;
-        section_length = str_length;
-
-        ALOGV("%s: Found new best section (%s)", __FUNCTION__, section);
-      }
-    }
-  }
-
-  if (section == NULL) {
-    return NAME_NOT_FOUND;
-  } else {
-    ALOGV("%s: Found matched section '%s' (%zu)", __FUNCTION__, section,
-          section_index);
-  }
-
-  // Get the tag name component of the name
-  const char* name_tag_name = name + section_length + 1;  // x.y.z -> z
-  if (section_length + 1 >= name_length) {
-    return BAD_VALUE;
-  }
-
-  // Match rest of name against the tag names in that section only
-  uint32_t candidate_tag = 0;
-  // Match built-in tags (typically android.*)
-  uint32_t tag_begin, tag_end;  // [tag_begin, tag_end)
-  tag_begin = camera_metadata_section_bounds[section_index][0];
-  tag_end = camera_metadata_section_bounds[section_index][1];
-
-  for (candidate_tag = tag_begin; candidate_tag < tag_end; ++candidate_tag) {
-    const char* tag_name = get_camera_metadata_tag_name(candidate_tag);
-
-    if (strcmp(name_tag_name, tag_name) == 0) {
-      ALOGV("%s: Found matched tag '%s' (%d)", __FUNCTION__, tag_name,
-            candidate_tag);
-      break;
-    }
-  }
-
-  if (candidate_tag == tag_end) {
-    return NAME_NOT_FOUND;
-  }
-
-  *tag = candidate_tag;
-  return OK;
+  // Configuration files name every tag, a linear scan over the section and
+  // tag name tables dominates parsing time.
+  return TagNameResolver::GetInstance().GetTag(name, tag);
 }
 
 static bool IsMaxSupportedSizeGreaterThanOrEqual(
@@ -278,6 +233,55 @@ status_t EmulatedCameraProviderHwlImpl::GetConcurrentStreamingCameraIds(
   return OK;
 }
 
+status_t EmulatedCameraProviderHwlImpl::GetStreamCombinationInfoLocked(
+    uint32_t camera_id, StreamCombinationInfo** info) {
+  auto info_it = stream_combination_infos_.find(camera_id);
+  if (info_it != stream_combination_infos_.end()) {
+    *info = info_it->second.get();
+    return OK;
+  }
+
+  auto new_info = std::make_unique<StreamCombinationInfo>();
+  new_info->stream_configuration_map =
+      std::make_unique<StreamConfigurationMap>(*(static_metadata_[camera_id]));
+  new_info->stream_configuration_map_max_resolution =
+      std::make_unique<StreamConfigurationMap>(*(static_metadata_[camera_id]),
+                                               /*maxResolution*/ true);
+
+  status_t ret = GetSensorCharacteristics(
+      (static_metadata_[camera_id]).get(), &new_info->sensor_chars[camera_id]);
+  if (ret != OK) {
+    ALOGE("%s: Unable to extract sensor chars for camera id %u", __FUNCTION__,
+          camera_id);
+    return UNKNOWN_ERROR;
+  }
+
+  auto const& physicalCameraInfo = camera_id_map_[camera_id];
+  for (size_t i = 0; i < physicalCameraInfo.size(); i++) {
+    uint32_t physical_camera_id = physicalCameraInfo[i].second;
+    new_info->physical_stream_configuration_map.emplace(
+        physical_camera_id, std::make_unique<StreamConfigurationMap>(
+                                *(static_metadata_[physical_camera_id])));
+
+    new_info->physical_stream_configuration_map_max_resolution.emplace(
+        physical_camera_id,
+        std::make_unique<StreamConfigurationMap>(
+            *(static_metadata_[physical_camera_id]), /*maxResolution*/ true));
+
+    ret = GetSensorCharacteristics(static_metadata_[physical_camera_id].get(),
+                                   &new_info->sensor_chars[physical_camera_id]);
+    if (ret != OK) {
+      ALOGE("%s: Unable to extract camera %d sensor characteristics %s (%d)",
+            __FUNCTION__, physical_camera_id, strerror(-ret), ret);
+      return ret;
+    }
+  }
+
+  *info = new_info.get();
+  stream_combination_infos_.emplace(camera_id, std::move(new_info));
+  return OK;
+}
+
 status_t EmulatedCameraProviderHwlImpl::IsConcurrentStreamCombinationSupported(
     const std::vector<CameraIdAndStreamConfiguration>& configs,
     bool* is_supported) {
@@ -285,57 +289,26 @@ status_t EmulatedCameraProviderHwlImpl::IsConcurrentStreamCombinationSupported(
 
   // Go through the given camera ids, get their sensor characteristics, stream
   // config maps and call EmulatedSensor::IsStreamCombinationSupported()
+  std::lock_guard<std::mutex> lock(stream_combination_info_lock_);
   for (auto& config : configs) {
-    // TODO: Consider caching sensor characteristics and StreamConfigurationMap
     if (camera_id_map_.find(config.camera_id) == camera_id_map_.end()) {
       ALOGE("%s: Camera id %u does not exist", __FUNCTION__, config.camera_id);
       return BAD_VALUE;
     }
 
-    auto stream_configuration_map = std::make_unique<StreamConfigurationMap>(
-        *(static_metadata_[config.camera_id]));
-    auto stream_configuration_map_max_resolution =
-        std::make_unique<StreamConfigurationMap>(
-            *(static_metadata_[config.camera_id]), /*maxResolution*/ true);
-
-    LogicalCharacteristics sensor_chars;
-    status_t ret =
-        GetSensorCharacteristics((static_metadata_[config.camera_id]).get(),
-                                 &sensor_chars[config.camera_id]);
+    StreamCombinationInfo* info = nullptr;
+    status_t ret = GetStreamCombinationInfoLocked(config.camera_id, &info);
     if (ret != OK) {
-      ALOGE("%s: Unable to extract sensor chars for camera id %u", __FUNCTION__,
-            config.camera_id);
-      return UNKNOWN_ERROR;
-    }
-
-    PhysicalStreamConfigurationMap physical_stream_configuration_map;
-    PhysicalStreamConfigurationMap physical_stream_configuration_map_max_resolution;
-    auto const& physicalCameraInfo = camera_id_map_[config.camera_id];
-    for (size_t i = 0; i < physicalCameraInfo.size(); i++) {
-      uint32_t physical_camera_id = physicalCameraInfo[i].second;
-      physical_stream_configuration_map.emplace(
-          physical_camera_id, std::make_unique<StreamConfigurationMap>(
-                                  *(static_metadata_[physical_camera_id])));
-
-      physical_stream_configuration_map_max_resolution.emplace(
-          physical_camera_id,
-          std::make_unique<StreamConfigurationMap>(
-              *(static_metadata_[physical_camera_id]), /*maxResolution*/ true));
-
-      ret = GetSensorCharacteristics(static_metadata_[physical_camera_id].get(),
-                                     &sensor_chars[physical_camera_id]);
-      if (ret != OK) {
-        ALOGE("%s: Unable to extract camera %d sensor characteristics %s (%d)",
-              __FUNCTION__, physical_camera_id, strerror(-ret), ret);
-        return ret;
-      }
+      return ret;
     }
 
     if (!EmulatedSensor::IsStreamCombinationSupported(
             config.camera_id, config.stream_configuration,
-            *stream_configuration_map, *stream_configuration_map_max_resolution,
-            physical_stream_configuration_map,
-            physical_stream_configuration_map_max_resolution, sensor_chars)) {
+            *info->stream_configuration_map,
+            *info->stream_configuration_map_max_resolution,
+            info->physical_stream_configuration_map,
+            info->physical_stream_configuration_map_max_resolution,
+            info->sensor_chars, &info->cache)) {
       return OK;
     }
   }
@@ -606,8 +579,9 @@ status_t InsertRationalTag(const Json::Value& json_value, uint32_t tag_id,
   return ret;
 }
 
-uint32_t EmulatedCameraProviderHwlImpl::ParseCharacteristics(
-    const Json::Value& value, ssize_t id) {
+status_t EmulatedCameraProviderHwlImpl::ParseCharacteristics(
+    const Json::Value& value,
+    std::unique_ptr<HalCameraMetadata>* characteristics) {
   if (!value.isObject()) {
     ALOGE("%s: Configuration root is not an object", __FUNCTION__);
     return BAD_VALUE;
@@ -666,14 +640,8 @@ uint32_t EmulatedCameraProviderHwlImpl::ParseCharacteristics(
   int32_t payload_frames = 0;
   static_meta->Set(google_camera_hal::kHdrplusPayloadFrames, &payload_frames, 1);
 
-  if (id < 0) {
-    static_metadata_.push_back(std::move(static_meta));
-    id = static_metadata_.size() - 1;
-  } else {
-    static_metadata_[id] = std::move(static_meta);
-  }
-
-  return id;
+  *characteristics = std::move(static_meta);
+  return OK;
 }
 
 status_t EmulatedCameraProviderHwlImpl::WaitForQemuSfFakeCameraPropertyAvailable() {
@@ -698,11 +666,87 @@ status_t EmulatedCameraProviderHwlImpl::WaitForQemuSfFakeCameraPropertyAvailable
   return OK;
 }
 
+status_t EmulatedCameraProviderHwlImpl::ParseConfiguration(
+    const std::string& config, CameraCharacteristics* characteristics) {
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> config_reader(builder.newCharReader());
+  Json::Value root;
+  std::string error_message;
+  if (!config_reader->parse(&*config.begin(), &*config.end(), &root,
+                            &error_message)) {
+    ALOGE("Could not parse configuration file: %s", error_message.c_str());
+    return BAD_VALUE;
+  }
+
+  if (root.isArray()) {
+    if (root.empty()) {
+      ALOGE("%s: Configuration doesn't describe any camera", __FUNCTION__);
+      return BAD_VALUE;
+    }
+
+    // The first device entry is always the logical camera followed by the
+    // physical devices. They must be at least 2.
+    Json::ArrayIndex num_devices = (root.size() >= 3) ? root.size() : 1;
+    characteristics->resize(num_devices);
+    for (Json::ArrayIndex i = 0; i < num_devices; i++) {
+      status_t ret = ParseCharacteristics(root[i], &characteristics->at(i));
+      if (ret != OK) {
+        return ret;
+      }
+    }
+  } else {
+    characteristics->resize(1);
+    return ParseCharacteristics(root, &characteristics->at(0));
+  }
+
+  return OK;
+}
+
+EmulatedCameraProviderHwlImpl::LoadedConfiguration
+EmulatedCameraProviderHwlImpl::LoadConfiguration(const std::string& config_path,
+                                                 const std::string& config,
+                                                 bool use_cache,
+                                                 uint64_t content_hash) {
+  LoadedConfiguration loaded;
+  if (use_cache) {
+    loaded.content_hash = content_hash;
+    loaded.cache_path = std::string(kCharacteristicsCacheDir) +
+                        android::base::Basename(config_path) +
+                        kCharacteristicsCacheSuffix.data();
+    if (CharacteristicsCache::Load(loaded.cache_path, loaded.content_hash,
+                                   &loaded.characteristics) == OK) {
+      ALOGV("%s: Loaded %s from %s", __FUNCTION__, config_path.c_str(),
+            loaded.cache_path.c_str());
+      loaded.compiled = true;
+      return loaded;
+    }
+  }
+
+  loaded.res = ParseConfiguration(config, &loaded.characteristics);
+  return loaded;
+}
+
+void EmulatedCameraProviderHwlImpl::AddCharacteristics(
+    size_t logical_id, CameraCharacteristics characteristics) {
+  static_metadata_[logical_id] = std::move(characteristics[0]);
+  camera_id_map_.emplace(
+      logical_id, std::vector<std::pair<CameraDeviceStatus, uint32_t>>());
+  for (size_t i = 1; i < characteristics.size(); i++) {
+    static_metadata_.push_back(std::move(characteristics[i]));
+    uint32_t physical_id = static_metadata_.size() - 1;
+    // Only notify unavailable physical camera if there are more than 2
+    // physical cameras backing the logical camera
+    auto device_status = (i - 1 < 2) ? CameraDeviceStatus::kPresent
+                                     : CameraDeviceStatus::kNotPresent;
+    camera_id_map_[logical_id].push_back(
+        std::make_pair(device_status, physical_id));
+  }
+}
+
 status_t EmulatedCameraProviderHwlImpl::Initialize() {
   // GCH expects all physical ids to be bigger than the logical ones.
   // Resize 'static_metadata_' to fit all logical devices and insert them
   // accordingly, push any remaining physical cameras in the back.
-  std::string config;
   size_t logical_id = 0;
   std::vector<std::string> config_file_locations;
   std::string config_dir = "";
@@ -750,83 +794,135 @@ status_t EmulatedCameraProviderHwlImpl::Initialize() {
   }
   static_metadata_.resize(ARRAY_SIZE(kCameraConfigFiles));
 
+  bool use_characteristics_cache =
+      property_get_bool(kCharacteristicsCacheProp, true);
+  // The fingerprint alone doesn't change when only the HAL is updated, e.g.
+  // through its APEX, so the library build ID is included as well.
+  std::string library_build_id = CharacteristicsCache::GetLibraryBuildId();
+  if (use_characteristics_cache && library_build_id.empty()) {
+    ALOGW("%s: No library build ID, characteristics cache disabled",
+          __FUNCTION__);
+    use_characteristics_cache = false;
+  }
+  property_get("ro.vendor.build.fingerprint", prop, "");
+  std::string build_id = std::string(prop) + "/" + library_build_id;
+
+  // Parse the configuration files concurrently. The cached characteristics
+  // embed the camera ids assigned to a file, which depend on the first
+  // logical and physical ids and on the files before it, so the hash of each
+  // file chains the paths and contents of all the files up to it.
+  std::vector<std::future<LoadedConfiguration>> loaded_futures;
+  std::string cache_key = build_id + "/" + std::to_string(logical_id) + "/" +
+                          std::to_string(static_metadata_.size());
   for (const auto& config_path : config_file_locations) {
+    std::string config;
     if (!android::base::ReadFileToString(config_path, &config)) {
       ALOGW("%s: Could not open configuration file: %s", __FUNCTION__,
             config_path.c_str());
       continue;
     }
+    uint64_t content_hash = CharacteristicsCache::GetContentHash(
+        config, cache_key + "/" + config_path);
+    cache_key = std::to_string(content_hash);
+    loaded_futures.push_back(std::async(
+        std::launch::async, &EmulatedCameraProviderHwlImpl::LoadConfiguration,
+        this, config_path, std::move(config), use_characteristics_cache,
+        content_hash));
+  }
+
+  // Physical camera ids are assigned in configuration file order, so each
+  // file is added once the preceding ones are. Logical cameras are adapted to
+  // their physical cameras as soon as their ids are known.
+  struct PendingLogicalCamera {
+    size_t logical_id;
+    std::string cache_path;
+    uint64_t content_hash;
+    std::future<std::unique_ptr<HalCameraMetadata>> adapted;
+  };
+  std::vector<PendingLogicalCamera> pending_cameras;
+  status_t res = OK;
+  for (auto& loaded_future : loaded_futures) {
+    LoadedConfiguration loaded = loaded_future.get();
+    if (res != OK) {
+      continue;
+    }
+    if (loaded.res != OK) {
+      res = loaded.res;
+      continue;
+    }
 
-    Json::CharReaderBuilder builder;
-    std::unique_ptr<Json::CharReader> config_reader(builder.newCharReader());
-    Json::Value root;
-    std::string error_message;
-    if (!config_reader->parse(&*config.begin(), &*config.end(), &root,
-                              &error_message)) {
-      ALOGE("Could not parse configuration file: %s", error_message.c_str());
-      return BAD_VALUE;
+    AddCharacteristics(logical_id, std::move(loaded.characteristics));
+    if (loaded.compiled) {
+      logical_id++;
+      continue;
     }
 
-    if (root.isArray()) {
-      auto device_iter = root.begin();
-      auto result_id = ParseCharacteristics(*device_iter, logical_id);
-      if (logical_id != result_id) {
-        return result_id;
+    PendingLogicalCamera pending = {.logical_id = logical_id,
+                                    .cache_path = loaded.cache_path,
+                                    .content_hash = loaded.content_hash};
+    if (!camera_id_map_[logical_id].empty()) {
+      auto physical_devices = std::make_unique<PhysicalDeviceMap>();
+      for (const auto& physical_device : camera_id_map_[logical_id]) {
+        HalCameraMetadata* physical_metadata =
+            static_metadata_[physical_device.second].get();
+        physical_devices->emplace(
+            physical_device.second,
+            std::make_pair(physical_device.first,
+                           HalCameraMetadata::Clone(physical_metadata)));
       }
-      device_iter++;
-
-      // The first device entry is always the logical camera followed by the
-      // physical devices. They must be at least 2.
-      camera_id_map_.emplace(logical_id, std::vector<std::pair<CameraDeviceStatus, uint32_t>>());
-      if (root.size() >= 3) {
-        camera_id_map_[logical_id].reserve(root.size() - 1);
-        size_t current_physical_device = 0;
-        while (device_iter != root.end()) {
-          auto physical_id = ParseCharacteristics(*device_iter, /*id*/ -1);
-          if (physical_id < 0) {
-            return physical_id;
-          }
-          // Only notify unavailable physical camera if there are more than 2
-          // physical cameras backing the logical camera
-          auto device_status = (current_physical_device < 2) ? CameraDeviceStatus::kPresent :
-              CameraDeviceStatus::kNotPresent;
-          camera_id_map_[logical_id].push_back(std::make_pair(device_status, physical_id));
-          device_iter++; current_physical_device++;
-        }
+      pending.adapted = std::async(
+          std::launch::async,
+          &EmulatedLogicalRequestState::AdaptLogicalCharacteristics,
+          HalCameraMetadata::Clone(static_metadata_[logical_id].get()),
+          std::move(physical_devices));
+    }
+    pending_cameras.push_back(std::move(pending));
+    logical_id++;
+  }
 
-        auto physical_devices = std::make_unique<PhysicalDeviceMap>();
-        for (const auto& physical_device : camera_id_map_[logical_id]) {
-          physical_devices->emplace(
-              physical_device.second, std::make_pair(physical_device.first,
-              HalCameraMetadata::Clone(
-                  static_metadata_[physical_device.second].get())));
-        }
-        auto updated_logical_chars =
-            EmulatedLogicalRequestState::AdaptLogicalCharacteristics(
-                HalCameraMetadata::Clone(static_metadata_[logical_id].get()),
-                std::move(physical_devices));
-        if (updated_logical_chars.get() != nullptr) {
-          static_metadata_[logical_id].swap(updated_logical_chars);
-        } else {
-          ALOGE("%s: Failed to updating logical camera characteristics!",
-                __FUNCTION__);
-          return BAD_VALUE;
-        }
+  for (auto& pending : pending_cameras) {
+    if (pending.adapted.valid()) {
+      auto updated_logical_chars = pending.adapted.get();
+      if (updated_logical_chars.get() != nullptr) {
+        static_metadata_[pending.logical_id].swap(updated_logical_chars);
+      } else if (res == OK) {
+        ALOGE("%s: Failed to updating logical camera characteristics!",
+              __FUNCTION__);
+        res = BAD_VALUE;
       }
-    } else {
-      auto result_id = ParseCharacteristics(root, logical_id);
-      if (result_id != logical_id) {
-        return result_id;
+    }
+
+    if (res == OK && use_characteristics_cache) {
+      std::vector<const HalCameraMetadata*> characteristics = {
+          static_metadata_[pending.logical_id].get()};
+      for (const auto& physical_device : camera_id_map_[pending.logical_id]) {
+        characteristics.push_back(
+            static_metadata_[physical_device.second].get());
       }
-      camera_id_map_.emplace(logical_id, std::vector<std::pair<CameraDeviceStatus, uint32_t>>());
+      CharacteristicsCache::Store(pending.cache_path, pending.content_hash,
+                                  characteristics);
     }
+  }
 
-    logical_id++;
+  if (res != OK) {
+    return res;
   }
 
+  PrecomputeDeviceInfos();
+
   return OK;
 }
 
+void EmulatedCameraProviderHwlImpl::PrecomputeDeviceInfos() {
+  std::lock_guard<std::mutex> lock(device_info_futures_lock_);
+  for (const auto& device : camera_id_map_) {
+    uint32_t camera_id = device.first;
+    device_info_futures_[camera_id] = std::async(
+        std::launch::async, &EmulatedCameraDeviceInfo::Create,
+        HalCameraMetadata::Clone(static_metadata_[camera_id].get()));
+  }
+}
+
 status_t EmulatedCameraProviderHwlImpl::SetCallback(
     const HwlCameraProviderCallback& callback) {
   torch_cb_ = callback.torch_mode_status_change;
@@ -881,7 +977,9 @@ status_t EmulatedCameraProviderHwlImpl::GetVendorTags(
     return BAD_VALUE;
   }
 
-  // No vendor specific tags as of now
+  vendor_tag_sections->insert(vendor_tag_sections->end(),
+                              kEmulatedVendorTagSections.begin(),
+                              kEmulatedVendorTagSections.end());
   return OK;
 }
 
@@ -934,8 +1032,26 @@ status_t EmulatedCameraProviderHwlImpl::CreateCameraDeviceHwl(
           physical_device.second, std::make_pair(physical_device.first,
           HalCameraMetadata::Clone(static_metadata_[physical_device.second].get())));
   }
+
+  // The device info built in the background is only used by the first
+  // device created for a camera.
+  std::future<std::unique_ptr<EmulatedCameraDeviceInfo>> device_info_future;
+  {
+    std::lock_guard<std::mutex> lock(device_info_futures_lock_);
+    auto it = device_info_futures_.find(camera_id);
+    if (it != device_info_futures_.end()) {
+      device_info_future = std::move(it->second);
+      device_info_futures_.erase(it);
+    }
+  }
+  std::unique_ptr<EmulatedCameraDeviceInfo> device_info;
+  if (device_info_future.valid()) {
+    device_info = device_info_future.get();
+  }
+
   *camera_device_hwl = EmulatedCameraDeviceHwlImpl::Create(
-      camera_id, std::move(meta), std::move(physical_devices), torch_state);
+      camera_id, std::move(meta), std::move(physical_devices), torch_state,
+      std::move(device_info));
   if (*camera_device_hwl == nullptr) {
     ALOGE("%s: Cannot create EmulatedCameraDeviceHWlImpl.", __FUNCTION__);
     return BAD_VALUE;
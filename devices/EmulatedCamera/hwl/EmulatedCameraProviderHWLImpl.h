@@ -23,6 +23,9 @@
 #include <json/reader.h>
 #include <future>
 
+#include "EmulatedCameraDeviceInfo.h"
+#include "EmulatedSensor.h"
+
 namespace android {
 
 using google_camera_hal::CameraBufferAllocatorHwl;
@@ -77,12 +80,65 @@ class EmulatedCameraProviderHwlImpl : public CameraProviderHwl {
   // End of override functions in CameraProviderHwl.
 
  private:
+  // Characteristics of a logical camera followed by its physical cameras.
+  typedef std::vector<std::unique_ptr<HalCameraMetadata>> CameraCharacteristics;
+
+  // Characteristics loaded from one configuration file.
+  struct LoadedConfiguration {
+    status_t res = OK;
+    CameraCharacteristics characteristics;
+    // Whether the characteristics came from the characteristics cache, in
+    // which case the logical camera has already been adapted to its physical
+    // cameras.
+    bool compiled = false;
+    uint64_t content_hash = 0;
+    std::string cache_path;
+  };
+
   status_t Initialize();
-  uint32_t ParseCharacteristics(const Json::Value& root, ssize_t id);
+  // Load the characteristics described by config, read from config_path,
+  // from the characteristics cache if use_cache is set and the cache matches
+  // content_hash. This doesn't access members, so configuration files can be
+  // loaded concurrently.
+  LoadedConfiguration LoadConfiguration(const std::string& config_path,
+                                        const std::string& config,
+                                        bool use_cache, uint64_t content_hash);
+  status_t ParseCharacteristics(
+      const Json::Value& root,
+      std::unique_ptr<HalCameraMetadata>* characteristics);
+  // Parse a JSON configuration file describing a logical camera and its
+  // physical cameras.
+  status_t ParseConfiguration(const std::string& config,
+                              CameraCharacteristics* characteristics);
+  // Add camera logical_id and its physical cameras, which are assigned the
+  // next free camera ids.
+  void AddCharacteristics(size_t logical_id,
+                          CameraCharacteristics characteristics);
+  // Start building the device info of each logical camera, which
+  // CreateCameraDeviceHwl() would otherwise do on first open.
+  void PrecomputeDeviceInfos();
   status_t GetTagFromName(const char* name, uint32_t* tag);
   status_t WaitForQemuSfFakeCameraPropertyAvailable();
   bool SupportsMandatoryConcurrentStreams(uint32_t camera_id);
 
+  // Stream configuration maps, sensor characteristics and memoized stream
+  // combination query results of a logical camera and its physical cameras.
+  struct StreamCombinationInfo {
+    std::unique_ptr<StreamConfigurationMap> stream_configuration_map;
+    std::unique_ptr<StreamConfigurationMap>
+        stream_configuration_map_max_resolution;
+    PhysicalStreamConfigurationMap physical_stream_configuration_map;
+    PhysicalStreamConfigurationMap
+        physical_stream_configuration_map_max_resolution;
+    LogicalCharacteristics sensor_chars;
+    StreamCombinationCache cache;
+  };
+
+  // Return the stream combination info of camera_id, building it on first
+  // use. Must be called with stream_combination_info_lock_ locked.
+  status_t GetStreamCombinationInfoLocked(uint32_t camera_id,
+                                          StreamCombinationInfo** info);
+
   std::vector<std::unique_ptr<HalCameraMetadata>> static_metadata_;
   // Logical to physical camera Id mapping. Empty value vector in case
   // of regular non-logical device.
@@ -90,6 +146,18 @@ class EmulatedCameraProviderHwlImpl : public CameraProviderHwl {
   HwlTorchModeStatusChangeFunc torch_cb_;
   HwlPhysicalCameraDeviceStatusChangeFunc physical_camera_status_cb_;
 
+  std::mutex stream_combination_info_lock_;
+  // Protected by stream_combination_info_lock_.
+  std::unordered_map<uint32_t, std::unique_ptr<StreamCombinationInfo>>
+      stream_combination_infos_;
+
+  std::mutex device_info_futures_lock_;
+  // Device infos being built in the background, protected by
+  // device_info_futures_lock_.
+  std::unordered_map<uint32_t,
+                     std::future<std::unique_ptr<EmulatedCameraDeviceInfo>>>
+      device_info_futures_;
+
   std::mutex status_callback_future_lock_;
   std::future<void> status_callback_future_;
   void WaitForStatusCallbackFuture();
@@ -128,6 +128,20 @@ EmulatedLogicalRequestState::InitializeLogicalResult(uint32_t pipeline_id,
   return ret;
 }
 
+void EmulatedLogicalRequestState::UpdateFrameStats(
+    const std::map<uint32_t, FrameStats>& frame_stats) {
+  for (const auto& stats : frame_stats) {
+    if (stats.first == logical_camera_id_) {
+      logical_request_state_->SetFrameStats(stats.second);
+      continue;
+    }
+    auto physical_request_state = physical_request_states_.find(stats.first);
+    if (physical_request_state != physical_request_states_.end()) {
+      physical_request_state->second->SetFrameStats(stats.second);
+    }
+  }
+}
+
 status_t EmulatedLogicalRequestState::InitializeLogicalSettings(
     std::unique_ptr<HalCameraMetadata> request_settings,
     std::unique_ptr<std::set<uint32_t>> physical_camera_output_ids,
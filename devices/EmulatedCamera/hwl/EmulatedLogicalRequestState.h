@@ -76,6 +76,10 @@ class EmulatedLogicalRequestState {
       uint32_t frame_number,
       EmulatedSensor::LogicalCameraSettings* logical_settings /*out*/);
 
+  // Pass the latest frame statistics of the logical and physical cameras to
+  // their request states.
+  void UpdateFrameStats(const std::map<uint32_t, FrameStats>& frame_stats);
+
   static std::unique_ptr<HalCameraMetadata> AdaptLogicalCharacteristics(
       std::unique_ptr<HalCameraMetadata> logical_chars,
       PhysicalDeviceMapPtr physical_devices);
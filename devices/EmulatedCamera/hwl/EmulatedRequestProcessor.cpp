@@ -471,6 +471,9 @@ void EmulatedRequestProcessor::RequestProcessorLoop() {
             }
           }
 
+          // 3A runs on the statistics of the latest processed frame.
+          request_state_->UpdateFrameStats(sensor_->GetLatestFrameStats());
+
           // Repeating requests usually include valid settings only during the
           // initial call. Afterwards an invalid settings pointer means that
           // there are no changes in the parameters and Hal should re-use the
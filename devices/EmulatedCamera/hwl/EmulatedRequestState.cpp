@@ -24,6 +24,7 @@
 #include <utils/HWLUtils.h>
 
 #include "EmulatedRequestProcessor.h"
+#include "EmulatedVendorTags.h"
 
 namespace android {
 
@@ -169,6 +170,24 @@ status_t EmulatedRequestState::DoFakeAE() {
         info.sensor_exposure_time_range_.second);
   }
 
+  if (frame_stats_.IsValid() && (frame_stats_.exposure_time > 0) &&
+      (frame_stats_.sensitivity > 0) && (info.sensor_sensitivity_ > 0)) {
+    // Aim for the exposure that brings the mean luma of the latest frame to
+    // kAETargetLuma at the current sensitivity.
+    float mean_luma = std::max(frame_stats_.GetMeanLuma(), 1.f);
+    float correction = std::pow(kAETargetLuma / mean_luma, kAELumaGamma) *
+                       frame_stats_.sensitivity / info.sensor_sensitivity_;
+    auto stats_target =
+        static_cast<nsecs_t>(frame_stats_.exposure_time * correction);
+    stats_target = GetClosestValue(
+        stats_target,
+        static_cast<nsecs_t>(ae_target_exposure_time_ / kAEMaxStatsCorrection),
+        static_cast<nsecs_t>(ae_target_exposure_time_ * kAEMaxStatsCorrection));
+    ae_target_exposure_time_ = GetClosestValue(
+        stats_target, info.sensor_exposure_time_range_.first,
+        info.sensor_exposure_time_range_.second);
+  }
+
   if ((info.ae_trigger_ == ANDROID_CONTROL_AE_PRECAPTURE_TRIGGER_START) ||
       (info.ae_state_ == ANDROID_CONTROL_AE_STATE_PRECAPTURE)) {
     if (info.ae_state_ != ANDROID_CONTROL_AE_STATE_PRECAPTURE) {
@@ -202,7 +221,13 @@ status_t EmulatedRequestState::DoFakeAE() {
         break;
       case ANDROID_CONTROL_AE_STATE_CONVERGED:
         ae_frame_counter_++;
-        if (ae_frame_counter_ > kStableAeMaxFrames) {
+        if (frame_stats_.IsValid()) {
+          // Follow scene brightness changes instead of wandering randomly
+          if (abs(ae_target_exposure_time_ - current_exposure_time_) >=
+              ae_target_exposure_time_ / kAETargetThreshold) {
+            info.ae_state_ = ANDROID_CONTROL_AE_STATE_SEARCHING;
+          }
+        } else if (ae_frame_counter_ > kStableAeMaxFrames) {
           float exposure_step = ((double)rand_r(&rand_seed_) / RAND_MAX) *
                                     (kExposureWanderMax - kExposureWanderMin) +
                                 kExposureWanderMin;
@@ -264,6 +289,23 @@ status_t EmulatedRequestState::ProcessAWB() {
 
     if (info.awb_lock_ == ANDROID_CONTROL_AWB_LOCK_ON) {
       info.awb_state_ = ANDROID_CONTROL_AWB_STATE_LOCKED;
+    } else if (frame_stats_.IsValid()) {
+      // Search while the gray world color balance of the scene keeps
+      // changing.
+      float rgb[3];
+      frame_stats_.GetMeanRgb(rgb);
+      float ratios[2] = {rgb[0] / std::max(rgb[1], 1.f),
+                         rgb[2] / std::max(rgb[1], 1.f)};
+      bool stable = true;
+      for (size_t i = 0; i < 2; i++) {
+        if (fabs(ratios[i] - awb_gray_world_ratios_[i]) >
+            awb_gray_world_ratios_[i] * kAWBStableThreshold) {
+          stable = false;
+        }
+        awb_gray_world_ratios_[i] = ratios[i];
+      }
+      info.awb_state_ = stable ? ANDROID_CONTROL_AWB_STATE_CONVERGED
+                               : ANDROID_CONTROL_AWB_STATE_SEARCHING;
     } else {
       info.awb_state_ = ANDROID_CONTROL_AWB_STATE_CONVERGED;
     }
@@ -856,6 +898,10 @@ status_t EmulatedRequestState::InitializeSensorSettings(
   sensor_settings->report_video_stab = !info.available_vstab_modes_.empty();
   sensor_settings->video_stab = vstab_mode;
   sensor_settings->report_edge_mode = info.report_edge_mode_;
+  camera_metadata_ro_entry_t stats_entry;
+  sensor_settings->report_frame_stats =
+      (request_settings_->Get(kEmulatedStatsEnable, &stats_entry) == OK) &&
+      (stats_entry.count == 1) && (stats_entry.data.u8[0] != 0);
   sensor_settings->edge_mode = edge_mode;
   sensor_settings->sensor_pixel_mode = info.sensor_pixel_mode_;
   sensor_settings->test_pattern_mode = test_pattern_mode;
@@ -879,6 +925,11 @@ uint32_t EmulatedRequestState::GetPartialResultCount(bool is_partial_result) {
   return res;
 }
 
+void EmulatedRequestState::SetFrameStats(const FrameStats& frame_stats) {
+  std::lock_guard<std::mutex> lock(request_state_mutex_);
+  frame_stats_ = frame_stats;
+}
+
 std::unique_ptr<HwlPipelineResult> EmulatedRequestState::InitializePartialResult(
     uint32_t pipeline_id, uint32_t frame_number) {
   auto& info = *device_info_;
@@ -1008,7 +1059,7 @@ std::unique_ptr<HwlPipelineResult> EmulatedRequestState::InitializeResult(
   if (info.report_rolling_shutter_skew_) {
     result->result_metadata->Set(
         ANDROID_SENSOR_ROLLING_SHUTTER_SKEW,
-        &EmulatedSensor::kSupportedFrameDurationRange[0], 1);
+        &EmulatedSensor::kRollingShutterSkew, 1);
   }
   if (info.report_post_raw_boost_) {
     result->result_metadata->Set(ANDROID_CONTROL_POST_RAW_SENSITIVITY_BOOST,
@@ -60,6 +60,9 @@ class EmulatedRequestState {
 
   uint32_t GetPartialResultCount(bool is_partial_result);
 
+  // Statistics of the latest frame, used by 3A for the next requests.
+  void SetFrameStats(const FrameStats& frame_stats);
+
  private:
   status_t ProcessAE();
   status_t ProcessAF();
@@ -89,9 +92,23 @@ class EmulatedRequestState {
   const float kExposureWanderMax = 1;
   const uint32_t kAETargetThreshold =
       10;  // Defines a threshold for reaching the AE target
+  // With frame statistics the AE target is adjusted until the mean luma of
+  // the frames reaches kAETargetLuma. The adjustment is limited to
+  // kAEMaxStatsCorrection times the fake AE target in either direction.
+  const float kAETargetLuma = 118.f;
+  const float kAEMaxStatsCorrection = 4.f;
+  // The frame luma is gamma encoded, roughly proportional to the exposure
+  // raised to the power of 1 / kAELumaGamma.
+  const float kAELumaGamma = 2.2f;
+  // Relative change of the gray world R/G and B/G ratios between frames
+  // above which AWB searches.
+  const float kAWBStableThreshold = .05f;
   nsecs_t ae_target_exposure_time_ = EmulatedSensor::kDefaultExposureTime;
   nsecs_t current_exposure_time_ = EmulatedSensor::kDefaultExposureTime;
   bool af_mode_changed_ = false;
+  FrameStats frame_stats_;
+  // Gray world R/G and B/G ratios of the latest frame AWB ran on.
+  float awb_gray_world_ratios_[2] = {0.f, 0.f};
   uint32_t settings_overriding_frame_number_ = 0;
 
   unsigned int rand_seed_ = 1;
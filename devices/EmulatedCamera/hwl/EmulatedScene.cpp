@@ -171,6 +171,10 @@ void EmulatedScene::SetTestPatternData(uint32_t data[4]) {
   memcpy(test_pattern_data_, data, 4);
 }
 
+void EmulatedScene::SetRollingShutterSkew(nsecs_t skew) {
+  rolling_shutter_skew_ = skew;
+}
+
 void EmulatedScene::CalculateScene(nsecs_t time, int32_t handshake_divider) {
   // Calculate time fractions for interpolation
   const nsecs_t kOneHourInNsec = 1e9 * 60 * 60;
@@ -334,21 +338,18 @@ void EmulatedScene::CalculateScene(nsecs_t time, int32_t handshake_divider) {
           current_colors_[i * NUM_CHANNELS + 2],
           current_colors_[i * NUM_CHANNELS + 3]);
   }
-  // Shake viewpoint; horizontal and vertical sinusoids at roughly
-  // human handshake frequencies
-  handshake_x_ =
-      (kFreq1Magnitude * std::sin(kHorizShakeFreq1 * time_since_idx) +
-       kFreq2Magnitude * std::sin(kHorizShakeFreq2 * time_since_idx)) *
-      map_div_ * kShakeFraction;
-  if (handshake_divider > 0) {
-    handshake_x_ /= handshake_divider;
-  }
-
-  handshake_y_ = (kFreq1Magnitude * std::sin(kVertShakeFreq1 * time_since_idx) +
-                  kFreq2Magnitude * std::sin(kVertShakeFreq2 * time_since_idx)) *
-                 map_div_ * kShakeFraction;
-  if (handshake_divider > 0) {
-    handshake_y_ /= handshake_divider;
+  CalculateHandshake(time_since_idx, handshake_divider, &handshake_x_,
+                     &handshake_y_);
+  if (rolling_shutter_skew_ > 0) {
+    // Bands are read out top to bottom, each one at its own point of the
+    // handshake.
+    band_rows_ = (sensor_height_ + kReadoutBands - 1) / kReadoutBands;
+    for (int band = 0; band < kReadoutBands; band++) {
+      CalculateHandshake(
+          time_since_idx + rolling_shutter_skew_ * band / kReadoutBands,
+          handshake_divider, &band_handshake_x_[band],
+          &band_handshake_y_[band]);
+    }
   }
 
   int32_t sensor_orientation =
@@ -372,6 +373,26 @@ void EmulatedScene::CalculateScene(nsecs_t time, int32_t handshake_divider) {
   SetReadoutPixel(0, 0);
 }
 
+void EmulatedScene::CalculateHandshake(nsecs_t time, int32_t handshake_divider,
+                                       int* handshake_x,
+                                       int* handshake_y) const {
+  // Shake viewpoint; horizontal and vertical sinusoids at roughly
+  // human handshake frequencies
+  *handshake_x = (kFreq1Magnitude * std::sin(kHorizShakeFreq1 * time) +
+                  kFreq2Magnitude * std::sin(kHorizShakeFreq2 * time)) *
+                 map_div_ * kShakeFraction;
+  if (handshake_divider > 0) {
+    *handshake_x /= handshake_divider;
+  }
+
+  *handshake_y = (kFreq1Magnitude * std::sin(kVertShakeFreq1 * time) +
+                  kFreq2Magnitude * std::sin(kVertShakeFreq2 * time)) *
+                 map_div_ * kShakeFraction;
+  if (handshake_divider > 0) {
+    *handshake_y /= handshake_divider;
+  }
+}
+
 void EmulatedScene::InitiliazeSceneRotation(bool clock_wise) {
   memcpy(scene_rot0_, kScene, sizeof(scene_rot0_));
 
@@ -408,10 +429,14 @@ void EmulatedScene::InitiliazeSceneRotation(bool clock_wise) {
 void EmulatedScene::SetReadoutPixel(int x, int y) {
   current_x_ = x;
   current_y_ = y;
-  sub_x_ = (x + offset_x_ + handshake_x_) % map_div_;
-  sub_y_ = (y + offset_y_ + handshake_y_) % map_div_;
-  scene_x_ = (x + offset_x_ + handshake_x_) / map_div_;
-  scene_y_ = (y + offset_y_ + handshake_y_) / map_div_;
+  int handshake_x = handshake_x_, handshake_y = handshake_y_;
+  if (rolling_shutter_skew_ > 0) {
+    GetBandHandshake(y, &handshake_x, &handshake_y);
+  }
+  sub_x_ = (x + offset_x_ + handshake_x) % map_div_;
+  sub_y_ = (y + offset_y_ + handshake_y) % map_div_;
+  scene_x_ = (x + offset_x_ + handshake_x) / map_div_;
+  scene_y_ = (y + offset_y_ + handshake_y) / map_div_;
   scene_idx_ = scene_y_ * kSceneWidth + scene_x_;
   current_scene_material_ = &(current_colors_[current_scene_[scene_idx_]]);
 }
@@ -454,6 +479,56 @@ const uint32_t* EmulatedScene::GetPixelElectronsColumn() {
   return pixel;
 }
 
+const uint32_t* EmulatedScene::GetPixelElectronsAt(int x, int y) const {
+  if (test_pattern_mode_) return test_pattern_data_;
+
+  int handshake_x = handshake_x_, handshake_y = handshake_y_;
+  if (rolling_shutter_skew_ > 0) {
+    GetBandHandshake(y, &handshake_x, &handshake_y);
+  }
+  int scene_x = (x + offset_x_ + handshake_x) / map_div_;
+  int scene_y = (y + offset_y_ + handshake_y) / map_div_;
+  return &(current_colors_[current_scene_[scene_y * kSceneWidth + scene_x]]);
+}
+
+uint64_t EmulatedScene::GetSignature() const {
+  // 64-bit FNV-1a
+  uint64_t signature = 0xcbf29ce484222325ULL;
+  auto add = [&signature](const void* data, size_t size) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+      signature = (signature ^ bytes[i]) * 0x100000001b3ULL;
+    }
+  };
+
+  add(&test_pattern_mode_, sizeof(test_pattern_mode_));
+  if (test_pattern_mode_) {
+    add(test_pattern_data_, sizeof(test_pattern_data_));
+    return signature;
+  }
+
+  int32_t geometry[] = {sensor_width_, sensor_height_, offset_x_,
+                        offset_y_,     handshake_x_,  handshake_y_,
+                        map_div_};
+  add(geometry, sizeof(geometry));
+  if (rolling_shutter_skew_ > 0) {
+    add(band_handshake_x_, sizeof(band_handshake_x_));
+    add(band_handshake_y_, sizeof(band_handshake_y_));
+  }
+  // Only the RGGB channels of the materials are calculated.
+  for (int i = 0; i < NUM_MATERIALS; i++) {
+    add(&current_colors_[i * NUM_CHANNELS], 4 * sizeof(current_colors_[0]));
+  }
+  // The rotated scenes only differ by their layout.
+  uint8_t rotation = current_scene_ == scene_rot90_    ? 1
+                     : current_scene_ == scene_rot180_ ? 2
+                     : current_scene_ == scene_rot270_ ? 3
+                                                       : 0;
+  add(&rotation, sizeof(rotation));
+
+  return signature;
+}
+
 // Handshake model constants.
 // Frequencies measured in a nanosecond timebase
 const float EmulatedScene::kHorizShakeFreq1 = 2 * M_PI * 2 / 1e9;   // 2 Hz
@@ -66,6 +66,12 @@ class EmulatedScene {
   void SetTestPattern(bool enabled);
   void SetTestPatternData(uint32_t data[4]);
 
+  // Set the time between the start of readout of the first and last sensor
+  // rows. When non-zero, rows are read out in kReadoutBands bands, each with
+  // the handshake at the time it is read. Must be called before
+  // calculateScene.
+  void SetRollingShutterSkew(nsecs_t skew);
+
   // Calculate scene information for current hour and the time offset since
   // the hour. Resets pixel readout location to 0,0
   void CalculateScene(nsecs_t time, int32_t handshake_divider);
@@ -85,13 +91,35 @@ class EmulatedScene {
   // indexed with ColorChannels.
   const uint32_t* GetPixelElectronsColumn();
 
+  // Get sensor response in physical units (electrons) for light hitting
+  // sensor pixel x, y, after passing through color filters. The readout
+  // pixel is left unchanged, so sparse sampling doesn't need to walk over
+  // skipped pixels. The returned array can be indexed with ColorChannels.
+  const uint32_t* GetPixelElectronsAt(int x, int y) const;
+
+  // Signature of the scene state set up by the last CalculateScene() call.
+  // Scenes with the same signature return the same electrons for every
+  // pixel, so their renders can be reused.
+  uint64_t GetSignature() const;
+
   enum ColorChannels { R = 0, Gr, Gb, B, Y, Cb, Cr, NUM_CHANNELS };
 
   static const int kSceneWidth = 20;
   static const int kSceneHeight = 20;
+  static const int kReadoutBands = 16;
 
  private:
   void InitiliazeSceneRotation(bool clock_wise);
+  void CalculateHandshake(nsecs_t time, int32_t handshake_divider,
+                          int* handshake_x, int* handshake_y) const;
+  // Handshake of the readout band of sensor row y.
+  inline void GetBandHandshake(int y, int* handshake_x,
+                               int* handshake_y) const {
+    int band = y / band_rows_;
+    if (band >= kReadoutBands) band = kReadoutBands - 1;
+    *handshake_x = band_handshake_x_[band];
+    *handshake_y = band_handshake_y_[band];
+  }
 
   uint8_t scene_rot0_[kSceneWidth*kSceneHeight];
   uint8_t scene_rot90_[kSceneWidth*kSceneHeight];
@@ -113,6 +141,11 @@ class EmulatedScene {
 
   int handshake_x_, handshake_y_;
 
+  nsecs_t rolling_shutter_skew_ = 0;
+  int band_rows_ = 1;
+  int band_handshake_x_[kReadoutBands] = {};
+  int band_handshake_y_[kReadoutBands] = {};
+
   int sensor_width_;
   int sensor_height_;
   int current_x_;
@@ -128,8 +161,8 @@ class EmulatedScene {
   float exposure_duration_;
   float sensor_sensitivity_;  // electrons per lux-second
 
-  bool test_pattern_mode_;  // SOLID_COLOR only
-  uint32_t test_pattern_data_[4];
+  bool test_pattern_mode_ = false;  // SOLID_COLOR only
+  uint32_t test_pattern_data_[4] = {};
 
   enum Materials {
     GRASS = 0,
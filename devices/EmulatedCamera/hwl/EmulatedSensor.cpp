@@ -39,8 +39,10 @@
 #include <cstdlib>
 
 #include "EmulatedSensor.h"
+#include "EmulatedVendorTags.h"
 #include "utils/ExifUtils.h"
 #include "utils/HWLUtils.h"
+#include "utils/QuadBayerRemosaic.h"
 
 namespace android {
 
@@ -99,6 +101,21 @@ const uint32_t EmulatedSensor::kDefaultBlackLevelPattern[4] = {1000, 1000, 1000,
 
 const nsecs_t EmulatedSensor::kMinVerticalBlank = 10000L;
 
+// Set to true before the camera is opened to run the sensor on a virtual
+// clock, see EmulatedSensor::use_virtual_clock_.
+static const char kVirtualClockProp[] = "vendor.camera.emulated.virtual_clock";
+
+// Rows are read out over the minimum frame duration. The readout is only
+// simulated row by row, see EmulatedScene::SetRollingShutterSkew(), if the
+// property below is set to true before the camera is opened.
+const nsecs_t EmulatedSensor::kRollingShutterSkew =
+    kSupportedFrameDurationRange[0];
+static const char kRollingShutterProp[] =
+    "vendor.camera.emulated.rolling_shutter";
+// Set to true before the camera is opened to deliver JPEG inputs in slices,
+// see EmulatedSensor::use_slice_delivery_.
+static const char kSliceDeliveryProp[] = "vendor.camera.emulated.slice_delivery";
+
 // Sensor sensitivity
 const float EmulatedSensor::kSaturationVoltage = 0.520f;
 const uint32_t EmulatedSensor::kSaturationElectrons = 2000;
@@ -127,6 +144,7 @@ const uint32_t EmulatedSensor::kMaxLensShadingMapSize[2]{64, 64};
 const int32_t EmulatedSensor::kFixedBitPrecision = 64;  // 6-bit
 // In fixed-point math, saturation point of sensor after gain
 const int32_t EmulatedSensor::kSaturationPoint = kFixedBitPrecision * 255;
+const int32_t EmulatedSensor::kColorMatrixFractionBits = 14;
 const camera_metadata_rational EmulatedSensor::kNeutralColorPoint[3] = {
     {255, 1}, {255, 1}, {255, 1}};
 const float EmulatedSensor::kGreenSplit = 1.f;  // No divergence
@@ -354,25 +372,42 @@ bool EmulatedSensor::IsStreamCombinationSupported(
     StreamConfigurationMap& max_resolution_config_map,
     const PhysicalStreamConfigurationMap& physical_map,
     const PhysicalStreamConfigurationMap& physical_map_max_resolution,
-    const LogicalCharacteristics& sensor_chars) {
+    const LogicalCharacteristics& sensor_chars,
+    StreamCombinationCache* cache) {
+  std::string key;
+  if (cache != nullptr) {
+    key = StreamCombinationCache::GetKey(config);
+    bool supported = false;
+    if (cache->Lookup(key, &supported)) {
+      return supported;
+    }
+  }
+
   StreamConfiguration default_mode_config, max_resolution_mode_config,
       input_stream_config;
   SplitStreamCombination(config, &default_mode_config,
                          &max_resolution_mode_config, &input_stream_config);
 
-  return IsStreamCombinationSupported(logical_id, default_mode_config,
-                                      default_config_map, physical_map,
-                                      sensor_chars) &&
-         IsStreamCombinationSupported(
-             logical_id, max_resolution_mode_config, max_resolution_config_map,
-             physical_map_max_resolution, sensor_chars, /*is_max_res*/ true) &&
-
-         (IsStreamCombinationSupported(logical_id, input_stream_config,
-                                       default_config_map, physical_map,
-                                       sensor_chars) ||
-          IsStreamCombinationSupported(
-              logical_id, input_stream_config, max_resolution_config_map,
-              physical_map_max_resolution, sensor_chars, /*is_max_res*/ true));
+  bool supported =
+      IsStreamCombinationSupported(logical_id, default_mode_config,
+                                   default_config_map, physical_map,
+                                   sensor_chars) &&
+      IsStreamCombinationSupported(
+          logical_id, max_resolution_mode_config, max_resolution_config_map,
+          physical_map_max_resolution, sensor_chars, /*is_max_res*/ true) &&
+
+      (IsStreamCombinationSupported(logical_id, input_stream_config,
+                                    default_config_map, physical_map,
+                                    sensor_chars) ||
+       IsStreamCombinationSupported(
+           logical_id, input_stream_config, max_resolution_config_map,
+           physical_map_max_resolution, sensor_chars, /*is_max_res*/ true));
+
+  if (cache != nullptr) {
+    cache->Insert(key, supported);
+  }
+
+  return supported;
 }
 
 bool EmulatedSensor::IsStreamCombinationSupported(
@@ -404,9 +439,7 @@ bool EmulatedSensor::IsStreamCombinationSupported(
         return false;
       }
 
-      auto const& supported_outputs =
-          config_map.GetValidOutputFormatsForInput(stream.format);
-      if (supported_outputs.empty()) {
+      if (!config_map.IsInputSupported(stream.format)) {
         ALOGE("%s: Input stream with format: 0x%x no supported on this device!",
               __FUNCTION__, stream.format);
         return false;
@@ -422,7 +455,7 @@ bool EmulatedSensor::IsStreamCombinationSupported(
       }
 
       if (is_dynamic_output) {
-        auto dynamic_physical_output_formats =
+        const auto& dynamic_physical_output_formats =
             physical_map.at(stream.physical_camera_id)
                 ->GetDynamicPhysicalStreamOutputFormats();
         if (dynamic_physical_output_formats.find(stream.format) ==
@@ -524,17 +557,18 @@ bool EmulatedSensor::IsStreamCombinationSupported(
           }
       }
 
-      auto output_sizes =
+      bool is_output_supported =
           is_dynamic_output
               ? physical_map.at(stream.physical_camera_id)
-                    ->GetDynamicPhysicalStreamOutputSizes(stream.format)
+                    ->IsDynamicPhysicalOutputSupported(
+                        stream.format, stream.width, stream.height)
               : stream.is_physical_camera_stream
                     ? physical_map.at(stream.physical_camera_id)
-                          ->GetOutputSizes(stream.format)
-                    : config_map.GetOutputSizes(stream.format);
-
-      auto stream_size = std::make_pair(stream.width, stream.height);
-      if (output_sizes.find(stream_size) == output_sizes.end()) {
+                          ->IsOutputSupported(stream.format, stream.width,
+                                              stream.height)
+                    : config_map.IsOutputSupported(stream.format, stream.width,
+                                                   stream.height);
+      if (!is_output_supported) {
         ALOGE("%s: Stream with size %dx%d and format 0x%x is not supported!",
               __FUNCTION__, stream.width, stream.height, stream.format);
         return false;
@@ -630,9 +664,18 @@ bool EmulatedSensor::IsStreamCombinationSupported(
   return true;
 }
 
+EmulatedSensor::Options EmulatedSensor::GetOptionsFromProperties() {
+  return {
+      .use_virtual_clock = property_get_bool(kVirtualClockProp, false),
+      .use_slice_delivery = property_get_bool(kSliceDeliveryProp, false),
+      .simulate_rolling_shutter = property_get_bool(kRollingShutterProp, false),
+  };
+}
+
 status_t EmulatedSensor::StartUp(
     uint32_t logical_camera_id,
-    std::unique_ptr<LogicalCharacteristics> logical_chars) {
+    std::unique_ptr<LogicalCharacteristics> logical_chars,
+    const Options& options) {
   if (isRunning()) {
     return OK;
   }
@@ -659,10 +702,22 @@ status_t EmulatedSensor::StartUp(
   }
 
   logical_camera_id_ = logical_camera_id;
+  use_virtual_clock_ = options.use_virtual_clock;
+  if (use_virtual_clock_) {
+    ALOGI("%s: Using a virtual sensor clock", __FUNCTION__);
+    virtual_clock_start_monotonic_ = systemTime(SYSTEM_TIME_MONOTONIC);
+    virtual_clock_start_boottime_ = systemTime(SYSTEM_TIME_BOOTTIME);
+    virtual_clock_elapsed_ = 0;
+  }
+  use_slice_delivery_ = options.use_slice_delivery;
   scene_ = std::make_unique<EmulatedScene>(
       device_chars->second.full_res_width, device_chars->second.full_res_height,
       kElectronsPerLuxSecond, device_chars->second.orientation,
       device_chars->second.is_front_facing);
+  if (options.simulate_rolling_shutter) {
+    ALOGI("%s: Simulating the rolling shutter readout", __FUNCTION__);
+    scene_->SetRollingShutterSkew(kRollingShutterSkew);
+  }
   jpeg_compressor_ = std::make_unique<JpegCompressor>();
 
   auto res = run(LOG_TAG, ANDROID_PRIORITY_URGENT_DISPLAY);
@@ -694,6 +749,7 @@ void EmulatedSensor::SetCurrentRequest(
   current_input_buffers_ = std::move(input_buffers);
   current_output_buffers_ = std::move(output_buffers);
   partial_result_ = std::move(partial_result);
+  request_available_.signal();
 }
 
 bool EmulatedSensor::WaitForVSyncLocked(nsecs_t reltime) {
@@ -756,7 +812,23 @@ status_t EmulatedSensor::Flush() {
   return ret ? OK : TIMED_OUT;
 }
 
+std::map<uint32_t, FrameStats> EmulatedSensor::GetLatestFrameStats() {
+  Mutex::Autolock lock(frame_stats_mutex_);
+  return latest_frame_stats_;
+}
+
+FrameStats* EmulatedSensor::GetFrameStatsToCollect(uint32_t camera_id) {
+  auto& stats = frame_stats_[camera_id];
+  return stats.IsValid() ? nullptr : &stats;
+}
+
 nsecs_t EmulatedSensor::getSystemTimeWithSource(uint32_t timestamp_source) {
+  if (use_virtual_clock_) {
+    return virtual_clock_elapsed_ +
+           (timestamp_source == ANDROID_SENSOR_INFO_TIMESTAMP_SOURCE_REALTIME
+                ? virtual_clock_start_boottime_
+                : virtual_clock_start_monotonic_);
+  }
   if (timestamp_source == ANDROID_SENSOR_INFO_TIMESTAMP_SOURCE_REALTIME) {
     return systemTime(SYSTEM_TIME_BOOTTIME);
   }
@@ -785,6 +857,13 @@ bool EmulatedSensor::threadLoop() {
   };
   {
     Mutex::Autolock lock(control_mutex_);
+    if (use_virtual_clock_ && (current_output_buffers_.get() == nullptr)) {
+      // Nothing else paces the loop. Let the request processor submit its
+      // next request and wait for it instead of spinning.
+      got_vsync_ = true;
+      vsync_.signal();
+      request_available_.waitRelative(control_mutex_, kDefaultFrameDuration);
+    }
     std::swap(settings, current_settings_);
     std::swap(next_buffers, current_output_buffers_);
     std::swap(next_input_buffer, current_input_buffers_);
@@ -800,6 +879,7 @@ bool EmulatedSensor::threadLoop() {
   auto frame_duration = EmulatedSensor::kSupportedFrameDurationRange[0];
   auto exposure_time = EmulatedSensor::kSupportedExposureTimeRange[0];
   uint32_t timestamp_source = ANDROID_SENSOR_INFO_TIMESTAMP_SOURCE_UNKNOWN;
+  bool has_request = settings.get() != nullptr;
   // Frame duration must always be the same among all physical devices
   if ((settings.get() != nullptr) && (!settings->empty())) {
     frame_duration = settings->begin()->second.frame_duration;
@@ -819,6 +899,7 @@ bool EmulatedSensor::threadLoop() {
   next_readout_time_ = frame_end_real_time + exposure_time;
 
   sensor_binning_factor_info_.clear();
+  frame_stats_.clear();
 
   bool reprocess_request = false;
   if ((next_input_buffer.get() != nullptr) && (!next_input_buffer->empty())) {
@@ -858,6 +939,10 @@ bool EmulatedSensor::threadLoop() {
                   static_cast<uint64_t>(next_readout_time_)}};
       callback.notify(next_result->pipeline_id, msg);
     }
+    YUV420RenderPlan render_plan;
+    if (!reprocess_request) {
+      PlanYUV420Renders(*next_buffers, *settings, &render_plan);
+    }
     auto b = next_buffers->begin();
     while (b != next_buffers->end()) {
       auto device_settings = settings->find((*b)->camera_id);
@@ -1032,10 +1117,11 @@ bool EmulatedSensor::threadLoop() {
           break;
         case PixelFormat::RGB_888:
           if (!reprocess_request) {
-            CaptureRGB((*b)->plane.img.img, (*b)->width, (*b)->height,
+            ProcessRGB((*b)->plane.img.img, (*b)->width, (*b)->height,
                        (*b)->plane.img.stride_in_bytes, RGBLayout::RGB,
                        device_settings->second.gain, (*b)->color_space,
-                       device_chars->second);
+                       device_chars->second, (*b)->camera_id,
+                       GetFrameStatsToCollect((*b)->camera_id));
           } else {
             ALOGE("%s: Reprocess requests with output format %x no supported!",
                   __FUNCTION__, (*b)->format);
@@ -1044,10 +1130,11 @@ bool EmulatedSensor::threadLoop() {
           break;
         case PixelFormat::RGBA_8888:
           if (!reprocess_request) {
-            CaptureRGB((*b)->plane.img.img, (*b)->width, (*b)->height,
+            ProcessRGB((*b)->plane.img.img, (*b)->width, (*b)->height,
                        (*b)->plane.img.stride_in_bytes, RGBLayout::RGBA,
                        device_settings->second.gain, (*b)->color_space,
-                       device_chars->second);
+                       device_chars->second, (*b)->camera_id,
+                       GetFrameStatsToCollect((*b)->camera_id));
           } else {
             ALOGE("%s: Reprocess requests with output format %x no supported!",
                   __FUNCTION__, (*b)->format);
@@ -1086,28 +1173,51 @@ bool EmulatedSensor::threadLoop() {
 
             bool rotate = device_settings->second.rotate_and_crop ==
                           ANDROID_SCALER_ROTATE_AND_CROP_90;
-            auto ret = ProcessYUV420(yuv_input, yuv_output,
-                                     device_settings->second.gain, process_type,
-                                     device_settings->second.zoom_ratio, rotate,
-                                     (*b)->color_space, device_chars->second);
-            if (ret != 0) {
-              (*b)->stream_buffer.status = BufferStatus::kError;
-              break;
+            uint32_t camera_id = (*b)->camera_id;
+            int32_t color_space = (*b)->color_space;
+            std::shared_ptr<SliceProgress> progress;
+            if (use_slice_delivery_ && !treat_as_reprocess) {
+              progress = std::make_shared<SliceProgress>(jpeg_input->height);
+              jpeg_input->progress = progress;
+              jpeg_input->thumbnail = RenderJpegThumbnail(
+                  *next_result->result_metadata, device_settings->second.gain,
+                  device_settings->second.zoom_ratio, rotate, color_space,
+                  device_chars->second);
             }
 
             auto jpeg_job = std::make_unique<JpegYUV420Job>();
             jpeg_job->exif_utils = std::unique_ptr<ExifUtils>(
                 ExifUtils::Create(device_chars->second));
             jpeg_job->input = std::move(jpeg_input);
-            // If jpeg compression is successful, then the jpeg compressor
-            // must set the corresponding status.
-            (*b)->stream_buffer.status = BufferStatus::kError;
-            std::swap(jpeg_job->output, *b);
             jpeg_job->result_metadata =
                 HalCameraMetadata::Clone(next_result->result_metadata.get());
+            auto queue_jpeg_job = [&]() {
+              // If jpeg compression is successful, then the jpeg compressor
+              // must set the corresponding status.
+              (*b)->stream_buffer.status = BufferStatus::kError;
+              std::swap(jpeg_job->output, *b);
 
-            Mutex::Autolock lock(control_mutex_);
-            jpeg_compressor_->QueueYUV420(std::move(jpeg_job));
+              Mutex::Autolock lock(control_mutex_);
+              jpeg_compressor_->QueueYUV420(std::move(jpeg_job));
+            };
+
+            // With slice delivery the compressor starts on the first rows
+            // while the rest of the input is rendered.
+            if (progress.get() != nullptr) {
+              queue_jpeg_job();
+            }
+            auto ret = ProcessYUV420(
+                yuv_input, yuv_output, device_settings->second.gain,
+                process_type, device_settings->second.zoom_ratio, rotate,
+                color_space, device_chars->second, camera_id, &render_plan,
+                GetFrameStatsToCollect(camera_id), progress.get());
+            if (progress.get() != nullptr) {
+              progress->Finish(ret == 0);
+            } else if (ret != 0) {
+              (*b)->stream_buffer.status = BufferStatus::kError;
+            } else {
+              queue_jpeg_job();
+            }
           } else {
             ALOGE("%s: Format %x with dataspace %x is TODO", __FUNCTION__,
                   (*b)->format, (*b)->dataSpace);
@@ -1129,10 +1239,11 @@ bool EmulatedSensor::threadLoop() {
                                  .planes = (*b)->plane.img_y_crcb};
           bool rotate = device_settings->second.rotate_and_crop ==
                         ANDROID_SCALER_ROTATE_AND_CROP_90;
-          auto ret =
-              ProcessYUV420(yuv_input, yuv_output, device_settings->second.gain,
-                            process_type, device_settings->second.zoom_ratio,
-                            rotate, (*b)->color_space, device_chars->second);
+          auto ret = ProcessYUV420(
+              yuv_input, yuv_output, device_settings->second.gain,
+              process_type, device_settings->second.zoom_ratio, rotate,
+              (*b)->color_space, device_chars->second, (*b)->camera_id,
+              &render_plan, GetFrameStatsToCollect((*b)->camera_id));
           if (ret != 0) {
             (*b)->stream_buffer.status = BufferStatus::kError;
           }
@@ -1165,7 +1276,9 @@ bool EmulatedSensor::threadLoop() {
                                      .planes = (*b)->plane.img_y_crcb};
               ProcessYUV420(yuv_input, yuv_output, device_settings->second.gain,
                             process_type, device_settings->second.zoom_ratio,
-                            rotate, (*b)->color_space, device_chars->second);
+                            rotate, (*b)->color_space, device_chars->second,
+                            (*b)->camera_id, &render_plan,
+                            GetFrameStatsToCollect((*b)->camera_id));
             } else {
               ALOGE(
                   "%s: Reprocess requests with output format %x no supported!",
@@ -1183,6 +1296,20 @@ bool EmulatedSensor::threadLoop() {
     }
   }
 
+  {
+    Mutex::Autolock lock(frame_stats_mutex_);
+    for (auto& stats : frame_stats_) {
+      if (stats.second.IsValid()) {
+        auto device_settings = settings->find(stats.first);
+        if (device_settings != settings->end()) {
+          stats.second.exposure_time = device_settings->second.exposure_time;
+          stats.second.sensitivity = device_settings->second.gain;
+        }
+        latest_frame_stats_[stats.first] = stats.second;
+      }
+    }
+  }
+
   if (reprocess_request) {
     auto input_buffer = next_input_buffer->begin();
     while (input_buffer != next_input_buffer->end()) {
@@ -1212,7 +1339,14 @@ bool EmulatedSensor::threadLoop() {
   work_done_real_time = getSystemTimeWithSource(timestamp_source);
   ALOGVV("Sensor vertical blanking interval");
   const nsecs_t time_accuracy = 2e6;  // 2 ms of imprecision is ok
-  if (work_done_real_time < frame_end_real_time - time_accuracy) {
+  if (use_virtual_clock_) {
+    // Skip to the end of the frame instead of sleeping. Loops without a
+    // request don't advance the clock, so that the timestamps only depend on
+    // the requests.
+    if (has_request) {
+      virtual_clock_elapsed_ += frame_end_real_time - work_done_real_time;
+    }
+  } else if (work_done_real_time < frame_end_real_time - time_accuracy) {
     timespec t;
     t.tv_sec = (frame_end_real_time - work_done_real_time) / 1000000000L;
     t.tv_nsec = (frame_end_real_time - work_done_real_time) % 1000000000L;
@@ -1259,45 +1393,12 @@ void EmulatedSensor::ReturnResults(
                                    &next_capture_time_, 1);
     }
 
-    uint8_t raw_binned_factor_used = false;
-    if (sensor_binning_factor_info_.find(logical_camera_id_) !=
-        sensor_binning_factor_info_.end()) {
-      auto& info = sensor_binning_factor_info_[logical_camera_id_];
-      // Logical stream was included in the request
-      if (!reprocess_request && info.quad_bayer_sensor && info.max_res_request &&
-          info.has_raw_stream && !info.has_non_raw_stream) {
-        raw_binned_factor_used = true;
-      }
-      result->result_metadata->Set(ANDROID_SENSOR_RAW_BINNING_FACTOR_USED,
-                                   &raw_binned_factor_used, 1);
-      if (info.has_cropped_raw_stream) {
-        if (info.raw_in_sensor_zoom_applied) {
-          result->result_metadata->Set(
-              ANDROID_SCALER_RAW_CROP_REGION,
-              device_chars->second.raw_crop_region_zoomed, 4);
-
-        } else {
-          result->result_metadata->Set(
-              ANDROID_SCALER_RAW_CROP_REGION,
-              device_chars->second.raw_crop_region_unzoomed, 4);
-        }
-      }
-    }
-    if (logical_settings->second.lens_shading_map_mode ==
-        ANDROID_STATISTICS_LENS_SHADING_MAP_MODE_ON) {
-      if ((device_chars->second.lens_shading_map_size[0] > 0) &&
-          (device_chars->second.lens_shading_map_size[1] > 0)) {
-        // Perfect lens, no actual shading needed.
-        std::vector<float> lens_shading_map(
-            device_chars->second.lens_shading_map_size[0] *
-                device_chars->second.lens_shading_map_size[1] * 4,
-            1.f);
-
-        result->result_metadata->Set(ANDROID_STATISTICS_LENS_SHADING_MAP,
-                                     lens_shading_map.data(),
-                                     lens_shading_map.size());
-      }
-    }
+    AppendResultFragment(
+        logical_camera_id_,
+        GetResultFragmentKey(logical_camera_id_, logical_settings->second,
+                             reprocess_request, /*physical*/ false),
+        /*erase_existing*/ reprocess_request, device_chars->second,
+        result->result_metadata.get());
     if (logical_settings->second.report_video_stab) {
       result->result_metadata->Set(ANDROID_CONTROL_VIDEO_STABILIZATION_MODE,
                                    &logical_settings->second.video_stab, 1);
@@ -1306,24 +1407,13 @@ void EmulatedSensor::ReturnResults(
       result->result_metadata->Set(ANDROID_EDGE_MODE,
                                    &logical_settings->second.edge_mode, 1);
     }
-    if (logical_settings->second.report_neutral_color_point) {
-      result->result_metadata->Set(ANDROID_SENSOR_NEUTRAL_COLOR_POINT,
-                                   kNeutralColorPoint,
-                                   ARRAY_SIZE(kNeutralColorPoint));
-    }
-    if (logical_settings->second.report_green_split) {
-      result->result_metadata->Set(ANDROID_SENSOR_GREEN_SPLIT, &kGreenSplit, 1);
-    }
-    if (logical_settings->second.report_noise_profile) {
-      CalculateAndAppendNoiseProfile(
-          logical_settings->second.gain,
-          GetBaseGainFactor(device_chars->second.max_raw_value),
-          result->result_metadata.get());
-    }
     if (logical_settings->second.report_rotate_and_crop) {
       result->result_metadata->Set(ANDROID_SCALER_ROTATE_AND_CROP,
           &logical_settings->second.rotate_and_crop, 1);
     }
+    if (logical_settings->second.report_frame_stats) {
+      AppendFrameStats(logical_camera_id_, result->result_metadata.get());
+    }
 
     if (!result->physical_camera_results.empty()) {
       for (auto& it : result->physical_camera_results) {
@@ -1333,38 +1423,22 @@ void EmulatedSensor::ReturnResults(
                 __FUNCTION__, it.first);
           continue;
         }
-        uint8_t raw_binned_factor_used = false;
-        if (sensor_binning_factor_info_.find(it.first) !=
-            sensor_binning_factor_info_.end()) {
-          auto& info = sensor_binning_factor_info_[it.first];
-          // physical stream was included in the request
-          if (!reprocess_request && info.quad_bayer_sensor &&
-              info.max_res_request && info.has_raw_stream &&
-              !info.has_non_raw_stream) {
-            raw_binned_factor_used = true;
-          }
-          it.second->Set(ANDROID_SENSOR_RAW_BINNING_FACTOR_USED,
-                         &raw_binned_factor_used, 1);
-        }
         // Sensor timestamp for all physical devices must be the same.
         it.second->Set(ANDROID_SENSOR_TIMESTAMP, &next_capture_time_, 1);
-        if (physical_settings->second.report_neutral_color_point) {
-          it.second->Set(ANDROID_SENSOR_NEUTRAL_COLOR_POINT, kNeutralColorPoint,
-                         ARRAY_SIZE(kNeutralColorPoint));
-        }
-        if (physical_settings->second.report_green_split) {
-          it.second->Set(ANDROID_SENSOR_GREEN_SPLIT, &kGreenSplit, 1);
+        auto device_chars = chars_->find(it.first);
+        if (device_chars == chars_->end()) {
+          ALOGE("%s: Sensor characteristics absent for device: %d", __func__,
+                it.first);
+          continue;
         }
-        if (physical_settings->second.report_noise_profile) {
-          auto device_chars = chars_->find(it.first);
-          if (device_chars == chars_->end()) {
-            ALOGE("%s: Sensor characteristics absent for device: %d", __func__,
-                  it.first);
-          }
-          CalculateAndAppendNoiseProfile(
-              physical_settings->second.gain,
-              GetBaseGainFactor(device_chars->second.max_raw_value),
-              it.second.get());
+        AppendResultFragment(
+            it.first,
+            GetResultFragmentKey(it.first, physical_settings->second,
+                                 reprocess_request, /*physical*/ true),
+            /*erase_existing*/ reprocess_request, device_chars->second,
+            it.second.get());
+        if (physical_settings->second.report_frame_stats) {
+          AppendFrameStats(it.first, it.second.get());
         }
       }
     }
@@ -1378,6 +1452,116 @@ void EmulatedSensor::ReturnResults(
   }
 }
 
+// Tags of the result fragments.
+static const std::unordered_set<uint32_t> kResultFragmentTags = {
+    ANDROID_SENSOR_RAW_BINNING_FACTOR_USED,
+    ANDROID_SCALER_RAW_CROP_REGION,
+    ANDROID_STATISTICS_LENS_SHADING_MAP,
+    ANDROID_SENSOR_NEUTRAL_COLOR_POINT,
+    ANDROID_SENSOR_GREEN_SPLIT,
+    ANDROID_SENSOR_NOISE_PROFILE};
+
+EmulatedSensor::ResultFragmentKey EmulatedSensor::GetResultFragmentKey(
+    uint32_t camera_id, const SensorSettings& settings, bool reprocess_request,
+    bool physical) {
+  ResultFragmentKey key;
+  auto info = sensor_binning_factor_info_.find(camera_id);
+  if (info != sensor_binning_factor_info_.end()) {
+    // The stream of the device was included in the request
+    key.raw_binning_factor_used =
+        !reprocess_request && info->second.quad_bayer_sensor &&
+        info->second.max_res_request && info->second.has_raw_stream &&
+        !info->second.has_non_raw_stream;
+    if (!physical && info->second.has_cropped_raw_stream) {
+      key.raw_crop_region = info->second.raw_in_sensor_zoom_applied
+                                ? ResultFragmentKey::kRawCropRegionZoomed
+                                : ResultFragmentKey::kRawCropRegionUnzoomed;
+    }
+  }
+  key.lens_shading_map =
+      !physical && (settings.lens_shading_map_mode ==
+                    ANDROID_STATISTICS_LENS_SHADING_MAP_MODE_ON);
+  key.neutral_color_point = settings.report_neutral_color_point;
+  key.green_split = settings.report_green_split;
+  key.noise_profile = settings.report_noise_profile;
+  key.noise_profile_gain = settings.report_noise_profile ? settings.gain : 0;
+  return key;
+}
+
+status_t EmulatedSensor::AppendResultFragment(
+    uint32_t camera_id, const ResultFragmentKey& key, bool erase_existing,
+    const SensorCharacteristics& chars, HalCameraMetadata* result /*out*/) {
+  if (result == nullptr) {
+    return BAD_VALUE;
+  }
+
+  auto& fragment = result_fragments_[camera_id];
+  if ((fragment.metadata.get() == nullptr) || !(fragment.key == key)) {
+    fragment.key = key;
+    fragment.metadata = BuildResultFragment(key, chars);
+    if (fragment.metadata.get() == nullptr) {
+      ALOGE("%s: Failed to build the result fragment of camera %u",
+            __FUNCTION__, camera_id);
+      return NO_MEMORY;
+    }
+  }
+
+  if (fragment.metadata->GetEntryCount() == 0) {
+    return OK;
+  }
+  // Results start as a copy of the request settings, which only contain
+  // these result tags for reprocess requests. Appending doesn't replace
+  // existing entries.
+  if (erase_existing) {
+    result->Erase(kResultFragmentTags);
+  }
+  return result->Append(fragment.metadata->GetRawCameraMetadata());
+}
+
+std::unique_ptr<HalCameraMetadata> EmulatedSensor::BuildResultFragment(
+    const ResultFragmentKey& key, const SensorCharacteristics& chars) {
+  auto fragment = HalCameraMetadata::Create(1, 10);
+  if (fragment.get() == nullptr) {
+    return nullptr;
+  }
+
+  if (key.raw_binning_factor_used >= 0) {
+    uint8_t raw_binned_factor_used = key.raw_binning_factor_used;
+    fragment->Set(ANDROID_SENSOR_RAW_BINNING_FACTOR_USED,
+                  &raw_binned_factor_used, 1);
+  }
+  if (key.raw_crop_region == ResultFragmentKey::kRawCropRegionZoomed) {
+    fragment->Set(ANDROID_SCALER_RAW_CROP_REGION, chars.raw_crop_region_zoomed,
+                  4);
+  } else if (key.raw_crop_region == ResultFragmentKey::kRawCropRegionUnzoomed) {
+    fragment->Set(ANDROID_SCALER_RAW_CROP_REGION,
+                  chars.raw_crop_region_unzoomed, 4);
+  }
+  if (key.lens_shading_map && (chars.lens_shading_map_size[0] > 0) &&
+      (chars.lens_shading_map_size[1] > 0)) {
+    // Perfect lens, no actual shading needed.
+    std::vector<float> lens_shading_map(
+        chars.lens_shading_map_size[0] * chars.lens_shading_map_size[1] * 4,
+        1.f);
+    fragment->Set(ANDROID_STATISTICS_LENS_SHADING_MAP, lens_shading_map.data(),
+                  lens_shading_map.size());
+  }
+  if (key.neutral_color_point) {
+    fragment->Set(ANDROID_SENSOR_NEUTRAL_COLOR_POINT, kNeutralColorPoint,
+                  ARRAY_SIZE(kNeutralColorPoint));
+  }
+  if (key.green_split) {
+    fragment->Set(ANDROID_SENSOR_GREEN_SPLIT, &kGreenSplit, 1);
+  }
+  if (key.noise_profile) {
+    CalculateAndAppendNoiseProfile(key.noise_profile_gain,
+                                   GetBaseGainFactor(chars.max_raw_value),
+                                   fragment.get());
+  }
+
+  return fragment;
+}
+
 void EmulatedSensor::CalculateAndAppendNoiseProfile(
     float gain /*in ISO*/, float base_gain_factor,
     HalCameraMetadata* result /*out*/) {
@@ -1395,6 +1579,27 @@ void EmulatedSensor::CalculateAndAppendNoiseProfile(
   }
 }
 
+void EmulatedSensor::AppendFrameStats(uint32_t camera_id,
+                                      HalCameraMetadata* result /*out*/) {
+  auto stats = frame_stats_.find(camera_id);
+  if ((result == nullptr) || (stats == frame_stats_.end()) ||
+      !stats->second.IsValid()) {
+    return;
+  }
+
+  int32_t luma_histogram[FrameStats::kLumaHistogramBins];
+  for (size_t i = 0; i < FrameStats::kLumaHistogramBins; i++) {
+    luma_histogram[i] = stats->second.luma_histogram[i];
+  }
+  result->Set(kEmulatedStatsLumaHistogram, luma_histogram,
+              ARRAY_SIZE(luma_histogram));
+  auto zone_mean_rgb = stats->second.GetZoneMeanRgb();
+  result->Set(kEmulatedStatsZoneMeanRgb, zone_mean_rgb.data(),
+              zone_mean_rgb.size());
+  float sharpness = stats->second.GetSharpness();
+  result->Set(kEmulatedStatsSharpness, &sharpness, 1);
+}
+
 EmulatedScene::ColorChannels EmulatedSensor::GetQuadBayerColor(uint32_t x,
                                                                uint32_t y) {
   // Row within larger set of quad bayer filter
@@ -1416,47 +1621,12 @@ EmulatedScene::ColorChannels EmulatedSensor::GetQuadBayerColor(uint32_t x,
   }
 }
 
-void EmulatedSensor::RemosaicQuadBayerBlock(uint16_t* img_in, uint16_t* img_out,
-                                            int xstart, int ystart,
-                                            int row_stride_in_bytes) {
-  uint32_t quad_block_copy_idx_map[16] = {0, 2, 1, 3, 8,  10, 6,  11,
-                                          4, 9, 5, 7, 12, 14, 13, 15};
-  uint16_t quad_block_copy[16];
-  uint32_t i = 0;
-  for (uint32_t row = 0; row < 4; row++) {
-    uint16_t* quad_bayer_row =
-        img_in + (ystart + row) * (row_stride_in_bytes / 2) + xstart;
-    for (uint32_t j = 0; j < 4; j++, i++) {
-      quad_block_copy[i] = quad_bayer_row[j];
-    }
-  }
-
-  for (uint32_t row = 0; row < 4; row++) {
-    uint16_t* regular_bayer_row =
-        img_out + (ystart + row) * (row_stride_in_bytes / 2) + xstart;
-    for (uint32_t j = 0; j < 4; j++, i++) {
-      uint32_t idx = quad_block_copy_idx_map[row + 4 * j];
-      regular_bayer_row[j] = quad_block_copy[idx];
-    }
-  }
-}
-
 status_t EmulatedSensor::RemosaicRAW16Image(uint16_t* img_in, uint16_t* img_out,
                                             size_t row_stride_in_bytes,
                                             const SensorCharacteristics& chars) {
-  if (chars.full_res_width % 2 != 0 || chars.full_res_height % 2 != 0) {
-    ALOGE(
-        "%s RAW16 Image with quad CFA, height %zu and width %zu, not multiples "
-        "of 4",
-        __FUNCTION__, chars.full_res_height, chars.full_res_width);
-    return BAD_VALUE;
-  }
-  for (uint32_t i = 0; i < chars.full_res_width; i += 4) {
-    for (uint32_t j = 0; j < chars.full_res_height; j += 4) {
-      RemosaicQuadBayerBlock(img_in, img_out, i, j, row_stride_in_bytes);
-    }
-  }
-  return OK;
+  ATRACE_CALL();
+  return RemosaicQuadBayerRaw16(img_in, img_out, chars.full_res_width,
+                                chars.full_res_height, row_stride_in_bytes);
 }
 
 void EmulatedSensor::CaptureRawBinned(uint8_t* img, size_t row_stride_in_bytes,
@@ -1498,7 +1668,6 @@ void EmulatedSensor::CaptureRaw(uint8_t* img, size_t row_stride_in_bytes,
   float read_noise_var =
       kReadNoiseVarBeforeGain * noise_var_gain + kReadNoiseVarAfterGain;
 
-  scene_->SetReadoutPixel(0, 0);
   // RGGB
   int bayer_select[4] = {EmulatedScene::R, EmulatedScene::Gr, EmulatedScene::Gb,
                          EmulatedScene::B};
@@ -1525,8 +1694,7 @@ void EmulatedSensor::CaptureRaw(uint8_t* img, size_t row_stride_in_bytes,
       x = std::min(std::max(x, 0), (int)chars.full_res_width - 1);
 
       uint32_t electron_count;
-      scene_->SetReadoutPixel(x, y);
-      electron_count = scene_->GetPixelElectrons()[color_idx];
+      electron_count = scene_->GetPixelElectronsAt(x, y)[color_idx];
 
       // TODO: Better pixel saturation curve?
       electron_count = (electron_count < kSaturationElectrons)
@@ -1550,8 +1718,6 @@ void EmulatedSensor::CaptureRaw(uint8_t* img, size_t row_stride_in_bytes,
 
       *px++ = raw_count;
     }
-    // TODO: Handle this better
-    // simulatedTime += mRowReadoutTime;
   }
   ALOGVV("Raw sensor image captured");
 }
@@ -1559,34 +1725,46 @@ void EmulatedSensor::CaptureRaw(uint8_t* img, size_t row_stride_in_bytes,
 void EmulatedSensor::CaptureRGB(uint8_t* img, uint32_t width, uint32_t height,
                                 uint32_t stride, RGBLayout layout,
                                 uint32_t gain, int32_t color_space,
-                                const SensorCharacteristics& chars) {
+                                const SensorCharacteristics& chars,
+                                FrameStats* stats) {
   ATRACE_CALL();
   float total_gain = gain / 100.0 * GetBaseGainFactor(chars.max_raw_value);
   // In fixed-point math, calculate total scaling from electrons to 8bpp
   int scale64x = 64 * total_gain * 255 / chars.max_raw_value;
   uint32_t inc_h = ceil((float)chars.full_res_width / width);
   uint32_t inc_v = ceil((float)chars.full_res_height / height);
+  const ColorPipeline pipeline = GetColorPipeline(color_space);
+  FrameStatsCollector stats_collector(
+      stats, (chars.full_res_width + inc_h - 1) / inc_h,
+      (chars.full_res_height + inc_v - 1) / inc_v);
 
   for (unsigned int y = 0, outy = 0; y < chars.full_res_height;
        y += inc_v, outy++) {
-    scene_->SetReadoutPixel(0, y);
     uint8_t* px = img + outy * stride;
-    for (unsigned int x = 0; x < chars.full_res_width; x += inc_h) {
+    if (stats_collector.IsCollecting()) {
+      stats_collector.StartRow(outy);
+    }
+    for (unsigned int x = 0, outx = 0; x < chars.full_res_width;
+         x += inc_h, outx++) {
       uint32_t r_count, g_count, b_count;
       // TODO: Perfect demosaicing is a cheat
-      const uint32_t* pixel = scene_->GetPixelElectrons();
+      const uint32_t* pixel = scene_->GetPixelElectronsAt(x, y);
       r_count = pixel[EmulatedScene::R] * scale64x;
       g_count = pixel[EmulatedScene::Gr] * scale64x;
       b_count = pixel[EmulatedScene::B] * scale64x;
 
-      if (color_space !=
-          ANDROID_REQUEST_AVAILABLE_COLOR_SPACE_PROFILES_MAP_UNSPECIFIED) {
-        RgbToRgb(&r_count, &g_count, &b_count);
+      if (pipeline.convert) {
+        ConvertRgb(pipeline, &r_count, &g_count, &b_count);
       }
 
       uint8_t r = r_count < 255 * 64 ? r_count / 64 : 255;
       uint8_t g = g_count < 255 * 64 ? g_count / 64 : 255;
       uint8_t b = b_count < 255 * 64 ? b_count / 64 : 255;
+      if (stats_collector.IsCollecting()) {
+        // JFIF luma
+        stats_collector.AddPixel(outx, r, g, b,
+                                 (77 * r + 150 * g + 29 * b) >> 8);
+      }
       switch (layout) {
         case RGB:
           *px++ = r;
@@ -1609,7 +1787,6 @@ void EmulatedSensor::CaptureRGB(uint8_t* img, uint32_t width, uint32_t height,
           ALOGE("%s: RGB layout: %d not supported", __FUNCTION__, layout);
           return;
       }
-      for (unsigned int j = 1; j < inc_h; j++) scene_->GetPixelElectrons();
     }
   }
   ALOGVV("RGB sensor image captured");
@@ -1619,7 +1796,8 @@ void EmulatedSensor::CaptureYUV420(YCbCrPlanes yuv_layout, uint32_t width,
                                    uint32_t height, uint32_t gain,
                                    float zoom_ratio, bool rotate,
                                    int32_t color_space,
-                                   const SensorCharacteristics& chars) {
+                                   const SensorCharacteristics& chars,
+                                   FrameStats* stats, SliceProgress* progress) {
   ATRACE_CALL();
   float total_gain = gain / 100.0 * GetBaseGainFactor(chars.max_raw_value);
   // Using fixed-point math with 6 bits of fractional precision.
@@ -1635,6 +1813,8 @@ void EmulatedSensor::CaptureYUV420(YCbCrPlanes yuv_layout, uint32_t width,
   // Scale back to 8bpp non-fixed-point
   const int scale_out = 64;
   const int scale_out_sq = scale_out * scale_out;  // after multiplies
+  const ColorPipeline pipeline = GetColorPipeline(color_space);
+  FrameStatsCollector stats_collector(stats, width, height);
 
   // inc = how many pixels to skip while reading every next pixel
   const float aspect_ratio = static_cast<float>(width) / height;
@@ -1652,6 +1832,9 @@ void EmulatedSensor::CaptureYUV420(YCbCrPlanes yuv_layout, uint32_t width,
     uint8_t* px_y = yuv_layout.img_y + out_y * yuv_layout.y_stride;
     uint8_t* px_cb = yuv_layout.img_cb + (out_y / 2) * yuv_layout.cbcr_stride;
     uint8_t* px_cr = yuv_layout.img_cr + (out_y / 2) * yuv_layout.cbcr_stride;
+    if (stats_collector.IsCollecting()) {
+      stats_collector.StartRow(out_y);
+    }
 
     for (unsigned int out_x = 0; out_x < width; out_x++) {
       int x, y;
@@ -1668,19 +1851,16 @@ void EmulatedSensor::CaptureYUV420(YCbCrPlanes yuv_layout, uint32_t width,
       }
       x = std::min(std::max(x, 0), (int)chars.full_res_width - 1);
       y = std::min(std::max(y, 0), (int)chars.full_res_height - 1);
-      scene_->SetReadoutPixel(x, y);
 
       uint32_t r_count, g_count, b_count;
       // TODO: Perfect demosaicing is a cheat
-      const uint32_t* pixel = rotate ? scene_->GetPixelElectronsColumn()
-                                     : scene_->GetPixelElectrons();
+      const uint32_t* pixel = scene_->GetPixelElectronsAt(x, y);
       r_count = pixel[EmulatedScene::R] * scale64x;
       g_count = pixel[EmulatedScene::Gr] * scale64x;
       b_count = pixel[EmulatedScene::B] * scale64x;
 
-      if (color_space !=
-          ANDROID_REQUEST_AVAILABLE_COLOR_SPACE_PROFILES_MAP_UNSPECIFIED) {
-        RgbToRgb(&r_count, &g_count, &b_count);
+      if (pipeline.convert) {
+        ConvertRgb(pipeline, &r_count, &g_count, &b_count);
       }
 
       r_count = r_count < kSaturationPoint ? r_count : kSaturationPoint;
@@ -1688,13 +1868,17 @@ void EmulatedSensor::CaptureYUV420(YCbCrPlanes yuv_layout, uint32_t width,
       b_count = b_count < kSaturationPoint ? b_count : kSaturationPoint;
 
       // Gamma correction
-      r_count = GammaTable(r_count, color_space);
-      g_count = GammaTable(g_count, color_space);
-      b_count = GammaTable(b_count, color_space);
+      r_count = pipeline.gamma_table[r_count];
+      g_count = pipeline.gamma_table[g_count];
+      b_count = pipeline.gamma_table[b_count];
 
       uint8_t y8 = (rgb_to_y[0] * r_count + rgb_to_y[1] * g_count +
                     rgb_to_y[2] * b_count) /
                    scale_out_sq;
+      if (stats_collector.IsCollecting()) {
+        stats_collector.AddPixel(out_x, r_count / scale_out,
+                                 g_count / scale_out, b_count / scale_out, y8);
+      }
       if (yuv_layout.bytesPerPixel == 1) {
         *px_y = y8;
       } else if (yuv_layout.bytesPerPixel == 2) {
@@ -1728,6 +1912,11 @@ void EmulatedSensor::CaptureYUV420(YCbCrPlanes yuv_layout, uint32_t width,
         px_cb += yuv_layout.cbcr_step;
       }
     }
+    // Chroma rows are written along with even luma rows, so slices of an
+    // even number of rows are complete.
+    if ((progress != nullptr) && ((out_y + 1) % kSliceRows == 0)) {
+      progress->Signal(out_y + 1);
+    }
   }
   ALOGVV("YUV420 sensor image captured");
 }
@@ -1744,97 +1933,406 @@ void EmulatedSensor::CaptureDepth(uint8_t* img, uint32_t gain, uint32_t width,
 
   for (unsigned int y = 0, out_y = 0; y < chars.full_res_height;
        y += inc_v, out_y++) {
-    scene_->SetReadoutPixel(0, y);
     uint16_t* px = (uint16_t*)(img + (out_y * stride));
     for (unsigned int x = 0; x < chars.full_res_width; x += inc_h) {
       uint32_t depth_count;
       // TODO: Make up real depth scene instead of using green channel
       // as depth
-      const uint32_t* pixel = scene_->GetPixelElectrons();
+      const uint32_t* pixel = scene_->GetPixelElectronsAt(x, y);
       depth_count = pixel[EmulatedScene::Gr] * scale64x;
 
       *px++ = depth_count < 8191 * 64 ? depth_count / 64 : 0;
-      for (unsigned int j = 1; j < inc_h; j++) scene_->GetPixelElectrons();
     }
-    // TODO: Handle this better
-    // simulatedTime += mRowReadoutTime;
   }
   ALOGVV("Depth sensor image captured");
 }
 
+EmulatedSensor::ProcessType EmulatedSensor::GetYUV420ProcessType(
+    ProcessType process_type) {
+  // Overwrite HIGH_QUALITY to REGULAR for Emulator if property
+  // ro.boot.qemu.camera_hq_edge_processing is false;
+  if (process_type == HIGH_QUALITY &&
+      !property_get_bool("ro.boot.qemu.camera_hq_edge_processing", true)) {
+    return REGULAR;
+  }
+  return process_type;
+}
+
+EmulatedSensor::YUV420RenderKey EmulatedSensor::GetYUV420RenderKey(
+    uint32_t camera_id, ProcessType process_type, bool rotate_and_crop,
+    int32_t color_space, size_t bytes_per_pixel, uint32_t width,
+    uint32_t height) {
+  YUV420RenderKey key{.camera_id = camera_id,
+                      .process_type = process_type,
+                      .color_space = color_space,
+                      .bytes_per_pixel = bytes_per_pixel};
+  // Regular renders are sized after the output aspect ratio. High quality
+  // renders always map the whole crop region to the output, unless rotated.
+  if (process_type == REGULAR || rotate_and_crop) {
+    key.aspect_ratio = static_cast<float>(width) / height;
+  }
+  return key;
+}
+
+void EmulatedSensor::PlanYUV420Renders(const Buffers& buffers,
+                                       const LogicalCameraSettings& settings,
+                                       YUV420RenderPlan* plan) {
+  ATRACE_CALL();
+  for (const auto& buffer : buffers) {
+    size_t bytes_per_pixel = 1;
+    switch (buffer->format) {
+      case PixelFormat::BLOB:
+        if (buffer->dataSpace != HAL_DATASPACE_V0_JFIF) {
+          continue;
+        }
+        break;
+      case PixelFormat::YCRCB_420_SP:
+      case PixelFormat::YCBCR_420_888:
+      case PixelFormat::YCBCR_P010:
+        bytes_per_pixel = buffer->plane.img_y_crcb.bytesPerPixel;
+        break;
+      default:
+        continue;
+    }
+
+    auto device_settings = settings.find(buffer->camera_id);
+    if (device_settings == settings.end()) {
+      continue;
+    }
+
+    ProcessType process_type = GetYUV420ProcessType(
+        device_settings->second.edge_mode == ANDROID_EDGE_MODE_HIGH_QUALITY
+            ? HIGH_QUALITY
+            : REGULAR);
+    bool rotate = device_settings->second.rotate_and_crop ==
+                  ANDROID_SCALER_ROTATE_AND_CROP_90;
+    auto key =
+        GetYUV420RenderKey(buffer->camera_id, process_type, rotate,
+                           buffer->color_space, bytes_per_pixel,
+                           buffer->width, buffer->height);
+    auto& render = (*plan)[key];
+    if (process_type == REGULAR) {
+      // Generate the smallest possible frame with the expected AR and
+      // then scale using libyuv.
+      render.width = EmulatedScene::kSceneWidth * key.aspect_ratio;
+      render.height = EmulatedScene::kSceneHeight;
+    } else {
+      render.width = std::max(render.width, buffer->width);
+      render.height = std::max(render.height, buffer->height);
+    }
+    render.output_count++;
+  }
+
+  for (auto it = plan->begin(); it != plan->end();) {
+    if (it->second.output_count < 2) {
+      it = plan->erase(it);
+    } else {
+      it++;
+    }
+  }
+}
+
+namespace {
+
+// Rows of pixel data of an output plane.
+struct OutputPlane {
+  uint8_t* data = nullptr;
+  size_t stride = 0;
+  size_t row_size = 0;
+  size_t rows = 0;
+};
+
+// Return the planes of a YUV420 output, interleaved chroma is a single plane.
+std::vector<OutputPlane> GetYUV420OutputPlanes(const YCbCrPlanes& planes,
+                                               uint32_t width,
+                                               uint32_t height) {
+  size_t bytes_per_pixel = planes.bytesPerPixel;
+  std::vector<OutputPlane> output_planes = {
+      {planes.img_y, planes.y_stride, width * bytes_per_pixel, height}};
+  if (planes.cbcr_step == 2) {
+    output_planes.push_back({std::min(planes.img_cb, planes.img_cr),
+                             planes.cbcr_stride, width * bytes_per_pixel,
+                             height / 2});
+  } else {
+    output_planes.push_back({planes.img_cb, planes.cbcr_stride,
+                             width / 2 * bytes_per_pixel, height / 2});
+    output_planes.push_back({planes.img_cr, planes.cbcr_stride,
+                             width / 2 * bytes_per_pixel, height / 2});
+  }
+  return output_planes;
+}
+
+void StoreOutputPlanes(const std::vector<OutputPlane>& planes,
+                       std::vector<uint8_t>* pixels /*out*/) {
+  size_t size = 0;
+  for (const auto& plane : planes) {
+    size += plane.row_size * plane.rows;
+  }
+  pixels->resize(size);
+  uint8_t* dst = pixels->data();
+  for (const auto& plane : planes) {
+    for (size_t row = 0; row < plane.rows; row++) {
+      memcpy(dst, plane.data + row * plane.stride, plane.row_size);
+      dst += plane.row_size;
+    }
+  }
+}
+
+void LoadOutputPlanes(const std::vector<uint8_t>& pixels,
+                      const std::vector<OutputPlane>& planes) {
+  const uint8_t* src = pixels.data();
+  for (const auto& plane : planes) {
+    for (size_t row = 0; row < plane.rows; row++) {
+      memcpy(plane.data + row * plane.stride, src, plane.row_size);
+      src += plane.row_size;
+    }
+  }
+}
+
+}  // namespace
+
+EmulatedSensor::CachedOutput* EmulatedSensor::GetCachedOutput(
+    const OutputCacheKey& key, const OutputContent& content) {
+  auto it = output_cache_.find(key);
+  bool content_repeated =
+      (it != output_cache_.end()) && (it->second.content == content);
+  if (it == output_cache_.end()) {
+    if (output_cache_.size() >= kMaxCachedOutputs) {
+      output_cache_.erase(std::min_element(
+          output_cache_.begin(), output_cache_.end(),
+          [](const auto& a, const auto& b) {
+            return a.second.last_use < b.second.last_use;
+          }));
+    }
+    it = output_cache_.emplace(key, CachedOutput()).first;
+  }
+
+  auto& cached_output = it->second;
+  if (content_repeated) {
+    cached_output.content_repeated = true;
+  } else {
+    cached_output = CachedOutput();
+    cached_output.content = content;
+  }
+  cached_output.last_use = next_capture_time_;
+
+  return &cached_output;
+}
+
+void EmulatedSensor::StoreCachedOutput(const YUV420Frame& output,
+                                       const FrameStats* stats,
+                                       CachedOutput* cached_output) {
+  if (!cached_output->content_repeated) {
+    return;
+  }
+  StoreOutputPlanes(
+      GetYUV420OutputPlanes(output.planes, output.width, output.height),
+      &cached_output->pixels);
+  if (stats != nullptr) {
+    cached_output->stats = *stats;
+  }
+}
+
+void EmulatedSensor::ProcessRGB(uint8_t* img, uint32_t width, uint32_t height,
+                                uint32_t stride, RGBLayout layout,
+                                uint32_t gain, int32_t color_space,
+                                const SensorCharacteristics& chars,
+                                uint32_t camera_id, FrameStats* stats) {
+  ATRACE_CALL();
+  size_t bytes_per_pixel = layout == RGB ? 3 : 4;
+  auto cached_output = GetCachedOutput({.camera_id = camera_id,
+                                        .layout = layout,
+                                        .width = width,
+                                        .height = height,
+                                        .bytes_per_pixel = bytes_per_pixel},
+                                       {.scene_signature = scene_->GetSignature(),
+                                        .gain = gain,
+                                        .color_space = color_space});
+  std::vector<OutputPlane> planes = {
+      {img, stride, width * bytes_per_pixel, height}};
+
+  if (cached_output->IsValid(stats)) {
+    LoadOutputPlanes(cached_output->pixels, planes);
+    if (stats != nullptr) {
+      *stats = cached_output->stats;
+    }
+    return;
+  }
+
+  CaptureRGB(img, width, height, stride, layout, gain, color_space, chars,
+             stats);
+  if (cached_output->content_repeated) {
+    StoreOutputPlanes(planes, &cached_output->pixels);
+    if (stats != nullptr) {
+      cached_output->stats = *stats;
+    }
+  }
+}
+
+std::unique_ptr<JpegYUV420Input> EmulatedSensor::RenderJpegThumbnail(
+    const HalCameraMetadata& result_metadata, uint32_t gain, float zoom_ratio,
+    bool rotate_and_crop, int32_t color_space,
+    const SensorCharacteristics& chars) {
+  ATRACE_CALL();
+  camera_metadata_ro_entry_t entry;
+  auto ret = result_metadata.Get(ANDROID_JPEG_THUMBNAIL_SIZE, &entry);
+  if ((ret != OK) || (entry.count != 2) || (entry.data.i32[0] <= 0) ||
+      (entry.data.i32[1] <= 0)) {
+    return nullptr;
+  }
+
+  auto thumbnail = std::make_unique<JpegYUV420Input>();
+  thumbnail->width = entry.data.i32[0];
+  thumbnail->height = entry.data.i32[1];
+  thumbnail->color_space = color_space;
+  auto img = new uint8_t[(thumbnail->width * thumbnail->height * 3) / 2];
+  thumbnail->yuv_planes = {
+      .img_y = img,
+      .img_cb = img + thumbnail->width * thumbnail->height,
+      .img_cr = img + (thumbnail->width * thumbnail->height * 5) / 4,
+      .y_stride = thumbnail->width,
+      .cbcr_stride = thumbnail->width / 2,
+      .cbcr_step = 1};
+  thumbnail->buffer_owner = true;
+  CaptureYUV420(thumbnail->yuv_planes, thumbnail->width, thumbnail->height,
+                gain, zoom_ratio, rotate_and_crop, color_space, chars);
+
+  return thumbnail;
+}
+
+void EmulatedSensor::RenderYUV420(YUV420Render* render, size_t bytes_per_pixel,
+                                  uint32_t gain, float zoom_ratio,
+                                  bool rotate_and_crop, int32_t color_space,
+                                  const SensorCharacteristics& chars,
+                                  FrameStats* stats) {
+  ATRACE_CALL();
+  size_t y_size = render->width * render->height * bytes_per_pixel;
+  render->buffer.resize((y_size * 3) / 2);
+  auto buffer = render->buffer.data();
+  render->planes = {
+      .img_y = buffer,
+      .img_cb = buffer + y_size,
+      .img_cr = buffer + (y_size * 5) / 4,
+      .y_stride = static_cast<uint32_t>(render->width * bytes_per_pixel),
+      .cbcr_stride = static_cast<uint32_t>(render->width * bytes_per_pixel) / 2,
+      .cbcr_step = 1,
+      .bytesPerPixel = bytes_per_pixel};
+  CaptureYUV420(render->planes, render->width, render->height, gain,
+                zoom_ratio, rotate_and_crop, color_space, chars, stats);
+}
+
 status_t EmulatedSensor::ProcessYUV420(const YUV420Frame& input,
                                        const YUV420Frame& output, uint32_t gain,
                                        ProcessType process_type,
                                        float zoom_ratio, bool rotate_and_crop,
                                        int32_t color_space,
-                                       const SensorCharacteristics& chars) {
+                                       const SensorCharacteristics& chars,
+                                       uint32_t camera_id,
+                                       YUV420RenderPlan* render_plan,
+                                       FrameStats* stats,
+                                       SliceProgress* progress) {
   ATRACE_CALL();
   size_t input_width, input_height;
   YCbCrPlanes input_planes, output_planes;
-  std::vector<uint8_t> temp_yuv, temp_output_uv, temp_input_uv;
+  std::vector<uint8_t> temp_output_uv, temp_input_uv;
+  libyuv::FilterMode filter_mode = libyuv::kFilterNone;
+  CachedOutput* cached_output = nullptr;
 
-  // Overwrite HIGH_QUALITY to REGULAR for Emulator if property
-  // ro.boot.qemu.camera_hq_edge_processing is false;
-  if (process_type == HIGH_QUALITY &&
-      !property_get_bool("ro.boot.qemu.camera_hq_edge_processing", true)) {
-    process_type = REGULAR;
-  }
+  process_type = GetYUV420ProcessType(process_type);
 
   size_t bytes_per_pixel = output.planes.bytesPerPixel;
-  switch (process_type) {
-    case HIGH_QUALITY:
-      CaptureYUV420(output.planes, output.width, output.height, gain,
-                    zoom_ratio, rotate_and_crop, color_space, chars);
+  if (process_type == REPROCESS) {
+    input_width = input.width;
+    input_height = input.height;
+    input_planes = input.planes;
+
+    // libyuv only supports planar YUV420 during scaling.
+    // Split the input U/V plane in separate planes if needed.
+    if (input_planes.cbcr_step == 2) {
+      temp_input_uv.resize(input_width * input_height / 2);
+      auto temp_uv_buffer = temp_input_uv.data();
+      input_planes.img_cb = temp_uv_buffer;
+      input_planes.img_cr = temp_uv_buffer + (input_width * input_height) / 4;
+      input_planes.cbcr_stride = input_width / 2;
+      if (input.planes.img_cb < input.planes.img_cr) {
+        libyuv::SplitUVPlane(input.planes.img_cb, input.planes.cbcr_stride,
+                             input_planes.img_cb, input_planes.cbcr_stride,
+                             input_planes.img_cr, input_planes.cbcr_stride,
+                             input_width / 2, input_height / 2);
+      } else {
+        libyuv::SplitUVPlane(input.planes.img_cr, input.planes.cbcr_stride,
+                             input_planes.img_cr, input_planes.cbcr_stride,
+                             input_planes.img_cb, input_planes.cbcr_stride,
+                             input_width / 2, input_height / 2);
+      }
+    }
+  } else {
+    cached_output = GetCachedOutput(
+        {.camera_id = camera_id,
+         .layout = kYUV420OutputLayout,
+         .width = output.width,
+         .height = output.height,
+         .bytes_per_pixel = bytes_per_pixel,
+         .cbcr_step = output.planes.cbcr_step,
+         .cr_first = output.planes.img_cr < output.planes.img_cb},
+        {.scene_signature = scene_->GetSignature(),
+         .gain = gain,
+         .zoom_ratio = zoom_ratio,
+         .color_space = color_space,
+         .process_type = process_type,
+         .rotate_and_crop = rotate_and_crop});
+    if (cached_output->IsValid(stats)) {
+      LoadOutputPlanes(cached_output->pixels,
+                       GetYUV420OutputPlanes(output.planes, output.width,
+                                             output.height));
+      if (stats != nullptr) {
+        *stats = cached_output->stats;
+      }
       return OK;
-    case REPROCESS:
-      input_width = input.width;
-      input_height = input.height;
-      input_planes = input.planes;
-
-      // libyuv only supports planar YUV420 during scaling.
-      // Split the input U/V plane in separate planes if needed.
-      if (input_planes.cbcr_step == 2) {
-        temp_input_uv.resize(input_width * input_height / 2);
-        auto temp_uv_buffer = temp_input_uv.data();
-        input_planes.img_cb = temp_uv_buffer;
-        input_planes.img_cr = temp_uv_buffer + (input_width * input_height) / 4;
-        input_planes.cbcr_stride = input_width / 2;
-        if (input.planes.img_cb < input.planes.img_cr) {
-          libyuv::SplitUVPlane(input.planes.img_cb, input.planes.cbcr_stride,
-                               input_planes.img_cb, input_planes.cbcr_stride,
-                               input_planes.img_cr, input_planes.cbcr_stride,
-                               input_width / 2, input_height / 2);
-        } else {
-          libyuv::SplitUVPlane(input.planes.img_cr, input.planes.cbcr_stride,
-                               input_planes.img_cr, input_planes.cbcr_stride,
-                               input_planes.img_cb, input_planes.cbcr_stride,
-                               input_width / 2, input_height / 2);
-        }
+    }
+
+    YUV420Render* render = nullptr;
+    if (render_plan != nullptr) {
+      auto it = render_plan->find(GetYUV420RenderKey(
+          camera_id, process_type, rotate_and_crop, color_space,
+          bytes_per_pixel, output.width, output.height));
+      if (it != render_plan->end()) {
+        render = &it->second;
+      }
+    }
+
+    YUV420Render output_render;
+    if (render == nullptr) {
+      if (process_type == HIGH_QUALITY) {
+        CaptureYUV420(output.planes, output.width, output.height, gain,
+                      zoom_ratio, rotate_and_crop, color_space, chars, stats,
+                      progress);
+        StoreCachedOutput(output, stats, cached_output);
+        return OK;
       }
-      break;
-    case REGULAR:
-    default:
       // Generate the smallest possible frame with the expected AR and
       // then scale using libyuv.
       float aspect_ratio = static_cast<float>(output.width) / output.height;
-      zoom_ratio = std::max(1.f, zoom_ratio);
-      input_width = EmulatedScene::kSceneWidth * aspect_ratio;
-      input_height = EmulatedScene::kSceneHeight;
-      temp_yuv.reserve((input_width * input_height * 3 * bytes_per_pixel) / 2);
-      auto temp_yuv_buffer = temp_yuv.data();
-      input_planes = {
-          .img_y = temp_yuv_buffer,
-          .img_cb =
-              temp_yuv_buffer + input_width * input_height * bytes_per_pixel,
-          .img_cr = temp_yuv_buffer +
-                    (input_width * input_height * bytes_per_pixel * 5) / 4,
-          .y_stride = static_cast<uint32_t>(input_width * bytes_per_pixel),
-          .cbcr_stride =
-              static_cast<uint32_t>(input_width * bytes_per_pixel) / 2,
-          .cbcr_step = 1,
-          .bytesPerPixel = bytes_per_pixel};
-      CaptureYUV420(input_planes, input_width, input_height, gain, zoom_ratio,
-                    rotate_and_crop, color_space, chars);
+      output_render.width = EmulatedScene::kSceneWidth * aspect_ratio;
+      output_render.height = EmulatedScene::kSceneHeight;
+      render = &output_render;
+    }
+
+    // Renders shared with other outputs of the frame are only done once.
+    if (render->buffer.empty()) {
+      if (process_type == REGULAR) {
+        zoom_ratio = std::max(1.f, zoom_ratio);
+      }
+      RenderYUV420(render, bytes_per_pixel, gain, zoom_ratio, rotate_and_crop,
+                   color_space, chars, stats);
+    }
+    input_width = render->width;
+    input_height = render->height;
+    input_planes = render->planes;
+    // High quality outputs are downscaled from the largest one.
+    if (process_type == HIGH_QUALITY) {
+      filter_mode = libyuv::kFilterBox;
+    }
   }
 
   output_planes = output.planes;
@@ -1865,7 +2363,7 @@ status_t EmulatedSensor::ProcessYUV420(const YUV420Frame& input,
                        output_planes.cbcr_stride / bytes_per_pixel,
                        (uint16_t*)output_planes.img_cr,
                        output_planes.cbcr_stride / bytes_per_pixel,
-                       output.width, output.height, libyuv::kFilterNone);
+                       output.width, output.height, filter_mode);
   } else {
     ret = I420Scale(input_planes.img_y, input_planes.y_stride,
                     input_planes.img_cb, input_planes.cbcr_stride,
@@ -1873,7 +2371,7 @@ status_t EmulatedSensor::ProcessYUV420(const YUV420Frame& input,
                     input_height, output_planes.img_y, output_planes.y_stride,
                     output_planes.img_cb, output_planes.cbcr_stride,
                     output_planes.img_cr, output_planes.cbcr_stride,
-                    output.width, output.height, libyuv::kFilterNone);
+                    output.width, output.height, filter_mode);
   }
   if (ret != 0) {
     ALOGE("%s: Failed during YUV scaling: %d", __FUNCTION__, ret);
@@ -1917,6 +2415,10 @@ status_t EmulatedSensor::ProcessYUV420(const YUV420Frame& input,
     }
   }
 
+  if (cached_output != nullptr) {
+    StoreCachedOutput(output, stats, cached_output);
+  }
+
   return ret;
 }
 
@@ -1954,35 +2456,53 @@ int32_t EmulatedSensor::ApplyHLGGamma(int32_t value, int32_t saturation) {
   return n_value * saturation;
 }
 
-int32_t EmulatedSensor::GammaTable(int32_t value, int32_t color_space) {
+EmulatedSensor::ColorPipeline EmulatedSensor::GetColorPipeline(
+    int32_t color_space) const {
+  ColorPipeline pipeline;
   switch (color_space) {
     case ColorSpaceNamed::BT709:
-      return gamma_table_smpte170m_[value];
+      pipeline.gamma_table = gamma_table_smpte170m_.data();
+      break;
     case ColorSpaceNamed::BT2020:
-      return gamma_table_hlg_[value];  // Assume HLG
+      pipeline.gamma_table = gamma_table_hlg_.data();  // Assume HLG
+      break;
     case ColorSpaceNamed::DISPLAY_P3:
     case ColorSpaceNamed::SRGB:
     default:
-      return gamma_table_sRGB_[value];
+      pipeline.gamma_table = gamma_table_sRGB_.data();
+      break;
+  }
+
+  pipeline.convert =
+      color_space !=
+      ANDROID_REQUEST_AVAILABLE_COLOR_SPACE_PROFILES_MAP_UNSPECIFIED;
+  if (pipeline.convert) {
+    const float matrix[9] = {
+        rgb_rgb_matrix_.rR, rgb_rgb_matrix_.gR, rgb_rgb_matrix_.bR,
+        rgb_rgb_matrix_.rG, rgb_rgb_matrix_.gG, rgb_rgb_matrix_.bG,
+        rgb_rgb_matrix_.rB, rgb_rgb_matrix_.gB, rgb_rgb_matrix_.bB};
+    for (size_t i = 0; i < 9; i++) {
+      pipeline.matrix[i] =
+          std::lround(matrix[i] * (1 << kColorMatrixFractionBits));
+    }
   }
 
-  return 0;
+  return pipeline;
 }
 
-void EmulatedSensor::RgbToRgb(uint32_t* r_count, uint32_t* g_count,
-                              uint32_t* b_count) {
-  uint32_t r = *r_count;
-  uint32_t g = *g_count;
-  uint32_t b = *b_count;
-  *r_count = (uint32_t)std::max(
-      r * rgb_rgb_matrix_.rR + g * rgb_rgb_matrix_.gR + b * rgb_rgb_matrix_.bR,
-      0.0f);
-  *g_count = (uint32_t)std::max(
-      r * rgb_rgb_matrix_.rG + g * rgb_rgb_matrix_.gG + b * rgb_rgb_matrix_.bG,
-      0.0f);
-  *b_count = (uint32_t)std::max(
-      r * rgb_rgb_matrix_.rB + g * rgb_rgb_matrix_.gB + b * rgb_rgb_matrix_.bB,
-      0.0f);
+void EmulatedSensor::ConvertRgb(const ColorPipeline& pipeline,
+                                uint32_t* r_count, uint32_t* g_count,
+                                uint32_t* b_count) {
+  int64_t r = *r_count;
+  int64_t g = *g_count;
+  int64_t b = *b_count;
+  const int32_t* m = pipeline.matrix;
+  *r_count = std::max<int64_t>(m[0] * r + m[1] * g + m[2] * b, 0) >>
+             kColorMatrixFractionBits;
+  *g_count = std::max<int64_t>(m[3] * r + m[4] * g + m[5] * b, 0) >>
+             kColorMatrixFractionBits;
+  *b_count = std::max<int64_t>(m[6] * r + m[7] * g + m[8] * b, 0) >>
+             kColorMatrixFractionBits;
 }
 
 void EmulatedSensor::CalculateRgbRgbMatrix(int32_t color_space,
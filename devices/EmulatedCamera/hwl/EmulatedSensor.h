@@ -80,11 +80,17 @@
 
 #include <algorithm>
 #include <functional>
+#include <map>
+#include <tuple>
+#include <vector>
 
 #include "Base.h"
 #include "EmulatedScene.h"
 #include "JpegCompressor.h"
+#include "utils/FrameStats.h"
+#include "utils/SliceProgress.h"
 #include "utils/Mutex.h"
+#include "utils/StreamCombinationCache.h"
 #include "utils/StreamConfigurationMap.h"
 #include "utils/Thread.h"
 #include "utils/Timers.h"
@@ -236,12 +242,15 @@ class EmulatedSensor : private Thread, public virtual RefBase {
   static bool AreCharacteristicsSupported(
       const SensorCharacteristics& characteristics);
 
+  // Results are memoized in cache if it is not nullptr. The cache must only
+  // be used for queries against the same maps and characteristics.
   static bool IsStreamCombinationSupported(
       uint32_t logical_id, const StreamConfiguration& config,
       StreamConfigurationMap& map, StreamConfigurationMap& max_resolution_map,
       const PhysicalStreamConfigurationMap& physical_map,
       const PhysicalStreamConfigurationMap& physical_map_max_resolution,
-      const LogicalCharacteristics& sensor_chars);
+      const LogicalCharacteristics& sensor_chars,
+      StreamCombinationCache* cache = nullptr);
 
   static bool IsStreamCombinationSupported(
       uint32_t logical_id, const StreamConfiguration& config,
@@ -253,8 +262,18 @@ class EmulatedSensor : private Thread, public virtual RefBase {
    * Power control
    */
 
+  // Simulation modes of the sensor. They are read from the
+  // vendor.camera.emulated.* properties unless set explicitly, e.g. by tests.
+  struct Options {
+    bool use_virtual_clock = false;
+    bool use_slice_delivery = false;
+    bool simulate_rolling_shutter = false;
+  };
+  static Options GetOptionsFromProperties();
+
   status_t StartUp(uint32_t logical_camera_id,
-                   std::unique_ptr<LogicalCharacteristics> logical_chars);
+                   std::unique_ptr<LogicalCharacteristics> logical_chars,
+                   const Options& options = GetOptionsFromProperties());
   status_t ShutDown();
 
   /*
@@ -280,6 +299,7 @@ class EmulatedSensor : private Thread, public virtual RefBase {
     uint32_t test_pattern_data[4] = {0, 0, 0, 0};
     uint32_t screen_rotation = 0;
     uint32_t timestamp_source = ANDROID_SENSOR_INFO_TIMESTAMP_SOURCE_UNKNOWN;
+    bool report_frame_stats = false;
   };
 
   // Maps physical and logical camera ids to individual device settings
@@ -293,6 +313,10 @@ class EmulatedSensor : private Thread, public virtual RefBase {
 
   status_t Flush();
 
+  // Statistics of the latest frame of each camera that had a YUV or RGB
+  // output, for the 3A of the next requests.
+  std::map<uint32_t, FrameStats> GetLatestFrameStats();
+
   /*
    * Synchronizing with sensor operation (vertical sync)
    */
@@ -311,6 +335,8 @@ class EmulatedSensor : private Thread, public virtual RefBase {
   static const int32_t kDefaultSensitivity;
   static const nsecs_t kDefaultFrameDuration;
   static const nsecs_t kReturnResultThreshod;
+  // Time between the start of readout of the first and last rows.
+  static const nsecs_t kRollingShutterSkew;
   static const uint32_t kDefaultBlackLevelPattern[4];
   static const camera_metadata_rational kDefaultColorTransform[9];
   static const float kDefaultColorCorrectionGains[4];
@@ -354,6 +380,7 @@ class EmulatedSensor : private Thread, public virtual RefBase {
   static const uint32_t kMaxLensShadingMapSize[2];
   static const int32_t kFixedBitPrecision;
   static const int32_t kSaturationPoint;
+  static const int32_t kColorMatrixFractionBits;
 
   std::vector<int32_t> gamma_table_sRGB_;
   std::vector<int32_t> gamma_table_smpte170m_;
@@ -363,6 +390,8 @@ class EmulatedSensor : private Thread, public virtual RefBase {
   // Start of control parameters
   Condition vsync_;
   bool got_vsync_;
+  // Signaled when a new request is set
+  Condition request_available_;
   std::unique_ptr<LogicalCameraSettings> current_settings_;
   std::unique_ptr<HwlPipelineResult> current_result_;
   std::unique_ptr<HwlPipelineResult> partial_result_;
@@ -372,6 +401,10 @@ class EmulatedSensor : private Thread, public virtual RefBase {
 
   // End of control parameters
 
+  Mutex frame_stats_mutex_;
+  // Protected by frame_stats_mutex_.
+  std::map<uint32_t, FrameStats> latest_frame_stats_;
+
   unsigned int rand_seed_ = 1;
 
   /**
@@ -383,6 +416,20 @@ class EmulatedSensor : private Thread, public virtual RefBase {
   nsecs_t next_capture_time_;
   nsecs_t next_readout_time_;
 
+  // With a virtual clock the sensor doesn't wait for the end of each frame.
+  // The clock starts at the real time of StartUp() and advances by the frame
+  // duration of each processed request, so timestamps stay consistent with
+  // the settings while frames are processed as fast as possible.
+  bool use_virtual_clock_ = false;
+  nsecs_t virtual_clock_start_monotonic_ = 0;
+  nsecs_t virtual_clock_start_boottime_ = 0;
+  nsecs_t virtual_clock_elapsed_ = 0;
+
+  // With slice delivery JPEG jobs are queued before their input is
+  // rendered, and the compressor encodes the rows of the input as soon as
+  // they are signaled.
+  bool use_slice_delivery_ = false;
+
   struct SensorBinningFactorInfo {
     bool has_raw_stream = false;
     bool has_non_raw_stream = false;
@@ -394,16 +441,18 @@ class EmulatedSensor : private Thread, public virtual RefBase {
 
   std::map<uint32_t, SensorBinningFactorInfo> sensor_binning_factor_info_;
 
+  // Statistics of the frame being processed, per camera.
+  std::map<uint32_t, FrameStats> frame_stats_;
+  // Return the statistics of camera_id to collect while rendering an output,
+  // or nullptr if they have already been collected for this frame.
+  FrameStats* GetFrameStatsToCollect(uint32_t camera_id);
+
   std::unique_ptr<EmulatedScene> scene_;
 
   RgbRgbMatrix rgb_rgb_matrix_;
 
   static EmulatedScene::ColorChannels GetQuadBayerColor(uint32_t x, uint32_t y);
 
-  static void RemosaicQuadBayerBlock(uint16_t* img_in, uint16_t* img_out,
-                                     int xstart, int ystart,
-                                     int row_stride_in_bytes);
-
   static status_t RemosaicRAW16Image(uint16_t* img_in, uint16_t* img_out,
                                      size_t row_stride_in_bytes,
                                      const SensorCharacteristics& chars);
@@ -422,16 +471,36 @@ class EmulatedSensor : private Thread, public virtual RefBase {
   enum RGBLayout { RGB, RGBA, ARGB };
   void CaptureRGB(uint8_t* img, uint32_t width, uint32_t height,
                   uint32_t stride, RGBLayout layout, uint32_t gain,
-                  int32_t color_space, const SensorCharacteristics& chars);
+                  int32_t color_space, const SensorCharacteristics& chars,
+                  FrameStats* stats = nullptr);
   void CaptureYUV420(YCbCrPlanes yuv_layout, uint32_t width, uint32_t height,
                      uint32_t gain, float zoom_ratio, bool rotate,
-                     int32_t color_space, const SensorCharacteristics& chars);
+                     int32_t color_space, const SensorCharacteristics& chars,
+                     FrameStats* stats = nullptr,
+                     SliceProgress* progress = nullptr);
   void CaptureDepth(uint8_t* img, uint32_t gain, uint32_t width, uint32_t height,
                     uint32_t stride, const SensorCharacteristics& chars);
-  void RgbToRgb(uint32_t* r_count, uint32_t* g_count, uint32_t* b_count);
   void CalculateRgbRgbMatrix(int32_t color_space,
                              const SensorCharacteristics& chars);
 
+  // Color processing of an output buffer, selected once per buffer instead
+  // of for every pixel.
+  struct ColorPipeline {
+    // Whether to convert to the output color space with matrix.
+    bool convert = false;
+    // rgb_rgb_matrix_ in fixed point, with kColorMatrixFractionBits
+    // fractional bits, in row major order.
+    int32_t matrix[9] = {};
+    // Gamma curve of the output color space, with kSaturationPoint + 1
+    // entries.
+    const int32_t* gamma_table = nullptr;
+  };
+
+  ColorPipeline GetColorPipeline(int32_t color_space) const;
+  static inline void ConvertRgb(const ColorPipeline& pipeline,
+                                uint32_t* r_count, uint32_t* g_count,
+                                uint32_t* b_count);
+
   struct YUV420Frame {
     uint32_t width = 0;
     uint32_t height = 0;
@@ -439,23 +508,232 @@ class EmulatedSensor : private Thread, public virtual RefBase {
   };
 
   enum ProcessType { REPROCESS, HIGH_QUALITY, REGULAR };
+
+  // Identifies the YUV outputs of a frame that can be scaled from the same
+  // scene render. Gain, zoom ratio and rotation are per camera settings and
+  // thus covered by camera_id.
+  struct YUV420RenderKey {
+    uint32_t camera_id = 0;
+    ProcessType process_type = REGULAR;
+    int32_t color_space = 0;
+    size_t bytes_per_pixel = 1;
+    // Output aspect ratio, for renders whose scene mapping depends on it and
+    // zero otherwise.
+    float aspect_ratio = 0.f;
+
+    bool operator<(const YUV420RenderKey& other) const {
+      return std::tie(camera_id, process_type, color_space, bytes_per_pixel,
+                      aspect_ratio) <
+             std::tie(other.camera_id, other.process_type, other.color_space,
+                      other.bytes_per_pixel, other.aspect_ratio);
+    }
+  };
+
+  // A planar scene render shared by several outputs. It is rendered at the
+  // largest size any of them needs on first use.
+  struct YUV420Render {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t output_count = 0;
+    std::vector<uint8_t> buffer;
+    YCbCrPlanes planes;
+  };
+
+  typedef std::map<YUV420RenderKey, YUV420Render> YUV420RenderPlan;
+
+  static ProcessType GetYUV420ProcessType(ProcessType process_type);
+  static YUV420RenderKey GetYUV420RenderKey(uint32_t camera_id,
+                                            ProcessType process_type,
+                                            bool rotate_and_crop,
+                                            int32_t color_space,
+                                            size_t bytes_per_pixel,
+                                            uint32_t width, uint32_t height);
+  // Plan the scene renders of the YUV and JPEG outputs of a frame that are
+  // rendered from the scene. Renders used by a single output are left out.
+  void PlanYUV420Renders(const Buffers& buffers,
+                         const LogicalCameraSettings& settings,
+                         YUV420RenderPlan* plan);
+  void RenderYUV420(YUV420Render* render, size_t bytes_per_pixel,
+                    uint32_t gain, float zoom_ratio, bool rotate_and_crop,
+                    int32_t color_space, const SensorCharacteristics& chars,
+                    FrameStats* stats);
+
+  // Scale output from input, or from the scene if process_type isn't
+  // REPROCESS. Scene renders planned in render_plan are reused. Statistics
+  // are collected in stats when the scene is rendered. The rows of output
+  // written while rendering are signaled in progress, when set, but the
+  // caller must finish it.
   status_t ProcessYUV420(const YUV420Frame& input, const YUV420Frame& output,
                          uint32_t gain, ProcessType process_type,
                          float zoom_ratio, bool rotate_and_crop,
                          int32_t color_space,
-                         const SensorCharacteristics& chars);
+                         const SensorCharacteristics& chars,
+                         uint32_t camera_id = 0,
+                         YUV420RenderPlan* render_plan = nullptr,
+                         FrameStats* stats = nullptr,
+                         SliceProgress* progress = nullptr);
+
+  // Rows rendered between two SliceProgress signals, one JPEG MCU row.
+  static const uint32_t kSliceRows = 16;
+
+  // Render the JPEG thumbnail requested in result_metadata from the scene,
+  // for JPEG inputs queued before they are rendered. Returns nullptr if no
+  // thumbnail is requested.
+  std::unique_ptr<JpegYUV420Input> RenderJpegThumbnail(
+      const HalCameraMetadata& result_metadata, uint32_t gain,
+      float zoom_ratio, bool rotate_and_crop, int32_t color_space,
+      const SensorCharacteristics& chars);
+
+  // Render an RGB output from the scene, reusing the cached copy of the
+  // output when possible. Statistics are collected in stats when the scene
+  // is rendered.
+  void ProcessRGB(uint8_t* img, uint32_t width, uint32_t height,
+                  uint32_t stride, RGBLayout layout, uint32_t gain,
+                  int32_t color_space, const SensorCharacteristics& chars,
+                  uint32_t camera_id, FrameStats* stats = nullptr);
+
+  // Identifies a processed output across frames.
+  struct OutputCacheKey {
+    uint32_t camera_id = 0;
+    // RGBLayout of RGB outputs, kYUV420OutputLayout for YUV outputs.
+    int32_t layout = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t bytes_per_pixel = 1;
+    // Chroma layout of YUV outputs.
+    uint32_t cbcr_step = 0;
+    bool cr_first = false;
+
+    bool operator<(const OutputCacheKey& other) const {
+      return std::tie(camera_id, layout, width, height, bytes_per_pixel,
+                      cbcr_step, cr_first) <
+             std::tie(other.camera_id, other.layout, other.width,
+                      other.height, other.bytes_per_pixel, other.cbcr_step,
+                      other.cr_first);
+    }
+  };
+  static const int32_t kYUV420OutputLayout = -1;
+
+  // Everything the pixels of an output rendered from the scene depend on,
+  // besides the characteristics of its camera.
+  struct OutputContent {
+    uint64_t scene_signature = 0;
+    uint32_t gain = 0;
+    float zoom_ratio = 0.f;
+    int32_t color_space = 0;
+    ProcessType process_type = REGULAR;
+    bool rotate_and_crop = false;
+
+    bool operator==(const OutputContent& other) const {
+      return std::tie(scene_signature, gain, zoom_ratio, color_space,
+                      process_type, rotate_and_crop) ==
+             std::tie(other.scene_signature, other.gain, other.zoom_ratio,
+                      other.color_space, other.process_type,
+                      other.rotate_and_crop);
+    }
+  };
+
+  // Copy of the pixels of an output. It is only stored once the same content
+  // is requested twice in a row, outputs of a changing scene are never
+  // copied.
+  struct CachedOutput {
+    OutputContent content;
+    bool content_repeated = false;
+    // Rows of the output planes without padding.
+    std::vector<uint8_t> pixels;
+    // Statistics collected while rendering the output, if any.
+    FrameStats stats;
+    nsecs_t last_use = 0;
+
+    // Whether the output can be copied instead of rendered, stats must be
+    // available as well if requested.
+    bool IsValid(const FrameStats* requested_stats) const {
+      return !pixels.empty() &&
+             ((requested_stats == nullptr) || stats.IsValid());
+    }
+  };
+
+  // Outputs of the latest frames, the least recently used ones are evicted
+  // past kMaxCachedOutputs. Only accessed by the processing thread.
+  static const size_t kMaxCachedOutputs = 4;
+  std::map<OutputCacheKey, CachedOutput> output_cache_;
+
+  // Return the cache entry of key, reset if content changed since the last
+  // frame using it.
+  CachedOutput* GetCachedOutput(const OutputCacheKey& key,
+                                const OutputContent& content);
+  // Copy output in cached_output if its content repeated, along with stats.
+  void StoreCachedOutput(const YUV420Frame& output, const FrameStats* stats,
+                         CachedOutput* cached_output);
 
   inline int32_t ApplysRGBGamma(int32_t value, int32_t saturation);
   inline int32_t ApplySMPTE170MGamma(int32_t value, int32_t saturation);
   inline int32_t ApplyST2084Gamma(int32_t value, int32_t saturation);
   inline int32_t ApplyHLGGamma(int32_t value, int32_t saturation);
-  inline int32_t GammaTable(int32_t value, int32_t color_space);
 
   bool WaitForVSyncLocked(nsecs_t reltime);
   void CalculateAndAppendNoiseProfile(float gain /*in ISO*/,
                                       float base_gain_factor,
                                       HalCameraMetadata* result /*out*/);
 
+  // Signature of the result metadata that only depends on the
+  // characteristics and settings of a device, and on the streams of the
+  // request. It changes rarely, so it is built once and appended to the
+  // results in a single copy.
+  struct ResultFragmentKey {
+    enum RawCropRegion : uint8_t {
+      kRawCropRegionNone,
+      kRawCropRegionUnzoomed,
+      kRawCropRegionZoomed
+    };
+
+    // ANDROID_SENSOR_RAW_BINNING_FACTOR_USED, -1 if it isn't reported.
+    int8_t raw_binning_factor_used = -1;
+    RawCropRegion raw_crop_region = kRawCropRegionNone;
+    bool lens_shading_map = false;
+    bool neutral_color_point = false;
+    bool green_split = false;
+    bool noise_profile = false;
+    // Sensitivity of the noise profile, zero if it isn't reported.
+    uint32_t noise_profile_gain = 0;
+
+    bool operator==(const ResultFragmentKey& other) const {
+      return std::tie(raw_binning_factor_used, raw_crop_region,
+                      lens_shading_map, neutral_color_point, green_split,
+                      noise_profile, noise_profile_gain) ==
+             std::tie(other.raw_binning_factor_used, other.raw_crop_region,
+                      other.lens_shading_map, other.neutral_color_point,
+                      other.green_split, other.noise_profile,
+                      other.noise_profile_gain);
+    }
+  };
+
+  struct ResultFragment {
+    ResultFragmentKey key;
+    std::unique_ptr<HalCameraMetadata> metadata;
+  };
+
+  // Latest result fragment of each device, rebuilt when its key changes.
+  // Only accessed by the processing thread.
+  std::unordered_map<uint32_t, ResultFragment> result_fragments_;
+
+  ResultFragmentKey GetResultFragmentKey(uint32_t camera_id,
+                                         const SensorSettings& settings,
+                                         bool reprocess_request, bool physical);
+  // Append the result fragment of camera_id for key, replacing the fragment
+  // tags already in result if erase_existing is set.
+  status_t AppendResultFragment(uint32_t camera_id,
+                                const ResultFragmentKey& key,
+                                bool erase_existing,
+                                const SensorCharacteristics& chars,
+                                HalCameraMetadata* result /*out*/);
+  std::unique_ptr<HalCameraMetadata> BuildResultFragment(
+      const ResultFragmentKey& key, const SensorCharacteristics& chars);
+
+  // Append the statistics of camera_id collected for the current frame as
+  // vendor tags.
+  void AppendFrameStats(uint32_t camera_id, HalCameraMetadata* result /*out*/);
+
   void ReturnResults(HwlPipelineCallback callback,
                      std::unique_ptr<LogicalCameraSettings> settings,
                      std::unique_ptr<HwlPipelineResult> result,
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "EmulatedVendorTags.h"
+
+namespace android {
+
+using google_camera_hal::CameraMetadataType;
+using google_camera_hal::VendorTagSection;
+
+// Frame statistics tags
+//
+// Requests setting com.google.emulated.stats.enable to 1 get the statistics
+// of their frame in the result:
+//   lumaHistogram: int32[FrameStats::kLumaHistogramBins]
+//   zoneMeanRgb: float[FrameStats::kZoneCount * 3], R, G and B per zone
+//   sharpness: float, see FrameStats::GetSharpness()
+const std::vector<VendorTagSection> kEmulatedVendorTagSections = {
+    {.section_name = "com.google.emulated.stats",
+     .tags = {{.tag_id = kEmulatedStatsEnable,
+               .tag_name = "enable",
+               .tag_type = CameraMetadataType::kByte},
+              {.tag_id = kEmulatedStatsLumaHistogram,
+               .tag_name = "lumaHistogram",
+               .tag_type = CameraMetadataType::kInt32},
+              {.tag_id = kEmulatedStatsZoneMeanRgb,
+               .tag_name = "zoneMeanRgb",
+               .tag_type = CameraMetadataType::kFloat},
+              {.tag_id = kEmulatedStatsSharpness,
+               .tag_name = "sharpness",
+               .tag_type = CameraMetadataType::kFloat}}},
+};
+
+}  // namespace android
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef EMULATOR_CAMERA_HAL_HWL_VENDOR_TAGS_H
+#define EMULATOR_CAMERA_HAL_HWL_VENDOR_TAGS_H
+
+#include <hal_types.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace android {
+
+// Vendor tags of the emulated camera. They use the first vendor tag section,
+// below the range the camera HAL reserves for its own tags.
+constexpr uint32_t kEmulatedVendorTagSectionStart = 0x80000000;
+
+// Emulated camera vendor tag IDs. Items should not be removed or rearranged.
+enum EmulatedVendorTagIds : uint32_t {
+  kEmulatedStatsEnable = kEmulatedVendorTagSectionStart,
+  kEmulatedStatsLumaHistogram,
+  kEmulatedStatsZoneMeanRgb,
+  kEmulatedStatsSharpness,
+};
+
+// Vendor tag sections reported by the emulated camera provider, see
+// EmulatedVendorTags.cpp for the tag definitions.
+extern const std::vector<google_camera_hal::VendorTagSection>
+    kEmulatedVendorTagSections;
+
+}  // namespace android
+
+#endif  // EMULATOR_CAMERA_HAL_HWL_VENDOR_TAGS_H
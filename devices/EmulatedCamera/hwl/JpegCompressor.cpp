@@ -245,11 +245,24 @@ void JpegCompressor::CompressYUV420(std::unique_ptr<JpegYUV420Job> job) {
       size_t thumbnail_height = 0;
       std::vector<uint8_t> thumb_yuv420_frame;
       YCbCrPlanes thumb_planes;
+      bool has_thumbnail = false;
       auto ret = job->result_metadata->Get(ANDROID_JPEG_THUMBNAIL_SIZE, &entry);
+      const auto& thumbnail = job->input->thumbnail;
       if ((ret == OK) && (entry.count == 2)) {
         thumbnail_width = entry.data.i32[0];
         thumbnail_height = entry.data.i32[1];
-        if ((thumbnail_width > 0) && (thumbnail_height > 0)) {
+        if ((thumbnail.get() != nullptr) &&
+            (thumbnail->width == thumbnail_width) &&
+            (thumbnail->height == thumbnail_height)) {
+          thumb_planes = thumbnail->yuv_planes;
+          has_thumbnail = true;
+        } else if ((thumbnail_width > 0) && (thumbnail_height > 0)) {
+          if ((job->input->progress.get() != nullptr) &&
+              !job->input->progress->Wait(job->input->height)) {
+            ALOGE("%s: Input frame failed, no output", __FUNCTION__);
+            job->output->stream_buffer.status = BufferStatus::kError;
+            return;
+          }
           thumb_yuv420_frame.resize((thumbnail_width * thumbnail_height * 3) /
                                     2);
           thumb_planes = {
@@ -272,14 +285,15 @@ void JpegCompressor::CompressYUV420(std::unique_ptr<JpegYUV420Job> job) {
               libyuv::kFilterNone);
           if (stat != 0) {
             ALOGE("%s: Failed during thumbnail scaling: %d", __FUNCTION__, stat);
-            thumb_yuv420_frame.clear();
+          } else {
+            has_thumbnail = true;
           }
         }
       }
 
       if (job->exif_utils->SetFromMetadata(
               *job->result_metadata, job->input->width, job->input->height)) {
-        if (!thumb_yuv420_frame.empty()) {
+        if (has_thumbnail) {
           thumbnail_jpeg_buffer.resize(64 * 1024);  // APP1 is limited by 64k
           encoded_thumbnail_size = CompressYUV420Frame(
               {.output_buffer = thumbnail_jpeg_buffer.data(),
@@ -289,7 +303,8 @@ void JpegCompressor::CompressYUV420(std::unique_ptr<JpegYUV420Job> job) {
                .height = thumbnail_height,
                .app1_buffer = nullptr,
                .app1_buffer_size = 0,
-               .color_space = job->input->color_space});
+               .color_space = job->input->color_space,
+               .progress = nullptr});
           if (encoded_thumbnail_size > 0) {
             job->output->stream_buffer.status = BufferStatus::kOk;
           } else {
@@ -326,7 +341,8 @@ void JpegCompressor::CompressYUV420(std::unique_ptr<JpegYUV420Job> job) {
        .height = job->input->height,
        .app1_buffer = app1_buffer,
        .app1_buffer_size = app1_buffer_size,
-       .color_space = job->input->color_space});
+       .color_space = job->input->color_space,
+       .progress = job->input->progress.get()});
   if (encoded_size > 0) {
     job->output->stream_buffer.status = BufferStatus::kOk;
   } else {
@@ -499,6 +515,13 @@ size_t JpegCompressor::CompressYUV420Frame(YUV420Frame frame) {
 
   const uint32_t batch_size = DCTSIZE * max_vsamp_factor;
   while (cinfo->next_scanline < cinfo->image_height) {
+    if ((frame.progress != nullptr) &&
+        !frame.progress->Wait(cinfo->next_scanline + batch_size)) {
+      ALOGE("%s: Input frame failed, exiting early", __FUNCTION__);
+      jpeg_abort_compress(cinfo.get());
+      return 0;
+    }
+
     JSAMPARRAY planes[3]{&y_lines[cinfo->next_scanline],
                          &cb_lines[cinfo->next_scanline / c_vsub_sampling],
                          &cr_lines[cinfo->next_scanline / c_vsub_sampling]};
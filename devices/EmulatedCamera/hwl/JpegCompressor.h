@@ -31,6 +31,7 @@ extern "C" {
 }
 
 #include "utils/ExifUtils.h"
+#include "utils/SliceProgress.h"
 
 namespace android {
 
@@ -43,10 +44,20 @@ struct JpegYUV420Input {
   bool buffer_owner;
   YCbCrPlanes yuv_planes;
   int32_t color_space;
+  // Set if the input is queued while it is still being written, the rows of
+  // yuv_planes must be waited for before reading them.
+  std::shared_ptr<SliceProgress> progress;
+  // Thumbnail of the input, scaled from the input when absent.
+  std::unique_ptr<JpegYUV420Input> thumbnail;
 
   JpegYUV420Input() : width(0), height(0), buffer_owner(false) {
   }
   ~JpegYUV420Input() {
+    if (progress.get() != nullptr) {
+      // The producer may still be using the planes after signaling all of
+      // their rows.
+      progress->WaitFinished();
+    }
     if ((yuv_planes.img_y != nullptr) && buffer_owner) {
       delete[] yuv_planes.img_y;
       yuv_planes = {};
@@ -91,6 +102,8 @@ class JpegCompressor {
     const uint8_t* app1_buffer;
     size_t app1_buffer_size;
     int32_t color_space;
+    // Rows of yuv_planes written so far, nullptr if they are all written.
+    SliceProgress* progress;
   };
   size_t CompressYUV420Frame(YUV420Frame frame);
   void ThreadLoop();
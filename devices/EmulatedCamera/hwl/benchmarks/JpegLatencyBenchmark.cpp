@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the latency of JPEG captures, from the shutter notification to
+// the release of the JPEG output buffer by the compressor, with the input
+// delivered to the compressor in slices while it is rendered
+// (vendor.camera.emulated.slice_delivery) and after it is fully rendered.
+// Run with:
+//   adb shell /data/benchmarktest64/emulated_jpeg_latency_benchmark/emulated_jpeg_latency_benchmark
+
+#include <benchmark/benchmark.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "EmulatedSensor.h"
+
+namespace android {
+namespace {
+
+using google_camera_hal::HalCameraMetadata;
+using google_camera_hal::MessageType;
+using google_camera_hal::NotifyMessage;
+
+constexpr uint32_t kCameraId = 0;
+constexpr uint32_t kSensorWidth = 4000;
+constexpr uint32_t kSensorHeight = 3000;
+constexpr int32_t kThumbnailSize[2] = {320, 240};
+
+// Times a single capture at a time.
+class CaptureTimer {
+ public:
+  void OnShutter() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutter_time_ = systemTime(SYSTEM_TIME_MONOTONIC);
+  }
+
+  void OnJpegReleased(BufferStatus status) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    release_time_ = systemTime(SYSTEM_TIME_MONOTONIC);
+    status_ = status;
+    released_ = true;
+    condition_.notify_one();
+  }
+
+  // Wait for the JPEG output and return the time since the shutter, or a
+  // negative value if the capture failed.
+  nsecs_t WaitForJpeg() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this] { return released_; });
+    released_ = false;
+    return status_ == BufferStatus::kOk ? release_time_ - shutter_time_ : -1;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  // Protected by mutex_.
+  nsecs_t shutter_time_ = 0;
+  nsecs_t release_time_ = 0;
+  BufferStatus status_ = BufferStatus::kError;
+  bool released_ = false;
+};
+
+// JPEG output backed by heap memory.
+struct JpegBuffer : public SensorBuffer {
+  std::vector<uint8_t> data;
+  CaptureTimer* timer = nullptr;
+
+  ~JpegBuffer() override {
+    timer->OnJpegReleased(stream_buffer.status);
+  }
+};
+
+std::unique_ptr<LogicalCharacteristics> CreateCharacteristics() {
+  SensorCharacteristics chars;
+  chars.width = chars.full_res_width = kSensorWidth;
+  chars.height = chars.full_res_height = kSensorHeight;
+  for (size_t i = 0; i < 2; i++) {
+    chars.exposure_time_range[i] =
+        EmulatedSensor::kSupportedExposureTimeRange[i];
+    chars.frame_duration_range[i] =
+        EmulatedSensor::kSupportedFrameDurationRange[i];
+    chars.sensitivity_range[i] = EmulatedSensor::kSupportedSensitivityRange[i];
+  }
+  chars.max_raw_value = EmulatedSensor::kDefaultMaxRawValue;
+  for (size_t i = 0; i < 4; i++) {
+    chars.black_level_pattern[i] = EmulatedSensor::kDefaultBlackLevelPattern[i];
+  }
+  chars.max_processed_streams = 1;
+  chars.max_stalling_streams = 1;
+  chars.max_pipeline_depth = EmulatedSensor::kPipelineDepth;
+
+  auto logical_chars = std::make_unique<LogicalCharacteristics>();
+  logical_chars->emplace(kCameraId, chars);
+  return logical_chars;
+}
+
+void SubmitJpegRequest(EmulatedSensor* sensor, uint32_t frame_number,
+                       uint32_t width, uint32_t height,
+                       const HwlPipelineCallback& callback,
+                       CaptureTimer* timer) {
+  EmulatedSensor::SensorSettings settings;
+  settings.exposure_time = EmulatedSensor::kDefaultExposureTime;
+  settings.frame_duration = EmulatedSensor::kSupportedFrameDurationRange[0];
+  settings.gain = EmulatedSensor::kDefaultSensitivity;
+  settings.lens_shading_map_mode = ANDROID_STATISTICS_LENS_SHADING_MAP_MODE_OFF;
+  auto logical_settings =
+      std::make_unique<EmulatedSensor::LogicalCameraSettings>();
+  logical_settings->emplace(kCameraId, settings);
+
+  auto result = std::make_unique<HwlPipelineResult>();
+  result->camera_id = kCameraId;
+  result->frame_number = frame_number;
+  result->result_metadata = HalCameraMetadata::Create(1, 10);
+  result->result_metadata->Set(ANDROID_JPEG_THUMBNAIL_SIZE, kThumbnailSize, 2);
+  auto partial_result = std::make_unique<HwlPipelineResult>();
+
+  auto buffer = std::make_unique<JpegBuffer>();
+  buffer->width = width;
+  buffer->height = height;
+  buffer->frame_number = frame_number;
+  buffer->camera_id = kCameraId;
+  buffer->format = PixelFormat::BLOB;
+  buffer->dataSpace = HAL_DATASPACE_V0_JFIF;
+  buffer->callback = callback;
+  buffer->timer = timer;
+  buffer->data.resize(width * height * 3 / 2);
+  buffer->plane.img = {
+      .img = buffer->data.data(),
+      .stride_in_bytes = static_cast<uint32_t>(buffer->data.size()),
+      .buffer_size = static_cast<uint32_t>(buffer->data.size())};
+  auto output_buffers = std::make_unique<Buffers>();
+  output_buffers->push_back(std::move(buffer));
+
+  sensor->SetCurrentRequest(std::move(logical_settings), std::move(result),
+                            std::move(partial_result),
+                            std::make_unique<Buffers>(),
+                            std::move(output_buffers));
+  sensor->WaitForVSync(EmulatedSensor::kSupportedFrameDurationRange[1]);
+}
+
+void BM_ShutterToJpeg(benchmark::State& state) {
+  bool slice_delivery = state.range(0) != 0;
+  uint32_t width = state.range(1);
+  uint32_t height = state.range(2);
+  // The virtual clock keeps the sensor from idling until the end of each
+  // frame, it doesn't affect the measured latency.
+  EmulatedSensor::Options options = {.use_virtual_clock = true,
+                                     .use_slice_delivery = slice_delivery};
+  sp<EmulatedSensor> sensor = new EmulatedSensor();
+  if (sensor->StartUp(kCameraId, CreateCharacteristics(), options) != OK) {
+    state.SkipWithError("Failed to start the sensor");
+    return;
+  }
+
+  CaptureTimer timer;
+  HwlPipelineCallback callback = {
+      .process_pipeline_result = nullptr,
+      .process_pipeline_batch_result = nullptr,
+      .notify =
+          [&timer](uint32_t /*pipeline_id*/, const NotifyMessage& message) {
+            if (message.type == MessageType::kShutter) {
+              timer.OnShutter();
+            }
+          },
+  };
+
+  uint32_t frame_number = 0;
+  for (auto _ : state) {
+    SubmitJpegRequest(sensor.get(), frame_number++, width, height, callback,
+                      &timer);
+    nsecs_t latency = timer.WaitForJpeg();
+    if (latency < 0) {
+      state.SkipWithError("JPEG capture failed");
+      break;
+    }
+    state.SetIterationTime(latency / 1e9);
+  }
+
+  sensor->ShutDown();
+}
+BENCHMARK(BM_ShutterToJpeg)
+    ->ArgNames({"slices", "width", "height"})
+    ->Args({0, 1920, 1440})
+    ->Args({1, 1920, 1440})
+    ->Args({0, 4000, 3000})
+    ->Args({1, 4000, 3000})
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace android
+
+BENCHMARK_MAIN();
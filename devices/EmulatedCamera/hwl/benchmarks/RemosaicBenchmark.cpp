@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the RAW16 quad Bayer remosaic of a 8000x6000 reprocess input,
+// comparing the former block by block column major remosaic with
+// RemosaicQuadBayerRaw16() on one and on all remosaic threads.
+// Run with:
+//   adb shell /data/benchmarktest64/emulated_remosaic_benchmark/emulated_remosaic_benchmark
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "utils/QuadBayerRemosaic.h"
+
+namespace android {
+namespace {
+
+constexpr size_t kWidth = 8000;
+constexpr size_t kHeight = 6000;
+constexpr size_t kRowStrideInBytes = kWidth * sizeof(uint16_t);
+
+void RemosaicQuadBayerBlock(const uint16_t* img_in, uint16_t* img_out,
+                            size_t xstart, size_t ystart,
+                            size_t row_stride_in_bytes) {
+  uint32_t quad_block_copy_idx_map[16] = {0, 2, 1, 3, 8,  10, 6,  11,
+                                          4, 9, 5, 7, 12, 14, 13, 15};
+  uint16_t quad_block_copy[16];
+  uint32_t i = 0;
+  for (uint32_t row = 0; row < 4; row++) {
+    const uint16_t* quad_bayer_row =
+        img_in + (ystart + row) * (row_stride_in_bytes / 2) + xstart;
+    for (uint32_t j = 0; j < 4; j++, i++) {
+      quad_block_copy[i] = quad_bayer_row[j];
+    }
+  }
+
+  for (uint32_t row = 0; row < 4; row++) {
+    uint16_t* regular_bayer_row =
+        img_out + (ystart + row) * (row_stride_in_bytes / 2) + xstart;
+    for (uint32_t j = 0; j < 4; j++) {
+      uint32_t idx = quad_block_copy_idx_map[row + 4 * j];
+      regular_bayer_row[j] = quad_block_copy[idx];
+    }
+  }
+}
+
+std::vector<uint16_t> CreateImage() {
+  std::vector<uint16_t> image(kWidth * kHeight);
+  for (size_t i = 0; i < image.size(); i++) {
+    image[i] = (i * 2654435761u) & 0x3FF;
+  }
+  return image;
+}
+
+void BM_RemosaicBlockByBlock(benchmark::State& state) {
+  auto input = CreateImage();
+  std::vector<uint16_t> output(input.size());
+  for (auto _ : state) {
+    for (size_t i = 0; i < kWidth; i += 4) {
+      for (size_t j = 0; j < kHeight; j += 4) {
+        RemosaicQuadBayerBlock(input.data(), output.data(), i, j,
+                               kRowStrideInBytes);
+      }
+    }
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetBytesProcessed(state.iterations() * input.size() *
+                          sizeof(uint16_t));
+}
+BENCHMARK(BM_RemosaicBlockByBlock)->Unit(benchmark::kMillisecond);
+
+void BM_RemosaicQuadBayerRaw16(benchmark::State& state) {
+  auto input = CreateImage();
+  std::vector<uint16_t> output(input.size());
+  for (auto _ : state) {
+    RemosaicQuadBayerRaw16(input.data(), output.data(), kWidth, kHeight,
+                           kRowStrideInBytes, state.range(0));
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetBytesProcessed(state.iterations() * input.size() *
+                          sizeof(uint16_t));
+}
+BENCHMARK(BM_RemosaicQuadBayerRaw16)
+    ->Arg(1)
+    ->Arg(kMaxRemosaicThreads)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace android
+
+BENCHMARK_MAIN();
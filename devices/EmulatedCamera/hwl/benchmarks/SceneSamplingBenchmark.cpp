@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures sampling small RGBA and depth outputs from the scene of a large
+// sensor, the way EmulatedSensor::CaptureRGB() and CaptureDepth() do, by
+// walking the readout pixel over every skipped pixel as done previously and
+// with EmulatedScene::GetPixelElectronsAt(), with and without the rolling
+// shutter readout. Also measures the scene signature checked before reusing a
+// cached output.
+// Run with:
+//   adb shell /data/benchmarktest64/emulated_scene_sampling_benchmark/emulated_scene_sampling_benchmark
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+#include "EmulatedScene.h"
+
+namespace android {
+namespace {
+
+constexpr uint32_t kSensorWidth = 4000;
+constexpr uint32_t kSensorHeight = 3000;
+constexpr float kSensorSensitivity = 5.f;
+// 12:00 on the first day, in nanoseconds.
+constexpr nsecs_t kSceneTime = 12LL * 3600 * 1000000000;
+
+struct OutputSize {
+  uint32_t width;
+  uint32_t height;
+};
+
+std::unique_ptr<EmulatedScene> CreateScene(nsecs_t rolling_shutter_skew = 0) {
+  auto scene = std::make_unique<EmulatedScene>(
+      kSensorWidth, kSensorHeight, kSensorSensitivity, /*sensor_orientation*/ 0,
+      /*is_front_facing*/ false);
+  scene->Initialize(kSensorWidth, kSensorHeight, kSensorSensitivity);
+  // sRGB primaries
+  scene->SetColorFilterXYZ(3.2406f, -1.5372f, -0.4986f, -0.9689f, 1.8758f,
+                           0.0415f, -0.9689f, 1.8758f, 0.0415f, 0.0557f,
+                           -0.2040f, 1.0570f);
+  scene->SetExposureDuration(0.01f);
+  scene->SetRollingShutterSkew(rolling_shutter_skew);
+  scene->CalculateScene(kSceneTime, /*handshake_divider*/ 0);
+  return scene;
+}
+
+// Sample one channel into a 16 bit output, stepping inc_h x inc_v sensor
+// pixels per output pixel.
+void SampleWalk(EmulatedScene* scene, uint32_t inc_h, uint32_t inc_v,
+                int channel, uint16_t* out) {
+  for (uint32_t y = 0; y < kSensorHeight; y += inc_v) {
+    scene->SetReadoutPixel(0, y);
+    for (uint32_t x = 0; x < kSensorWidth; x += inc_h) {
+      *out++ = scene->GetPixelElectrons()[channel];
+      for (uint32_t j = 1; j < inc_h; j++) scene->GetPixelElectrons();
+    }
+  }
+}
+
+void SampleDirect(const EmulatedScene& scene, uint32_t inc_h, uint32_t inc_v,
+                  int channel, uint16_t* out) {
+  for (uint32_t y = 0; y < kSensorHeight; y += inc_v) {
+    for (uint32_t x = 0; x < kSensorWidth; x += inc_h) {
+      *out++ = scene.GetPixelElectronsAt(x, y)[channel];
+    }
+  }
+}
+
+// Sample R, G and B into an RGBA output.
+void SampleRgbaWalk(EmulatedScene* scene, uint32_t inc_h, uint32_t inc_v,
+                    uint8_t* out) {
+  for (uint32_t y = 0; y < kSensorHeight; y += inc_v) {
+    scene->SetReadoutPixel(0, y);
+    for (uint32_t x = 0; x < kSensorWidth; x += inc_h) {
+      const uint32_t* pixel = scene->GetPixelElectrons();
+      *out++ = pixel[EmulatedScene::R];
+      *out++ = pixel[EmulatedScene::Gr];
+      *out++ = pixel[EmulatedScene::B];
+      *out++ = 255;
+      for (uint32_t j = 1; j < inc_h; j++) scene->GetPixelElectrons();
+    }
+  }
+}
+
+void SampleRgbaDirect(const EmulatedScene& scene, uint32_t inc_h,
+                      uint32_t inc_v, uint8_t* out) {
+  for (uint32_t y = 0; y < kSensorHeight; y += inc_v) {
+    for (uint32_t x = 0; x < kSensorWidth; x += inc_h) {
+      const uint32_t* pixel = scene.GetPixelElectronsAt(x, y);
+      *out++ = pixel[EmulatedScene::R];
+      *out++ = pixel[EmulatedScene::Gr];
+      *out++ = pixel[EmulatedScene::B];
+      *out++ = 255;
+    }
+  }
+}
+
+uint32_t GetIncrement(uint32_t sensor_size, uint32_t output_size) {
+  return std::ceil(static_cast<float>(sensor_size) / output_size);
+}
+
+void BM_SampleRgba(benchmark::State& state, bool direct) {
+  auto scene = CreateScene();
+  uint32_t inc_h = GetIncrement(kSensorWidth, state.range(0));
+  uint32_t inc_v = GetIncrement(kSensorHeight, state.range(1));
+  std::vector<uint8_t> output(state.range(0) * state.range(1) * 4);
+  for (auto _ : state) {
+    if (direct) {
+      SampleRgbaDirect(*scene, inc_h, inc_v, output.data());
+    } else {
+      SampleRgbaWalk(scene.get(), inc_h, inc_v, output.data());
+    }
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) *
+                          state.range(1));
+}
+BENCHMARK_CAPTURE(BM_SampleRgba, Walk, false)
+    ->Args({320, 240})
+    ->Args({640, 480});
+BENCHMARK_CAPTURE(BM_SampleRgba, Direct, true)
+    ->Args({320, 240})
+    ->Args({640, 480});
+
+// Direct sampling with the handshake evaluated per readout band.
+void BM_SampleRgbaRollingShutter(benchmark::State& state) {
+  auto scene = CreateScene(/*rolling_shutter_skew*/ 33331760);
+  uint32_t inc_h = GetIncrement(kSensorWidth, state.range(0));
+  uint32_t inc_v = GetIncrement(kSensorHeight, state.range(1));
+  std::vector<uint8_t> output(state.range(0) * state.range(1) * 4);
+  for (auto _ : state) {
+    SampleRgbaDirect(*scene, inc_h, inc_v, output.data());
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) *
+                          state.range(1));
+}
+BENCHMARK(BM_SampleRgbaRollingShutter)->Args({320, 240})->Args({640, 480});
+
+void BM_SampleDepth(benchmark::State& state, bool direct) {
+  auto scene = CreateScene();
+  uint32_t inc_h = GetIncrement(kSensorWidth, state.range(0));
+  uint32_t inc_v = GetIncrement(kSensorHeight, state.range(1));
+  std::vector<uint16_t> output(state.range(0) * state.range(1));
+  for (auto _ : state) {
+    if (direct) {
+      SampleDirect(*scene, inc_h, inc_v, EmulatedScene::Gr, output.data());
+    } else {
+      SampleWalk(scene.get(), inc_h, inc_v, EmulatedScene::Gr, output.data());
+    }
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) *
+                          state.range(1));
+}
+BENCHMARK_CAPTURE(BM_SampleDepth, Walk, false)
+    ->Args({160, 120})
+    ->Args({320, 240});
+BENCHMARK_CAPTURE(BM_SampleDepth, Direct, true)
+    ->Args({160, 120})
+    ->Args({320, 240});
+
+void BM_SceneSignature(benchmark::State& state) {
+  auto scene = CreateScene();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(scene->GetSignature());
+  }
+}
+BENCHMARK(BM_SceneSignature);
+
+}  // namespace
+}  // namespace android
+
+BENCHMARK_MAIN();
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures EmulatedSensor::IsStreamCombinationSupported() over the mandatory
+// stream combinations of the LEGACY, LIMITED, FULL, RAW and LEVEL_3 hardware
+// levels, with and without a StreamCombinationCache.
+// Run with:
+//   adb shell /data/benchmarktest64/emulated_stream_combination_benchmark/emulated_stream_combination_benchmark
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "EmulatedSensor.h"
+
+namespace android {
+namespace {
+
+using google_camera_hal::Stream;
+using google_camera_hal::StreamConfigurationMode;
+using google_camera_hal::StreamType;
+
+constexpr uint32_t kCameraId = 0;
+constexpr StreamSize kMaximumSize = {4032, 3024};
+constexpr StreamSize kPreviewSize = {1920, 1080};
+constexpr StreamSize kVgaSize = {640, 480};
+
+constexpr android_pixel_format_t kPriv =
+    HAL_PIXEL_FORMAT_IMPLEMENTATION_DEFINED;
+constexpr android_pixel_format_t kYuv = HAL_PIXEL_FORMAT_YCBCR_420_888;
+constexpr android_pixel_format_t kJpeg = HAL_PIXEL_FORMAT_BLOB;
+constexpr android_pixel_format_t kRaw = HAL_PIXEL_FORMAT_RAW16;
+
+typedef std::vector<StreamConfig> Combination;
+
+// Mandatory stream combinations, see CameraDevice#createCaptureSession. The
+// record size is the preview size on the emulated cameras.
+const std::vector<Combination> kMandatoryCombinations = {
+    // LEGACY
+    {{kPriv, kPreviewSize}},
+    {{kJpeg, kMaximumSize}},
+    {{kYuv, kPreviewSize}},
+    {{kPriv, kPreviewSize}, {kJpeg, kMaximumSize}},
+    {{kYuv, kPreviewSize}, {kJpeg, kMaximumSize}},
+    {{kPriv, kPreviewSize}, {kPriv, kPreviewSize}},
+    {{kPriv, kPreviewSize}, {kYuv, kPreviewSize}},
+    {{kPriv, kPreviewSize}, {kYuv, kPreviewSize}, {kJpeg, kMaximumSize}},
+    // LIMITED
+    {{kPriv, kPreviewSize}, {kYuv, kPreviewSize}},
+    {{kYuv, kPreviewSize}, {kYuv, kPreviewSize}},
+    {{kPriv, kPreviewSize}, {kPriv, kPreviewSize}, {kJpeg, kPreviewSize}},
+    {{kPriv, kPreviewSize}, {kYuv, kPreviewSize}, {kJpeg, kPreviewSize}},
+    {{kYuv, kPreviewSize}, {kYuv, kPreviewSize}, {kJpeg, kPreviewSize}},
+    {{kYuv, kPreviewSize}, {kYuv, kPreviewSize}, {kJpeg, kMaximumSize}},
+    // FULL
+    {{kPriv, kPreviewSize}, {kPriv, kMaximumSize}},
+    {{kPriv, kPreviewSize}, {kYuv, kMaximumSize}},
+    {{kYuv, kPreviewSize}, {kYuv, kMaximumSize}},
+    {{kPriv, kPreviewSize}, {kPriv, kPreviewSize}, {kJpeg, kMaximumSize}},
+    {{kYuv, kVgaSize}, {kPriv, kPreviewSize}, {kYuv, kMaximumSize}},
+    {{kYuv, kVgaSize}, {kYuv, kPreviewSize}, {kYuv, kMaximumSize}},
+    // RAW
+    {{kRaw, kMaximumSize}},
+    {{kPriv, kPreviewSize}, {kRaw, kMaximumSize}},
+    {{kYuv, kPreviewSize}, {kRaw, kMaximumSize}},
+    {{kPriv, kPreviewSize}, {kPriv, kPreviewSize}, {kRaw, kMaximumSize}},
+    {{kPriv, kPreviewSize}, {kYuv, kPreviewSize}, {kRaw, kMaximumSize}},
+    {{kYuv, kPreviewSize}, {kYuv, kPreviewSize}, {kRaw, kMaximumSize}},
+    {{kPriv, kPreviewSize}, {kJpeg, kMaximumSize}, {kRaw, kMaximumSize}},
+    {{kYuv, kPreviewSize}, {kJpeg, kMaximumSize}, {kRaw, kMaximumSize}},
+    // LEVEL_3
+    {{kPriv, kPreviewSize},
+     {kPriv, kVgaSize},
+     {kYuv, kMaximumSize},
+     {kRaw, kMaximumSize}},
+    {{kPriv, kPreviewSize},
+     {kPriv, kVgaSize},
+     {kJpeg, kMaximumSize},
+     {kRaw, kMaximumSize}},
+};
+
+std::unique_ptr<HalCameraMetadata> CreateCharacteristics() {
+  const android_pixel_format_t formats[] = {kPriv, kYuv, kJpeg};
+  const StreamSize sizes[] = {kMaximumSize, {1920, 1440}, kPreviewSize,
+                              {1280, 720},  kVgaSize,     {320, 240}};
+  std::vector<int32_t> configurations;
+  std::vector<int64_t> durations;
+  auto append = [&](android_pixel_format_t format, const StreamSize& size) {
+    configurations.insert(
+        configurations.end(),
+        {static_cast<int32_t>(format), static_cast<int32_t>(size.first),
+         static_cast<int32_t>(size.second),
+         ANDROID_SCALER_AVAILABLE_STREAM_CONFIGURATIONS_OUTPUT});
+    durations.insert(durations.end(),
+                     {static_cast<int64_t>(format), size.first, size.second,
+                      33333333});
+  };
+  for (auto format : formats) {
+    for (const auto& size : sizes) {
+      append(format, size);
+    }
+  }
+  append(kRaw, kMaximumSize);
+
+  auto characteristics = HalCameraMetadata::Create(/*num_entries=*/4,
+                                                   /*data_bytes=*/1024);
+  characteristics->Set(ANDROID_SCALER_AVAILABLE_STREAM_CONFIGURATIONS,
+                       configurations.data(), configurations.size());
+  characteristics->Set(ANDROID_SCALER_AVAILABLE_MIN_FRAME_DURATIONS,
+                       durations.data(), durations.size());
+  return characteristics;
+}
+
+StreamConfiguration CreateStreamConfiguration(const Combination& combination) {
+  StreamConfiguration config;
+  config.operation_mode = StreamConfigurationMode::kNormal;
+  for (const auto& stream_config : combination) {
+    Stream stream;
+    stream.id = config.streams.size();
+    stream.stream_type = StreamType::kOutput;
+    stream.format = stream_config.first;
+    stream.width = stream_config.second.first;
+    stream.height = stream_config.second.second;
+    config.streams.push_back(stream);
+  }
+  return config;
+}
+
+class StreamCombinationFixture : public benchmark::Fixture {
+ public:
+  void SetUp(const benchmark::State&) override {
+    auto characteristics = CreateCharacteristics();
+    map_ = std::make_unique<StreamConfigurationMap>(*characteristics);
+    max_resolution_map_ = std::make_unique<StreamConfigurationMap>(
+        *characteristics, /*maxResolution*/ true);
+
+    SensorCharacteristics& chars = sensor_chars_[kCameraId];
+    chars.width = chars.full_res_width = kMaximumSize.first;
+    chars.height = chars.full_res_height = kMaximumSize.second;
+    chars.max_raw_streams = 1;
+    chars.max_processed_streams = 3;
+    chars.max_stalling_streams = 1;
+
+    for (const auto& combination : kMandatoryCombinations) {
+      configs_.push_back(CreateStreamConfiguration(combination));
+    }
+  }
+
+  void TearDown(const benchmark::State&) override {
+    configs_.clear();
+    map_ = nullptr;
+    max_resolution_map_ = nullptr;
+    sensor_chars_.clear();
+  }
+
+  // Query every mandatory stream combination once.
+  bool QueryAll(StreamCombinationCache* cache) {
+    bool all_supported = true;
+    for (const auto& config : configs_) {
+      all_supported &= EmulatedSensor::IsStreamCombinationSupported(
+          kCameraId, config, *map_, *max_resolution_map_, physical_map_,
+          physical_map_max_resolution_, sensor_chars_, cache);
+    }
+    return all_supported;
+  }
+
+ protected:
+  std::vector<StreamConfiguration> configs_;
+  std::unique_ptr<StreamConfigurationMap> map_;
+  std::unique_ptr<StreamConfigurationMap> max_resolution_map_;
+  PhysicalStreamConfigurationMap physical_map_;
+  PhysicalStreamConfigurationMap physical_map_max_resolution_;
+  LogicalCharacteristics sensor_chars_;
+};
+
+BENCHMARK_F(StreamCombinationFixture, Uncached)(benchmark::State& state) {
+  if (!QueryAll(/*cache=*/nullptr)) {
+    state.SkipWithError("A mandatory stream combination is not supported.");
+    return;
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(QueryAll(/*cache=*/nullptr));
+  }
+  state.SetItemsProcessed(state.iterations() * configs_.size());
+}
+
+BENCHMARK_F(StreamCombinationFixture, Cached)(benchmark::State& state) {
+  StreamCombinationCache cache;
+  if (!QueryAll(&cache)) {
+    state.SkipWithError("A mandatory stream combination is not supported.");
+    return;
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(QueryAll(&cache));
+  }
+  state.SetItemsProcessed(state.iterations() * configs_.size());
+}
+
+}  // namespace
+}  // namespace android
+
+BENCHMARK_MAIN();
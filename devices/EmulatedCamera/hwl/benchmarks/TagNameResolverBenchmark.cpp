@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Resolves the tag names of every emulated camera configuration, the way
+// EmulatedCameraProviderHwlImpl::ParseCharacteristics() does, with the
+// section prefix scan used previously and with TagNameResolver.
+// Run with:
+//   adb shell /data/benchmarktest64/emulated_tag_name_resolver_benchmark/emulated_tag_name_resolver_benchmark
+
+#include <android-base/file.h>
+#include <benchmark/benchmark.h>
+#include <json/json.h>
+#include <system/camera_metadata.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tag_name_resolver.h"
+
+namespace android {
+namespace {
+
+using google_camera_hal::TagNameResolver;
+
+const char* kConfigFiles[] = {
+    "/vendor/etc/config/emu_camera_back.json",
+    "/vendor/etc/config/emu_camera_front.json",
+    "/vendor/etc/config/emu_camera_external.json",
+    "/vendor/etc/config/emu_camera_depth.json",
+};
+
+// Collect the tag names of a configuration, which is either a single camera
+// object or an array of logical and physical camera objects.
+void CollectTagNames(const Json::Value& value,
+                     std::vector<std::string>* names) {
+  if (value.isArray()) {
+    for (const auto& camera : value) {
+      CollectTagNames(camera, names);
+    }
+  } else if (value.isObject()) {
+    auto members = value.getMemberNames();
+    names->insert(names->end(), members.begin(), members.end());
+  }
+}
+
+std::vector<std::string> LoadTagNames() {
+  std::vector<std::string> names;
+  for (auto path : kConfigFiles) {
+    std::string config;
+    if (!android::base::ReadFileToString(path, &config)) {
+      continue;
+    }
+
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    Json::Value root;
+    std::string error;
+    if (reader->parse(config.data(), config.data() + config.size(), &root,
+                      &error)) {
+      CollectTagNames(root, &names);
+    }
+  }
+  return names;
+}
+
+// Name lookup replaced by TagNameResolver: longest section prefix match
+// followed by a scan over the tag names of the section.
+status_t GetTagFromNameLinear(const char* name, uint32_t* tag) {
+  size_t name_length = strlen(name);
+  const char* section = nullptr;
+  size_t section_index = 0;
+  size_t section_length = 0;
+  for (size_t i = 0; i < ANDROID_SECTION_COUNT; ++i) {
+    const char* str = camera_metadata_section_names[i];
+    if (strstr(name, str) == name) {
+      size_t str_length = strlen(str);
+      if (section == nullptr || section_length < str_length) {
+        section = str;
+        section_index = i;
+        section_length = str_length;
+      }
+    }
+  }
+
+  if (section == nullptr) {
+    return NAME_NOT_FOUND;
+  }
+
+  if (section_length + 1 >= name_length) {
+    return BAD_VALUE;
+  }
+
+  const char* name_tag_name = name + section_length + 1;
+  uint32_t tag_begin = camera_metadata_section_bounds[section_index][0];
+  uint32_t tag_end = camera_metadata_section_bounds[section_index][1];
+  for (uint32_t candidate = tag_begin; candidate < tag_end; ++candidate) {
+    if (strcmp(name_tag_name, get_camera_metadata_tag_name(candidate)) == 0) {
+      *tag = candidate;
+      return OK;
+    }
+  }
+
+  return NAME_NOT_FOUND;
+}
+
+void BM_LinearScan(benchmark::State& state) {
+  std::vector<std::string> names = LoadTagNames();
+  if (names.empty()) {
+    state.SkipWithError("No emulated camera configuration found.");
+    return;
+  }
+
+  for (auto _ : state) {
+    for (const auto& name : names) {
+      uint32_t tag = 0;
+      benchmark::DoNotOptimize(GetTagFromNameLinear(name.c_str(), &tag));
+      benchmark::DoNotOptimize(tag);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * names.size());
+}
+BENCHMARK(BM_LinearScan);
+
+void BM_TagNameResolver(benchmark::State& state) {
+  std::vector<std::string> names = LoadTagNames();
+  if (names.empty()) {
+    state.SkipWithError("No emulated camera configuration found.");
+    return;
+  }
+
+  // Index the tag names outside of the measured loop.
+  auto& resolver = TagNameResolver::GetInstance();
+  for (auto _ : state) {
+    for (const auto& name : names) {
+      uint32_t tag = 0;
+      benchmark::DoNotOptimize(resolver.GetTag(name, &tag));
+      benchmark::DoNotOptimize(tag);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * names.size());
+}
+BENCHMARK(BM_TagNameResolver);
+
+}  // namespace
+}  // namespace android
+
+BENCHMARK_MAIN();
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "CharacteristicsCacheTests"
+#include <android-base/file.h>
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include "utils/CharacteristicsCache.h"
+
+namespace android {
+namespace {
+
+using android::base::ReadFileToString;
+using android::base::WriteStringToFile;
+
+static constexpr uint64_t kContentHash = 0x1234567890abcdefULL;
+
+class CharacteristicsCacheTests : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = std::string(temp_dir_.path) + "/back.json.characteristics";
+    for (size_t capacity : {4, 16}) {
+      auto metadata = HalCameraMetadata::Create(capacity, capacity * 8);
+      ASSERT_NE(metadata, nullptr);
+      characteristics_.push_back(std::move(metadata));
+    }
+  }
+
+  status_t Store(uint64_t content_hash) {
+    std::vector<const HalCameraMetadata*> characteristics;
+    for (const auto& metadata : characteristics_) {
+      characteristics.push_back(metadata.get());
+    }
+    return CharacteristicsCache::Store(path_, content_hash, characteristics);
+  }
+
+  status_t Load(uint64_t content_hash,
+                std::vector<std::unique_ptr<HalCameraMetadata>>* loaded) {
+    return CharacteristicsCache::Load(path_, content_hash, loaded);
+  }
+
+  TemporaryDir temp_dir_;
+  std::string path_;
+  std::vector<std::unique_ptr<HalCameraMetadata>> characteristics_;
+};
+
+TEST_F(CharacteristicsCacheTests, StoreAndLoad) {
+  ASSERT_EQ(Store(kContentHash), OK);
+
+  std::vector<std::unique_ptr<HalCameraMetadata>> loaded;
+  ASSERT_EQ(Load(kContentHash, &loaded), OK);
+  ASSERT_EQ(loaded.size(), characteristics_.size());
+  for (size_t i = 0; i < loaded.size(); i++) {
+    size_t size = characteristics_[i]->GetCameraMetadataSize();
+    ASSERT_EQ(loaded[i]->GetCameraMetadataSize(), size);
+    EXPECT_EQ(memcmp(loaded[i]->GetRawCameraMetadata(),
+                     characteristics_[i]->GetRawCameraMetadata(), size),
+              0);
+  }
+}
+
+TEST_F(CharacteristicsCacheTests, MissingFile) {
+  std::vector<std::unique_ptr<HalCameraMetadata>> loaded;
+  EXPECT_EQ(Load(kContentHash, &loaded), NAME_NOT_FOUND);
+}
+
+TEST_F(CharacteristicsCacheTests, HashMismatch) {
+  ASSERT_EQ(Store(kContentHash), OK);
+
+  std::vector<std::unique_ptr<HalCameraMetadata>> loaded;
+  EXPECT_EQ(Load(kContentHash + 1, &loaded), NAME_NOT_FOUND);
+  EXPECT_TRUE(loaded.empty());
+}
+
+TEST_F(CharacteristicsCacheTests, TruncatedFile) {
+  ASSERT_EQ(Store(kContentHash), OK);
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(path_, &contents));
+
+  // Cut inside the last metadata buffer and inside the file header.
+  for (size_t size : {contents.size() - 16, size_t(16), size_t(0)}) {
+    ASSERT_TRUE(WriteStringToFile(contents.substr(0, size), path_));
+    std::vector<std::unique_ptr<HalCameraMetadata>> loaded;
+    EXPECT_EQ(Load(kContentHash, &loaded), BAD_VALUE) << "size " << size;
+    EXPECT_TRUE(loaded.empty());
+  }
+}
+
+TEST_F(CharacteristicsCacheTests, CorruptBlob) {
+  ASSERT_EQ(Store(kContentHash), OK);
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(path_, &contents));
+
+  // Claim the first metadata buffer is larger than the file.
+  const auto& first = characteristics_[0];
+  size_t offset = contents.find(std::string(
+      reinterpret_cast<const char*>(first->GetRawCameraMetadata()),
+      first->GetCameraMetadataSize()));
+  ASSERT_NE(offset, std::string::npos);
+  uint32_t size = UINT32_MAX;
+  memcpy(&contents[offset], &size, sizeof(size));
+  ASSERT_TRUE(WriteStringToFile(contents, path_));
+
+  std::vector<std::unique_ptr<HalCameraMetadata>> loaded;
+  EXPECT_EQ(Load(kContentHash, &loaded), BAD_VALUE);
+  EXPECT_TRUE(loaded.empty());
+}
+
+TEST_F(CharacteristicsCacheTests, ContentHash) {
+  const std::string config = "{\"android.info.supportedHardwareLevel\": 1}";
+  const std::string build_id =
+      "fingerprint/" + CharacteristicsCache::GetLibraryBuildId();
+  uint64_t hash = CharacteristicsCache::GetContentHash(config, build_id);
+  EXPECT_EQ(CharacteristicsCache::GetContentHash(config, build_id), hash);
+  EXPECT_NE(CharacteristicsCache::GetContentHash(config + " ", build_id), hash);
+  EXPECT_NE(CharacteristicsCache::GetContentHash(config, build_id + "0"), hash);
+}
+
+TEST_F(CharacteristicsCacheTests, LibraryBuildId) {
+  std::string build_id = CharacteristicsCache::GetLibraryBuildId();
+  // Android binaries are always linked with a build ID.
+  ASSERT_FALSE(build_id.empty());
+  EXPECT_EQ(build_id.find_first_not_of("0123456789abcdef"), std::string::npos);
+  EXPECT_EQ(CharacteristicsCache::GetLibraryBuildId(), build_id);
+}
+
+}  // namespace
+}  // namespace android
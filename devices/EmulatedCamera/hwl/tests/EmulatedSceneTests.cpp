@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "EmulatedSceneTests"
+#include <gtest/gtest.h>
+
+#include "EmulatedScene.h"
+
+namespace android {
+namespace {
+
+constexpr int kSensorWidth = 4000;
+constexpr int kSensorHeight = 3000;
+constexpr float kSensorSensitivity = 5.f;
+// 12:00 on the first day, in nanoseconds.
+constexpr nsecs_t kSceneTime = 12LL * 3600 * 1000000000;
+
+class EmulatedSceneTests : public ::testing::Test {
+ protected:
+  static std::unique_ptr<EmulatedScene> CreateScene() {
+    auto scene = std::make_unique<EmulatedScene>(
+        kSensorWidth, kSensorHeight, kSensorSensitivity,
+        /*sensor_orientation*/ 0, /*is_front_facing*/ false);
+    scene->SetTestPattern(false);
+    scene->SetScreenRotation(0);
+    scene->SetExposureDuration(0.01f);
+    scene->CalculateScene(kSceneTime, /*handshake_divider*/ 1);
+    return scene;
+  }
+
+  void SetUp() override {
+    scene_ = CreateScene();
+    signature_ = scene_->GetSignature();
+  }
+
+  std::unique_ptr<EmulatedScene> scene_;
+  uint64_t signature_ = 0;
+};
+
+TEST_F(EmulatedSceneTests, SameState) {
+  EXPECT_EQ(CreateScene()->GetSignature(), signature_);
+
+  scene_->CalculateScene(kSceneTime, /*handshake_divider*/ 1);
+  EXPECT_EQ(scene_->GetSignature(), signature_);
+}
+
+TEST_F(EmulatedSceneTests, ExposureChange) {
+  scene_->SetExposureDuration(0.02f);
+  scene_->CalculateScene(kSceneTime, /*handshake_divider*/ 1);
+  EXPECT_NE(scene_->GetSignature(), signature_);
+}
+
+TEST_F(EmulatedSceneTests, HandshakeChange) {
+  // Same time of day, only the handshake magnitude differs.
+  scene_->CalculateScene(kSceneTime, /*handshake_divider*/ 4);
+  EXPECT_NE(scene_->GetSignature(), signature_);
+}
+
+TEST_F(EmulatedSceneTests, RotationChange) {
+  scene_->SetScreenRotation(90);
+  scene_->CalculateScene(kSceneTime, /*handshake_divider*/ 1);
+  EXPECT_NE(scene_->GetSignature(), signature_);
+}
+
+TEST_F(EmulatedSceneTests, TestPatternChange) {
+  uint32_t pattern[4] = {100, 200, 200, 300};
+  scene_->SetTestPattern(true);
+  scene_->SetTestPatternData(pattern);
+  scene_->CalculateScene(kSceneTime, /*handshake_divider*/ 1);
+  uint64_t pattern_signature = scene_->GetSignature();
+  EXPECT_NE(pattern_signature, signature_);
+
+  pattern[0] = 150;
+  scene_->SetTestPatternData(pattern);
+  EXPECT_NE(scene_->GetSignature(), pattern_signature);
+}
+
+}  // namespace
+}  // namespace android
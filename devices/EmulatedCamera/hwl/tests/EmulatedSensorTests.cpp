@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "EmulatedSensorTests"
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "EmulatedSensor.h"
+
+namespace android {
+namespace {
+
+using google_camera_hal::MessageType;
+using google_camera_hal::NotifyMessage;
+
+static constexpr uint32_t kCameraId = 0;
+static constexpr uint32_t kWidth = 320;
+static constexpr uint32_t kHeight = 240;
+
+// Output buffer backed by heap memory.
+struct TestSensorBuffer : public SensorBuffer {
+  std::vector<uint8_t> data;
+};
+
+class EmulatedSensorTests : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    sensor_ = new EmulatedSensor();
+    callback_.notify = [this](uint32_t /*pipeline_id*/,
+                              const NotifyMessage& message) {
+      if (message.type == MessageType::kShutter) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutter_timestamps_.push_back(message.message.shutter.timestamp_ns);
+        condition_.notify_all();
+      }
+    };
+  }
+
+  void TearDown() override {
+    sensor_->ShutDown();
+  }
+
+  status_t StartUp(const EmulatedSensor::Options& options) {
+    SensorCharacteristics chars;
+    chars.width = chars.full_res_width = kWidth;
+    chars.height = chars.full_res_height = kHeight;
+    for (size_t i = 0; i < 2; i++) {
+      chars.exposure_time_range[i] =
+          EmulatedSensor::kSupportedExposureTimeRange[i];
+      chars.frame_duration_range[i] =
+          EmulatedSensor::kSupportedFrameDurationRange[i];
+      chars.sensitivity_range[i] = EmulatedSensor::kSupportedSensitivityRange[i];
+    }
+    chars.max_raw_value = EmulatedSensor::kDefaultMaxRawValue;
+    for (size_t i = 0; i < 4; i++) {
+      chars.black_level_pattern[i] =
+          EmulatedSensor::kDefaultBlackLevelPattern[i];
+    }
+    chars.max_processed_streams = 1;
+    chars.max_stalling_streams = 1;
+    chars.max_pipeline_depth = EmulatedSensor::kPipelineDepth;
+
+    auto logical_chars = std::make_unique<LogicalCharacteristics>();
+    logical_chars->emplace(kCameraId, chars);
+    return sensor_->StartUp(kCameraId, std::move(logical_chars), options);
+  }
+
+  std::unique_ptr<SensorBuffer> CreateRgbaBuffer(uint32_t frame_number) {
+    auto buffer = std::make_unique<TestSensorBuffer>();
+    buffer->width = kWidth;
+    buffer->height = kHeight;
+    buffer->frame_number = frame_number;
+    buffer->camera_id = kCameraId;
+    buffer->format = PixelFormat::RGBA_8888;
+    buffer->callback = callback_;
+    buffer->data.resize(kWidth * kHeight * 4);
+    buffer->plane.img = {.img = buffer->data.data(),
+                         .stride_in_bytes = kWidth * 4,
+                         .buffer_size =
+                             static_cast<uint32_t>(buffer->data.size())};
+    return buffer;
+  }
+
+  // Submit a request the way the request processor does, and wait until the
+  // sensor picks it up.
+  void SubmitRequest(uint32_t frame_number, nsecs_t frame_duration,
+                     std::unique_ptr<Buffers> output_buffers) {
+    EmulatedSensor::SensorSettings settings;
+    settings.exposure_time = EmulatedSensor::kDefaultExposureTime;
+    settings.frame_duration = frame_duration;
+    settings.gain = EmulatedSensor::kDefaultSensitivity;
+    settings.lens_shading_map_mode =
+        ANDROID_STATISTICS_LENS_SHADING_MAP_MODE_OFF;
+    auto logical_settings =
+        std::make_unique<EmulatedSensor::LogicalCameraSettings>();
+    logical_settings->emplace(kCameraId, settings);
+
+    auto result = std::make_unique<HwlPipelineResult>();
+    result->camera_id = kCameraId;
+    result->frame_number = frame_number;
+    auto partial_result = std::make_unique<HwlPipelineResult>();
+    partial_result->camera_id = kCameraId;
+    partial_result->frame_number = frame_number;
+
+    sensor_->SetCurrentRequest(std::move(logical_settings), std::move(result),
+                               std::move(partial_result),
+                               std::make_unique<Buffers>(),
+                               std::move(output_buffers));
+    sensor_->WaitForVSync(EmulatedSensor::kSupportedFrameDurationRange[1]);
+  }
+
+  std::vector<uint64_t> WaitForShutters(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait_for(lock, std::chrono::seconds(10), [this, count] {
+      return shutter_timestamps_.size() >= count;
+    });
+    return shutter_timestamps_;
+  }
+
+  sp<EmulatedSensor> sensor_;
+  HwlPipelineCallback callback_;
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  // Protected by mutex_.
+  std::vector<uint64_t> shutter_timestamps_;
+};
+
+TEST_F(EmulatedSensorTests, VirtualClock) {
+  const size_t request_count = 10;
+  const nsecs_t frame_duration = ms2ns(500);
+  ASSERT_EQ(StartUp({.use_virtual_clock = true}), OK);
+
+  nsecs_t start_time = systemTime(SYSTEM_TIME_MONOTONIC);
+  for (size_t i = 0; i < request_count; i++) {
+    auto output_buffers = std::make_unique<Buffers>();
+    output_buffers->push_back(CreateRgbaBuffer(i));
+    SubmitRequest(i, frame_duration, std::move(output_buffers));
+  }
+  auto timestamps = WaitForShutters(request_count);
+  nsecs_t wall_time = systemTime(SYSTEM_TIME_MONOTONIC) - start_time;
+
+  ASSERT_EQ(timestamps.size(), request_count);
+  EXPECT_GT(timestamps[0], static_cast<uint64_t>(start_time));
+  // Each request advances the clock by exactly its frame duration.
+  for (size_t i = 1; i < timestamps.size(); i++) {
+    ASSERT_GT(timestamps[i], timestamps[i - 1]) << "request " << i;
+    EXPECT_EQ(timestamps[i] - timestamps[i - 1],
+              static_cast<uint64_t>(frame_duration))
+        << "request " << i;
+  }
+  // The sensor doesn't wait for the end of the frames.
+  EXPECT_LT(wall_time, request_count * frame_duration / 4);
+}
+
+}  // namespace
+}  // namespace android
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "FrameStatsTests"
+#include <gtest/gtest.h>
+#include <log/log.h>
+
+#include "utils/FrameStats.h"
+
+namespace android {
+namespace {
+
+// Collect a width x height frame whose left half is black and right half is
+// white.
+void CollectSplitFrame(uint32_t width, uint32_t height, FrameStats* stats) {
+  FrameStatsCollector collector(stats, width, height);
+  for (uint32_t y = 0; y < height; y++) {
+    collector.StartRow(y);
+    for (uint32_t x = 0; x < width; x++) {
+      uint8_t value = x < width / 2 ? 0 : 255;
+      collector.AddPixel(x, value, value, value, value);
+    }
+  }
+}
+
+TEST(FrameStatsTests, EmptyStats) {
+  FrameStats stats;
+  EXPECT_FALSE(stats.IsValid());
+  EXPECT_EQ(stats.GetMeanLuma(), 0.f);
+  EXPECT_EQ(stats.GetSharpness(), 0.f);
+
+  FrameStatsCollector collector(nullptr, 16, 16);
+  EXPECT_FALSE(collector.IsCollecting());
+  FrameStatsCollector empty_collector(&stats, 0, 0);
+  EXPECT_FALSE(empty_collector.IsCollecting());
+}
+
+TEST(FrameStatsTests, LumaHistogram) {
+  const uint32_t width = 64, height = 32;
+  FrameStats stats;
+  CollectSplitFrame(width, height, &stats);
+
+  ASSERT_TRUE(stats.IsValid());
+  EXPECT_EQ(stats.pixel_count, width * height);
+  EXPECT_EQ(stats.luma_histogram[0], width * height / 2);
+  EXPECT_EQ(stats.luma_histogram[FrameStats::kLumaHistogramBins - 1],
+            width * height / 2);
+  EXPECT_FLOAT_EQ(stats.GetMeanLuma(), 127.5f);
+}
+
+TEST(FrameStatsTests, ZoneMeans) {
+  const uint32_t width = 64, height = 32;
+  FrameStats stats;
+  CollectSplitFrame(width, height, &stats);
+
+  auto zone_means = stats.GetZoneMeanRgb();
+  ASSERT_EQ(zone_means.size(), FrameStats::kZoneCount * 3);
+  for (size_t zone = 0; zone < FrameStats::kZoneCount; zone++) {
+    EXPECT_EQ(stats.zone_pixel_counts[zone],
+              width * height / FrameStats::kZoneCount);
+    size_t column = zone % FrameStats::kZoneGridSize;
+    float expected = column < FrameStats::kZoneGridSize / 2 ? 0.f : 255.f;
+    for (size_t c = 0; c < 3; c++) {
+      EXPECT_FLOAT_EQ(zone_means[zone * 3 + c], expected);
+    }
+  }
+
+  float rgb[3];
+  stats.GetMeanRgb(rgb);
+  for (size_t c = 0; c < 3; c++) {
+    EXPECT_FLOAT_EQ(rgb[c], 127.5f);
+  }
+}
+
+TEST(FrameStatsTests, Sharpness) {
+  const uint32_t width = 64, height = 32;
+  FrameStats stats;
+  CollectSplitFrame(width, height, &stats);
+  // A single edge per row, gradients don't cross rows.
+  EXPECT_EQ(stats.gradient_count, (width - 1) * height);
+  EXPECT_FLOAT_EQ(stats.GetSharpness(), 255.f * 255.f / (width - 1));
+
+  // A smooth ramp over the same range is less sharp.
+  FrameStats ramp_stats;
+  FrameStatsCollector collector(&ramp_stats, width, height);
+  for (uint32_t y = 0; y < height; y++) {
+    collector.StartRow(y);
+    for (uint32_t x = 0; x < width; x++) {
+      uint8_t value = x * 255 / (width - 1);
+      collector.AddPixel(x, value, value, value, value);
+    }
+  }
+  EXPECT_LT(ramp_stats.GetSharpness(), stats.GetSharpness() / 10);
+}
+
+}  // namespace
+}  // namespace android
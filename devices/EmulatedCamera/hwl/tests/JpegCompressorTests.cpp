@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "JpegCompressorTests"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "JpegCompressor.h"
+
+namespace android {
+namespace {
+
+static constexpr uint32_t kWidth = 320;
+static constexpr uint32_t kHeight = 240;
+
+// JPEG output backed by heap memory, reporting its status once the
+// compressor releases it.
+struct TestJpegBuffer : public SensorBuffer {
+  std::vector<uint8_t> data;
+  std::promise<BufferStatus> released;
+
+  ~TestJpegBuffer() override {
+    released.set_value(stream_buffer.status);
+  }
+};
+
+// Return an input owning its planes, written as progress is signaled.
+std::unique_ptr<JpegYUV420Input> CreateSlicedInput(
+    std::shared_ptr<SliceProgress> progress) {
+  auto input = std::make_unique<JpegYUV420Input>();
+  input->width = kWidth;
+  input->height = kHeight;
+  input->color_space =
+      ANDROID_REQUEST_AVAILABLE_COLOR_SPACE_PROFILES_MAP_UNSPECIFIED;
+  auto img = new uint8_t[(kWidth * kHeight * 3) / 2]();
+  input->yuv_planes = {.img_y = img,
+                       .img_cb = img + kWidth * kHeight,
+                       .img_cr = img + (kWidth * kHeight * 5) / 4,
+                       .y_stride = kWidth,
+                       .cbcr_stride = kWidth / 2,
+                       .cbcr_step = 1};
+  input->buffer_owner = true;
+  input->progress = progress;
+  return input;
+}
+
+// Queue a job whose input is written as the returned progress is signaled.
+std::shared_ptr<SliceProgress> QueueSlicedJob(
+    JpegCompressor* compressor, std::future<BufferStatus>* output_status) {
+  auto progress = std::make_shared<SliceProgress>(kHeight);
+  auto input = CreateSlicedInput(progress);
+
+  auto output = std::make_unique<TestJpegBuffer>();
+  output->width = kWidth;
+  output->height = kHeight;
+  output->format = PixelFormat::BLOB;
+  output->dataSpace = HAL_DATASPACE_V0_JFIF;
+  output->stream_buffer.status = BufferStatus::kError;
+  output->data.resize(kWidth * kHeight * 3);
+  output->plane.img = {
+      .img = output->data.data(),
+      .stride_in_bytes = static_cast<uint32_t>(output->data.size()),
+      .buffer_size = static_cast<uint32_t>(output->data.size())};
+  *output_status = output->released.get_future();
+
+  auto job = std::make_unique<JpegYUV420Job>();
+  job->input = std::move(input);
+  job->output = std::move(output);
+  EXPECT_EQ(compressor->QueueYUV420(std::move(job)), OK);
+  return progress;
+}
+
+TEST(JpegCompressorTests, SlicedInput) {
+  JpegCompressor compressor;
+  std::future<BufferStatus> output_status;
+  auto progress = QueueSlicedJob(&compressor, &output_status);
+  for (uint32_t row = 16; row <= kHeight; row += 16) {
+    progress->Signal(row);
+  }
+  progress->Finish(true);
+
+  ASSERT_EQ(output_status.wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+  EXPECT_EQ(output_status.get(), BufferStatus::kOk);
+}
+
+TEST(JpegCompressorTests, FailedSliceProducer) {
+  JpegCompressor compressor;
+  std::future<BufferStatus> output_status;
+  auto progress = QueueSlicedJob(&compressor, &output_status);
+  progress->Signal(kHeight / 4);
+  progress->Finish(false);
+
+  // The compressor must give up on the input and return an error buffer.
+  ASSERT_EQ(output_status.wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+  EXPECT_EQ(output_status.get(), BufferStatus::kError);
+}
+
+// The sensor signals all the rows of inputs whose height is a multiple of
+// EmulatedSensor::kSliceRows before it is done with them, e.g. while it
+// copies them to its output cache. The planes must not be freed until then.
+TEST(JpegCompressorTests, OwnedInputOutlivesProducer) {
+  static_assert(kHeight % 16 == 0);
+  auto progress = std::make_shared<SliceProgress>(kHeight);
+  auto input = CreateSlicedInput(progress);
+  const uint8_t* img_y = input->yuv_planes.img_y;
+  progress->Signal(kHeight);
+
+  std::atomic_bool destroyed = false;
+  std::thread consumer([&input, &destroyed] {
+    input.reset();
+    destroyed = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(destroyed);
+  std::vector<uint8_t> copy(img_y, img_y + kWidth * kHeight);
+  progress->Finish(true);
+  consumer.join();
+  EXPECT_TRUE(destroyed);
+}
+
+}  // namespace
+}  // namespace android
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "QuadBayerRemosaicTests"
+#include <gtest/gtest.h>
+#include <log/log.h>
+
+#include <random>
+#include <vector>
+
+#include "utils/QuadBayerRemosaic.h"
+
+namespace android {
+namespace {
+
+// The block by block remosaic EmulatedSensor used before
+// RemosaicQuadBayerRaw16(), used as the golden implementation.
+void RemosaicQuadBayerBlock(const uint16_t* img_in, uint16_t* img_out,
+                            size_t xstart, size_t ystart,
+                            size_t row_stride_in_bytes) {
+  uint32_t quad_block_copy_idx_map[16] = {0, 2, 1, 3, 8,  10, 6,  11,
+                                          4, 9, 5, 7, 12, 14, 13, 15};
+  uint16_t quad_block_copy[16];
+  uint32_t i = 0;
+  for (uint32_t row = 0; row < 4; row++) {
+    const uint16_t* quad_bayer_row =
+        img_in + (ystart + row) * (row_stride_in_bytes / 2) + xstart;
+    for (uint32_t j = 0; j < 4; j++, i++) {
+      quad_block_copy[i] = quad_bayer_row[j];
+    }
+  }
+
+  for (uint32_t row = 0; row < 4; row++) {
+    uint16_t* regular_bayer_row =
+        img_out + (ystart + row) * (row_stride_in_bytes / 2) + xstart;
+    for (uint32_t j = 0; j < 4; j++) {
+      uint32_t idx = quad_block_copy_idx_map[row + 4 * j];
+      regular_bayer_row[j] = quad_block_copy[idx];
+    }
+  }
+}
+
+void GoldenRemosaic(const uint16_t* img_in, uint16_t* img_out, size_t width,
+                    size_t height, size_t row_stride_in_bytes) {
+  for (size_t i = 0; i < width; i += 4) {
+    for (size_t j = 0; j < height; j += 4) {
+      RemosaicQuadBayerBlock(img_in, img_out, i, j, row_stride_in_bytes);
+    }
+  }
+}
+
+std::vector<uint16_t> CreateRandomImage(size_t row_stride, size_t height) {
+  std::mt19937 generator(row_stride * height);
+  std::uniform_int_distribution<uint16_t> distribution(0, 1023);
+  std::vector<uint16_t> image(row_stride * height);
+  for (auto& pixel : image) {
+    pixel = distribution(generator);
+  }
+  return image;
+}
+
+void CompareWithGolden(size_t width, size_t height, size_t row_stride,
+                       size_t max_threads) {
+  auto input = CreateRandomImage(row_stride, height);
+  // Padding must be left untouched.
+  std::vector<uint16_t> expected(row_stride * height, 0xFFFF);
+  std::vector<uint16_t> output(row_stride * height, 0xFFFF);
+
+  GoldenRemosaic(input.data(), expected.data(), width, height,
+                 row_stride * sizeof(uint16_t));
+  ASSERT_EQ(RemosaicQuadBayerRaw16(input.data(), output.data(), width, height,
+                                   row_stride * sizeof(uint16_t), max_threads),
+            OK);
+  ASSERT_EQ(output, expected) << width << "x" << height << " stride "
+                              << row_stride << " threads " << max_threads;
+}
+
+}  // namespace
+
+TEST(QuadBayerRemosaicTests, SingleBlock) {
+  // Pixel values are the quad Bayer block index in row major order.
+  std::vector<uint16_t> input(16);
+  for (uint16_t i = 0; i < 16; i++) {
+    input[i] = i;
+  }
+  const std::vector<uint16_t> expected = {0, 8, 4,  12, 2, 10, 9, 14,
+                                          1, 6, 5,  13, 3, 11, 7, 15};
+
+  std::vector<uint16_t> output(16);
+  ASSERT_EQ(RemosaicQuadBayerRaw16(input.data(), output.data(), 4, 4,
+                                   4 * sizeof(uint16_t)),
+            OK);
+  EXPECT_EQ(output, expected);
+}
+
+TEST(QuadBayerRemosaicTests, MatchesGolden) {
+  // Widths with and without a trailing single block.
+  CompareWithGolden(8, 8, 8, 1);
+  CompareWithGolden(12, 4, 12, 1);
+  CompareWithGolden(4000, 3000, 4000, 1);
+  CompareWithGolden(4036, 3024, 4036, 1);
+}
+
+TEST(QuadBayerRemosaicTests, MatchesGoldenWithPaddedStride) {
+  CompareWithGolden(640, 480, 704, 1);
+  CompareWithGolden(644, 480, 648, 1);
+}
+
+TEST(QuadBayerRemosaicTests, MatchesGoldenMultiThreaded) {
+  CompareWithGolden(4000, 3000, 4000, kMaxRemosaicThreads);
+  // Band count not dividing the block row count.
+  CompareWithGolden(1284, 1028, 1296, 3);
+  // Too small to be split.
+  CompareWithGolden(64, 64, 64, kMaxRemosaicThreads);
+}
+
+TEST(QuadBayerRemosaicTests, InvalidArguments) {
+  std::vector<uint16_t> input(64 * 64);
+  std::vector<uint16_t> output(64 * 64);
+  size_t row_stride_in_bytes = 64 * sizeof(uint16_t);
+
+  EXPECT_EQ(RemosaicQuadBayerRaw16(nullptr, output.data(), 64, 64,
+                                   row_stride_in_bytes),
+            BAD_VALUE);
+  EXPECT_EQ(RemosaicQuadBayerRaw16(input.data(), nullptr, 64, 64,
+                                   row_stride_in_bytes),
+            BAD_VALUE);
+  // Dimensions must be multiples of 4.
+  EXPECT_EQ(RemosaicQuadBayerRaw16(input.data(), output.data(), 62, 64,
+                                   row_stride_in_bytes),
+            BAD_VALUE);
+  EXPECT_EQ(RemosaicQuadBayerRaw16(input.data(), output.data(), 64, 62,
+                                   row_stride_in_bytes),
+            BAD_VALUE);
+  // Stride shorter than a row.
+  EXPECT_EQ(RemosaicQuadBayerRaw16(input.data(), output.data(), 64, 64,
+                                   row_stride_in_bytes - 8),
+            BAD_VALUE);
+}
+
+}  // namespace android
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SliceProgressTests"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "utils/SliceProgress.h"
+
+namespace android {
+namespace {
+
+TEST(SliceProgressTests, SignaledRows) {
+  SliceProgress progress(64);
+  EXPECT_EQ(progress.GetRows(), 64u);
+  progress.Signal(16);
+  EXPECT_TRUE(progress.Wait(0));
+  EXPECT_TRUE(progress.Wait(16));
+  // Rows past the end of the image are clamped.
+  progress.Signal(100);
+  EXPECT_TRUE(progress.Wait(100));
+  progress.Finish(true);
+}
+
+TEST(SliceProgressTests, WaitForProducer) {
+  const uint32_t rows = 480, slice_rows = 16;
+  SliceProgress progress(rows);
+  std::thread producer([&progress] {
+    for (uint32_t row = slice_rows; row <= rows; row += slice_rows) {
+      progress.Signal(row);
+    }
+    progress.Finish(true);
+  });
+
+  for (uint32_t row = slice_rows; row <= rows; row += slice_rows) {
+    EXPECT_TRUE(progress.Wait(row));
+  }
+  producer.join();
+}
+
+TEST(SliceProgressTests, ProducerFailure) {
+  SliceProgress progress(64);
+  std::thread producer([&progress] {
+    progress.Signal(16);
+    progress.Finish(false);
+  });
+
+  EXPECT_FALSE(progress.Wait(64));
+  EXPECT_TRUE(progress.Wait(16));
+  producer.join();
+}
+
+TEST(SliceProgressTests, Finished) {
+  SliceProgress progress(64);
+  progress.Finish(true);
+  EXPECT_TRUE(progress.Wait(64));
+}
+
+TEST(SliceProgressTests, WaitFinished) {
+  SliceProgress progress(64);
+  std::atomic_bool finished = false;
+  std::thread producer([&progress, &finished] {
+    progress.Signal(64);
+    // All rows are signaled but the producer still uses the image.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    finished = true;
+    progress.Finish(true);
+  });
+
+  EXPECT_TRUE(progress.Wait(64));
+  progress.WaitFinished();
+  EXPECT_TRUE(finished);
+  producer.join();
+}
+
+}  // namespace
+}  // namespace android
@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "CharacteristicsCache"
+#include "CharacteristicsCache.h"
+
+#include <android-base/file.h>
+#include <android-base/unique_fd.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <log/log.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system/camera_metadata.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace android {
+
+using android::base::unique_fd;
+
+static constexpr char kMagic[8] = {'E', 'M', 'U', 'C', 'H', 'A', 'R', 'S'};
+
+static size_t AlignUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+// 64-bit FNV-1a
+static uint64_t HashBytes(uint64_t hash, const std::string& bytes) {
+  for (unsigned char c : bytes) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+struct BuildIdSearch {
+  uintptr_t address;
+  std::string build_id;
+};
+
+static bool ContainsAddress(const dl_phdr_info* info, uintptr_t address) {
+  for (int i = 0; i < info->dlpi_phnum; i++) {
+    const auto& phdr = info->dlpi_phdr[i];
+    uintptr_t start = info->dlpi_addr + phdr.p_vaddr;
+    if (phdr.p_type == PT_LOAD && address >= start &&
+        address < start + phdr.p_memsz) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static int FindBuildId(dl_phdr_info* info, size_t /*size*/, void* data) {
+  auto search = static_cast<BuildIdSearch*>(data);
+  if (!ContainsAddress(info, search->address)) {
+    return 0;
+  }
+
+  for (int i = 0; i < info->dlpi_phnum; i++) {
+    const auto& phdr = info->dlpi_phdr[i];
+    if (phdr.p_type != PT_NOTE) {
+      continue;
+    }
+
+    auto note =
+        reinterpret_cast<const uint8_t*>(info->dlpi_addr + phdr.p_vaddr);
+    auto end = note + phdr.p_memsz;
+    while (end - note >= static_cast<ptrdiff_t>(sizeof(ElfW(Nhdr)))) {
+      auto header = reinterpret_cast<const ElfW(Nhdr)*>(note);
+      auto name = note + sizeof(ElfW(Nhdr));
+      auto desc = name + AlignUp(header->n_namesz, 4);
+      auto next = desc + AlignUp(header->n_descsz, 4);
+      if (next > end) {
+        break;
+      }
+      if (header->n_type == NT_GNU_BUILD_ID && header->n_namesz == 4 &&
+          memcmp(name, "GNU", 4) == 0) {
+        static constexpr char kHexDigits[] = "0123456789abcdef";
+        for (size_t j = 0; j < header->n_descsz; j++) {
+          search->build_id += kHexDigits[desc[j] >> 4];
+          search->build_id += kHexDigits[desc[j] & 0xf];
+        }
+        return 1;
+      }
+      note = next;
+    }
+  }
+
+  // The binary was found but has no build ID.
+  return 1;
+}
+
+std::string CharacteristicsCache::GetLibraryBuildId() {
+  BuildIdSearch search;
+  search.address = reinterpret_cast<uintptr_t>(&FindBuildId);
+  dl_iterate_phdr(FindBuildId, &search);
+  return search.build_id;
+}
+
+uint64_t CharacteristicsCache::GetContentHash(const std::string& config,
+                                              const std::string& build_id) {
+  uint64_t hash = HashBytes(0xcbf29ce484222325ULL, std::to_string(kVersion));
+  hash = HashBytes(hash, std::string(1, '\0'));
+  hash = HashBytes(hash, build_id);
+  hash = HashBytes(hash, std::string(1, '\0'));
+  return HashBytes(hash, config);
+}
+
+status_t CharacteristicsCache::Load(
+    const std::string& path, uint64_t content_hash,
+    std::vector<std::unique_ptr<HalCameraMetadata>>* characteristics) {
+  if (characteristics == nullptr) {
+    return BAD_VALUE;
+  }
+
+  unique_fd fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+  if (fd.get() < 0) {
+    return NAME_NOT_FOUND;
+  }
+
+  struct stat st;
+  if (fstat(fd.get(), &st) != 0 || st.st_size < 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    ALOGW("%s: Invalid cache file %s", __FUNCTION__, path.c_str());
+    return BAD_VALUE;
+  }
+
+  size_t file_size = st.st_size;
+  void* data = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+  if (data == MAP_FAILED) {
+    ALOGE("%s: Failed to map %s: %s", __FUNCTION__, path.c_str(),
+          strerror(errno));
+    return UNKNOWN_ERROR;
+  }
+
+  const uint8_t* begin = static_cast<const uint8_t*>(data);
+  const Header* header = reinterpret_cast<const Header*>(begin);
+  status_t res = OK;
+  if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+      header->version != kVersion || header->file_size != file_size) {
+    ALOGW("%s: Cache file %s has an unsupported format", __FUNCTION__,
+          path.c_str());
+    res = BAD_VALUE;
+  } else if (header->content_hash != content_hash) {
+    ALOGV("%s: Cache file %s is stale", __FUNCTION__, path.c_str());
+    res = NAME_NOT_FOUND;
+  }
+
+  std::vector<std::unique_ptr<HalCameraMetadata>> loaded;
+  size_t offset = sizeof(Header);
+  for (uint32_t i = 0; res == OK && i < header->camera_count; i++) {
+    uint64_t metadata_size = 0;
+    if (file_size - offset < sizeof(metadata_size)) {
+      res = BAD_VALUE;
+      break;
+    }
+    memcpy(&metadata_size, begin + offset, sizeof(metadata_size));
+    offset += sizeof(metadata_size);
+
+    if (file_size - offset < metadata_size) {
+      res = BAD_VALUE;
+      break;
+    }
+
+    // Metadata buffers are aligned within the file and mmap returns a page
+    // aligned address, so they can be validated and cloned in place.
+    auto metadata =
+        reinterpret_cast<const camera_metadata_t*>(begin + offset);
+    size_t expected_size = metadata_size;
+    if (validate_camera_metadata_structure(metadata, &expected_size) != OK) {
+      res = BAD_VALUE;
+      break;
+    }
+
+    auto hal_metadata = HalCameraMetadata::Clone(metadata);
+    if (hal_metadata == nullptr) {
+      res = NO_MEMORY;
+      break;
+    }
+    loaded.push_back(std::move(hal_metadata));
+    offset += AlignUp(metadata_size, kAlignment);
+  }
+
+  munmap(data, file_size);
+
+  if (res == BAD_VALUE) {
+    ALOGW("%s: Cache file %s is corrupted", __FUNCTION__, path.c_str());
+  }
+  if (res != OK) {
+    return res;
+  }
+
+  *characteristics = std::move(loaded);
+  return OK;
+}
+
+status_t CharacteristicsCache::Store(
+    const std::string& path, uint64_t content_hash,
+    const std::vector<const HalCameraMetadata*>& characteristics) {
+  Header header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.camera_count = characteristics.size();
+  header.content_hash = content_hash;
+
+  std::string blob(sizeof(header), '\0');
+  for (auto metadata : characteristics) {
+    if (metadata == nullptr) {
+      ALOGE("%s: metadata is nullptr", __FUNCTION__);
+      return BAD_VALUE;
+    }
+
+    uint64_t metadata_size = metadata->GetCameraMetadataSize();
+    blob.append(reinterpret_cast<const char*>(&metadata_size),
+                sizeof(metadata_size));
+    blob.append(
+        reinterpret_cast<const char*>(metadata->GetRawCameraMetadata()),
+        metadata_size);
+    blob.resize(AlignUp(blob.size(), kAlignment), '\0');
+  }
+
+  header.file_size = blob.size();
+  memcpy(&blob[0], &header, sizeof(header));
+
+  // Write to a temporary file first so a partially written cache is never
+  // picked up.
+  std::string temp_path = path + ".tmp";
+  if (!android::base::WriteStringToFile(blob, temp_path)) {
+    ALOGW("%s: Failed to write %s: %s", __FUNCTION__, temp_path.c_str(),
+          strerror(errno));
+    return UNKNOWN_ERROR;
+  }
+
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    ALOGW("%s: Failed to rename %s to %s: %s", __FUNCTION__, temp_path.c_str(),
+          path.c_str(), strerror(errno));
+    unlink(temp_path.c_str());
+    return UNKNOWN_ERROR;
+  }
+
+  ALOGV("%s: Stored %zu cameras to %s", __FUNCTION__, characteristics.size(),
+        path.c_str());
+  return OK;
+}
+
+}  // namespace android
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef EMULATOR_CAMERA_HAL_HWL_CHARACTERISTICS_CACHE_H_
+#define EMULATOR_CAMERA_HAL_HWL_CHARACTERISTICS_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hal_camera_metadata.h"
+
+namespace android {
+
+using google_camera_hal::HalCameraMetadata;
+
+// Compiled form of an emulated camera JSON configuration file. It holds the
+// fully resolved static metadata of the cameras described by the file, the
+// logical camera first, followed by its physical cameras. Loading it maps
+// the file and copies the metadata buffers, which avoids parsing the JSON
+// and resolving every tag name on each provider start.
+//
+// File layout, all fields in native byte order:
+//   Header
+//   For each camera: uint64_t metadata size, camera_metadata_t buffer,
+//                    padding to kAlignment bytes.
+//
+// A cache is only valid for the configuration contents and build it was
+// compiled from, see GetContentHash().
+class CharacteristicsCache {
+ public:
+  // Must be bumped whenever the file layout or the way configurations are
+  // parsed changes.
+  static const uint32_t kVersion = 2;
+
+  // Return the GNU build ID of the binary holding the configuration parser,
+  // hex encoded, or an empty string if it wasn't linked with one. Unlike the
+  // build fingerprint it changes with every update of the HAL code, including
+  // APEX updates.
+  static std::string GetLibraryBuildId();
+
+  // Return the hash that identifies a configuration file. build_id is
+  // included since tag ids and parsing may change between builds, kVersion
+  // is always included.
+  static uint64_t GetContentHash(const std::string& config,
+                                 const std::string& build_id);
+
+  // Load the characteristics compiled from a configuration with
+  // content_hash. Return NAME_NOT_FOUND if the cache doesn't exist or was
+  // compiled from different contents, BAD_VALUE if it is corrupted.
+  static status_t Load(
+      const std::string& path, uint64_t content_hash,
+      std::vector<std::unique_ptr<HalCameraMetadata>>* characteristics);
+
+  // Store characteristics compiled from a configuration with content_hash.
+  // The file is replaced atomically.
+  static status_t Store(
+      const std::string& path, uint64_t content_hash,
+      const std::vector<const HalCameraMetadata*>& characteristics);
+
+ private:
+  static const size_t kAlignment = 8;
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t camera_count;
+    uint64_t content_hash;
+    uint64_t file_size;
+  };
+};
+
+}  // namespace android
+
+#endif  // EMULATOR_CAMERA_HAL_HWL_CHARACTERISTICS_CACHE_H_
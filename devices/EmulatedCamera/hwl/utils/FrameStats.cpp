@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FrameStats.h"
+
+namespace android {
+
+float FrameStats::GetMeanLuma() const {
+  if (pixel_count == 0) {
+    return 0.f;
+  }
+  return static_cast<float>(luma_sum) / pixel_count;
+}
+
+float FrameStats::GetSharpness() const {
+  if (gradient_count == 0) {
+    return 0.f;
+  }
+  return static_cast<float>(gradient_energy) / gradient_count;
+}
+
+void FrameStats::GetMeanRgb(float rgb[3]) const {
+  for (size_t c = 0; c < 3; c++) {
+    uint64_t sum = 0;
+    for (size_t zone = 0; zone < kZoneCount; zone++) {
+      sum += zone_rgb_sums[zone][c];
+    }
+    rgb[c] = pixel_count > 0 ? static_cast<float>(sum) / pixel_count : 0.f;
+  }
+}
+
+std::vector<float> FrameStats::GetZoneMeanRgb() const {
+  std::vector<float> means(kZoneCount * 3, 0.f);
+  for (size_t zone = 0; zone < kZoneCount; zone++) {
+    if (zone_pixel_counts[zone] == 0) {
+      continue;
+    }
+    for (size_t c = 0; c < 3; c++) {
+      means[zone * 3 + c] =
+          static_cast<float>(zone_rgb_sums[zone][c]) / zone_pixel_counts[zone];
+    }
+  }
+  return means;
+}
+
+FrameStatsCollector::FrameStatsCollector(FrameStats* stats, uint32_t width,
+                                         uint32_t height)
+    : stats_(stats), height_(height) {
+  if ((width == 0) || (height == 0)) {
+    stats_ = nullptr;
+  }
+  if (stats_ != nullptr) {
+    column_zones_.resize(width);
+    for (uint32_t x = 0; x < width; x++) {
+      column_zones_[x] = x * FrameStats::kZoneGridSize / width;
+    }
+  }
+}
+
+}  // namespace android
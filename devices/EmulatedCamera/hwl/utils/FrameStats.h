@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef EMULATOR_CAMERA_HAL_HWL_FRAME_STATS_H
+#define EMULATOR_CAMERA_HAL_HWL_FRAME_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace android {
+
+// Statistics of a processed frame, collected by the sensor while rendering
+// an output and consumed by the emulated 3A of the following requests.
+struct FrameStats {
+  static constexpr size_t kLumaHistogramBins = 64;
+  // The frame is divided in kZoneGridSize x kZoneGridSize zones.
+  static constexpr size_t kZoneGridSize = 4;
+  static constexpr size_t kZoneCount = kZoneGridSize * kZoneGridSize;
+
+  // Histogram of the 8-bit luma values.
+  uint32_t luma_histogram[kLumaHistogramBins] = {};
+  // Sums of the 8-bit R, G and B values of each zone, in row major order.
+  uint64_t zone_rgb_sums[kZoneCount][3] = {};
+  uint32_t zone_pixel_counts[kZoneCount] = {};
+  uint64_t luma_sum = 0;
+  // Sum of the squared luma differences of horizontally adjacent pixels.
+  uint64_t gradient_energy = 0;
+  uint64_t gradient_count = 0;
+  uint64_t pixel_count = 0;
+  // Sensor exposure time in nanoseconds and sensitivity the frame was
+  // captured with.
+  int64_t exposure_time = 0;
+  int32_t sensitivity = 0;
+
+  bool IsValid() const {
+    return pixel_count > 0;
+  }
+
+  // Mean 8-bit luma of the frame.
+  float GetMeanLuma() const;
+  // Mean squared horizontal luma gradient, higher for sharper frames.
+  float GetSharpness() const;
+  // Mean 8-bit R, G and B values of the frame.
+  void GetMeanRgb(float rgb[3]) const;
+  // Mean 8-bit R, G and B values of each zone, in row major order.
+  std::vector<float> GetZoneMeanRgb() const;
+};
+
+// Accumulates the statistics of a frame rendered row by row, as a side output
+// of the render. Does nothing if constructed with a nullptr FrameStats.
+class FrameStatsCollector {
+ public:
+  FrameStatsCollector(FrameStats* stats, uint32_t width, uint32_t height);
+
+  bool IsCollecting() const {
+    return stats_ != nullptr;
+  }
+
+  // Must be called before adding the pixels of row y.
+  inline void StartRow(uint32_t y) {
+    row_zone_ = (y * FrameStats::kZoneGridSize / height_) *
+                FrameStats::kZoneGridSize;
+    previous_luma_ = -1;
+  }
+
+  // Add pixel x of the current row, pixels must be added left to right.
+  inline void AddPixel(uint32_t x, uint8_t r, uint8_t g, uint8_t b,
+                       uint8_t luma) {
+    size_t zone = row_zone_ + column_zones_[x];
+    stats_->zone_rgb_sums[zone][0] += r;
+    stats_->zone_rgb_sums[zone][1] += g;
+    stats_->zone_rgb_sums[zone][2] += b;
+    stats_->zone_pixel_counts[zone]++;
+    stats_->luma_histogram[luma * FrameStats::kLumaHistogramBins / 256]++;
+    stats_->luma_sum += luma;
+    stats_->pixel_count++;
+    if (previous_luma_ >= 0) {
+      int32_t gradient = luma - previous_luma_;
+      stats_->gradient_energy += gradient * gradient;
+      stats_->gradient_count++;
+    }
+    previous_luma_ = luma;
+  }
+
+ private:
+  FrameStats* stats_;
+  uint32_t height_;
+  // Zone column of each pixel column.
+  std::vector<uint8_t> column_zones_;
+  size_t row_zone_ = 0;
+  int32_t previous_luma_ = -1;
+};
+
+}  // namespace android
+
+#endif  // EMULATOR_CAMERA_HAL_HWL_FRAME_STATS_H
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "QuadBayerRemosaic"
+#include "QuadBayerRemosaic.h"
+
+#include <log/log.h>
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace android {
+
+// Bands smaller than this aren't worth a thread.
+static const size_t kMinBlockRowsPerThread = 64;
+
+// Source of each pixel of a remosaiced 4x4 block, as an index into the quad
+// Bayer block in row major order.
+static const uint8_t kQuadBlockSource[4][4] = {{0, 8, 4, 12},
+                                               {2, 10, 9, 14},
+                                               {1, 6, 5, 13},
+                                               {3, 11, 7, 15}};
+
+static void RemosaicBlockRowScalar(const uint16_t* in_rows[4],
+                                   uint16_t* out_rows[4], size_t x_begin,
+                                   size_t x_end) {
+  for (size_t x = x_begin; x < x_end; x += 4) {
+    for (size_t row = 0; row < 4; row++) {
+      for (size_t col = 0; col < 4; col++) {
+        uint8_t source = kQuadBlockSource[row][col];
+        out_rows[row][x + col] = in_rows[source / 4][x + source % 4];
+      }
+    }
+  }
+}
+
+#if defined(__has_builtin) && __has_builtin(__builtin_shufflevector)
+#define QUAD_BAYER_REMOSAIC_SIMD 1
+
+// Two horizontally adjacent 4x4 blocks of one row.
+typedef uint16_t Pixels8 __attribute__((vector_size(16)));
+
+static inline Pixels8 Load(const uint16_t* pixels) {
+  Pixels8 v;
+  memcpy(&v, pixels, sizeof(v));
+  return v;
+}
+
+static inline void Store(uint16_t* pixels, Pixels8 v) {
+  memcpy(pixels, &v, sizeof(v));
+}
+
+// Remosaic pairs of blocks. Each output row takes pixels from all four input
+// rows, so it is assembled from a shuffle of rows 0 and 1, a shuffle of rows
+// 2 and 3, and a final shuffle picking from those two. Lanes 0-7 of a
+// shuffle index its first operand and lanes 8-15 its second.
+static size_t RemosaicBlockRowSimd(const uint16_t* in_rows[4],
+                                   uint16_t* out_rows[4], size_t width) {
+  size_t x = 0;
+  for (; x + 8 <= width; x += 8) {
+    Pixels8 r0 = Load(in_rows[0] + x);
+    Pixels8 r1 = Load(in_rows[1] + x);
+    Pixels8 r2 = Load(in_rows[2] + x);
+    Pixels8 r3 = Load(in_rows[3] + x);
+
+    Pixels8 lo = __builtin_shufflevector(r0, r1, 0, 0, 8, 0, 4, 0, 12, 0);
+    Pixels8 hi = __builtin_shufflevector(r2, r3, 0, 0, 0, 8, 0, 4, 0, 12);
+    Store(out_rows[0] + x,
+          __builtin_shufflevector(lo, hi, 0, 9, 2, 11, 4, 13, 6, 15));
+
+    lo = __builtin_shufflevector(r0, r1, 2, 0, 0, 0, 6, 0, 0, 0);
+    hi = __builtin_shufflevector(r2, r3, 0, 2, 1, 10, 0, 6, 5, 14);
+    Store(out_rows[1] + x,
+          __builtin_shufflevector(lo, hi, 0, 9, 10, 11, 4, 13, 14, 15));
+
+    lo = __builtin_shufflevector(r0, r1, 1, 10, 9, 0, 5, 14, 13, 0);
+    hi = __builtin_shufflevector(r2, r3, 0, 0, 0, 9, 0, 0, 0, 13);
+    Store(out_rows[2] + x,
+          __builtin_shufflevector(lo, hi, 0, 1, 2, 11, 4, 5, 6, 15));
+
+    lo = __builtin_shufflevector(r0, r1, 3, 0, 11, 0, 7, 0, 15, 0);
+    hi = __builtin_shufflevector(r2, r3, 0, 3, 0, 11, 0, 7, 0, 15);
+    Store(out_rows[3] + x,
+          __builtin_shufflevector(lo, hi, 0, 9, 2, 11, 4, 13, 6, 15));
+  }
+  return x;
+}
+#endif
+
+// Remosaic rows [4 * block_row_begin, 4 * block_row_end).
+static void RemosaicBand(const uint16_t* img_in, uint16_t* img_out,
+                         size_t width, size_t row_stride,
+                         size_t block_row_begin, size_t block_row_end) {
+  for (size_t block_row = block_row_begin; block_row < block_row_end;
+       block_row++) {
+    const uint16_t* in_rows[4];
+    uint16_t* out_rows[4];
+    for (size_t row = 0; row < 4; row++) {
+      in_rows[row] = img_in + (block_row * 4 + row) * row_stride;
+      out_rows[row] = img_out + (block_row * 4 + row) * row_stride;
+    }
+
+    size_t x = 0;
+#ifdef QUAD_BAYER_REMOSAIC_SIMD
+    x = RemosaicBlockRowSimd(in_rows, out_rows, width);
+#endif
+    RemosaicBlockRowScalar(in_rows, out_rows, x, width);
+  }
+}
+
+status_t RemosaicQuadBayerRaw16(const uint16_t* img_in, uint16_t* img_out,
+                                size_t width, size_t height,
+                                size_t row_stride_in_bytes,
+                                size_t max_threads) {
+  if (img_in == nullptr || img_out == nullptr) {
+    ALOGE("%s: Input or output image is nullptr", __FUNCTION__);
+    return BAD_VALUE;
+  }
+
+  if (width % 4 != 0 || height % 4 != 0) {
+    ALOGE("%s: Quad Bayer image size %zux%zu is not a multiple of 4",
+          __FUNCTION__, width, height);
+    return BAD_VALUE;
+  }
+
+  if (row_stride_in_bytes % sizeof(uint16_t) != 0 ||
+      row_stride_in_bytes < width * sizeof(uint16_t)) {
+    ALOGE("%s: Invalid row stride %zu for width %zu", __FUNCTION__,
+          row_stride_in_bytes, width);
+    return BAD_VALUE;
+  }
+
+  size_t row_stride = row_stride_in_bytes / sizeof(uint16_t);
+  size_t block_rows = height / 4;
+  size_t num_threads =
+      std::min({std::max<size_t>(max_threads, 1),
+                std::max<size_t>(std::thread::hardware_concurrency(), 1),
+                std::max<size_t>(block_rows / kMinBlockRowsPerThread, 1)});
+
+  // The calling thread takes the first band.
+  size_t band_size = (block_rows + num_threads - 1) / num_threads;
+  std::vector<std::thread> threads;
+  for (size_t begin = band_size; begin < block_rows; begin += band_size) {
+    size_t end = std::min(begin + band_size, block_rows);
+    threads.emplace_back(RemosaicBand, img_in, img_out, width, row_stride,
+                         begin, end);
+  }
+  RemosaicBand(img_in, img_out, width, row_stride, 0,
+               std::min(band_size, block_rows));
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  return OK;
+}
+
+}  // namespace android
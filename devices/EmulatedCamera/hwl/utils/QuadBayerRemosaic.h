@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef EMULATOR_CAMERA_HAL_HWL_QUAD_BAYER_REMOSAIC_H_
+#define EMULATOR_CAMERA_HAL_HWL_QUAD_BAYER_REMOSAIC_H_
+
+#include <utils/Errors.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace android {
+
+// Maximum number of threads a remosaic is split across.
+static const size_t kMaxRemosaicThreads = 4;
+
+// Rearrange a RAW16 quad Bayer image into a regular Bayer image. Every 4x4
+// block is permuted the same way. Rows of 4 blocks are processed at once,
+// two blocks per SIMD shuffle, and bands of rows are split across up to
+// max_threads threads. width and height must be multiples of 4, img_in and
+// img_out share row_stride_in_bytes and must not overlap.
+status_t RemosaicQuadBayerRaw16(const uint16_t* img_in, uint16_t* img_out,
+                                size_t width, size_t height,
+                                size_t row_stride_in_bytes,
+                                size_t max_threads = kMaxRemosaicThreads);
+
+}  // namespace android
+
+#endif  // EMULATOR_CAMERA_HAL_HWL_QUAD_BAYER_REMOSAIC_H_
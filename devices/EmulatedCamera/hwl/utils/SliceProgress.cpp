@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SliceProgress.h"
+
+#include <algorithm>
+
+namespace android {
+
+void SliceProgress::Signal(uint32_t rows) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  written_rows_ = std::max(written_rows_, std::min(rows, rows_));
+  condition_.notify_all();
+}
+
+void SliceProgress::Finish(bool success) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (success) {
+    written_rows_ = rows_;
+  }
+  finished_ = true;
+  condition_.notify_all();
+}
+
+bool SliceProgress::Wait(uint32_t rows) {
+  rows = std::min(rows, rows_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  condition_.wait(lock,
+                  [this, rows] { return (written_rows_ >= rows) || finished_; });
+  return written_rows_ >= rows;
+}
+
+void SliceProgress::WaitFinished() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  condition_.wait(lock, [this] { return finished_; });
+}
+
+}  // namespace android
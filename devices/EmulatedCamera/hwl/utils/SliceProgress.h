@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef EMULATOR_CAMERA_HAL_HWL_SLICE_PROGRESS_H
+#define EMULATOR_CAMERA_HAL_HWL_SLICE_PROGRESS_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace android {
+
+// Fence-like counter of the rows of an image written so far by a producer.
+// Consumers wait for the rows they need and can start working on the top of
+// the image while the rest is being written.
+class SliceProgress {
+ public:
+  explicit SliceProgress(uint32_t rows) : rows_(rows) {
+  }
+
+  // Signal that rows [0, rows) are written.
+  void Signal(uint32_t rows);
+  // Signal that the producer is done, all rows are written if success is set.
+  // Must be called exactly once, it releases all waiting consumers.
+  void Finish(bool success);
+  // Wait until rows [0, rows) are written. Returns false if the producer
+  // failed before writing them.
+  bool Wait(uint32_t rows);
+  // Wait until the producer is done with the image, e.g. before freeing it.
+  // Rows may all be signaled while the producer still reads them.
+  void WaitFinished();
+
+  uint32_t GetRows() const {
+    return rows_;
+  }
+
+ private:
+  const uint32_t rows_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  // Protected by mutex_.
+  uint32_t written_rows_ = 0;
+  bool finished_ = false;
+};
+
+}  // namespace android
+
+#endif  // EMULATOR_CAMERA_HAL_HWL_SLICE_PROGRESS_H
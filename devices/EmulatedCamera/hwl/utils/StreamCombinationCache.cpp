@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StreamCombinationCache.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace android {
+
+// Stream fields that EmulatedSensor::IsStreamCombinationSupported() depends
+// on. Stream ids, usage and buffer sizes don't change the outcome.
+typedef std::array<int64_t, 12> StreamKey;
+
+static StreamKey GetStreamKey(const google_camera_hal::Stream& stream) {
+  return {static_cast<int64_t>(stream.stream_type),
+          stream.width,
+          stream.height,
+          stream.format,
+          stream.data_space,
+          static_cast<int64_t>(stream.rotation),
+          stream.is_physical_camera_stream,
+          stream.is_physical_camera_stream ? stream.physical_camera_id : 0,
+          stream.group_id,
+          (stream.intended_for_default_resolution_mode ? 1 : 0) |
+              (stream.intended_for_max_resolution_mode ? 2 : 0),
+          stream.dynamic_profile,
+          stream.use_case};
+}
+
+std::string StreamCombinationCache::GetKey(const StreamConfiguration& config) {
+  std::vector<StreamKey> stream_keys;
+  stream_keys.reserve(config.streams.size());
+  for (const auto& stream : config.streams) {
+    stream_keys.push_back(GetStreamKey(stream));
+  }
+  std::sort(stream_keys.begin(), stream_keys.end());
+
+  uint32_t operation_mode = static_cast<uint32_t>(config.operation_mode);
+  std::string key;
+  key.reserve(sizeof(operation_mode) + stream_keys.size() * sizeof(StreamKey));
+  key.append(reinterpret_cast<const char*>(&operation_mode),
+             sizeof(operation_mode));
+  key.append(reinterpret_cast<const char*>(stream_keys.data()),
+             stream_keys.size() * sizeof(StreamKey));
+  return key;
+}
+
+bool StreamCombinationCache::Lookup(const std::string& key, bool* supported) {
+  std::lock_guard<std::mutex> lock(cache_lock_);
+  auto it = entry_map_.find(key);
+  if (it == entry_map_.end()) {
+    return false;
+  }
+
+  entries_.splice(entries_.begin(), entries_, it->second);
+  *supported = it->second->second;
+  return true;
+}
+
+void StreamCombinationCache::Insert(const std::string& key, bool supported) {
+  std::lock_guard<std::mutex> lock(cache_lock_);
+  if (capacity_ == 0) {
+    return;
+  }
+
+  auto it = entry_map_.find(key);
+  if (it != entry_map_.end()) {
+    it->second->second = supported;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+
+  if (entries_.size() >= capacity_) {
+    entry_map_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+
+  entries_.emplace_front(key, supported);
+  entry_map_[key] = entries_.begin();
+}
+
+void StreamCombinationCache::Clear() {
+  std::lock_guard<std::mutex> lock(cache_lock_);
+  entries_.clear();
+  entry_map_.clear();
+}
+
+}  // namespace android
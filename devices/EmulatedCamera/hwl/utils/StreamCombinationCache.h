@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef EMULATOR_CAMERA_HAL_HWL_STREAM_COMBINATION_CACHE_H_
+#define EMULATOR_CAMERA_HAL_HWL_STREAM_COMBINATION_CACHE_H_
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "hal_types.h"
+
+namespace android {
+
+using google_camera_hal::StreamConfiguration;
+
+// Least recently used memo of stream combination query results of a single
+// camera device. Stream combinations are keyed by the stream fields the
+// query depends on, regardless of stream order and stream ids, so the
+// repeated queries issued by the camera framework during startup resolve
+// with a single hash lookup.
+class StreamCombinationCache {
+ public:
+  static const size_t kDefaultCapacity = 64;
+
+  explicit StreamCombinationCache(size_t capacity = kDefaultCapacity)
+      : capacity_(capacity) {
+  }
+
+  // Return the canonical key of a stream combination.
+  static std::string GetKey(const StreamConfiguration& config);
+
+  // Return true and set supported if key was cached.
+  bool Lookup(const std::string& key, bool* supported);
+
+  void Insert(const std::string& key, bool supported);
+
+  void Clear();
+
+ private:
+  typedef std::pair<std::string, bool> Entry;
+
+  const size_t capacity_;
+
+  std::mutex cache_lock_;
+  // From the most to the least recently used. Protected by cache_lock_.
+  std::list<Entry> entries_;
+  // Protected by cache_lock_.
+  std::unordered_map<std::string, std::list<Entry>::iterator> entry_map_;
+};
+
+}  // namespace android
+
+#endif  // EMULATOR_CAMERA_HAL_HWL_STREAM_COMBINATION_CACHE_H_
@@ -65,6 +65,8 @@ void StreamConfigurationMap::AppendAvailableStreamConfigurations(
     if (!isInput) {
       stream_output_formats_.insert(format);
       stream_output_size_map_[format].insert(std::make_pair(width, height));
+      stream_output_configs_.insert(
+          std::make_pair(format, std::make_pair(width, height)));
     }
   }
 }
@@ -82,6 +84,8 @@ void StreamConfigurationMap::AppendAvailableDynamicPhysicalStreamConfigurations(
     dynamic_physical_stream_output_formats_.insert(format);
     dynamic_physical_stream_output_size_map_[format].insert(
         std::make_pair(width, height));
+    dynamic_physical_stream_output_configs_.insert(
+        std::make_pair(format, std::make_pair(width, height)));
   }
 }
 
@@ -20,6 +20,7 @@
 #include <memory>
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "hwl_types.h"
 #include "system/camera_metadata.h"
@@ -65,6 +66,15 @@ class StreamConfigurationMap {
     return stream_output_size_map_[format];
   }
 
+  // Constant time lookup of a single output format and size, which unlike
+  // GetOutputSizes() doesn't modify the map for unknown formats.
+  bool IsOutputSupported(android_pixel_format_t format, uint32_t width,
+                         uint32_t height) const {
+    return stream_output_configs_.find(std::make_pair(
+               format, std::make_pair(width, height))) !=
+           stream_output_configs_.end();
+  }
+
   const std::set<android_pixel_format_t>& GetDynamicPhysicalStreamOutputFormats()
       const {
     return dynamic_physical_stream_output_formats_;
@@ -75,6 +85,13 @@ class StreamConfigurationMap {
     return dynamic_physical_stream_output_size_map_[format];
   }
 
+  bool IsDynamicPhysicalOutputSupported(android_pixel_format_t format,
+                                        uint32_t width, uint32_t height) const {
+    return dynamic_physical_stream_output_configs_.find(std::make_pair(
+               format, std::make_pair(width, height))) !=
+           dynamic_physical_stream_output_configs_.end();
+  }
+
   nsecs_t GetOutputMinFrameDuration(StreamConfig configuration) const {
     auto ret = stream_min_duration_map_.find(configuration);
     return (ret == stream_min_duration_map_.end()) ? 0 : ret->second;
@@ -89,6 +106,12 @@ class StreamConfigurationMap {
     return !stream_input_output_map_.empty();
   }
 
+  bool IsInputSupported(android_pixel_format_t format) const {
+    auto outputs = stream_input_output_map_.find(format);
+    return outputs != stream_input_output_map_.end() &&
+           !outputs->second.empty();
+  }
+
   const std::set<android_pixel_format_t>& GetValidOutputFormatsForInput(
       android_pixel_format_t format) {
     return stream_input_output_map_[format];
@@ -116,6 +139,9 @@ class StreamConfigurationMap {
   std::set<android_pixel_format_t> stream_output_formats_;
   std::unordered_map<android_pixel_format_t, std::set<StreamSize>>
       stream_output_size_map_;
+  // Same contents as stream_output_size_map_, indexed by format and size.
+  std::unordered_set<StreamConfig, StreamConfigurationHash>
+      stream_output_configs_;
   std::unordered_map<StreamConfig, nsecs_t, StreamConfigurationHash>
       stream_stall_map_;
   std::unordered_map<StreamConfig, nsecs_t, StreamConfigurationHash>
@@ -127,6 +153,8 @@ class StreamConfigurationMap {
   std::set<android_pixel_format_t> dynamic_physical_stream_output_formats_;
   std::unordered_map<android_pixel_format_t, std::set<StreamSize>>
       dynamic_physical_stream_output_size_map_;
+  std::unordered_set<StreamConfig, StreamConfigurationHash>
+      dynamic_physical_stream_output_configs_;
 };
 
 typedef std::unordered_map<uint32_t, std::unique_ptr<StreamConfigurationMap>>